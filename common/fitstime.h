@@ -0,0 +1,82 @@
+/*
+    FITS timestamps for frames dated by the driver
+
+    Copyright (C) 2026 INDI 3rd party contributors
+
+    This library is free software; you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published
+    by the Free Software Foundation; either version 2.1 of the License, or
+    (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful, but
+    WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+    or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public
+    License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with this library; if not, write to the Free Software Foundation,
+    Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA
+
+    Header only so that every driver can use it by adding ../common to its
+    include directories.
+
+    INDI::CCD fills DATE-OBS from the start of the exposure it last armed.
+    Drivers that upload a frame after the next exposure has started, or
+    several frames per exposure, replace it with the start of the frame
+    itself, formatted the same way.
+*/
+
+#pragma once
+
+#include <chrono>
+#include <cstdio>
+#include <ctime>
+#include <string>
+#include <vector>
+
+#include <sys/time.h>
+
+namespace FITSTime
+{
+
+// UTC time as YYYY-MM-DDThh:mm:ss.sss, the format of DATE-OBS
+inline std::string isoTimestamp(time_t seconds, long milliseconds)
+{
+    struct tm utc;
+    gmtime_r(&seconds, &utc);
+    char timestamp[32], iso[40];
+    strftime(timestamp, sizeof(timestamp), "%Y-%m-%dT%H:%M:%S", &utc);
+    snprintf(iso, sizeof(iso), "%s.%03ld", timestamp, milliseconds);
+    return iso;
+}
+
+inline std::string isoTimestamp(const timeval &time)
+{
+    return isoTimestamp(time.tv_sec, static_cast<long>(time.tv_usec / 1000));
+}
+
+inline std::string isoTimestamp(std::chrono::system_clock::time_point time)
+{
+    auto sinceEpoch = time.time_since_epoch();
+    auto seconds = std::chrono::duration_cast<std::chrono::seconds>(sinceEpoch);
+    auto milliseconds = std::chrono::duration_cast<std::chrono::milliseconds>(sinceEpoch - seconds);
+    return isoTimestamp(static_cast<time_t>(seconds.count()), static_cast<long>(milliseconds.count()));
+}
+
+// Replaces the record with the same key, or appends it when the base class did not write one.
+// Record is INDI::FITSRecord, a template keeps this header free of INDI includes.
+template <typename Record>
+void replaceRecord(std::vector<Record> &records, const Record &record)
+{
+    for (auto &oneRecord : records)
+    {
+        if (oneRecord.key() == record.key())
+        {
+            oneRecord = record;
+            return;
+        }
+    }
+    records.push_back(record);
+}
+
+}
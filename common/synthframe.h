@@ -0,0 +1,317 @@
+/*
+    Synthetic frame generator for driver simulation modes
+
+    Copyright (C) 2026 INDI 3rd party contributors
+
+    This library is free software; you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published
+    by the Free Software Foundation; either version 2.1 of the License, or
+    (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful, but
+    WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+    or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public
+    License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with this library; if not, write to the Free Software Foundation,
+    Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA
+
+    Header only so that every driver can use it from its simulation path by
+    adding ../common to its include directories.
+
+    The generator renders bias, dark, flat and light (star field) frames into
+    a caller supplied buffer. The star field is defined in unbinned sensor
+    coordinates so that subframes and binning show the same sky. Rows are
+    split into bands that are rendered in parallel.
+*/
+
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+namespace SynthFrame
+{
+
+// Same order as INDI::CCDChip::CCD_FRAME so drivers can cast the chip frame type.
+enum FrameType
+{
+    LIGHT_FRAME,
+    BIAS_FRAME,
+    DARK_FRAME,
+    FLAT_FRAME
+};
+
+struct Params
+{
+    // Geometry in unbinned sensor pixels.
+    int sensorWidth  { 0 };
+    int sensorHeight { 0 };
+    int subX { 0 };
+    int subY { 0 };
+    int subW { 0 };
+    int subH { 0 };
+    int binX { 1 };
+    int binY { 1 };
+    // 8 or 16 bits per pixel. 16 bit pixels are written in host byte order.
+    int bpp { 16 };
+
+    FrameType frameType { LIGHT_FRAME };
+    // Exposure duration in seconds.
+    double exposure { 1.0 };
+
+    // Sensor model, all values in 16 bit ADU.
+    double bias        { 500.0 };
+    double readNoise   { 8.0 };
+    double darkCurrent { 0.5 };     // ADU/s/pixel
+    double skyLevel    { 50.0 };    // ADU/s/pixel
+    double flatLevel   { 30000.0 }; // ADU, independent of exposure
+    double hotPixels   { 0.0005 };  // Fraction of pixels with high dark current
+
+    // Star field.
+    int starCount    { 300 };
+    double maxFlux   { 200000.0 };  // ADU/s of the brightest star
+    double fwhm      { 3.0 };       // Unbinned pixels
+    // Field offset in unbinned pixels, e.g. to simulate drift for guiding tests.
+    double offsetX   { 0 };
+    double offsetY   { 0 };
+
+    uint32_t seed { 1 };
+    // Number of worker threads, 0 selects the hardware concurrency.
+    int threads { 0 };
+};
+
+namespace detail
+{
+
+// Small and fast generator, good enough for simulated sensor noise.
+struct XorShift
+{
+    uint64_t state;
+
+    explicit XorShift(uint64_t seed) : state(seed * 0x9E3779B97F4A7C15ULL + 0x2545F4914F6CDD1DULL)
+    {
+        if (state == 0)
+            state = 0x2545F4914F6CDD1DULL;
+    }
+
+    uint64_t next()
+    {
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        return state;
+    }
+
+    // Uniform in [0, 1)
+    double uniform()
+    {
+        return (next() >> 11) * (1.0 / 9007199254740992.0);
+    }
+
+    // Approximately normal with zero mean and unit variance (Irwin-Hall, n = 4).
+    double gaussian()
+    {
+        uint64_t r = next();
+        double sum = static_cast<double>(r & 0xFFFF) + static_cast<double>((r >> 16) & 0xFFFF) +
+                     static_cast<double>((r >> 32) & 0xFFFF) + static_cast<double>(r >> 48);
+        return (sum / 65536.0 - 2.0) * 1.7320508075688772;
+    }
+};
+
+// Stateless uniform value in [0, 1) for a sensor location, used for fixed pattern defects.
+inline double pixelHash(uint32_t x, uint32_t y, uint32_t seed)
+{
+    uint64_t h = (static_cast<uint64_t>(x) << 32 | y) ^ (static_cast<uint64_t>(seed) * 0xBF58476D1CE4E5B9ULL);
+    h ^= h >> 30;
+    h *= 0xBF58476D1CE4E5B9ULL;
+    h ^= h >> 27;
+    h *= 0x94D049BB133111EBULL;
+    h ^= h >> 31;
+    return (h >> 11) * (1.0 / 9007199254740992.0);
+}
+
+struct Star
+{
+    double x, y, flux;
+};
+
+}
+
+class Generator
+{
+    public:
+        /**
+         * @brief render Fill buffer with a synthetic frame.
+         * @param params frame description.
+         * @param buffer destination of (subW / binX) * (subH / binY) pixels of bpp bits.
+         */
+        void render(const Params &params, void *buffer)
+        {
+            const int width  = params.subW / std::max(1, params.binX);
+            const int height = params.subH / std::max(1, params.binY);
+            if (width <= 0 || height <= 0 || buffer == nullptr)
+                return;
+
+            if (params.frameType == LIGHT_FRAME)
+                prepareStars(params);
+            m_Frame++;
+
+            int threads = params.threads > 0 ? params.threads : static_cast<int>(std::thread::hardware_concurrency());
+            threads = std::max(1, std::min(threads, height / 16 + 1));
+
+            const int band = (height + threads - 1) / threads;
+            std::vector<std::thread> workers;
+            for (int i = 1; i < threads; i++)
+            {
+                int first = i * band;
+                int last  = std::min(height, first + band);
+                if (first < last)
+                    workers.emplace_back(&Generator::renderRows, this, std::cref(params), buffer, first, last);
+            }
+            renderRows(params, buffer, 0, std::min(height, band));
+            for (auto &worker : workers)
+                worker.join();
+        }
+
+    private:
+        void prepareStars(const Params &params)
+        {
+            if (params.sensorWidth == m_Width && params.sensorHeight == m_Height && params.seed == m_Seed &&
+                    params.starCount == static_cast<int>(m_Stars.size()))
+                return;
+
+            m_Width  = params.sensorWidth;
+            m_Height = params.sensorHeight;
+            m_Seed   = params.seed;
+            m_Stars.clear();
+            m_Stars.reserve(params.starCount);
+
+            detail::XorShift rng(params.seed);
+            for (int i = 0; i < params.starCount; i++)
+            {
+                detail::Star star;
+                star.x = rng.uniform() * m_Width;
+                star.y = rng.uniform() * m_Height;
+                // Roughly follow the number counts of a real field, few bright and many faint stars.
+                star.flux = params.maxFlux * std::pow(rng.uniform(), 4.0);
+                m_Stars.push_back(star);
+            }
+            // Sorted by row so that each band only visits the stars it can see.
+            std::sort(m_Stars.begin(), m_Stars.end(), [](const detail::Star & a, const detail::Star & b)
+            {
+                return a.y < b.y;
+            });
+        }
+
+        void renderRows(const Params &params, void *buffer, int firstRow, int lastRow) const
+        {
+            const int width     = params.subW / std::max(1, params.binX);
+            const int binX      = std::max(1, params.binX);
+            const int binY      = std::max(1, params.binY);
+            const double maxADU = params.bpp == 8 ? 255.0 : 65535.0;
+            const double scale  = params.bpp == 8 ? 1.0 / 256.0 : 1.0;
+
+            // Binned pixels are sampled at their centre and scaled like an average of the bin, so the
+            // levels stay the same across binning modes.
+            double level = params.bias;
+            switch (params.frameType)
+            {
+                case BIAS_FRAME:
+                    break;
+                case DARK_FRAME:
+                    level += params.darkCurrent * params.exposure;
+                    break;
+                case FLAT_FRAME:
+                    level += params.flatLevel;
+                    break;
+                case LIGHT_FRAME:
+                    level += (params.darkCurrent + params.skyLevel) * params.exposure;
+                    break;
+            }
+
+            const double sigma     = std::max(0.1, params.fwhm / 2.3548);
+            const double radius    = 4.0 * sigma;
+            const double inv2s2    = 1.0 / (2.0 * sigma * sigma);
+            const double peakScale = params.exposure / (2.0 * M_PI * sigma * sigma);
+            const double cx        = params.sensorWidth / 2.0;
+            const double cy        = params.sensorHeight / 2.0;
+            const double vignette  = 0.25 / std::max(1.0, cx * cx + cy * cy);
+            const bool hasDark     = params.frameType == DARK_FRAME || params.frameType == LIGHT_FRAME;
+
+            std::vector<double> row(width);
+
+            for (int y = firstRow; y < lastRow; y++)
+            {
+                // Seeded per row so the output does not depend on how rows are split between threads.
+                detail::XorShift rng((static_cast<uint64_t>(params.seed) << 32) + m_Frame * 65536 + y);
+                // Centre of the binned pixel row in sensor coordinates.
+                const double sy = params.subY + (y + 0.5) * binY;
+
+                for (int x = 0; x < width; x++)
+                    row[x] = level;
+
+                if (params.frameType == FLAT_FRAME)
+                {
+                    for (int x = 0; x < width; x++)
+                    {
+                        double sx = params.subX + (x + 0.5) * binX;
+                        double r2 = (sx - cx) * (sx - cx) + (sy - cy) * (sy - cy);
+                        row[x] -= params.flatLevel * vignette * r2;
+                    }
+                }
+                else if (params.frameType == LIGHT_FRAME)
+                {
+                    // Stars are sorted by y, jump to the first one within reach of this row.
+                    double top = sy - params.offsetY - radius - binY;
+                    auto it = std::lower_bound(m_Stars.begin(), m_Stars.end(), top,
+                                               [](const detail::Star & s, double v)
+                    {
+                        return s.y < v;
+                    });
+                    for (; it != m_Stars.end() && it->y + params.offsetY <= sy + radius + binY; ++it)
+                    {
+                        double starX = it->x + params.offsetX;
+                        double dy    = sy - (it->y + params.offsetY);
+                        int x0 = std::max(0, static_cast<int>((starX - radius - params.subX) / binX));
+                        int x1 = std::min(width - 1, static_cast<int>((starX + radius - params.subX) / binX));
+                        double rowWeight = std::exp(-dy * dy * inv2s2) * it->flux * peakScale;
+                        for (int x = x0; x <= x1; x++)
+                        {
+                            double dx = params.subX + (x + 0.5) * binX - starX;
+                            row[x] += rowWeight * std::exp(-dx * dx * inv2s2);
+                        }
+                    }
+                }
+
+                for (int x = 0; x < width; x++)
+                {
+                    double signal = row[x];
+                    if (hasDark && detail::pixelHash(params.subX + x * binX, static_cast<uint32_t>(sy), params.seed) < params.hotPixels)
+                        signal += 200.0 * params.darkCurrent * params.exposure;
+                    // Shot noise on the accumulated signal plus read noise of the binned pixel.
+                    double variance = std::max(0.0, signal - params.bias) + params.readNoise * params.readNoise;
+                    double value = (signal + std::sqrt(variance) * rng.gaussian()) * scale;
+                    value = std::min(maxADU, std::max(0.0, value));
+
+                    if (params.bpp == 8)
+                        static_cast<uint8_t *>(buffer)[y * width + x] = static_cast<uint8_t>(value);
+                    else
+                        static_cast<uint16_t *>(buffer)[y * width + x] = static_cast<uint16_t>(value);
+                }
+            }
+        }
+
+        std::vector<detail::Star> m_Stars;
+        int m_Width { 0 };
+        int m_Height { 0 };
+        uint32_t m_Seed { 0 };
+        // Changes the noise pattern from one frame to the next.
+        uint64_t m_Frame { 0 };
+};
+
+}
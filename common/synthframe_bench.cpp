@@ -0,0 +1,74 @@
+/*
+    Synthetic frame generator benchmark
+
+    This library is free software; you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published
+    by the Free Software Foundation; either version 2.1 of the License, or
+    (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful, but
+    WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+    or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public
+    License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with this library; if not, write to the Free Software Foundation,
+    Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA
+
+    Measures how fast the simulation modes render synthetic frames, to check
+    that the generator can keep up with the exposure rate of a simulated
+    sequence. Only the rendering into the frame buffer is timed. The FITS
+    packing and BLOB upload that follow ExposureComplete() are not, so the
+    BLOB pipeline is load tested by running a simulated driver instead.
+
+    Usage: synthframe_bench [width] [height] [bin] [bpp] [frames] [threads]
+*/
+
+#include "synthframe.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+
+int main(int argc, char *argv[])
+{
+    SynthFrame::Params params;
+    params.sensorWidth  = argc > 1 ? atoi(argv[1]) : 4656;
+    params.sensorHeight = argc > 2 ? atoi(argv[2]) : 3520;
+    params.binX = params.binY = argc > 3 ? atoi(argv[3]) : 1;
+    params.bpp          = argc > 4 ? atoi(argv[4]) : 16;
+    int frames          = argc > 5 ? atoi(argv[5]) : 20;
+    params.threads      = argc > 6 ? atoi(argv[6]) : 0;
+    params.subW         = params.sensorWidth;
+    params.subH         = params.sensorHeight;
+
+    if (params.sensorWidth <= 0 || params.sensorHeight <= 0 || params.binX <= 0 || frames <= 0 ||
+            (params.bpp != 8 && params.bpp != 16))
+    {
+        fprintf(stderr, "Usage: %s [width] [height] [bin] [bpp] [frames] [threads]\n", argv[0]);
+        return 1;
+    }
+
+    size_t size = static_cast<size_t>(params.subW / params.binX) * (params.subH / params.binY) * params.bpp / 8;
+    std::vector<uint8_t> buffer(size);
+    SynthFrame::Generator generator;
+
+    const SynthFrame::FrameType types[] = { SynthFrame::BIAS_FRAME, SynthFrame::DARK_FRAME, SynthFrame::FLAT_FRAME, SynthFrame::LIGHT_FRAME };
+    const char *names[] = { "Bias", "Dark", "Flat", "Light" };
+
+    for (int t = 0; t < 4; t++)
+    {
+        params.frameType = types[t];
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < frames; i++)
+            generator.render(params, buffer.data());
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+        printf("%-5s %dx%d bin %d %d-bit: render %.1f ms/frame, %.1f fps, %.1f MB/s\n", names[t],
+               params.subW / params.binX, params.subH / params.binY, params.binX, params.bpp,
+               elapsed.count() * 1000.0 / frames, frames / elapsed.count(),
+               size * frames / elapsed.count() / 1e6);
+    }
+
+    return 0;
+}
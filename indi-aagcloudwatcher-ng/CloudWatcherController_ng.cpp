@@ -29,11 +29,14 @@ Anemometer code contributed by Joao Bento.
 #include "indiweather.h"
 #include "connectionplugins/connectionserial.h"
 
+#include <chrono>
 #include <cmath>
 #include <cstring>
 #include <iostream>
 
 #define READ_TIMEOUT 5
+#define ACQUISITION_PERIOD 10 /* Default time over which the acquisition thread spreads a cycle of readings (s) */
+#define ACQUISITION_RETRY 5   /* Pause after a failed reading of the acquisition thread (s) */
 
 /******************************************************************/
 /* PUBLIC MEMBERS                                                */
@@ -47,6 +50,11 @@ CloudWatcherController::CloudWatcherController(bool verbose) : verbose(verbose)
 {
 }
 
+CloudWatcherController::~CloudWatcherController()
+{
+    stopAcquisition();
+}
+
 const char *CloudWatcherController::getDeviceName()
 {
     return "AAG Cloud Watcher NG";
@@ -62,8 +70,16 @@ void CloudWatcherController::setAnemometerType(enum ANEMOMETER_TYPE type)
     anemometerType = type;
 }
 
+void CloudWatcherController::setAcquisitionPeriod(double seconds)
+{
+    std::lock_guard<std::mutex> lock(dataMutex);
+    acquisitionPeriod = seconds > 0 ? seconds : ACQUISITION_PERIOD;
+}
+
 bool CloudWatcherController::checkCloudWatcher()
 {
+    std::lock_guard<std::recursive_mutex> lock(portMutex);
+
     sendCloudwatcherCommand("A!");
 
     char inputBuffer[BLOCK_SIZE * 2];
@@ -90,6 +106,8 @@ bool CloudWatcherController::checkCloudWatcher()
 
 bool CloudWatcherController::getSwitchStatus(int *switchStatus)
 {
+    std::lock_guard<std::recursive_mutex> lock(portMutex);
+
     sendCloudwatcherCommand("F!");
 
     char inputBuffer[BLOCK_SIZE * 2];
@@ -119,19 +137,9 @@ bool CloudWatcherController::getSwitchStatus(int *switchStatus)
 
 bool CloudWatcherController::getAllData(CloudWatcherData *cwd)
 {
-    int skyTemperature[NUMBER_OF_READS] = {0};
-    int sensorTemperature[NUMBER_OF_READS] = {0};
-    int rainFrequency[NUMBER_OF_READS] = {0};
-    int internalSupplyVoltage[NUMBER_OF_READS] = {0};
-    int ambientTemperature[NUMBER_OF_READS] = {0};
-    int ldrValue[NUMBER_OF_READS] = {0};
-    int ldrFreqValue[NUMBER_OF_READS] = {0};
-    int rainSensorTemperature[NUMBER_OF_READS] = {0};
-    int windSpeed[NUMBER_OF_READS] = {0};
-    int humidity[NUMBER_OF_READS] = {0};
-    int pressure[NUMBER_OF_READS] = {0};
+    std::lock_guard<std::recursive_mutex> lock(portMutex);
 
-    int check = 0;
+    CloudWatcherSample samples[NUMBER_OF_READS];
 
     totalReadings++;
 
@@ -140,126 +148,164 @@ bool CloudWatcherController::getAllData(CloudWatcherData *cwd)
 
     for (int i = 0; i < NUMBER_OF_READS; i++)
     {
-        check = getIRSkyTemperature(&skyTemperature[i]);
-
-        if (!check)
+        if (!readSample(&samples[i]))
         {
-            LOG_ERROR( "ERROR in getIRSkyTemperature" );
             return false;
         }
+    }
 
-        check = getIRSensorTemperature(&sensorTemperature[i]);
+    timeval end;
+    gettimeofday(&end, nullptr);
 
-        if (!check)
-        {
-            LOG_ERROR( "ERROR in getIRSensorTemperature" );
-            return false;
-        }
+    float rc = float(end.tv_sec - begin.tv_sec) + float(end.tv_usec - begin.tv_usec) / 1000000.0;
 
-        check = getRainFrequency(&rainFrequency[i]);
-        if (!check)
-        {
-            LOG_ERROR( "ERROR in getIRSensorTemperature" );
-            return false;
-        }
+    cwd->readCycle = rc;
 
-        check = getValues(&internalSupplyVoltage[i], &ambientTemperature[i], &ldrValue[i], &ldrFreqValue[i], &rainSensorTemperature[i]);
+    aggregateSamples(samples, NUMBER_OF_READS, cwd);
+    cwd->totalReadings   = totalReadings;
 
-        if (!check)
-        {
-            LOG_ERROR( "ERROR in getValues" );
-            return false;
-        }
+    return readStatus(cwd);
+}
 
-        check = getWindSpeed(&windSpeed[i]);
+void CloudWatcherController::startAcquisition()
+{
+    stopAcquisition();
 
-        if (!check)
-        {
-            LOG_ERROR( "ERROR in getWindSpeed" );
-            return false;
-        }
+    acquisitionQuit = false;
+    latestValid     = false;
+    acquisition     = std::thread(&CloudWatcherController::acquisitionLoop, this);
 
-        if (m_FirmwareVersion >= 5.6)
-        {
-            check = getHumidity(&humidity[i]);
+    // Wait for the first reading, so the first weather update already has data
+    std::unique_lock<std::mutex> lock(dataMutex);
+    acquisitionCondition.wait_for(lock, std::chrono::seconds(READ_TIMEOUT), [this]()
+    {
+        return latestValid;
+    });
+}
 
-            if (!check)
-            {
-                LOG_ERROR( "ERROR in getHumidity" );
-                return false;
-            }
-        }
+void CloudWatcherController::stopAcquisition()
+{
+    if (!acquisition.joinable())
+    {
+        return;
+    }
 
-        if (m_FirmwareVersion >= 5.8)
-        {
+    {
+        std::lock_guard<std::mutex> lock(dataMutex);
+        acquisitionQuit = true;
+    }
+    acquisitionCondition.notify_all();
+    acquisition.join();
+}
+
+bool CloudWatcherController::getLatestData(CloudWatcherData *cwd)
+{
+    std::lock_guard<std::mutex> lock(dataMutex);
 
-            check = getPressure(&pressure[i]);
+    if (!latestValid)
+    {
+        return false;
+    }
 
-            if (!check)
+    *cwd = latestData;
+
+    return true;
+}
+
+void CloudWatcherController::acquisitionLoop()
+{
+    std::vector<CloudWatcherSample> samples;
+    std::vector<float> sampleDurations;
+    CloudWatcherData data {};
+    int readings = 0;
+
+    while (true)
+    {
+        double period;
+        {
+            std::lock_guard<std::mutex> lock(dataMutex);
+            if (acquisitionQuit)
             {
-                LOG_ERROR( "ERROR in getPressure" );
-                return false;
+                break;
             }
+            period = acquisitionPeriod;
         }
-    }
-
-    timeval end;
-    gettimeofday(&end, nullptr);
 
-    float rc = float(end.tv_sec - begin.tv_sec) + float(end.tv_usec - begin.tv_usec) / 1000000.0;
+        auto start = std::chrono::steady_clock::now();
+        CloudWatcherSample sample;
+        bool check;
 
-    cwd->readCycle = rc;
+        // The port is only held for one reading, so switch and heater commands do not wait for a whole cycle
+        {
+            std::lock_guard<std::recursive_mutex> lock(portMutex);
+            check = readSample(&sample);
 
-    cwd->sky             = aggregateInts(skyTemperature, NUMBER_OF_READS);
-    cwd->sensor          = aggregateInts(sensorTemperature, NUMBER_OF_READS);
-    cwd->rain            = aggregateInts(rainFrequency, NUMBER_OF_READS);
-    cwd->supply          = aggregateInts(internalSupplyVoltage, NUMBER_OF_READS);
-    cwd->ambient         = aggregateInts(ambientTemperature, NUMBER_OF_READS);
-    cwd->ldr             = aggregateInts(ldrValue, NUMBER_OF_READS);
-    cwd->ldrFreq          = aggregateInts(ldrFreqValue, NUMBER_OF_READS);
-    cwd->rainTemperature = aggregateInts(rainSensorTemperature, NUMBER_OF_READS);
-    cwd->windSpeed       = aggregateInts(windSpeed, NUMBER_OF_READS);
-    if (m_FirmwareVersion >= 5.6)
-        cwd->humidity        = aggregateInts(humidity, NUMBER_OF_READS);
-    else
-        cwd->humidity = -1;
-    if (m_FirmwareVersion >= 5.8)
-        cwd->pressure        = aggregateInts(pressure, NUMBER_OF_READS);
-    else
-        cwd->pressure = -1;
-    cwd->totalReadings   = totalReadings;
+            // Errors, heater and switch are read once per cycle, as in getAllData()
+            if (check && readings % NUMBER_OF_READS == 0)
+            {
+                check = readStatus(&data);
+            }
+        }
 
-    check = getIRErrors(&cwd->firstByteErrors, &cwd->commandByteErrors, &cwd->secondByteErrors, &cwd->pecByteErrors);
+        auto duration = std::chrono::duration<float>(std::chrono::steady_clock::now() - start).count();
 
-    if (!check)
-    {
-        LOG_DEBUG( "ERROR in getIRErrors" );
-        return false;
-    }
+        std::unique_lock<std::mutex> lock(dataMutex);
 
-    cwd->internalErrors = cwd->firstByteErrors + cwd->commandByteErrors + cwd->secondByteErrors + cwd->pecByteErrors;
+        if (!check)
+        {
+            // Start over, the failed reading may have left the device out of step
+            samples.clear();
+            sampleDurations.clear();
+            readings    = 0;
+            latestValid = false;
+            acquisitionCondition.wait_for(lock, std::chrono::seconds(ACQUISITION_RETRY), [this]()
+            {
+                return acquisitionQuit;
+            });
+            continue;
+        }
 
-    check = getPWMDutyCycle(&cwd->rainHeater);
+        readings++;
+        samples.push_back(sample);
+        sampleDurations.push_back(duration);
+        if (samples.size() > NUMBER_OF_READS)
+        {
+            samples.erase(samples.begin());
+            sampleDurations.erase(sampleDurations.begin());
+        }
 
-    if (!check)
-    {
-        LOG_DEBUG( "ERROR in getPWMDutyCycle" );
-        return false;
-    }
+        // Rolling aggregate of the last NUMBER_OF_READS readings. As in getAllData(), readCycle is the
+        // time spent reading them, without the pauses, and totalReadings counts complete cycles.
+        aggregateSamples(samples.data(), samples.size(), &data);
+        data.readCycle = 0;
+        for (float sampleDuration : sampleDurations)
+        {
+            data.readCycle += sampleDuration;
+        }
+        if (readings % NUMBER_OF_READS == 0)
+        {
+            totalReadings++;
+        }
+        data.totalReadings = totalReadings;
 
-    check = getSwitchStatus(&cwd->switchStatus);
+        latestData  = data;
+        latestValid = true;
+        acquisitionCondition.notify_all();
 
-    if (!check)
-    {
-        LOG_DEBUG( "ERROR in getSwitchStatus" );
-        return false;
+        // A cycle of NUMBER_OF_READS readings is spread over the acquisition period
+        auto next = start + std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                        std::chrono::duration<double>(period / NUMBER_OF_READS));
+        acquisitionCondition.wait_until(lock, next, [this]()
+        {
+            return acquisitionQuit;
+        });
     }
-
-    return true;
 }
 
 bool CloudWatcherController::getConstants(CloudWatcherConstants *cwc)
 {
+    std::lock_guard<std::recursive_mutex> lock(portMutex);
+
     bool r = getFirmwareVersion(m_FirmwareVersion);
 
     if (!r)
@@ -303,6 +349,8 @@ bool CloudWatcherController::getConstants(CloudWatcherConstants *cwc)
 
 bool CloudWatcherController::closeSwitch()
 {
+    std::lock_guard<std::recursive_mutex> lock(portMutex);
+
     sendCloudwatcherCommand("G!");
 
     char inputBuffer[BLOCK_SIZE * 2];
@@ -324,6 +372,8 @@ bool CloudWatcherController::closeSwitch()
 
 bool CloudWatcherController::openSwitch()
 {
+    std::lock_guard<std::recursive_mutex> lock(portMutex);
+
     sendCloudwatcherCommand("H!");
 
     char inputBuffer[BLOCK_SIZE * 2];
@@ -345,6 +395,8 @@ bool CloudWatcherController::openSwitch()
 
 bool CloudWatcherController::setPWMDutyCycle(int pwmDutyCycle)
 {
+    std::lock_guard<std::recursive_mutex> lock(portMutex);
+
     if (pwmDutyCycle < 0)
     {
         pwmDutyCycle = 0;
@@ -754,7 +806,7 @@ bool CloudWatcherController::getValues(int *internalSupplyVoltage, int *ambientT
 
     if (m_FirmwareVersion >= 5.88)
     {
-        char inputBuffer[BLOCK_SIZE * 4];
+        char inputBuffer[BLOCK_SIZE * 5];
 
         int r = getCloudWatcherAnswer(inputBuffer, 5);
 
@@ -864,6 +916,139 @@ bool CloudWatcherController::getIRErrors(int *firstAddressByteErrors, int *comma
     return true;
 }
 
+bool CloudWatcherController::readSample(CloudWatcherSample *sample)
+{
+    int check = getIRSkyTemperature(&sample->sky);
+
+    if (!check)
+    {
+        LOG_ERROR( "ERROR in getIRSkyTemperature" );
+        return false;
+    }
+
+    check = getIRSensorTemperature(&sample->sensor);
+
+    if (!check)
+    {
+        LOG_ERROR( "ERROR in getIRSensorTemperature" );
+        return false;
+    }
+
+    check = getRainFrequency(&sample->rain);
+    if (!check)
+    {
+        LOG_ERROR( "ERROR in getIRSensorTemperature" );
+        return false;
+    }
+
+    check = getValues(&sample->supply, &sample->ambient, &sample->ldr, &sample->ldrFreq, &sample->rainTemperature);
+
+    if (!check)
+    {
+        LOG_ERROR( "ERROR in getValues" );
+        return false;
+    }
+
+    check = getWindSpeed(&sample->windSpeed);
+
+    if (!check)
+    {
+        LOG_ERROR( "ERROR in getWindSpeed" );
+        return false;
+    }
+
+    sample->humidity = 0;
+    if (m_FirmwareVersion >= 5.6)
+    {
+        check = getHumidity(&sample->humidity);
+
+        if (!check)
+        {
+            LOG_ERROR( "ERROR in getHumidity" );
+            return false;
+        }
+    }
+
+    sample->pressure = 0;
+    if (m_FirmwareVersion >= 5.8)
+    {
+
+        check = getPressure(&sample->pressure);
+
+        if (!check)
+        {
+            LOG_ERROR( "ERROR in getPressure" );
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool CloudWatcherController::readStatus(CloudWatcherData *cwd)
+{
+    int check = getIRErrors(&cwd->firstByteErrors, &cwd->commandByteErrors, &cwd->secondByteErrors, &cwd->pecByteErrors);
+
+    if (!check)
+    {
+        LOG_DEBUG( "ERROR in getIRErrors" );
+        return false;
+    }
+
+    cwd->internalErrors = cwd->firstByteErrors + cwd->commandByteErrors + cwd->secondByteErrors + cwd->pecByteErrors;
+
+    check = getPWMDutyCycle(&cwd->rainHeater);
+
+    if (!check)
+    {
+        LOG_DEBUG( "ERROR in getPWMDutyCycle" );
+        return false;
+    }
+
+    check = getSwitchStatus(&cwd->switchStatus);
+
+    if (!check)
+    {
+        LOG_DEBUG( "ERROR in getSwitchStatus" );
+        return false;
+    }
+
+    return true;
+}
+
+void CloudWatcherController::aggregateSamples(const CloudWatcherSample samples[], int numberOfSamples,
+        CloudWatcherData *cwd)
+{
+    std::vector<int> values(numberOfSamples);
+
+    auto aggregate = [&](int CloudWatcherSample::*field)
+    {
+        for (int i = 0; i < numberOfSamples; i++)
+        {
+            values[i] = samples[i].*field;
+        }
+        return aggregateInts(values.data(), numberOfSamples);
+    };
+
+    cwd->sky             = aggregate(&CloudWatcherSample::sky);
+    cwd->sensor          = aggregate(&CloudWatcherSample::sensor);
+    cwd->rain            = aggregate(&CloudWatcherSample::rain);
+    cwd->supply          = aggregate(&CloudWatcherSample::supply);
+    cwd->ambient         = aggregate(&CloudWatcherSample::ambient);
+    cwd->ldr             = aggregate(&CloudWatcherSample::ldr);
+    cwd->ldrFreq         = aggregate(&CloudWatcherSample::ldrFreq);
+    cwd->rainTemperature = aggregate(&CloudWatcherSample::rainTemperature);
+    cwd->windSpeed       = aggregate(&CloudWatcherSample::windSpeed);
+    if (m_FirmwareVersion >= 5.6)
+        cwd->humidity        = aggregate(&CloudWatcherSample::humidity);
+    else
+        cwd->humidity = -1;
+    if (m_FirmwareVersion >= 5.8)
+        cwd->pressure        = aggregate(&CloudWatcherSample::pressure);
+    else
+        cwd->pressure = -1;
+}
+
 float CloudWatcherController::aggregateFloats(float values[], int numberOfValues)
 {
     float average = 0.0;
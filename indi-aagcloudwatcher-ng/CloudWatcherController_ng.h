@@ -24,6 +24,12 @@ Anemometer code contributed by Joao Bento.
 
 #pragma once
 
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
 /**
  *  A struct to group and send all AAG Cloud Watcher constants
  */
@@ -70,8 +76,8 @@ struct CloudWatcherData
     int rainTemperature; ///< Rain sensor temperature (used as ambient temperature in models where there is no ambient temperature sensor)
     int ldr;               ///< Ambient light sensor
     int ldrFreq;            ///< Ambient light sensor in K
-    float readCycle;       ///< Time used in the readings
-    int totalReadings;     ///< Total number of readings taken by the Cloud Watcher Controller
+    float readCycle;       ///< Time used in the last NUMBER_OF_READS readings, without pauses
+    int totalReadings;     ///< Total number of reading cycles (NUMBER_OF_READS readings) taken by the Cloud Watcher Controller
     int internalErrors;    ///< Total number of internal errors
     int firstByteErrors;   ///< First byte errors count
     int secondByteErrors;  ///< Second byte errors count
@@ -83,6 +89,26 @@ struct CloudWatcherData
     int pressure;          ///< atmospheric pressure
 };
 
+/**
+ *  A single reading of the sensors that are aggregated over NUMBER_OF_READS
+ *  readings (RAW data, directly from the device)
+ */
+
+struct CloudWatcherSample
+{
+    int supply;
+    int sky;
+    int sensor;
+    int ambient;
+    int rain;
+    int rainTemperature;
+    int ldr;
+    int ldrFreq;
+    int windSpeed;
+    int humidity;
+    int pressure;
+};
+
 /**
  * A class  to communicate with the AAG Cloud Watcher. It is responsible to
  * send and recieve all the commands specified in the AAG Cloud Watcher
@@ -107,7 +133,7 @@ class CloudWatcherController
         /**
         * A destructor
         */
-        virtual ~CloudWatcherController() = default;
+        virtual ~CloudWatcherController();
 
         const char *getDeviceName();
 
@@ -122,6 +148,13 @@ class CloudWatcherController
         */
         void setAnemometerType(enum ANEMOMETER_TYPE type);
 
+        /**
+        * Sets the time over which the acquisition thread spreads the
+        * NUMBER_OF_READS readings of a cycle, normally the weather update period.
+        * @param seconds the period, or 0 for the default of 10 seconds.
+        */
+        void setAcquisitionPeriod(double seconds);
+
         /**
         * Checks if the AAG Cloud Watcher is connected and accesible by requesting
         * its device name.
@@ -148,6 +181,30 @@ class CloudWatcherController
         */
         bool getAllData(CloudWatcherData * cwd);
 
+        /**
+        * Starts reading the sensors continuously on a background thread, one
+        * cycle of NUMBER_OF_READS readings per acquisition period. The readings
+        * are aggregated over the last NUMBER_OF_READS readings and can be
+        * retrieved at any time with getLatestData(). Returns after the first
+        * reading, or after a timeout if it fails.
+        */
+        void startAcquisition();
+
+        /**
+        * Stops the background thread started by startAcquisition(). Must be
+        * called before the port is closed.
+        */
+        void stopAcquisition();
+
+        /**
+        * Gets the latest aggregated data of the background thread without
+        * talking to the device.
+        * @param cwd where the dynamic data of the AAG Cloud Watcher will be stored.
+        * @return true if there is data and the last reading succeeded. false
+        * otherwise.
+        */
+        bool getLatestData(CloudWatcherData * cwd);
+
         /**
         * Gets all constants from the AAG Cloud Watcher. Some of the constants are
         * retrieved from the device (from firmware version >3.0)
@@ -262,9 +319,51 @@ class CloudWatcherController
         float rainBeta = 3450;
 
         /**
-        * The total number of readings performed by the controller
+        * The total number of reading cycles performed by the controller
+        */
+        std::atomic<int> totalReadings {0};
+
+        /**
+        * Serializes request/answer exchanges between the acquisition thread and
+        * the commands sent by the driver. Recursive because getAllData() calls
+        * getSwitchStatus().
+        */
+        std::recursive_mutex portMutex;
+
+        /**
+        * Background acquisition thread and the latest aggregated data
+        */
+        std::thread acquisition;
+        std::mutex dataMutex;
+        std::condition_variable acquisitionCondition;
+        bool acquisitionQuit = false;
+        bool latestValid = false;
+        CloudWatcherData latestData {};
+        double acquisitionPeriod = 10;
+
+        /**
+        * Body of the acquisition thread
+        */
+        void acquisitionLoop();
+
+        /**
+        * Reads each sensor once.
+        * @param sample where the readings will be stored
+        * @return true if all sensors were read. false otherwise.
+        */
+        bool readSample(CloudWatcherSample *sample);
+
+        /**
+        * Reads the IR errors, PWM duty cycle and switch status into cwd.
+        * @return true if succesfully read. false otherwise.
+        */
+        bool readStatus(CloudWatcherData *cwd);
+
+        /**
+        * Aggregates the sensor readings of several samples into cwd.
+        * @see aggregateInts()
         */
-        int totalReadings = 0;
+        void aggregateSamples(const CloudWatcherSample samples[], int numberOfSamples, CloudWatcherData *cwd);
 
         /**
         * Print a buffer of chars. Just for debugging
@@ -27,6 +27,7 @@ Anemometer code contributed by Joao Bento.
 
 #include "config.h"
 
+#include <algorithm>
 #include <cstring>
 #include <cmath>
 #include <memory>
@@ -74,6 +75,10 @@ bool AAGCloudWatcher::Handshake()
             setCriticalParameter("WEATHER_HUMIDITY");
         }
 
+        // Sensors are read in the background, updateWeather only publishes the latest readings
+        updateAcquisitionPeriod();
+        cwc->startAcquisition();
+
         return true;
     }
     else
@@ -109,6 +114,14 @@ bool AAGCloudWatcher::initProperties()
     return true;
 }
 
+bool AAGCloudWatcher::Disconnect()
+{
+    // Stop reading before the port is closed
+    cwc->stopAcquisition();
+
+    return INDI::Weather::Disconnect();
+}
+
 IPState AAGCloudWatcher::updateWeather()
 {
     if (!sendData())
@@ -135,6 +148,12 @@ bool AAGCloudWatcher::ISNewNumber(const char *dev, const char *name, double valu
         return false;
     }
 
+    if (WI::UpdatePeriodNP.isNameMatch(name))
+    {
+        updateAcquisitionPeriod();
+        return true;
+    }
+
     auto nvp = getNumber(name);
 
     if (!nvp)
@@ -363,6 +382,12 @@ bool AAGCloudWatcher::ISNewSwitch(const char *dev, const char *name, ISState *st
     return false;
 }
 
+void AAGCloudWatcher::updateAcquisitionPeriod()
+{
+    // One cycle of readings per weather update. Without automatic updates, use the same minimum as the heater algorithm.
+    cwc->setAcquisitionPeriod(std::max(3.0, WI::UpdatePeriodNP[0].getValue()));
+}
+
 float AAGCloudWatcher::getLastReadPeriod()
 {
     return lastReadPeriod;
@@ -584,7 +609,7 @@ bool AAGCloudWatcher::sendData()
 {
     CloudWatcherData data;
 
-    if (cwc->getAllData(&data) == 0)
+    if (cwc->getLatestData(&data) == 0)
         return false;
 
     auto nvp = getNumber("readings");
@@ -47,6 +47,7 @@ class AAGCloudWatcher : public INDI::Weather
         virtual bool ISNewSwitch(const char *dev, const char *name, ISState *states, char *names[], int n) override;
 
         virtual const char *getDefaultName() override;
+        virtual bool Disconnect() override;
         bool sendData();
         float getLastReadPeriod();
         bool heatingAlgorithm();
@@ -67,6 +68,7 @@ class AAGCloudWatcher : public INDI::Weather
         double getNumberValueFromVector(INumberVectorProperty *nvp, const char *name);
         double getNumberValueFromVector(INDI::PropertyNumber nvp, const char *name);
         bool isWetRain();
+        void updateAcquisitionPeriod();
 
         HeatingAlgorithmStatus heatingStatus;
 
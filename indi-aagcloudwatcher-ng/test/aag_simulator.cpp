@@ -0,0 +1,225 @@
+/**
+This file is part of the AAG Cloud Watcher INDI Driver.
+A driver for the AAG Cloud Watcher (AAGware - http : //www.aagware.eu/)
+
+Copyright (C) 2026 INDI 3rd party contributors
+
+AAG Cloud Watcher INDI Driver is free software : you can redistribute it
+and / or modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation, either version 3 of the License,
+or (at your option) any later version.
+
+AAG Cloud Watcher INDI Driver is distributed in the hope that it will be
+useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with AAG Cloud Watcher INDI Driver.  If not, see
+< http : //www.gnu.org/licenses/>.
+*/
+
+#include "aag_simulator.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+
+#include <fcntl.h>
+#include <poll.h>
+#include <termios.h>
+#include <unistd.h>
+
+namespace
+{
+
+// Every answer ends with this block
+const std::string HANDSHAKE = std::string("\x21\x11", 2) + "            0";
+
+// A 15 bytes block: the code followed by the right aligned value
+std::string block(const char *code, const std::string &value)
+{
+    char buffer[16];
+    snprintf(buffer, sizeof(buffer), "%s%*s", code, 15 - static_cast<int>(std::string(code).size()), value.c_str());
+    return buffer;
+}
+
+std::string block(const char *code, int value)
+{
+    return block(code, std::to_string(value));
+}
+
+}
+
+AAGSimulator::AAGSimulator()
+{
+}
+
+AAGSimulator::~AAGSimulator()
+{
+    stop();
+}
+
+bool AAGSimulator::start()
+{
+    master = posix_openpt(O_RDWR | O_NOCTTY);
+    if (master < 0 || grantpt(master) != 0 || unlockpt(master) != 0)
+    {
+        return false;
+    }
+
+    termios tty;
+    tcgetattr(master, &tty);
+    cfmakeraw(&tty);
+    tcsetattr(master, TCSANOW, &tty);
+
+    port   = ptsname(master);
+    quit   = false;
+    thread = std::thread(&AAGSimulator::run, this);
+
+    return true;
+}
+
+void AAGSimulator::stop()
+{
+    quit = true;
+    if (thread.joinable())
+    {
+        thread.join();
+    }
+    if (master >= 0)
+    {
+        close(master);
+        master = -1;
+    }
+}
+
+void AAGSimulator::run()
+{
+    std::string pending;
+
+    while (!quit)
+    {
+        pollfd fd { master, POLLIN, 0 };
+        if (poll(&fd, 1, 20) <= 0 || !(fd.revents & POLLIN))
+        {
+            continue;
+        }
+
+        char buffer[64];
+        ssize_t n = read(master, buffer, sizeof(buffer));
+        if (n <= 0)
+        {
+            // The port is not open yet, or was closed
+            std::this_thread::sleep_for(std::chrono::milliseconds(20));
+            continue;
+        }
+        pending.append(buffer, n);
+
+        // Commands are a letter and '!', except "Pxxxx!"
+        while (!pending.empty())
+        {
+            size_t size = pending[0] == 'P' ? 6 : 2;
+            if (pending.size() < size)
+            {
+                break;
+            }
+            std::string command = pending.substr(0, size);
+            pending.erase(0, size);
+            commands[static_cast<unsigned char>(command[0]) & 0x7F]++;
+            answer(command);
+        }
+    }
+}
+
+void AAGSimulator::answer(const std::string &command)
+{
+    if (answerDelay > 0)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(answerDelay));
+    }
+
+    switch (command[0])
+    {
+        case 'A':
+            send("!N CloudWatcher");
+            break;
+        case 'B':
+            send(block("!V", FIRMWARE));
+            break;
+        case 'K':
+            send(block("!K", SERIAL_NUMBER));
+            break;
+        case 'M':
+        {
+            // Zener voltage, LDR max and pull up, rain beta, resistance at 25 and pull up, two bytes each
+            const char constants[] = { 1, 44, 0, 100, 2, 48, 13, 122, 0, 100, 0, 10 };
+            send("!M" + std::string(constants, sizeof(constants)) + " ");
+            break;
+        }
+        case 'v':
+            send(block("!v", 1));
+            break;
+        case 'S':
+            send(block("!1", SKY));
+            break;
+        case 'T':
+            send(block("!2", SENSOR));
+            break;
+        case 'E':
+            send(block("!R", RAIN));
+            break;
+        case 'C':
+            send(block("!6", 270) + block("!4", 500) + block("!8", 1000) + block("!5", 600));
+            break;
+        case 'V':
+            send(block("!w", 0));
+            break;
+        case 'h':
+            send(block("!h", 50));
+            break;
+        case 'p':
+            send(block("!p", 16000));
+            break;
+        case 'D':
+            send(block("!E1", 0) + block("!E2", 0) + block("!E3", 0) + block("!E4", 0));
+            break;
+        case 'Q':
+            send(block("!Q", pwmDutyCycle));
+            break;
+        case 'P':
+            pwmDutyCycle = atoi(command.substr(1, 4).c_str());
+            send(block("!Q", pwmDutyCycle));
+            break;
+        case 'F':
+            send(block(switchState.c_str(), ""));
+            break;
+        case 'G':
+            switchState = "!X";
+            send(block("!X", ""));
+            break;
+        case 'H':
+            switchState = "!Y";
+            send(block("!Y", ""));
+            break;
+        default:
+            // Unknown commands only get the handshake block
+            send("");
+            break;
+    }
+}
+
+void AAGSimulator::send(const std::string &blocks)
+{
+    std::string message = blocks + HANDSHAKE;
+    size_t written = 0;
+    while (written < message.size())
+    {
+        ssize_t n = write(master, message.data() + written, message.size() - written);
+        if (n <= 0)
+        {
+            return;
+        }
+        written += n;
+    }
+}
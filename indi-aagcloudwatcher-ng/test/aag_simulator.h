@@ -0,0 +1,91 @@
+/**
+This file is part of the AAG Cloud Watcher INDI Driver.
+A driver for the AAG Cloud Watcher (AAGware - http : //www.aagware.eu/)
+
+Copyright (C) 2026 INDI 3rd party contributors
+
+AAG Cloud Watcher INDI Driver is free software : you can redistribute it
+and / or modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation, either version 3 of the License,
+or (at your option) any later version.
+
+AAG Cloud Watcher INDI Driver is distributed in the hope that it will be
+useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with AAG Cloud Watcher INDI Driver.  If not, see
+< http : //www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <atomic>
+#include <string>
+#include <thread>
+
+/**
+ * An AAG Cloud Watcher on a pseudo terminal. It answers the RS232 commands
+ * of the documents in docs/ as a firmware 5.88 unit with an anemometer,
+ * humidity and pressure sensors, so the controller can be tested through
+ * the same tty calls it uses with the device.
+ */
+
+class AAGSimulator
+{
+    public:
+        static constexpr const char *FIRMWARE = "5.88";
+        static constexpr int SERIAL_NUMBER = 1234;
+        static constexpr int SKY = -1850;
+        static constexpr int SENSOR = 1520;
+        static constexpr int RAIN = 2800;
+
+        AAGSimulator();
+        ~AAGSimulator();
+
+        /**
+        * Opens the pseudo terminal and starts answering commands.
+        * @return false if the pseudo terminal could not be opened.
+        */
+        bool start();
+        void stop();
+
+        /**
+        * The device to connect to, e.g. /dev/pts/3
+        */
+        const std::string &portName() const
+        {
+            return port;
+        }
+
+        /**
+        * Delay before each answer, as the device takes some time to read its sensors
+        */
+        void setAnswerDelay(int milliseconds)
+        {
+            answerDelay = milliseconds;
+        }
+
+        /**
+        * Number of times a command was received, by its first letter
+        */
+        int count(char command) const
+        {
+            return commands[static_cast<unsigned char>(command) & 0x7F];
+        }
+
+    private:
+        void run();
+        void answer(const std::string &command);
+        void send(const std::string &blocks);
+
+        int master = -1;
+        std::string port;
+        std::thread thread;
+        std::atomic_bool quit { false };
+        std::atomic_int answerDelay { 0 };
+        std::atomic_int commands[128] {};
+        int pwmDutyCycle = 0;
+        std::string switchState = "!X";
+};
@@ -0,0 +1,141 @@
+/**
+This file is part of the AAG Cloud Watcher INDI Driver.
+A driver for the AAG Cloud Watcher (AAGware - http : //www.aagware.eu/)
+
+Copyright (C) 2026 INDI 3rd party contributors
+
+AAG Cloud Watcher INDI Driver is free software : you can redistribute it
+and / or modify it under the terms of the GNU General Public License as
+published by the Free Software Foundation, either version 3 of the License,
+or (at your option) any later version.
+
+AAG Cloud Watcher INDI Driver is distributed in the hope that it will be
+useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with AAG Cloud Watcher INDI Driver.  If not, see
+< http : //www.gnu.org/licenses/>.
+*/
+
+#include "aag_simulator.h"
+
+#include "indicom.h"
+#include "indiweather.h"
+#include "CloudWatcherController_ng.h"
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <thread>
+
+class CloudWatcherControllerTest : public ::testing::Test
+{
+    protected:
+        void SetUp() override
+        {
+            ASSERT_TRUE(simulator.start());
+            ASSERT_EQ(tty_connect(simulator.portName().c_str(), 9600, 8, 0, 1, &PortFD), TTY_OK);
+            cwc.setPortFD(PortFD);
+            ASSERT_TRUE(cwc.checkCloudWatcher());
+            ASSERT_TRUE(cwc.getConstants(&constants));
+        }
+
+        void TearDown() override
+        {
+            cwc.stopAcquisition();
+            tty_disconnect(PortFD);
+            simulator.stop();
+        }
+
+        // Waits for the acquisition thread to complete a number of reading cycles
+        bool waitForCycles(int cycles, CloudWatcherData *data)
+        {
+            auto timeout = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+            while (std::chrono::steady_clock::now() < timeout)
+            {
+                if (cwc.getLatestData(data) && data->totalReadings >= cycles)
+                {
+                    return true;
+                }
+                std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            }
+            return false;
+        }
+
+        AAGSimulator simulator;
+        CloudWatcherController cwc;
+        CloudWatcherConstants constants;
+        int PortFD = -1;
+};
+
+TEST_F(CloudWatcherControllerTest, Constants)
+{
+    EXPECT_DOUBLE_EQ(constants.firmwareVersion, 5.88);
+    EXPECT_EQ(constants.internalSerialNumber, AAGSimulator::SERIAL_NUMBER);
+    EXPECT_EQ(constants.anemometerStatus, 1);
+}
+
+TEST_F(CloudWatcherControllerTest, GetAllDataIsOneCycle)
+{
+    CloudWatcherData data;
+    ASSERT_TRUE(cwc.getAllData(&data));
+
+    EXPECT_EQ(simulator.count('S'), 5);
+    EXPECT_EQ(data.totalReadings, 1);
+    EXPECT_EQ(data.sky, AAGSimulator::SKY);
+    EXPECT_EQ(data.sensor, AAGSimulator::SENSOR);
+    EXPECT_EQ(data.rain, AAGSimulator::RAIN);
+    EXPECT_EQ(data.humidity, 54);
+    EXPECT_EQ(data.pressure, 1000);
+}
+
+TEST_F(CloudWatcherControllerTest, AcquisitionSpreadsACycleOverThePeriod)
+{
+    // Five readings per second, one every 200 ms
+    cwc.setAcquisitionPeriod(1.0);
+    cwc.startAcquisition();
+    std::this_thread::sleep_for(std::chrono::milliseconds(1100));
+    cwc.stopAcquisition();
+
+    int readings = simulator.count('S');
+    EXPECT_GE(readings, 4);
+    EXPECT_LE(readings, 8);
+
+    // Errors, heater and switch once per cycle
+    EXPECT_EQ(simulator.count('D'), (readings + 4) / 5);
+
+    CloudWatcherData data;
+    ASSERT_TRUE(cwc.getLatestData(&data));
+    EXPECT_EQ(data.totalReadings, readings / 5);
+    EXPECT_EQ(data.sky, AAGSimulator::SKY);
+}
+
+TEST_F(CloudWatcherControllerTest, ReadCycleExcludesThePauses)
+{
+    // 7 commands per reading at 5 ms each, and 800 ms of pauses in a cycle
+    simulator.setAnswerDelay(5);
+    cwc.setAcquisitionPeriod(1.0);
+    cwc.startAcquisition();
+
+    CloudWatcherData data;
+    ASSERT_TRUE(waitForCycles(1, &data));
+    EXPECT_GE(data.readCycle, 0.15);
+    EXPECT_LT(data.readCycle, 0.5);
+}
+
+TEST_F(CloudWatcherControllerTest, SwitchDuringAcquisition)
+{
+    cwc.setAcquisitionPeriod(0.5);
+    cwc.startAcquisition();
+
+    EXPECT_TRUE(cwc.openSwitch());
+    EXPECT_TRUE(cwc.closeSwitch());
+    EXPECT_TRUE(cwc.setPWMDutyCycle(512));
+
+    CloudWatcherData data;
+    ASSERT_TRUE(waitForCycles(1, &data));
+    EXPECT_EQ(simulator.count('H'), 1);
+    EXPECT_EQ(simulator.count('G'), 1);
+}
@@ -24,12 +24,16 @@
 #include "asi_helpers.h"
 
 #include "config.h"
+#include "fitstime.h"
 
 #include <stream/streammanager.h>
 #include <indielapsedtimer.h>
 
 #include <algorithm>
 #include <cmath>
+#include <cstring>
+#include <ctime>
+#include <thread>
 #include <vector>
 #include <map>
 #include <unistd.h>
@@ -38,6 +42,8 @@
 #define VERBOSE_EXPOSURE        3
 #define TEMP_TIMER_MS           1000 /* Temperature polling time (ms) */
 #define TEMP_THRESHOLD          .25  /* Differential temperature threshold (C)*/
+#define BURST_RING_SIZE         4    /* Burst frames buffered between capture and upload */
+#define BURST_MAX_TIMEOUTS      3    /* Consecutive video timeouts before a burst is aborted */
 
 #define CONTROL_TAB "Controls"
 
@@ -270,7 +276,175 @@ void ASIBase::workerExposure(const std::atomic_bool &isAboutToQuit, float durati
     if (PrimaryCCD.getExposureDuration() > VERBOSE_EXPOSURE)
         LOG_INFO("Exposure done, downloading image...");
 
-    grabImage(duration);
+    if (grabImage(duration) == 0)
+    {
+        mSingleCycleSeconds = exposureTimer.elapsed() / 1000.0;
+        mSingleCycleDuration = duration;
+    }
+}
+
+void ASIBase::workerBurstExposure(const std::atomic_bool &isAboutToQuit, float duration, int count)
+{
+    ASI_ERROR_CODE ret;
+    ASI_IMG_TYPE type = getImageType();
+
+    uint16_t subW = PrimaryCCD.getSubW() / PrimaryCCD.getBinX();
+    uint16_t subH = PrimaryCCD.getSubH() / PrimaryCCD.getBinY();
+    int nChannels = (type == ASI_IMG_RGB24) ? 3 : 1;
+    size_t nTotalBytes = subW * subH * nChannels * (PrimaryCCD.getBPP() / 8);
+
+    PrimaryCCD.setExposureDuration(duration);
+
+    ret = ASISetControlValue(mCameraInfo.CameraID, ASI_EXPOSURE, duration * 1000 * 1000, ASI_FALSE);
+    if (ret != ASI_SUCCESS)
+    {
+        LOGF_ERROR("Failed to set exposure duration (%s).", Helpers::toString(ret));
+        mBurstActive = false;
+        PrimaryCCD.setExposureFailed();
+        return;
+    }
+
+    // The ring is kept between bursts and only reallocated when the frame size changes.
+    mBurstRing.resize(BURST_RING_SIZE);
+    for (auto &frame : mBurstRing)
+        frame.data.resize(nTotalBytes);
+
+    mBurstFree.clear();
+    mBurstReady.clear();
+    for (size_t i = 0; i < mBurstRing.size(); i++)
+        mBurstFree.push_back(i);
+    mBurstDone = false;
+    mBurstFrameCount = count;
+    updateImageLayout(type);
+
+    std::thread delivery(&ASIBase::burstDelivery, this, duration, type, subW, subH);
+
+    ret = ASIStartVideoCapture(mCameraInfo.CameraID);
+    if (ret != ASI_SUCCESS)
+        LOGF_ERROR("Failed to start video capture (%s).", Helpers::toString(ret));
+
+    LOGF_INFO("Taking a burst of %d x %g seconds frames...", count, duration);
+
+    INDI::ElapsedTimer burstTimer;
+    int waitMS = static_cast<int>((duration * 2000.0) + 500);
+    int captured = 0, timeouts = 0;
+
+    while (ret == ASI_SUCCESS && captured < count && !isAboutToQuit)
+    {
+        size_t slot;
+        {
+            // Wait for the upload thread to free a slot, the SDK keeps buffering meanwhile.
+            std::unique_lock<std::mutex> lock(mBurstMutex);
+            mBurstCondition.wait(lock, [&]()
+            {
+                return !mBurstFree.empty() || isAboutToQuit;
+            });
+            if (isAboutToQuit)
+                break;
+            slot = mBurstFree.front();
+            mBurstFree.pop_front();
+        }
+
+        BurstFrame &frame = mBurstRing[slot];
+        ret = ASIGetVideoData(mCameraInfo.CameraID, frame.data.data(), nTotalBytes, waitMS);
+        auto arrival = std::chrono::system_clock::now();
+
+        if (ret != ASI_SUCCESS)
+        {
+            std::lock_guard<std::mutex> lock(mBurstMutex);
+            mBurstFree.push_front(slot);
+            if (ret == ASI_ERROR_TIMEOUT && ++timeouts < BURST_MAX_TIMEOUTS)
+                ret = ASI_SUCCESS;
+            continue;
+        }
+
+        timeouts = 0;
+        // A video frame is read out right after its exposure ends.
+        frame.start = arrival - std::chrono::microseconds(static_cast<int64_t>(duration * 1e6));
+        frame.index = ++captured;
+        PrimaryCCD.setExposureLeft((count - captured) * duration);
+
+        {
+            std::lock_guard<std::mutex> lock(mBurstMutex);
+            mBurstReady.push_back(slot);
+        }
+        mBurstCondition.notify_all();
+    }
+
+    double seconds = burstTimer.elapsed() / 1000.0;
+    ASIStopVideoCapture(mCameraInfo.CameraID);
+
+    int dropped = 0;
+    ASIGetDroppedFrames(mCameraInfo.CameraID, &dropped);
+
+    {
+        std::lock_guard<std::mutex> lock(mBurstMutex);
+        mBurstDone = true;
+        // Frames not sent yet are of no use after an abort.
+        if (isAboutToQuit)
+            mBurstReady.clear();
+    }
+    mBurstCondition.notify_all();
+    delivery.join();
+    mBurstFrameIndex = 0;
+    mBurstActive = false;
+
+    if (ret != ASI_SUCCESS)
+    {
+        LOGF_ERROR("Burst stopped after %d of %d frames (%s).", captured, count, Helpers::toString(ret));
+        PrimaryCCD.setExposureFailed();
+        return;
+    }
+
+    if (captured > 0 && seconds > 0)
+    {
+        LOGF_INFO("Burst captured %d frames in %.2f seconds, %.2f fps (%d dropped by the camera).",
+                  captured, seconds, captured / seconds, dropped);
+        if (mSingleCycleSeconds > 0)
+            LOGF_INFO("Single exposures last ran at %.2f fps for %g seconds frames.",
+                      1.0 / mSingleCycleSeconds, mSingleCycleDuration);
+    }
+}
+
+void ASIBase::burstDelivery(float duration, ASI_IMG_TYPE type, uint16_t subW, uint16_t subH)
+{
+    while (true)
+    {
+        size_t slot;
+        {
+            std::unique_lock<std::mutex> lock(mBurstMutex);
+            mBurstCondition.wait(lock, [this]()
+            {
+                return mBurstDone || !mBurstReady.empty();
+            });
+            if (mBurstReady.empty())
+                break;
+            slot = mBurstReady.front();
+            mBurstReady.pop_front();
+        }
+
+        const BurstFrame &frame = mBurstRing[slot];
+        {
+            std::lock_guard<std::mutex> guard(ccdBufferLock);
+            copyFrame(frame.data.data(), type, subW, subH);
+        }
+        mBurstFrameIndex = frame.index;
+        mBurstFrameStart = frame.start;
+
+        // The frame is in the CCD buffer, let the capture reuse its slot while it is uploaded.
+        {
+            std::lock_guard<std::mutex> lock(mBurstMutex);
+            mBurstFree.push_back(slot);
+        }
+        mBurstCondition.notify_all();
+
+        PrimaryCCD.setExposureDuration(duration);
+        ExposureComplete(&PrimaryCCD);
+
+        // ExposureComplete reports the exposure done, it is only done after the last frame.
+        if (frame.index < mBurstFrameCount)
+            PrimaryCCD.setExposureLeft((mBurstFrameCount - frame.index) * duration);
+    }
 }
 
 ///////////////////////////////////////////////////////////////////////
@@ -328,6 +502,9 @@ bool ASIBase::initProperties()
     BlinkNP[BLINK_DURATION].fill("BLINK_DURATION", "Blink duration",         "%2.3f", 0,  60, 0.001, 0);
     BlinkNP.fill(getDeviceName(), "BLINK", "Blink", CONTROL_TAB, IP_RW, 60, IPS_IDLE);
 
+    BurstNP[BURST_COUNT].fill("BURST_COUNT", "Frames per exposure", "%.0f", 0, 10000, 1, 0);
+    BurstNP.fill(getDeviceName(), "BURST", "Burst", CONTROL_TAB, IP_RW, 60, IPS_IDLE);
+
     IUSaveText(&BayerT[2], getBayerString());
 
     ADCDepthNP[0].fill("BITS", "Bits", "%2.0f", 0, 32, 1, mCameraInfo.BitDepth);
@@ -467,6 +644,7 @@ bool ASIBase::updateProperties()
         }
 
         defineProperty(BlinkNP);
+        defineProperty(BurstNP);
         defineProperty(ADCDepthNP);
         defineProperty(SDKVersionSP);
         if (!mSerialNumber.empty())
@@ -500,6 +678,7 @@ bool ASIBase::updateProperties()
             deleteProperty(VideoFormatSP.getName());
 
         deleteProperty(BlinkNP.getName());
+        deleteProperty(BurstNP.getName());
         deleteProperty(SDKVersionSP.getName());
         if (!mSerialNumber.empty())
         {
@@ -783,6 +962,15 @@ bool ASIBase::ISNewNumber(const char *dev, const char *name, double values[], ch
             BlinkNP.apply();
             return true;
         }
+
+        if (BurstNP.isNameMatch(name))
+        {
+            BurstNP.setState(BurstNP.update(values, names, n) ? IPS_OK : IPS_ALERT);
+            BurstNP.apply();
+            if (BurstNP[BURST_COUNT].getValue() > 1)
+                LOGF_INFO("Each exposure now captures a burst of %.0f frames in video mode.", BurstNP[BURST_COUNT].getValue());
+            return true;
+        }
     }
 
     return INDI::CCD::ISNewNumber(dev, name, values, names, n);
@@ -1010,8 +1198,22 @@ bool ASIBase::activateCooler(bool enable)
 
 bool ASIBase::StartExposure(float duration)
 {
+    // Starting the worker again would stop the burst, it has to be aborted explicitly.
+    if (mBurstActive)
+    {
+        LOG_ERROR("A burst is still running, abort it before starting a new exposure.");
+        return false;
+    }
+
     mExposureRetry = 0;
-    mWorker.start(std::bind(&ASIBase::workerExposure, this, std::placeholders::_1, duration));
+    int burst = BurstNP[BURST_COUNT].getValue();
+    if (burst > 1)
+    {
+        mBurstActive = true;
+        mWorker.start(std::bind(&ASIBase::workerBurstExposure, this, std::placeholders::_1, duration, burst));
+    }
+    else
+        mWorker.start(std::bind(&ASIBase::workerExposure, this, std::placeholders::_1, duration));
     return true;
 }
 
@@ -1020,6 +1222,7 @@ bool ASIBase::AbortExposure()
     LOG_DEBUG("Aborting exposure...");
 
     mWorker.quit();
+    mBurstActive = false;
 
     ASIStopExposure(mCameraInfo.CameraID);
     return true;
@@ -1152,8 +1355,7 @@ int ASIBase::grabImage(float duration)
     ASI_IMG_TYPE type = getImageType();
 
     std::unique_lock<std::mutex> guard(ccdBufferLock);
-    uint8_t *image = PrimaryCCD.getFrameBuffer();
-    uint8_t *buffer = image;
+    uint8_t *buffer = PrimaryCCD.getFrameBuffer();
 
     uint16_t subW = PrimaryCCD.getSubW() / PrimaryCCD.getBinX();
     uint16_t subH = PrimaryCCD.getSubH() / PrimaryCCD.getBinY();
@@ -1162,12 +1364,8 @@ int ASIBase::grabImage(float duration)
 
     if (type == ASI_IMG_RGB24)
     {
-        buffer = static_cast<uint8_t *>(malloc(nTotalBytes));
-        if (buffer == nullptr)
-        {
-            LOGF_ERROR("%s: %d malloc failed (RGB 24).", getDeviceName());
-            return -1;
-        }
+        mRGBBuffer.resize(nTotalBytes);
+        buffer = mRGBBuffer.data();
     }
 
     ret = ASIGetDataAfterExp(mCameraInfo.CameraID, buffer, nTotalBytes);
@@ -1177,31 +1375,50 @@ int ASIBase::grabImage(float duration)
             "Failed to get data after exposure (%dx%d #%d channels) (%s).",
             subW, subH, nChannels, Helpers::toString(ret)
         );
-        if (type == ASI_IMG_RGB24)
-            free(buffer);
         return -1;
     }
 
     if (type == ASI_IMG_RGB24)
+        copyFrame(buffer, type, subW, subH);
+    guard.unlock();
+
+    updateImageLayout(type);
+
+    if (duration > VERBOSE_EXPOSURE)
+        LOG_INFO("Download complete.");
+
+    ExposureComplete(&PrimaryCCD);
+    return 0;
+}
+
+void ASIBase::copyFrame(const uint8_t *frame, ASI_IMG_TYPE type, uint16_t subW, uint16_t subH)
+{
+    uint8_t *image = PrimaryCCD.getFrameBuffer();
+
+    if (type != ASI_IMG_RGB24)
     {
-        uint8_t *dstR = image;
-        uint8_t *dstG = image + subW * subH;
-        uint8_t *dstB = image + subW * subH * 2;
+        if (frame != image)
+            memcpy(image, frame, subW * subH * (PrimaryCCD.getBPP() / 8));
+        return;
+    }
 
-        const uint8_t *src = buffer;
-        const uint8_t *end = buffer + subW * subH * 3;
+    uint8_t *dstR = image;
+    uint8_t *dstG = image + subW * subH;
+    uint8_t *dstB = image + subW * subH * 2;
 
-        while (src != end)
-        {
-            *dstB++ = *src++;
-            *dstG++ = *src++;
-            *dstR++ = *src++;
-        }
+    const uint8_t *src = frame;
+    const uint8_t *end = frame + subW * subH * 3;
 
-        free(buffer);
+    while (src != end)
+    {
+        *dstB++ = *src++;
+        *dstG++ = *src++;
+        *dstR++ = *src++;
     }
-    guard.unlock();
+}
 
+void ASIBase::updateImageLayout(ASI_IMG_TYPE type)
+{
     PrimaryCCD.setNAxis(type == ASI_IMG_RGB24 ? 3 : 2);
 
     // If mono camera or we're sending Luma or RGB, turn off bayering
@@ -1209,12 +1426,6 @@ int ASIBase::grabImage(float duration)
         SetCCDCapability(GetCCDCapability() & ~CCD_HAS_BAYER);
     else
         SetCCDCapability(GetCCDCapability() | CCD_HAS_BAYER);
-
-    if (duration > VERBOSE_EXPOSURE)
-        LOG_INFO("Download complete.");
-
-    ExposureComplete(&PrimaryCCD);
-    return 0;
 }
 
 bool ASIBase::isMonoBinActive()
@@ -1540,6 +1751,17 @@ void ASIBase::addFITSKeywords(INDI::CCDChip *targetChip, std::vector<INDI::FITSR
     {
         fitsKeywords.push_back({"OFFSET", np->value, 3, "Offset"});
     }
+
+    // The base class dates every burst frame from the start of the burst. The SDK has no frame
+    // timestamp outside GPS models, so the start is the arrival of the frame minus its exposure.
+    if (mBurstFrameIndex > 0)
+    {
+        FITSTime::replaceRecord(fitsKeywords, INDI::FITSRecord("DATE-OBS",
+                                FITSTime::isoTimestamp(mBurstFrameStart).c_str(),
+                                "UTC start, frame arrival minus exposure"));
+        fitsKeywords.push_back({"BURSTIDX", mBurstFrameIndex, "Frame number in burst"});
+        fitsKeywords.push_back({"BURSTLEN", mBurstFrameCount, "Frames in burst"});
+    }
 }
 
 bool ASIBase::saveConfigItems(FILE *fp)
@@ -1562,6 +1784,7 @@ bool ASIBase::saveConfigItems(FILE *fp)
         VideoFormatSP.save(fp);
 
     BlinkNP.save(fp);
+    BurstNP.save(fp);
 
     return true;
 }
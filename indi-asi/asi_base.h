@@ -29,6 +29,11 @@
 #include "indipropertytext.h"
 #include "indisinglethreadpool.h"
 
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
 #include <vector>
 
 #include <indiccd.h>
@@ -88,10 +93,20 @@ class ASIBase : public INDI::CCD
         void workerStreamVideo(const std::atomic_bool &isAboutToQuit);
         void workerBlinkExposure(const std::atomic_bool &isAboutToQuit, int blinks, float duration);
         void workerExposure(const std::atomic_bool &isAboutToQuit, float duration);
+        void workerBurstExposure(const std::atomic_bool &isAboutToQuit, float duration, int count);
 
         /** Get image from CCD and send it to client */
         int grabImage(float duration);
 
+        /** Copy a camera frame into the primary CCD buffer, converting BGR to planar RGB */
+        void copyFrame(const uint8_t *frame, ASI_IMG_TYPE type, uint16_t subW, uint16_t subH);
+
+        /** Set axis count and bayer capability for the image type */
+        void updateImageLayout(ASI_IMG_TYPE type);
+
+        /** Send burst frames from the ring as they arrive */
+        void burstDelivery(float duration, ASI_IMG_TYPE type, uint16_t subW, uint16_t subH);
+
     protected:
         double mTargetTemperature;
         double mCurrentTemperature;
@@ -152,6 +167,12 @@ class ASIBase : public INDI::CCD
             BLINK_DURATION
         };
 
+        INDI::PropertyNumber  BurstNP {1};
+        enum
+        {
+            BURST_COUNT
+        };
+
         INDI::PropertySwitch  FlipSP {2};
         enum
         {
@@ -164,4 +185,32 @@ class ASIBase : public INDI::CCD
         uint8_t mExposureRetry {0};
         ASI_IMG_TYPE mCurrentVideoFormat;
         std::vector<ASI_CONTROL_CAPS> mControlCaps;
+
+        /** Scratch buffer for BGR frames */
+        std::vector<uint8_t> mRGBBuffer;
+
+        /** Last single exposure cycle, to compare burst throughput against */
+        double mSingleCycleSeconds {0};
+        float mSingleCycleDuration {0};
+
+        /** Burst frames are captured into a preallocated ring and sent from another thread */
+        struct BurstFrame
+        {
+            std::vector<uint8_t> data;
+            std::chrono::system_clock::time_point start;
+            int index {0};
+        };
+        std::vector<BurstFrame> mBurstRing;
+        std::deque<size_t> mBurstFree, mBurstReady;
+        bool mBurstDone {false};
+        std::mutex mBurstMutex;
+        std::condition_variable mBurstCondition;
+
+        /** Set from StartExposure until the last burst frame is sent */
+        std::atomic_bool mBurstActive {false};
+
+        /** Frame being sent, for the FITS header. Index is zero outside bursts */
+        int mBurstFrameIndex {0};
+        int mBurstFrameCount {0};
+        std::chrono::system_clock::time_point mBurstFrameStart;
 };
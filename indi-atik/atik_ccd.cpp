@@ -23,13 +23,19 @@
 #include "atik_ccd.h"
 
 #include "config.h"
+#include "fitstime.h"
 
 #include <stream/streammanager.h>
 
 #include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
 #include <math.h>
 #include <unistd.h>
 #include <deque>
+#include <map>
 #include <memory>
 
 #define MAX_CONNECTION_RETRIES  5
@@ -175,6 +181,12 @@ bool ATIKCCD::initProperties()
     IUFillSwitchVector(&FastModeSP, FastModeS, 2, getDeviceName(), "CCD_FAST_MODE", "Fast Mode", CONTROLS_TAB, IP_RW,
                        ISR_1OFMANY, 60, IPS_IDLE);
 
+    // Overlapped exposures
+    IUFillSwitch(&OverlapS[OVERLAP_ON], "OVERLAP_ON", "On", ISS_OFF);
+    IUFillSwitch(&OverlapS[OVERLAP_OFF], "OVERLAP_OFF", "Off", ISS_ON);
+    IUFillSwitchVector(&OverlapSP, OverlapS, 2, getDeviceName(), "CCD_OVERLAP", "Overlap Exposures", CONTROLS_TAB, IP_RW,
+                       ISR_1OFMANY, 60, IPS_IDLE);
+
 #if 0
     // Bit send format
     IUFillSwitch(&BitSendS[BITSEND_16BITS], "BITSEND_16BITS", "16BITS", ISS_OFF);
@@ -233,6 +245,9 @@ bool ATIKCCD::updateProperties()
         if (m_CameraFlags & ARTEMIS_PROPERTIES_CAMERAFLAGS_HAS_FILTERWHEEL)
             INDI::FilterInterface::updateProperties();
 
+        defineProperty(&OverlapSP);
+        loadConfig(true, "CCD_OVERLAP");
+
         defineProperty(&VersionInfoSP);
     }
     else
@@ -258,6 +273,7 @@ bool ATIKCCD::updateProperties()
         if (m_CameraFlags & ARTEMIS_PROPERTIES_CAMERAFLAGS_HAS_FILTERWHEEL)
             INDI::FilterInterface::updateProperties();
 
+        deleteProperty(OverlapSP.name);
         deleteProperty(VersionInfoSP.name);
     }
 
@@ -377,6 +393,14 @@ bool ATIKCCD::setupParams()
         cap |= CCD_HAS_ST4_PORT;
     }
 
+    // Fast mode delivers frames through a callback, which streaming is built on
+    m_HasFastMode = ArtemisHasFastMode(hCam);
+    if (m_HasFastMode)
+    {
+        LOG_DEBUG("Camera supports fast mode streaming.");
+        cap |= CCD_HAS_STREAMING;
+    }
+
     // Done with the capabilities!
     SetCCDCapability(cap);
 
@@ -623,12 +647,16 @@ bool ATIKCCD::Disconnect()
     RemoveTimer(genTimerID);
     genTimerID = -1;
 
+    if (m_FastStream.isStreaming())
+        Streamer->setStream(false);
+
     pthread_mutex_lock(&condMutex);
     tState = threadState;
     threadRequest = StateTerminate;
     pthread_cond_signal(&cv);
     pthread_mutex_unlock(&condMutex);
     pthread_join(imagingThread, nullptr);
+    cancelOverlappedExposure();
     tState = StateNone;
     if (isSimulation() == false)
     {
@@ -769,6 +797,19 @@ bool ATIKCCD::ISNewSwitch(const char *dev, const char *name, ISState *states, ch
 
             return true;
         }
+        // Overlapped exposures
+        else if (!strcmp(name, OverlapSP.name))
+        {
+            IUUpdateSwitch(&OverlapSP, states, names, n);
+            OverlapSP.s = IPS_OK;
+            if (OverlapS[OVERLAP_ON].s == ISS_ON)
+                LOG_INFO("Overlapped exposures are on. Each exposure starts while the previous frame is downloaded, "
+                         "do not use them with dithering or other changes between frames.");
+            else
+                cancelOverlappedExposure();
+            IDSetSwitch(&OverlapSP, nullptr);
+            return true;
+        }
         // Cooler controler
         else if (!strcmp(name, CoolerSP.name))
         {
@@ -983,9 +1024,28 @@ bool ATIKCCD::activateCooler(bool enable)
 
 bool ATIKCCD::StartExposure(float duration)
 {
+    if (m_FastStream.isStreaming())
+    {
+        LOG_ERROR("Cannot start an exposure while streaming.");
+        return false;
+    }
+
     PrimaryCCD.setExposureDuration(duration);
     ExposureRequest = duration;
 
+    if (adoptOverlappedExposure(duration))
+    {
+        m_FrameOverlapped = true;
+        LOGF_DEBUG("Start Exposure : %.3fs, started during the previous readout", duration);
+        InExposure = true;
+        pthread_mutex_lock(&condMutex);
+        threadRequest = StateExposure;
+        pthread_cond_signal(&cv);
+        pthread_mutex_unlock(&condMutex);
+        return true;
+    }
+    m_FrameOverlapped = false;
+
     // Camera needs to be in idle state to start exposure after previous abort
     int maxWaitCount = 1000; // 1000 * 0.1s = 100s
     while (ArtemisCameraState(hCam) != CAMERA_IDLE && --maxWaitCount > 0)
@@ -1054,6 +1114,7 @@ bool ATIKCCD::AbortExposure()
     }
     pthread_mutex_unlock(&condMutex);
     ArtemisStopExposure(hCam);
+    cancelOverlappedExposure();
     InExposure = false;
     return true;
 }
@@ -1063,6 +1124,8 @@ bool ATIKCCD::AbortExposure()
 /////////////////////////////////////////////////////////
 bool ATIKCCD::UpdateCCDFrame(int x, int y, int w, int h)
 {
+    cancelOverlappedExposure();
+
     int rc = ArtemisSubframe(hCam, x, y, w, h);
     if (rc != ARTEMIS_OK)
     {
@@ -1084,6 +1147,8 @@ bool ATIKCCD::UpdateCCDFrame(int x, int y, int w, int h)
 /////////////////////////////////////////////////////////
 bool ATIKCCD::UpdateCCDBin(int binx, int biny)
 {
+    cancelOverlappedExposure();
+
     int rc = ArtemisBin(hCam, binx, biny);
 
     if (rc != ARTEMIS_OK)
@@ -1094,6 +1159,105 @@ bool ATIKCCD::UpdateCCDBin(int binx, int biny)
     return UpdateCCDFrame(PrimaryCCD.getSubX(), PrimaryCCD.getSubY(), PrimaryCCD.getSubW(), PrimaryCCD.getSubH());
 }
 
+/////////////////////////////////////////////////////////
+/// Start streaming in fast mode
+/////////////////////////////////////////////////////////
+bool ATIKCCD::StartStreaming()
+{
+    if (!m_HasFastMode)
+    {
+        LOG_ERROR("Camera does not support fast mode streaming.");
+        return false;
+    }
+    if (InExposure)
+    {
+        LOG_ERROR("Cannot start streaming while an exposure is in progress.");
+        return false;
+    }
+    cancelOverlappedExposure();
+
+    int subW = PrimaryCCD.getSubW() / PrimaryCCD.getBinX();
+    int subH = PrimaryCCD.getSubH() / PrimaryCCD.getBinY();
+    int exposureMS = std::max(1, static_cast<int>(lround(1000.0 / Streamer->getTargetFPS())));
+    Streamer->setPixelFormat(streamPixelFormat(), PrimaryCCD.getBPP());
+    Streamer->setSize(subW, subH);
+
+    if (m_isHorizon)
+    {
+        uint16_t value = FASTMODE_FAST;
+        pthread_mutex_lock(&accessMutex);
+        ArtemisCameraSpecificOptionSetData(hCam, ID_AtikHorizonExposureSpeed, reinterpret_cast<uint8_t*>(&value), 2);
+        pthread_mutex_unlock(&accessMutex);
+    }
+
+    size_t frameBytes = static_cast<size_t>(subW) * subH * PrimaryCCD.getBPP() / 8;
+    auto newFrame = [this](const uint8_t *frame, size_t size)
+    {
+        Streamer->newFrame(frame, size);
+    };
+    if (!m_FastStream.start(hCam, exposureMS, frameBytes, PrimaryCCD.getBPP(), newFrame))
+    {
+        LOGF_ERROR("Failed to start fast exposure of %d ms.", exposureMS);
+        StopStreaming();
+        return false;
+    }
+
+    LOGF_DEBUG("Streaming %dx%d at %d ms per frame.", subW, subH, exposureMS);
+    return true;
+}
+
+/////////////////////////////////////////////////////////
+/// Stop streaming
+/////////////////////////////////////////////////////////
+bool ATIKCCD::StopStreaming()
+{
+    bool streaming = m_FastStream.isStreaming();
+    m_FastStream.stop();
+
+    if (m_isHorizon)
+    {
+        // Back to the exposure speed selected for still frames
+        uint16_t value = static_cast<uint16_t>(std::max(0, IUFindOnSwitchIndex(&FastModeSP)));
+        pthread_mutex_lock(&accessMutex);
+        ArtemisCameraSpecificOptionSetData(hCam, ID_AtikHorizonExposureSpeed, reinterpret_cast<uint8_t*>(&value), 2);
+        pthread_mutex_unlock(&accessMutex);
+    }
+
+    if (streaming)
+        LOGF_DEBUG("Streaming stopped, %u frames received and %u dropped, fast exposure restarted %u times.",
+                   m_FastStream.received(), m_FastStream.dropped(), m_FastStream.restarts());
+    return true;
+}
+
+/////////////////////////////////////////////////////////
+/// Streamed frames carry no Bayer offsets, so the pattern
+/// in BayerT is moved to the origin of the subframe.
+/////////////////////////////////////////////////////////
+INDI_PIXEL_FORMAT ATIKCCD::streamPixelFormat()
+{
+    if (!HasBayer())
+        return INDI_MONO;
+
+    static const std::map<std::string, INDI_PIXEL_FORMAT> formats =
+    {
+        {"RGGB", INDI_BAYER_RGGB},
+        {"GRBG", INDI_BAYER_GRBG},
+        {"GBRG", INDI_BAYER_GBRG},
+        {"BGGR", INDI_BAYER_BGGR},
+    };
+
+    std::string pattern = AtikStream::bayerPattern(BayerT[2].text,
+                          atoi(BayerT[0].text) + PrimaryCCD.getSubX(),
+                          atoi(BayerT[1].text) + PrimaryCCD.getSubY());
+    auto format = formats.find(pattern);
+    if (format == formats.end())
+    {
+        LOGF_WARN("Unknown Bayer pattern %s, streaming monochrome frames.", pattern.c_str());
+        return INDI_MONO;
+    }
+    return format->second;
+}
+
 /////////////////////////////////////////////////////////
 /// Download from CCD
 /////////////////////////////////////////////////////////
@@ -1114,10 +1278,21 @@ bool ATIKCCD::grabImage()
         PrimaryCCD.setFrameBufferSize(bufferSize, false);
     }
 
+    bool overlap = OverlapS[OVERLAP_ON].s == ISS_ON;
     std::unique_lock<std::mutex> guard(ccdBufferLock);
-    PrimaryCCD.setFrameBuffer(reinterpret_cast<uint8_t*>(ArtemisImageBuffer(hCam)));
+    uint8_t *image = reinterpret_cast<uint8_t*>(ArtemisImageBuffer(hCam));
+    if (overlap)
+    {
+        m_OverlapBuffer.assign(image, image + PrimaryCCD.getFrameBufferSize());
+        image = m_OverlapBuffer.data();
+    }
+    PrimaryCCD.setFrameBuffer(image);
     guard.unlock();
 
+    // The sensor exposes the next frame while this one is published
+    if (overlap)
+        armOverlappedExposure();
+
     if (ExposureRequest > VERBOSE_EXPOSURE)
         LOG_INFO("Download complete.");
 
@@ -1125,6 +1300,64 @@ bool ATIKCCD::grabImage()
     return true;
 }
 
+/////////////////////////////////////////////////////////
+/// Frame settings an overlapped exposure must match
+/////////////////////////////////////////////////////////
+AtikOverlap::Settings ATIKCCD::overlapSettings()
+{
+    AtikOverlap::Settings settings;
+    settings.frameType = PrimaryCCD.getFrameType();
+    settings.x = PrimaryCCD.getSubX();
+    settings.y = PrimaryCCD.getSubY();
+    settings.w = PrimaryCCD.getSubW();
+    settings.h = PrimaryCCD.getSubH();
+    settings.binX = PrimaryCCD.getBinX();
+    settings.binY = PrimaryCCD.getBinY();
+    settings.filter = CurrentFilter;
+    return settings;
+}
+
+/////////////////////////////////////////////////////////
+/// Start the next exposure during readout. Called from
+/// the imaging thread with accessMutex held.
+/////////////////////////////////////////////////////////
+void ATIKCCD::armOverlappedExposure()
+{
+    int rc = m_ArmedExposure.arm(hCam, static_cast<float>(ExposureRequest), overlapSettings());
+    if (rc != ARTEMIS_OK)
+    {
+        LOGF_WARN("Failed to start overlapped exposure (%d), overlapped exposures are turned off.", rc);
+        IUResetSwitch(&OverlapSP);
+        OverlapS[OVERLAP_OFF].s = ISS_ON;
+        OverlapSP.s = IPS_ALERT;
+        IDSetSwitch(&OverlapSP, nullptr);
+    }
+}
+
+/////////////////////////////////////////////////////////
+/// Use the armed exposure for this request if it was
+/// started with the same settings and is not stale.
+/// Otherwise it is discarded.
+/////////////////////////////////////////////////////////
+bool ATIKCCD::adoptOverlappedExposure(float duration)
+{
+    AtikOverlap::ArmedExposure::Adoption adoption = m_ArmedExposure.adopt(duration, overlapSettings());
+    if (adoption.adopted)
+        m_FrameStart = adoption.start;
+    else if (adoption.armed)
+        LOGF_DEBUG("Discarding overlapped exposure started %.3fs ago.", adoption.waited);
+    return adoption.adopted;
+}
+
+/////////////////////////////////////////////////////////
+/// Discard the armed exposure, the frame settings changed
+/////////////////////////////////////////////////////////
+void ATIKCCD::cancelOverlappedExposure()
+{
+    if (m_ArmedExposure.cancel())
+        LOG_DEBUG("Discarded overlapped exposure.");
+}
+
 /////////////////////////////////////////////////////////
 /// Cooler & Filter Wheel monitoring
 /////////////////////////////////////////////////////////
@@ -1516,6 +1749,11 @@ void ATIKCCD::addFITSKeywords(INDI::CCDChip *targetChip, std::vector<INDI::FITSR
         fitsKeywords.push_back({"GAIN", ControlN[CONTROL_GAIN].value, 3, "Gain"});
         fitsKeywords.push_back({"OFFSET", ControlN[CONTROL_OFFSET].value, 3, "Offset"});
     }
+
+    // The base DATE-OBS is the time of the exposure request, an overlapped exposure started during the previous readout
+    if (m_FrameOverlapped)
+        FITSTime::replaceRecord(fitsKeywords, INDI::FITSRecord("DATE-OBS", FITSTime::isoTimestamp(m_FrameStart).c_str(),
+                                "UTC start date of observation"));
 }
 
 /////////////////////////////////////////////////////////
@@ -1542,6 +1780,8 @@ bool ATIKCCD::saveConfigItems(FILE *fp)
         // IUSaveConfigSwitch(fp, &BitSendSP); // unused
     }
 
+    IUSaveConfigSwitch(fp, &OverlapSP);
+
     if (m_CameraFlags & ARTEMIS_PROPERTIES_CAMERAFLAGS_HAS_FILTERWHEEL)
         IUSaveConfigText(fp, FilterNameTP);
     // JM 2020-01-15: Seems like setting filter slot results in spinning
@@ -1553,6 +1793,7 @@ bool ATIKCCD::saveConfigItems(FILE *fp)
 
 bool ATIKCCD::SelectFilter(int targetFilter)
 {
+    cancelOverlappedExposure();
     LOGF_DEBUG("Selecting filter %d", targetFilter);
     int rc = ArtemisFilterWheelMove(hCam, targetFilter - 1);
     return (rc == ARTEMIS_OK);
@@ -21,11 +21,17 @@
 
 #pragma once
 
+#include "atik_overlap.h"
+#include "atik_stream.h"
+
 #include <AtikCameras.h>
 
 #include <indifilterinterface.h>
 #include <indiccd.h>
 
+#include <chrono>
+#include <vector>
+
 class ATIKCCD : public INDI::CCD, public INDI::FilterInterface
 {
     public:
@@ -55,6 +61,10 @@ class ATIKCCD : public INDI::CCD, public INDI::FilterInterface
         virtual bool UpdateCCDFrame(int x, int y, int w, int h) override;
         virtual bool UpdateCCDBin(int binx, int biny) override;
 
+        // Streaming
+        virtual bool StartStreaming() override;
+        virtual bool StopStreaming() override;
+
         // Guide Port
         virtual IPState GuideNorth(uint32_t ms) override;
         virtual IPState GuideSouth(uint32_t ms) override;
@@ -134,6 +144,15 @@ class ATIKCCD : public INDI::CCD, public INDI::FilterInterface
         // Retrieve image from SDK
         bool grabImage();
 
+        // Fast mode streaming
+        INDI_PIXEL_FORMAT streamPixelFormat();
+
+        // Overlapped exposures
+        AtikOverlap::Settings overlapSettings();
+        void armOverlappedExposure();
+        bool adoptOverlappedExposure(float duration);
+        void cancelOverlappedExposure();
+
         /**
          * @brief setupParams get initial camera parameters
          */
@@ -212,6 +231,15 @@ class ATIKCCD : public INDI::CCD, public INDI::FilterInterface
             FASTMODE_FAST,
         };
 
+        // Overlapped exposures: the next exposure starts while the current frame is published
+        ISwitch OverlapS[2];
+        ISwitchVectorProperty OverlapSP;
+        enum
+        {
+            OVERLAP_ON,
+            OVERLAP_OFF,
+        };
+
 #if 0 // unused
         // Bit send
         ISwitch BitSendS[2];
@@ -269,6 +297,19 @@ class ATIKCCD : public INDI::CCD, public INDI::FilterInterface
         // Temperature Sensors
         int m_TemperatureSensorsCount {0};
 
+        // Fast mode streaming
+        bool m_HasFastMode { false };
+        AtikStream::FastStream m_FastStream { accessMutex };
+
+        // Overlapped exposures. The armed exposure was started during the last readout and is used
+        // by the next StartExposure if it matches, or discarded 2 seconds after it is done.
+        AtikOverlap::ArmedExposure m_ArmedExposure { accessMutex, 2.0 };
+        // Start of the frame being exposed, when it is an overlapped exposure
+        bool m_FrameOverlapped { false };
+        std::chrono::system_clock::time_point m_FrameStart;
+        // Published frames are copied out of the SDK buffer, which the next exposure downloads into
+        std::vector<uint8_t> m_OverlapBuffer;
+
         char name[MAXINDIDEVICE];
 
         friend void ::ISGetProperties(const char *dev);
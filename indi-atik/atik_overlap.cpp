@@ -0,0 +1,93 @@
+/*
+ ATIK overlapped exposures
+ Copyright (C) 2026 INDI 3rd party contributors
+
+ This library is free software; you can redistribute it and/or
+ modify it under the terms of the GNU Lesser General Public
+ License as published by the Free Software Foundation; either
+ version 2.1 of the License, or (at your option) any later version.
+
+ This library is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public
+ License along with this library; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+
+*/
+
+#include "atik_overlap.h"
+
+#include <cmath>
+
+namespace AtikOverlap
+{
+
+ArmedExposure::ArmedExposure(pthread_mutex_t &sdkMutex, double maxWait) : m_SDKMutex(sdkMutex), m_MaxWait(maxWait)
+{
+}
+
+int ArmedExposure::arm(ArtemisHandle handle, float duration, const Settings &settings)
+{
+    m_Armed = false;
+
+    int rc = ArtemisSetOverlappedExposureTime(handle, duration);
+    if (rc == ARTEMIS_OK)
+        rc = ArtemisStartOverlappedExposure(handle);
+    if (rc != ARTEMIS_OK)
+        return rc;
+
+    m_Armed = true;
+    m_Handle = handle;
+    m_Duration = duration;
+    m_Settings = settings;
+    m_Start = std::chrono::system_clock::now();
+    m_ArmedTime = std::chrono::steady_clock::now();
+    return ARTEMIS_OK;
+}
+
+ArmedExposure::Adoption ArmedExposure::adopt(float duration, const Settings &settings)
+{
+    Adoption adoption;
+
+    pthread_mutex_lock(&m_SDKMutex);
+    adoption.armed = m_Armed;
+    m_Armed = false;
+    if (adoption.armed)
+    {
+        adoption.waited = std::chrono::duration<double>(std::chrono::steady_clock::now() - m_ArmedTime).count();
+        adoption.start = m_Start;
+        adoption.adopted = std::fabs(duration - m_Duration) < DURATION_TOLERANCE && settings == m_Settings &&
+                           adoption.waited < m_Duration + m_MaxWait && ArtemisOverlappedExposureValid(m_Handle);
+        if (!adoption.adopted)
+            ArtemisStopExposure(m_Handle);
+    }
+    pthread_mutex_unlock(&m_SDKMutex);
+
+    return adoption;
+}
+
+bool ArmedExposure::cancel()
+{
+    pthread_mutex_lock(&m_SDKMutex);
+    bool armed = m_Armed;
+    if (armed)
+    {
+        m_Armed = false;
+        ArtemisStopExposure(m_Handle);
+    }
+    pthread_mutex_unlock(&m_SDKMutex);
+    return armed;
+}
+
+bool ArmedExposure::isArmed()
+{
+    pthread_mutex_lock(&m_SDKMutex);
+    bool armed = m_Armed;
+    pthread_mutex_unlock(&m_SDKMutex);
+    return armed;
+}
+
+}
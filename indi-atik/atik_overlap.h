@@ -0,0 +1,99 @@
+/*
+ ATIK overlapped exposures
+ Copyright (C) 2026 INDI 3rd party contributors
+
+ This library is free software; you can redistribute it and/or
+ modify it under the terms of the GNU Lesser General Public
+ License as published by the Free Software Foundation; either
+ version 2.1 of the License, or (at your option) any later version.
+
+ This library is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public
+ License along with this library; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+
+ Only depends on the Atik SDK, so the tests link it against the fake
+ libatik in test/fake instead.
+*/
+
+#pragma once
+
+#include <AtikCameras.h>
+
+#include <pthread.h>
+
+#include <chrono>
+
+namespace AtikOverlap
+{
+
+// Frame settings an armed exposure was started with
+struct Settings
+{
+    int frameType { 0 };
+    int x { 0 }, y { 0 }, w { 0 }, h { 0 };
+    int binX { 1 }, binY { 1 };
+    int filter { 0 };
+
+    bool operator==(const Settings &other) const
+    {
+        return frameType == other.frameType && x == other.x && y == other.y && w == other.w && h == other.h &&
+               binX == other.binX && binY == other.binY && filter == other.filter;
+    }
+    bool operator!=(const Settings &other) const
+    {
+        return !(*this == other);
+    }
+};
+
+// The next exposure, started during the readout of the current frame and used by the next request
+// if it asks for the same exposure with the same settings.
+class ArmedExposure
+{
+    public:
+        // Durations closer than this are the same request, the SDK times exposures to the millisecond
+        static constexpr double DURATION_TOLERANCE = 1e-3;
+
+        // SDK calls are made with sdkMutex held. An exposure is stale maxWait seconds after it is done.
+        ArmedExposure(pthread_mutex_t &sdkMutex, double maxWait);
+
+        // Starts the overlapped exposure. Called with sdkMutex held, from the readout.
+        // Returns ARTEMIS_OK or the SDK error, in which case nothing is armed.
+        int arm(ArtemisHandle handle, float duration, const Settings &settings);
+
+        struct Adoption
+        {
+            // An exposure was armed, and whether it was taken for this request
+            bool armed { false };
+            bool adopted { false };
+            // Seconds since it was armed, and when it started on the host clock
+            double waited { 0 };
+            std::chrono::system_clock::time_point start;
+        };
+
+        // Takes the armed exposure for this request, or stops it if it does not match or is stale.
+        // Nothing is armed afterwards.
+        Adoption adopt(float duration, const Settings &settings);
+
+        // Stops the armed exposure. True if one was armed.
+        bool cancel();
+
+        bool isArmed();
+
+    private:
+        pthread_mutex_t &m_SDKMutex;
+        double m_MaxWait { 0 };
+
+        bool m_Armed { false };
+        ArtemisHandle m_Handle { nullptr };
+        float m_Duration { 0 };
+        Settings m_Settings;
+        std::chrono::system_clock::time_point m_Start;
+        std::chrono::steady_clock::time_point m_ArmedTime;
+};
+
+}
@@ -0,0 +1,220 @@
+/*
+ ATIK fast mode streaming
+ Copyright (C) 2026 INDI 3rd party contributors
+
+ This library is free software; you can redistribute it and/or
+ modify it under the terms of the GNU Lesser General Public
+ License as published by the Free Software Foundation; either
+ version 2.1 of the License, or (at your option) any later version.
+
+ This library is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public
+ License along with this library; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+
+*/
+
+#include "atik_stream.h"
+
+#include <chrono>
+#include <cstring>
+#include <map>
+
+namespace AtikStream
+{
+
+// The fast mode callback carries no context, so it finds its stream by handle
+static std::mutex callbackLock;
+static std::map<ArtemisHandle, FastStream *> callbackStreams;
+
+std::string bayerPattern(const std::string &pattern, int offsetX, int offsetY)
+{
+    if (pattern.size() != 4)
+        return pattern;
+
+    std::string moved = pattern;
+    // An odd column offset swaps the columns, an odd row offset swaps the rows
+    if (offsetX & 1)
+        moved = { moved[1], moved[0], moved[3], moved[2] };
+    if (offsetY & 1)
+        moved = { moved[2], moved[3], moved[0], moved[1] };
+    return moved;
+}
+
+FastStream::FastStream(pthread_mutex_t &sdkMutex) : m_SDKMutex(sdkMutex)
+{
+}
+
+FastStream::~FastStream()
+{
+    stop();
+}
+
+bool FastStream::start(ArtemisHandle handle, int exposureMS, size_t frameBytes, int bitsPerPixel, NewFrame newFrame)
+{
+    stop();
+
+    m_Handle = handle;
+    m_ExposureMS = exposureMS;
+    m_BitsPerPixel = bitsPerPixel;
+    m_NewFrame = std::move(newFrame);
+
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        m_FrameBytes = frameBytes;
+        m_Pool.assign(POOL_SIZE, std::vector<uint8_t>(m_FrameBytes));
+        m_Free.clear();
+        m_Ready.clear();
+        for (int i = 0; i < POOL_SIZE; i++)
+            m_Free.push_back(i);
+        m_Received = 0;
+        m_Dropped = 0;
+        m_Restarts = 0;
+        m_Streaming = true;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(callbackLock);
+        callbackStreams[m_Handle] = this;
+    }
+
+    pthread_mutex_lock(&m_SDKMutex);
+    ArtemisSetFastCallbackEx(m_Handle, &FastStream::callbackHelper);
+    pthread_mutex_unlock(&m_SDKMutex);
+
+    if (!startExposure())
+    {
+        stop();
+        return false;
+    }
+
+    m_Thread = std::thread(&FastStream::deliveryThread, this);
+    return true;
+}
+
+void FastStream::stop()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        if (!m_Streaming)
+            return;
+        m_Streaming = false;
+    }
+    m_CV.notify_all();
+    if (m_Thread.joinable())
+        m_Thread.join();
+
+    pthread_mutex_lock(&m_SDKMutex);
+    ArtemisStopExposure(m_Handle);
+    pthread_mutex_unlock(&m_SDKMutex);
+
+    // Waits for a callback in progress, the pool is not touched after this
+    std::lock_guard<std::mutex> lock(callbackLock);
+    callbackStreams.erase(m_Handle);
+}
+
+bool FastStream::startExposure()
+{
+    pthread_mutex_lock(&m_SDKMutex);
+    bool started = ArtemisStartFastExposure(m_Handle, m_ExposureMS);
+    pthread_mutex_unlock(&m_SDKMutex);
+    return started;
+}
+
+void FastStream::callbackHelper(ArtemisHandle handle, int x, int y, int w, int h, int binx, int biny,
+                                void *imageBuffer, unsigned char *info)
+{
+    (void)x;
+    (void)y;
+    (void)binx;
+    (void)biny;
+    (void)info;
+
+    std::lock_guard<std::mutex> lock(callbackLock);
+    auto stream = callbackStreams.find(handle);
+    if (stream != callbackStreams.end())
+        stream->second->callback(w, h, imageBuffer);
+}
+
+void FastStream::callback(int w, int h, const void *imageBuffer)
+{
+    int slot = -1;
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        if (!m_Streaming)
+            return;
+
+        m_Received++;
+        if (static_cast<size_t>(w) * h * m_BitsPerPixel / 8 < m_FrameBytes)
+        {
+            m_Dropped++;
+            return;
+        }
+
+        if (!m_Free.empty())
+        {
+            slot = m_Free.front();
+            m_Free.pop_front();
+        }
+        else if (!m_Ready.empty())
+        {
+            slot = m_Ready.front();
+            m_Ready.pop_front();
+            m_Dropped++;
+        }
+        else
+        {
+            m_Dropped++;
+            return;
+        }
+    }
+
+    memcpy(m_Pool[slot].data(), imageBuffer, m_FrameBytes);
+
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        m_Ready.push_back(slot);
+    }
+    m_CV.notify_one();
+}
+
+void FastStream::deliveryThread()
+{
+    // A frame should arrive well within this, otherwise the fast exposure is started again
+    const auto watchdog = std::chrono::milliseconds(2 * m_ExposureMS + 2000);
+
+    auto frameReady = [this]()
+    {
+        return !m_Streaming || !m_Ready.empty();
+    };
+
+    std::unique_lock<std::mutex> lock(m_Mutex);
+    while (m_Streaming)
+    {
+        if (!m_CV.wait_for(lock, watchdog, frameReady))
+        {
+            m_Restarts++;
+            lock.unlock();
+            startExposure();
+            lock.lock();
+            continue;
+        }
+        if (!m_Streaming)
+            break;
+
+        int slot = m_Ready.front();
+        m_Ready.pop_front();
+        lock.unlock();
+
+        m_NewFrame(m_Pool[slot].data(), m_FrameBytes);
+
+        lock.lock();
+        m_Free.push_back(slot);
+    }
+}
+
+}
@@ -0,0 +1,110 @@
+/*
+ ATIK fast mode streaming
+ Copyright (C) 2026 INDI 3rd party contributors
+
+ This library is free software; you can redistribute it and/or
+ modify it under the terms of the GNU Lesser General Public
+ License as published by the Free Software Foundation; either
+ version 2.1 of the License, or (at your option) any later version.
+
+ This library is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public
+ License along with this library; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+
+ Only depends on the Atik SDK, so the tests link it against the fake
+ libatik in test/fake instead.
+*/
+
+#pragma once
+
+#include <AtikCameras.h>
+
+#include <pthread.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace AtikStream
+{
+
+// Bayer pattern at a pixel offset from the origin of a pattern, e.g. RGGB moved by one column is GRBG.
+// Patterns that are not four colors are returned unchanged.
+std::string bayerPattern(const std::string &pattern, int offsetX, int offsetY);
+
+// Fast mode exposures of one camera. The SDK callback copies each frame into a free pool slot and
+// the delivery thread hands it on. When the delivery falls behind, the oldest waiting frame is
+// dropped so the stream stays current.
+class FastStream
+{
+    public:
+        static constexpr int POOL_SIZE = 4;
+
+        // Called from the delivery thread with every frame.
+        using NewFrame = std::function<void(const uint8_t *frame, size_t size)>;
+
+        // SDK calls are made with sdkMutex held.
+        explicit FastStream(pthread_mutex_t &sdkMutex);
+        ~FastStream();
+
+        // Registers the callback and starts fast exposures of exposureMS. False if the SDK refused.
+        bool start(ArtemisHandle handle, int exposureMS, size_t frameBytes, int bitsPerPixel, NewFrame newFrame);
+        // Stops the exposures, waits for the delivery thread and for a callback in progress.
+        void stop();
+
+        bool isStreaming() const
+        {
+            return m_Streaming;
+        }
+        uint32_t received() const
+        {
+            return m_Received;
+        }
+        uint32_t dropped() const
+        {
+            return m_Dropped;
+        }
+        // Fast exposures started again because no frame arrived in time.
+        uint32_t restarts() const
+        {
+            return m_Restarts;
+        }
+
+    private:
+        static void callbackHelper(ArtemisHandle handle, int x, int y, int w, int h, int binx, int biny,
+                                   void *imageBuffer, unsigned char *info);
+        void callback(int w, int h, const void *imageBuffer);
+        bool startExposure();
+        void deliveryThread();
+
+        pthread_mutex_t &m_SDKMutex;
+        ArtemisHandle m_Handle { nullptr };
+        int m_ExposureMS { 0 };
+        int m_BitsPerPixel { 16 };
+        size_t m_FrameBytes { 0 };
+        NewFrame m_NewFrame;
+
+        std::atomic_bool m_Streaming { false };
+        std::vector<std::vector<uint8_t>> m_Pool;
+        std::deque<int> m_Free;
+        std::deque<int> m_Ready;
+        uint32_t m_Received { 0 };
+        uint32_t m_Dropped { 0 };
+        uint32_t m_Restarts { 0 };
+        std::mutex m_Mutex;
+        std::condition_variable m_CV;
+        std::thread m_Thread;
+};
+
+}
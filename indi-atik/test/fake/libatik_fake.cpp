@@ -0,0 +1,166 @@
+/*
+ Fake of the parts of libatik used by the SDK-only driver sources.
+ Copyright (C) 2026 INDI 3rd party contributors
+
+ This library is free software; you can redistribute it and/or
+ modify it under the terms of the GNU Lesser General Public
+ License as published by the Free Software Foundation; either
+ version 2.1 of the License, or (at your option) any later version.
+
+ This library is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public
+ License along with this library; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+
+*/
+
+#include "libatik_fake.h"
+
+#include <atomic>
+#include <map>
+#include <mutex>
+
+namespace
+{
+
+using FastCallback = void(*)(ArtemisHandle handle, int x, int y, int w, int h, int binx, int biny,
+                             void *imageBuffer, unsigned char *info);
+
+std::mutex fakeLock;
+std::map<ArtemisHandle, FastCallback> fastCallbacks;
+bool fastRefused = false;
+std::atomic_int fastExposureCount { 0 };
+std::atomic_int stopExposureCount { 0 };
+int overlappedRC = ARTEMIS_OK;
+bool overlappedIsValid = true;
+int overlappedCount = 0;
+float overlappedSeconds = 0;
+
+}
+
+BOOL ArtemisSetFastCallbackEx(ArtemisHandle handle, void(*callback)(ArtemisHandle handle, int x, int y, int w, int h,
+                              int binx, int biny, void *imageBuffer, unsigned char *info))
+{
+    std::lock_guard<std::mutex> lock(fakeLock);
+    fastCallbacks[handle] = callback;
+    return true;
+}
+
+BOOL ArtemisStartFastExposure(ArtemisHandle handle, int ms)
+{
+    (void)handle;
+    (void)ms;
+    fastExposureCount++;
+    std::lock_guard<std::mutex> lock(fakeLock);
+    return !fastRefused;
+}
+
+int ArtemisStopExposure(ArtemisHandle handle)
+{
+    (void)handle;
+    stopExposureCount++;
+    return ARTEMIS_OK;
+}
+
+int ArtemisSetOverlappedExposureTime(ArtemisHandle handle, float fSeconds)
+{
+    (void)handle;
+    std::lock_guard<std::mutex> lock(fakeLock);
+    overlappedSeconds = fSeconds;
+    return ARTEMIS_OK;
+}
+
+int ArtemisStartOverlappedExposure(ArtemisHandle handle)
+{
+    (void)handle;
+    std::lock_guard<std::mutex> lock(fakeLock);
+    if (overlappedRC == ARTEMIS_OK)
+        overlappedCount++;
+    return overlappedRC;
+}
+
+BOOL ArtemisOverlappedExposureValid(ArtemisHandle handle)
+{
+    (void)handle;
+    std::lock_guard<std::mutex> lock(fakeLock);
+    return overlappedIsValid;
+}
+
+namespace AtikFake
+{
+
+void reset()
+{
+    std::lock_guard<std::mutex> lock(fakeLock);
+    fastCallbacks.clear();
+    fastRefused = false;
+    fastExposureCount = 0;
+    stopExposureCount = 0;
+    overlappedRC = ARTEMIS_OK;
+    overlappedIsValid = true;
+    overlappedCount = 0;
+    overlappedSeconds = 0;
+}
+
+void refuseFastExposure(bool refuse)
+{
+    std::lock_guard<std::mutex> lock(fakeLock);
+    fastRefused = refuse;
+}
+
+bool fastFrame(ArtemisHandle handle, int w, int h, const std::vector<uint16_t> &pixels)
+{
+    FastCallback callback = nullptr;
+    {
+        std::lock_guard<std::mutex> lock(fakeLock);
+        auto registered = fastCallbacks.find(handle);
+        if (registered != fastCallbacks.end())
+            callback = registered->second;
+    }
+    if (callback == nullptr)
+        return false;
+
+    std::vector<uint16_t> buffer = pixels;
+    callback(handle, 0, 0, w, h, 1, 1, buffer.data(), nullptr);
+    return true;
+}
+
+void overlappedResult(int rc)
+{
+    std::lock_guard<std::mutex> lock(fakeLock);
+    overlappedRC = rc;
+}
+
+void overlappedValid(bool valid)
+{
+    std::lock_guard<std::mutex> lock(fakeLock);
+    overlappedIsValid = valid;
+}
+
+int fastExposures()
+{
+    return fastExposureCount;
+}
+
+int stopExposures()
+{
+    return stopExposureCount;
+}
+
+int overlappedExposures()
+{
+    std::lock_guard<std::mutex> lock(fakeLock);
+    return overlappedCount;
+}
+
+float overlappedTime()
+{
+    std::lock_guard<std::mutex> lock(fakeLock);
+    return overlappedSeconds;
+}
+
+}
@@ -0,0 +1,54 @@
+/*
+ Fake of the parts of libatik used by the SDK-only driver sources.
+ Copyright (C) 2026 INDI 3rd party contributors
+
+ This library is free software; you can redistribute it and/or
+ modify it under the terms of the GNU Lesser General Public
+ License as published by the Free Software Foundation; either
+ version 2.1 of the License, or (at your option) any later version.
+
+ This library is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public
+ License along with this library; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+
+ The tests compile against the real AtikCameras.h and link libatik_fake.cpp
+ instead of libatik, so no camera is needed. Fast mode frames are pushed by
+ the test through the registered callback, as the SDK thread would, and
+ overlapped exposures are only counted.
+*/
+
+#pragma once
+
+#include <AtikCameras.h>
+
+#include <cstdint>
+#include <vector>
+
+namespace AtikFake
+{
+
+// Forgets the callback, clears the counters and makes the overlapped exposures succeed.
+void reset();
+
+// Makes ArtemisStartFastExposure fail.
+void refuseFastExposure(bool refuse);
+
+// Passes a w x h frame to the fast callback registered for handle. False if there is none.
+bool fastFrame(ArtemisHandle handle, int w, int h, const std::vector<uint16_t> &pixels);
+
+// Result of ArtemisStartOverlappedExposure, and what ArtemisOverlappedExposureValid reports.
+void overlappedResult(int rc);
+void overlappedValid(bool valid);
+
+int fastExposures();
+int stopExposures();
+int overlappedExposures();
+// Time of the last ArtemisSetOverlappedExposureTime.
+float overlappedTime();
+
+}
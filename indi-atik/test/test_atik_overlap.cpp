@@ -0,0 +1,175 @@
+/*
+ ATIK overlapped exposures against the fake libatik in test/fake.
+ Copyright (C) 2026 INDI 3rd party contributors
+
+ This library is free software; you can redistribute it and/or
+ modify it under the terms of the GNU Lesser General Public
+ License as published by the Free Software Foundation; either
+ version 2.1 of the License, or (at your option) any later version.
+
+ This library is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public
+ License along with this library; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+
+*/
+
+#include "atik_overlap.h"
+#include "fake/libatik_fake.h"
+
+#include <gtest/gtest.h>
+
+#include <thread>
+
+namespace
+{
+
+ArtemisHandle camera = reinterpret_cast<ArtemisHandle>(0x1234);
+
+AtikOverlap::Settings frameSettings()
+{
+    AtikOverlap::Settings settings;
+    settings.frameType = 0;
+    settings.w = 1024;
+    settings.h = 768;
+    settings.filter = 2;
+    return settings;
+}
+
+class AtikOverlapTest : public ::testing::Test
+{
+    protected:
+        void SetUp() override
+        {
+            AtikFake::reset();
+        }
+
+        // Arms as the readout does, with the SDK lock held
+        int arm(float duration, const AtikOverlap::Settings &settings = frameSettings())
+        {
+            pthread_mutex_lock(&sdkMutex);
+            int rc = armed.arm(camera, duration, settings);
+            pthread_mutex_unlock(&sdkMutex);
+            return rc;
+        }
+
+        pthread_mutex_t sdkMutex = PTHREAD_MUTEX_INITIALIZER;
+        AtikOverlap::ArmedExposure armed { sdkMutex, 2.0 };
+};
+
+}
+
+TEST_F(AtikOverlapTest, MatchingRequestIsAdopted)
+{
+    auto before = std::chrono::system_clock::now();
+    ASSERT_EQ(arm(1.5f), ARTEMIS_OK);
+    EXPECT_TRUE(armed.isArmed());
+    EXPECT_EQ(AtikFake::overlappedExposures(), 1);
+    EXPECT_FLOAT_EQ(AtikFake::overlappedTime(), 1.5f);
+
+    auto adoption = armed.adopt(1.5f, frameSettings());
+    EXPECT_TRUE(adoption.armed);
+    EXPECT_TRUE(adoption.adopted);
+    EXPECT_GE(adoption.start, before);
+    EXPECT_FALSE(armed.isArmed());
+    EXPECT_EQ(AtikFake::stopExposures(), 0);
+
+    // Taken once only
+    adoption = armed.adopt(1.5f, frameSettings());
+    EXPECT_FALSE(adoption.armed);
+    EXPECT_FALSE(adoption.adopted);
+}
+
+TEST_F(AtikOverlapTest, DurationsAreComparedWithATolerance)
+{
+    // 0.1 is not exact in float or double, and clients send it back through text
+    ASSERT_EQ(arm(0.1f), ARTEMIS_OK);
+    EXPECT_TRUE(armed.adopt(static_cast<float>(0.1), frameSettings()).adopted);
+
+    ASSERT_EQ(arm(0.1f), ARTEMIS_OK);
+    EXPECT_TRUE(armed.adopt(0.1000001f, frameSettings()).adopted);
+
+    ASSERT_EQ(arm(0.1f), ARTEMIS_OK);
+    auto adoption = armed.adopt(0.2f, frameSettings());
+    EXPECT_TRUE(adoption.armed);
+    EXPECT_FALSE(adoption.adopted);
+    EXPECT_EQ(AtikFake::stopExposures(), 1);
+}
+
+TEST_F(AtikOverlapTest, ChangedSettingsDiscardTheExposure)
+{
+    AtikOverlap::Settings roi = frameSettings();
+    roi.x = 10;
+    roi.w = 512;
+    AtikOverlap::Settings bin = frameSettings();
+    bin.binX = bin.binY = 2;
+    AtikOverlap::Settings filter = frameSettings();
+    filter.filter = 3;
+    AtikOverlap::Settings dark = frameSettings();
+    dark.frameType = 2;
+
+    int stops = 0;
+    for (const AtikOverlap::Settings &changed : { roi, bin, filter, dark })
+    {
+        ASSERT_EQ(arm(1.0f), ARTEMIS_OK);
+        auto adoption = armed.adopt(1.0f, changed);
+        EXPECT_TRUE(adoption.armed);
+        EXPECT_FALSE(adoption.adopted);
+        EXPECT_FALSE(armed.isArmed());
+        EXPECT_EQ(AtikFake::stopExposures(), ++stops);
+    }
+}
+
+TEST_F(AtikOverlapTest, CancelStopsTheExposure)
+{
+    // The driver cancels when the ROI, binning or filter changes, or the overlap is turned off
+    ASSERT_EQ(arm(1.0f), ARTEMIS_OK);
+    EXPECT_TRUE(armed.cancel());
+    EXPECT_FALSE(armed.isArmed());
+    EXPECT_EQ(AtikFake::stopExposures(), 1);
+
+    EXPECT_FALSE(armed.cancel());
+    EXPECT_EQ(AtikFake::stopExposures(), 1);
+
+    auto adoption = armed.adopt(1.0f, frameSettings());
+    EXPECT_FALSE(adoption.armed);
+    EXPECT_FALSE(adoption.adopted);
+}
+
+TEST_F(AtikOverlapTest, InvalidExposureIsDiscarded)
+{
+    ASSERT_EQ(arm(1.0f), ARTEMIS_OK);
+    AtikFake::overlappedValid(false);
+    auto adoption = armed.adopt(1.0f, frameSettings());
+    EXPECT_TRUE(adoption.armed);
+    EXPECT_FALSE(adoption.adopted);
+    EXPECT_EQ(AtikFake::stopExposures(), 1);
+}
+
+TEST_F(AtikOverlapTest, StaleExposureIsDiscarded)
+{
+    AtikOverlap::ArmedExposure quick { sdkMutex, 0.05 };
+    pthread_mutex_lock(&sdkMutex);
+    ASSERT_EQ(quick.arm(camera, 0.01f, frameSettings()), ARTEMIS_OK);
+    pthread_mutex_unlock(&sdkMutex);
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    auto adoption = quick.adopt(0.01f, frameSettings());
+    EXPECT_TRUE(adoption.armed);
+    EXPECT_FALSE(adoption.adopted);
+    EXPECT_GE(adoption.waited, 0.1);
+    EXPECT_EQ(AtikFake::stopExposures(), 1);
+}
+
+TEST_F(AtikOverlapTest, FailedStartArmsNothing)
+{
+    AtikFake::overlappedResult(ARTEMIS_OPERATION_FAILED);
+    EXPECT_EQ(arm(1.0f), ARTEMIS_OPERATION_FAILED);
+    EXPECT_FALSE(armed.isArmed());
+    EXPECT_FALSE(armed.adopt(1.0f, frameSettings()).armed);
+    EXPECT_EQ(AtikFake::stopExposures(), 0);
+}
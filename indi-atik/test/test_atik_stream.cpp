@@ -0,0 +1,228 @@
+/*
+ ATIK fast mode streaming against the fake libatik in test/fake.
+ Copyright (C) 2026 INDI 3rd party contributors
+
+ This library is free software; you can redistribute it and/or
+ modify it under the terms of the GNU Lesser General Public
+ License as published by the Free Software Foundation; either
+ version 2.1 of the License, or (at your option) any later version.
+
+ This library is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public
+ License along with this library; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+
+*/
+
+#include "atik_stream.h"
+#include "fake/libatik_fake.h"
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+namespace
+{
+
+const int W = 16;
+const int H = 8;
+const size_t FRAME_BYTES = W * H * sizeof(uint16_t);
+
+ArtemisHandle camera = reinterpret_cast<ArtemisHandle>(0x1234);
+
+std::vector<uint16_t> frame(uint16_t value)
+{
+    return std::vector<uint16_t>(W * H, value);
+}
+
+// First pixel of every delivered frame. The delivery blocks while the gate is closed.
+class Frames
+{
+    public:
+        void add(const uint8_t *data, size_t size)
+        {
+            std::unique_lock<std::mutex> lock(m_Mutex);
+            m_Arrived++;
+            m_CV.notify_all();
+            m_CV.wait(lock, [this]()
+            {
+                return m_Open;
+            });
+            EXPECT_EQ(size, FRAME_BYTES);
+            m_Values.push_back(reinterpret_cast<const uint16_t *>(data)[0]);
+            m_CV.notify_all();
+        }
+
+        void close()
+        {
+            std::lock_guard<std::mutex> lock(m_Mutex);
+            m_Open = false;
+        }
+
+        void open()
+        {
+            std::lock_guard<std::mutex> lock(m_Mutex);
+            m_Open = true;
+            m_CV.notify_all();
+        }
+
+        // Waits until count frames reached the delivery, or were delivered.
+        bool waitArrived(size_t count)
+        {
+            std::unique_lock<std::mutex> lock(m_Mutex);
+            return m_CV.wait_for(lock, std::chrono::seconds(2), [&]()
+            {
+                return m_Arrived >= count;
+            });
+        }
+        bool waitDelivered(size_t count)
+        {
+            std::unique_lock<std::mutex> lock(m_Mutex);
+            return m_CV.wait_for(lock, std::chrono::seconds(2), [&]()
+            {
+                return m_Values.size() >= count;
+            });
+        }
+
+        std::vector<uint16_t> values()
+        {
+            std::lock_guard<std::mutex> lock(m_Mutex);
+            return m_Values;
+        }
+
+    private:
+        std::mutex m_Mutex;
+        std::condition_variable m_CV;
+        bool m_Open { true };
+        size_t m_Arrived { 0 };
+        std::vector<uint16_t> m_Values;
+};
+
+class AtikStreamTest : public ::testing::Test
+{
+    protected:
+        void SetUp() override
+        {
+            AtikFake::reset();
+        }
+
+        bool start(int exposureMS = 100)
+        {
+            return stream.start(camera, exposureMS, FRAME_BYTES, 16, [this](const uint8_t *data, size_t size)
+            {
+                frames.add(data, size);
+            });
+        }
+
+        pthread_mutex_t sdkMutex = PTHREAD_MUTEX_INITIALIZER;
+        AtikStream::FastStream stream { sdkMutex };
+        Frames frames;
+};
+
+}
+
+TEST(AtikBayerPattern, OffsetsMoveThePattern)
+{
+    EXPECT_EQ(AtikStream::bayerPattern("RGGB", 0, 0), "RGGB");
+    EXPECT_EQ(AtikStream::bayerPattern("RGGB", 1, 0), "GRBG");
+    EXPECT_EQ(AtikStream::bayerPattern("RGGB", 0, 1), "GBRG");
+    EXPECT_EQ(AtikStream::bayerPattern("RGGB", 1, 1), "BGGR");
+    EXPECT_EQ(AtikStream::bayerPattern("RGGB", 2, 4), "RGGB");
+    EXPECT_EQ(AtikStream::bayerPattern("RGGB", 101, 0), "GRBG");
+    EXPECT_EQ(AtikStream::bayerPattern("BGGR", 1, 1), "RGGB");
+    EXPECT_EQ(AtikStream::bayerPattern("RGGB", -1, 0), "GRBG");
+    EXPECT_EQ(AtikStream::bayerPattern("", 1, 1), "");
+}
+
+TEST_F(AtikStreamTest, FramesAreDelivered)
+{
+    ASSERT_TRUE(start());
+    EXPECT_TRUE(stream.isStreaming());
+    EXPECT_EQ(AtikFake::fastExposures(), 1);
+
+    for (uint16_t i = 1; i <= 3; i++)
+    {
+        AtikFake::fastFrame(camera, W, H, frame(i));
+        ASSERT_TRUE(frames.waitDelivered(i));
+    }
+
+    stream.stop();
+    EXPECT_EQ(frames.values(), std::vector<uint16_t>({1, 2, 3}));
+    EXPECT_EQ(stream.received(), 3u);
+    EXPECT_EQ(stream.dropped(), 0u);
+    EXPECT_EQ(AtikFake::stopExposures(), 1);
+}
+
+TEST_F(AtikStreamTest, ShortFramesAreDropped)
+{
+    ASSERT_TRUE(start());
+    AtikFake::fastFrame(camera, W, H / 2, std::vector<uint16_t>(W * H / 2, 7));
+    AtikFake::fastFrame(camera, W, H, frame(8));
+    ASSERT_TRUE(frames.waitDelivered(1));
+
+    stream.stop();
+    EXPECT_EQ(frames.values(), std::vector<uint16_t>({8}));
+    EXPECT_EQ(stream.received(), 2u);
+    EXPECT_EQ(stream.dropped(), 1u);
+}
+
+TEST_F(AtikStreamTest, SlowDeliveryDropsTheOldestFrames)
+{
+    ASSERT_TRUE(start());
+
+    // Frame 1 is held in the delivery, the other three slots take frames 2 to 4
+    frames.close();
+    AtikFake::fastFrame(camera, W, H, frame(1));
+    ASSERT_TRUE(frames.waitArrived(1));
+    for (uint16_t i = 2; i <= 7; i++)
+        AtikFake::fastFrame(camera, W, H, frame(i));
+    frames.open();
+
+    ASSERT_TRUE(frames.waitDelivered(4));
+    stream.stop();
+    EXPECT_EQ(frames.values(), std::vector<uint16_t>({1, 5, 6, 7}));
+    EXPECT_EQ(stream.received(), 7u);
+    EXPECT_EQ(stream.dropped(), 3u);
+}
+
+TEST_F(AtikStreamTest, RefusedExposureStopsTheStream)
+{
+    AtikFake::refuseFastExposure(true);
+    EXPECT_FALSE(start());
+    EXPECT_FALSE(stream.isStreaming());
+    EXPECT_EQ(AtikFake::stopExposures(), 1);
+
+    // The callback is no longer routed to the stream
+    AtikFake::fastFrame(camera, W, H, frame(1));
+    EXPECT_EQ(stream.received(), 0u);
+}
+
+TEST_F(AtikStreamTest, StoppedStreamIgnoresFrames)
+{
+    ASSERT_TRUE(start());
+    stream.stop();
+    stream.stop();
+    EXPECT_EQ(AtikFake::stopExposures(), 1);
+
+    AtikFake::fastFrame(camera, W, H, frame(1));
+    EXPECT_EQ(stream.received(), 0u);
+    EXPECT_TRUE(frames.values().empty());
+}
+
+TEST_F(AtikStreamTest, MissingFramesRestartTheExposure)
+{
+    // The watchdog is twice the exposure plus two seconds
+    ASSERT_TRUE(start(1));
+    std::this_thread::sleep_for(std::chrono::milliseconds(2300));
+    stream.stop();
+
+    EXPECT_EQ(stream.restarts(), 1u);
+    EXPECT_EQ(AtikFake::fastExposures(), 2);
+}
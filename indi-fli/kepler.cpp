@@ -19,9 +19,11 @@
 
 #include "config.h"
 #include "kepler.h"
+#include "kepler_stream.h"
 
 #include <unistd.h>
 #include <memory>
+#include <vector>
 #include <map>
 #include <locale>
 #include <codecvt>
@@ -139,9 +141,76 @@ std::map<FPRODEVICETYPE, double> Kepler::SensorPixelSize
 /********************************************************************************
 *
 ********************************************************************************/
-void Kepler::workerStreamVideo(const std::atomic_bool &isAboutToQuit)
+void Kepler::workerStreamVideo(const std::atomic_bool &isAboutToQuit, double framerate)
 {
+    const double exposure = 1.0 / framerate;
+    int32_t result = FPROCtrl_SetExposure(m_CameraHandle, exposure * 1e9, 0, false);
+    if (result != 0)
+    {
+        LOGF_ERROR("Failed to set streaming exposure: %d", result);
+        Streamer->setStream(false);
+        return;
+    }
+
+    // The reads are synchronous, so a single raw buffer and set of planes is enough. The SDK
+    // allocates the planes on the first frame and unpacks every following frame into them.
+    std::vector<uint8_t> raw(m_TotalFrameBufferSize);
+    FPROUNPACKEDIMAGES unpacked;
+    UnpackedKey key;
+    acquireUnpacked(unpacked, key);
+
+    // Frame count of zero streams until the capture is stopped.
+    result = FPROFrame_CaptureStart(m_CameraHandle, 0);
+    if (result != 0)
+    {
+        LOGF_ERROR("Failed to start video capture: %d", result);
+        releaseUnpacked(unpacked, key);
+        Streamer->setStream(false);
+        return;
+    }
+
+    const uint32_t timeoutMS = static_cast<uint32_t>(exposure * 2000.0) + 1000;
+    KeplerStream::FrameIntervals intervals;
 
+    result = KeplerStream::readFrames(m_CameraHandle, isAboutToQuit, timeoutMS, raw, unpacked,
+                                      [&](std::vector<uint8_t> &frame, FPROUNPACKEDIMAGES &planes)
+    {
+        // ROI, binning or merging changed while streaming, the planes no longer fit.
+        if (key != unpackedKey())
+        {
+            releaseUnpacked(planes, key);
+            acquireUnpacked(planes, key);
+            frame.resize(m_TotalFrameBufferSize);
+        }
+        requestPlanes(planes);
+    },
+    [&](const FPROUNPACKEDIMAGES &planes, uint32_t grabSize, uint64_t timestampNS, bool cameraTime)
+    {
+        uint8_t *plane = nullptr;
+        uint32_t planeSize = 0;
+        if (selectedPlane(planes, &plane, &planeSize))
+            Streamer->newFrame(plane, planeSize);
+
+        // Frame interval from the exposure start in the frame metadata, or from the host
+        // clock when the SDK cannot parse it.
+        intervals.add(timestampNS, cameraTime);
+        if (intervals.count() == STREAM_STATS_FRAMES)
+        {
+            LOGF_DEBUG("Streaming %.2f fps, frame interval min %.1f ms avg %.1f ms max %.1f ms (%s clock), %u bytes per frame.",
+                       intervals.fps(), intervals.minMS(), intervals.averageMS(), intervals.maxMS(),
+                       intervals.cameraTime() ? "camera" : "host", grabSize);
+            intervals.restart();
+        }
+    });
+
+    if (result < 0 && !isAboutToQuit)
+    {
+        LOGF_ERROR("Failed to read video frame: %d", result);
+        Streamer->setStream(false);
+    }
+
+    FPROFrame_CaptureStop(m_CameraHandle);
+    releaseUnpacked(unpacked, key);
 }
 
 /********************************************************************************
@@ -201,33 +270,28 @@ void Kepler::workerExposure(const std::atomic_bool &isAboutToQuit, float duratio
 
     // This is blocking?
     std::unique_lock<std::mutex> guard(ccdBufferLock);
-    prepareUnpacked();
+    bool recycled = prepareUnpacked();
+    INDI::ElapsedTimer unpackTimer;
     result = FPROFrame_GetVideoFrameUnpacked(m_CameraHandle,
              m_FrameBuffer,
              &grabSize,
              timeLeft * 1000,
              &fproUnpacked,
              RequestStatSP.findOnSwitchIndex() == INDI_ENABLED ? &fproStats : nullptr);
+    LOGF_DEBUG("Frame unpacked in %.1f ms into %s planes (%u allocated, %u recycled so far).",
+               unpackTimer.nsecsElapsed() / 1e6, recycled ? "recycled" : "new", m_UnpackedAllocations, m_UnpackedRecycled);
 
     if (result >= 0)
     {
         FPROFrame_CaptureAbort(m_CameraHandle);
 
         // Send the merged image.
-        switch (MergePlanesSP.findOnSwitchIndex())
+        uint8_t *plane = nullptr;
+        uint32_t planeSize = 0;
+        if (selectedPlane(fproUnpacked, &plane, &planeSize))
         {
-            case to_underlying(FPRO_HWMERGEFRAMES::HWMERGE_FRAME_BOTH):
-                PrimaryCCD.setFrameBuffer(reinterpret_cast<uint8_t*>(fproUnpacked.pMergedImage));
-                PrimaryCCD.setFrameBufferSize(fproUnpacked.uiMergedBufferSize, false);
-                break;
-            case to_underlying(FPRO_HWMERGEFRAMES::HWMERGE_FRAME_HIGHONLY):
-                PrimaryCCD.setFrameBuffer(reinterpret_cast<uint8_t*>(fproUnpacked.pHighImage));
-                PrimaryCCD.setFrameBufferSize(fproUnpacked.uiHighBufferSize, false);
-                break;
-            case to_underlying(FPRO_HWMERGEFRAMES::HWMERGE_FRAME_LOWONLY):
-                PrimaryCCD.setFrameBuffer(reinterpret_cast<uint8_t*>(fproUnpacked.pLowImage));
-                PrimaryCCD.setFrameBufferSize(fproUnpacked.uiLowBufferSize, false);
-                break;
+            PrimaryCCD.setFrameBuffer(plane);
+            PrimaryCCD.setFrameBufferSize(planeSize, false);
         }
 
         PrimaryCCD.setExposureLeft(0.0);
@@ -277,7 +341,7 @@ bool Kepler::initProperties()
     INDI::CCD::initProperties();
 
     // Set Camera capabilities
-    SetCCDCapability(CCD_CAN_ABORT | CCD_CAN_BIN | CCD_CAN_SUBFRAME | CCD_HAS_COOLER | CCD_HAS_SHUTTER);
+    SetCCDCapability(CCD_CAN_ABORT | CCD_CAN_BIN | CCD_CAN_SUBFRAME | CCD_HAS_COOLER | CCD_HAS_SHUTTER | CCD_HAS_STREAMING);
 
     // Add capture format
     CaptureFormat mono = {"INDI_MONO", "Mono", 16, true};
@@ -535,6 +599,9 @@ bool Kepler::ISNewSwitch(const char *dev, const char *name, ISState *states, cha
                                      || index == to_underlying(FPRO_HWMERGEFRAMES::HWMERGE_FRAME_BOTH);
             fproStats.bMergedRequest = index == to_underlying(FPRO_HWMERGEFRAMES::HWMERGE_FRAME_BOTH);
 
+            // Pooled planes were unpacked for the old merge selection.
+            clearUnpackedPool();
+
             MergePlanesSP.apply();
             saveConfig(MergePlanesSP);
             return true;
@@ -689,6 +756,9 @@ bool Kepler::Connect()
 ********************************************************************************/
 bool Kepler::Disconnect()
 {
+    m_Worker.quit();
+    releaseUnpacked(fproUnpacked, m_ExposureUnpackedKey);
+    clearUnpackedPool();
     free(m_FrameBuffer);
     m_FrameBuffer = nullptr;
     FPROCam_Close(m_CameraHandle);
@@ -851,18 +921,15 @@ bool Kepler::setup()
 /********************************************************************************
 *
 ********************************************************************************/
-void Kepler::prepareUnpacked()
+bool Kepler::prepareUnpacked()
 {
-    memset(&fproUnpacked, 0, sizeof(fproUnpacked));
+    // Planes of a failed exposure were never uploaded, return them before taking new ones.
+    releaseUnpacked(fproUnpacked, m_ExposureUnpackedKey);
+    bool recycled = acquireUnpacked(fproUnpacked, m_ExposureUnpackedKey);
 
     // Merging Planes
+    requestPlanes(fproUnpacked);
     int index = MergePlanesSP.findOnSwitchIndex();
-    fproUnpacked.bLowImageRequest = index == to_underlying(FPRO_HWMERGEFRAMES::HWMERGE_FRAME_LOWONLY)
-                                    || index == to_underlying(FPRO_HWMERGEFRAMES::HWMERGE_FRAME_BOTH);
-    fproUnpacked.bHighImageRequest = index == to_underlying(FPRO_HWMERGEFRAMES::HWMERGE_FRAME_HIGHONLY)
-                                     || index == to_underlying(FPRO_HWMERGEFRAMES::HWMERGE_FRAME_BOTH);
-    fproUnpacked.bMergedImageRequest = index == to_underlying(FPRO_HWMERGEFRAMES::HWMERGE_FRAME_BOTH);
-    fproUnpacked.bMetaDataRequest = true;
 
     // Statistics
     fproStats.bLowRequest = index == to_underlying(FPRO_HWMERGEFRAMES::HWMERGE_FRAME_LOWONLY)
@@ -871,9 +938,140 @@ void Kepler::prepareUnpacked()
                              || index == to_underlying(FPRO_HWMERGEFRAMES::HWMERGE_FRAME_BOTH);
     fproStats.bMergedRequest = index == to_underlying(FPRO_HWMERGEFRAMES::HWMERGE_FRAME_BOTH);
 
+    return recycled;
+}
+
+/********************************************************************************
+*
+********************************************************************************/
+void Kepler::requestPlanes(FPROUNPACKEDIMAGES &unpacked)
+{
+    int index = MergePlanesSP.findOnSwitchIndex();
+    unpacked.bLowImageRequest = index == to_underlying(FPRO_HWMERGEFRAMES::HWMERGE_FRAME_LOWONLY)
+                                || index == to_underlying(FPRO_HWMERGEFRAMES::HWMERGE_FRAME_BOTH);
+    unpacked.bHighImageRequest = index == to_underlying(FPRO_HWMERGEFRAMES::HWMERGE_FRAME_HIGHONLY)
+                                 || index == to_underlying(FPRO_HWMERGEFRAMES::HWMERGE_FRAME_BOTH);
+    unpacked.bMergedImageRequest = index == to_underlying(FPRO_HWMERGEFRAMES::HWMERGE_FRAME_BOTH);
+    unpacked.bMetaDataRequest = true;
+
     // Merging Method
-    fproUnpacked.eMergeFormat = FPRO_IMAGE_FORMAT::IFORMAT_FITS;
+    unpacked.eMergeFormat = FPRO_IMAGE_FORMAT::IFORMAT_FITS;
+}
 
+/********************************************************************************
+*
+********************************************************************************/
+Kepler::UnpackedKey Kepler::unpackedKey()
+{
+    return UnpackedKey(m_TotalFrameBufferSize, PrimaryCCD.getSubW(), PrimaryCCD.getSubH(), PrimaryCCD.getBinX(),
+                       PrimaryCCD.getBinY(), MergePlanesSP.findOnSwitchIndex());
+}
+
+/********************************************************************************
+* Hands out planes from the pool when the frame geometry and merging did not
+* change, otherwise an empty set the SDK allocates into. True if recycled.
+********************************************************************************/
+bool Kepler::acquireUnpacked(FPROUNPACKEDIMAGES &unpacked, UnpackedKey &key)
+{
+    std::lock_guard<std::mutex> lock(m_UnpackedPoolLock);
+
+    key = unpackedKey();
+    if (key != m_UnpackedPoolKey)
+    {
+        if (!m_UnpackedPool.empty())
+            LOGF_DEBUG("Frame geometry changed, freeing %zu pooled unpacked buffer set(s).", m_UnpackedPool.size());
+        for (auto &pooled : m_UnpackedPool)
+            FPROFrame_FreeUnpackedBuffers(&pooled);
+        m_UnpackedPool.clear();
+        m_UnpackedPoolBytes = 0;
+        m_UnpackedPoolKey = key;
+    }
+
+    if (m_UnpackedPool.empty())
+    {
+        memset(&unpacked, 0, sizeof(unpacked));
+        m_UnpackedAllocations++;
+        return false;
+    }
+
+    unpacked = m_UnpackedPool.back();
+    m_UnpackedPool.pop_back();
+    m_UnpackedPoolBytes -= unpackedBytes(unpacked);
+    m_UnpackedRecycled++;
+    return true;
+}
+
+/********************************************************************************
+* Returns planes to the pool, or frees them if they are of an older geometry
+* or the pool already holds UNPACKED_POOL_MAX_BYTES.
+********************************************************************************/
+void Kepler::releaseUnpacked(FPROUNPACKEDIMAGES &unpacked, const UnpackedKey &key)
+{
+    if (unpacked.pMetaData == nullptr && unpacked.pLowImage == nullptr && unpacked.pHighImage == nullptr
+            && unpacked.pMergedImage == nullptr)
+        return;
+
+    std::lock_guard<std::mutex> lock(m_UnpackedPoolLock);
+    uint64_t bytes = unpackedBytes(unpacked);
+    if (key == m_UnpackedPoolKey && m_UnpackedPoolBytes + bytes <= UNPACKED_POOL_MAX_BYTES)
+    {
+        m_UnpackedPool.push_back(unpacked);
+        m_UnpackedPoolBytes += bytes;
+    }
+    else
+        FPROFrame_FreeUnpackedBuffers(&unpacked);
+    memset(&unpacked, 0, sizeof(unpacked));
+}
+
+/********************************************************************************
+* Frees the pooled planes. Planes still in use are freed when they are released.
+********************************************************************************/
+void Kepler::clearUnpackedPool()
+{
+    std::lock_guard<std::mutex> lock(m_UnpackedPoolLock);
+    for (auto &pooled : m_UnpackedPool)
+        FPROFrame_FreeUnpackedBuffers(&pooled);
+    m_UnpackedPool.clear();
+    m_UnpackedPoolBytes = 0;
+    m_UnpackedPoolKey = UnpackedKey();
+    LOGF_DEBUG("Unpacked buffers: %u allocated, %u recycled.", m_UnpackedAllocations, m_UnpackedRecycled);
+    m_UnpackedAllocations = m_UnpackedRecycled = 0;
+}
+
+/********************************************************************************
+*
+********************************************************************************/
+uint64_t Kepler::unpackedBytes(const FPROUNPACKEDIMAGES &unpacked)
+{
+    return static_cast<uint64_t>(unpacked.uiLowBufferSize) + unpacked.uiHighBufferSize + unpacked.uiMergedBufferSize +
+           unpacked.uiMetaDataSize;
+}
+
+/********************************************************************************
+* Plane matching the merge selection, false if it was not unpacked.
+********************************************************************************/
+bool Kepler::selectedPlane(const FPROUNPACKEDIMAGES &unpacked, uint8_t **buffer, uint32_t *size)
+{
+    *buffer = nullptr;
+    *size = 0;
+
+    switch (MergePlanesSP.findOnSwitchIndex())
+    {
+        case to_underlying(FPRO_HWMERGEFRAMES::HWMERGE_FRAME_BOTH):
+            *buffer = reinterpret_cast<uint8_t*>(unpacked.pMergedImage);
+            *size = unpacked.uiMergedBufferSize;
+            break;
+        case to_underlying(FPRO_HWMERGEFRAMES::HWMERGE_FRAME_HIGHONLY):
+            *buffer = reinterpret_cast<uint8_t*>(unpacked.pHighImage);
+            *size = unpacked.uiHighBufferSize;
+            break;
+        case to_underlying(FPRO_HWMERGEFRAMES::HWMERGE_FRAME_LOWONLY):
+            *buffer = reinterpret_cast<uint8_t*>(unpacked.pLowImage);
+            *size = unpacked.uiLowBufferSize;
+            break;
+    }
+
+    return *buffer != nullptr;
 }
 /********************************************************************************
 *
@@ -916,6 +1114,25 @@ bool Kepler::AbortExposure()
     return (FPROFrame_CaptureStop(m_CameraHandle) == 0);
 }
 
+/********************************************************************************
+*
+********************************************************************************/
+bool Kepler::StartStreaming()
+{
+    Streamer->setPixelFormat(INDI_MONO, 16);
+    m_Worker.start(std::bind(&Kepler::workerStreamVideo, this, std::placeholders::_1, Streamer->getTargetFPS()));
+    return true;
+}
+
+/********************************************************************************
+*
+********************************************************************************/
+bool Kepler::StopStreaming()
+{
+    m_Worker.quit();
+    return true;
+}
+
 /********************************************************************************
 *
 ********************************************************************************/
@@ -956,6 +1173,9 @@ bool Kepler::UpdateCCDFrame(int x, int y, int w, int h)
         // We need to only
         m_TotalFrameBufferSize = FPROFrame_ComputeFrameSize(m_CameraHandle);
         m_FrameBuffer = static_cast<uint8_t*>(realloc(m_FrameBuffer, m_TotalFrameBufferSize));
+
+        // Pooled planes are of the old ROI or binning.
+        clearUnpackedPool();
         return true;
     }
     else
@@ -1164,7 +1384,7 @@ void Kepler::UploadComplete(INDI::CCDChip *targetChip)
     ExposureTriggerSP.apply();
 #endif
 
-    if (RequestStatSP.findOnSwitchIndex() == INDI_ENABLED)
-        FPROFrame_FreeUnpackedBuffers(&fproUnpacked);
+    // Keep the planes for the next exposure, the SDK unpacks into them again.
+    releaseUnpacked(fproUnpacked, m_ExposureUnpackedKey);
     FPROFrame_FreeUnpackedStatistics(&fproStats);
 }
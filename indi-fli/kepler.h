@@ -29,6 +29,10 @@
 #include <inditimer.h>
 #include <indisinglethreadpool.h>
 
+#include <mutex>
+#include <tuple>
+#include <vector>
+
 class Kepler : public INDI::CCD
 {
     public:
@@ -47,6 +51,9 @@ class Kepler : public INDI::CCD
         bool StartExposure(float duration) override;
         bool AbortExposure() override;
 
+        bool StartStreaming() override;
+        bool StopStreaming() override;
+
         virtual bool ISNewNumber(const char *dev, const char *name, double values[], char *names[], int n) override;
         virtual bool ISNewSwitch(const char *dev, const char *name, ISState *states, char *names[], int n) override;
         virtual bool ISNewText(const char *dev, const char *name, char *texts[], char *names[], int n) override;
@@ -125,14 +132,27 @@ class Kepler : public INDI::CCD
         // Communication Functions
         //****************************************************************************************
         bool setup();
-        void prepareUnpacked();
+        bool prepareUnpacked();
+        void requestPlanes(FPROUNPACKEDIMAGES &unpacked);
+        bool selectedPlane(const FPROUNPACKEDIMAGES &unpacked, uint8_t **buffer, uint32_t *size);
+
+        //****************************************************************************************
+        // Unpacked Buffer Pool
+        //****************************************************************************************
+        // Frame size, subframe width & height, binning and merge selection.
+        using UnpackedKey = std::tuple<uint32_t, uint32_t, uint32_t, uint32_t, uint32_t, int>;
+        UnpackedKey unpackedKey();
+        bool acquireUnpacked(FPROUNPACKEDIMAGES &unpacked, UnpackedKey &key);
+        void releaseUnpacked(FPROUNPACKEDIMAGES &unpacked, const UnpackedKey &key);
+        void clearUnpackedPool();
+        static uint64_t unpackedBytes(const FPROUNPACKEDIMAGES &unpacked);
         void readTemperature();
         void readGPS();
 
         //****************************************************************************************
         // Workers
         //****************************************************************************************
-        void workerStreamVideo(const std::atomic_bool &isAboutToQuit);
+        void workerStreamVideo(const std::atomic_bool &isAboutToQuit, double framerate);
         void workerExposure(const std::atomic_bool &isAboutToQuit, float duration);
 
         //****************************************************************************************
@@ -149,9 +169,19 @@ class Kepler : public INDI::CCD
         // Merging
         uint8_t *m_FrameBuffer {nullptr};
         FPROUNPACKEDIMAGES fproUnpacked;
+        UnpackedKey m_ExposureUnpackedKey;
         FPROUNPACKEDSTATS  fproStats;
         FPRO_HWMERGEENABLE mergeEnables;
 
+        // Planes unpacked by the SDK are kept here after upload and handed back to it
+        // for the next frame of the same geometry instead of being freed.
+        std::vector<FPROUNPACKEDIMAGES> m_UnpackedPool;
+        UnpackedKey m_UnpackedPoolKey;
+        uint64_t m_UnpackedPoolBytes {0};
+        uint32_t m_UnpackedAllocations {0};
+        uint32_t m_UnpackedRecycled {0};
+        std::mutex m_UnpackedPoolLock;
+
         // Format
         uint32_t m_FormatsCount;
         FPRO_PIXEL_FORMAT *m_FormatList {nullptr};
@@ -172,6 +202,10 @@ class Kepler : public INDI::CCD
         static constexpr double TEMPERATURE_FREQUENCY_BUSY {1000};
         static constexpr double TEMPERATURE_FREQUENCY_IDLE {5000};
         static constexpr uint32_t GPS_TIMER_PERIOD {5000};
+        // Upper bound of the plane bytes kept in the unpacked pool.
+        static constexpr uint64_t UNPACKED_POOL_MAX_BYTES {256 * 1024 * 1024};
+        // Log streaming frame timing every this many frames.
+        static constexpr uint32_t STREAM_STATS_FRAMES {100};
 
         static constexpr const char *GPS_TAB {"GPS"};
         static constexpr const char *LEGACY_TAB {"Legacy"};
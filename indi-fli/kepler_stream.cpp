@@ -0,0 +1,107 @@
+/*
+    Kepler video frames, read one at a time and dated by the camera.
+    Copyright (C) 2026 INDI 3rd party contributors
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#include "kepler_stream.h"
+
+#include <algorithm>
+#include <chrono>
+
+namespace KeplerStream
+{
+
+bool frameTimestamp(const FPROUNPACKEDIMAGES &unpacked, uint64_t &timestampNS)
+{
+    // HAVE_FPRO_META_VALUES is set by CMake when the SDK has the metadata parser.
+#ifdef HAVE_FPRO_META_VALUES
+    if (unpacked.pMetaData == nullptr || unpacked.uiMetaDataSize == 0)
+        return false;
+    if (FPROFrame_MetaValueInit(unpacked.pMetaData, unpacked.uiMetaDataSize) < 0)
+        return false;
+
+    FPRO_META_VALUE value;
+    if (FPROFrame_MetaValueGet(FPRO_META_KEYS::FPRO_META_KEY_EXPOSURE_START_TIMESTAMP, &value) < 0)
+        return false;
+    timestampNS = static_cast<uint64_t>(value.dblValue);
+    return true;
+#else
+    (void)unpacked;
+    (void)timestampNS;
+    return false;
+#endif
+}
+
+void FrameIntervals::add(uint64_t timestampNS, bool cameraTime)
+{
+    if (m_HasLast && cameraTime != m_CameraTime)
+    {
+        // The clocks are not comparable, start over from this frame.
+        restart();
+        m_HasLast = false;
+    }
+
+    if (m_HasLast)
+    {
+        if (timestampNS <= m_LastNS)
+            return;
+        double intervalMS = (timestampNS - m_LastNS) / 1e6;
+        m_MinMS = (m_Count == 0) ? intervalMS : std::min(m_MinMS, intervalMS);
+        m_MaxMS = std::max(m_MaxMS, intervalMS);
+        m_TotalMS += intervalMS;
+        m_Count++;
+    }
+
+    m_HasLast = true;
+    m_CameraTime = cameraTime;
+    m_LastNS = timestampNS;
+}
+
+void FrameIntervals::restart()
+{
+    m_Count = 0;
+    m_MinMS = m_MaxMS = m_TotalMS = 0;
+}
+
+int32_t readFrames(int32_t handle, const std::atomic_bool &isAboutToQuit, uint32_t timeoutMS,
+                   std::vector<uint8_t> &raw, FPROUNPACKEDIMAGES &unpacked,
+                   const PrepareFrame &prepare, const NewFrame &newFrame)
+{
+    int32_t result = 0;
+
+    while (!isAboutToQuit)
+    {
+        prepare(raw, unpacked);
+
+        uint32_t grabSize = raw.size();
+        result = FPROFrame_GetVideoFrameUnpacked(handle, raw.data(), &grabSize, timeoutMS, &unpacked, nullptr);
+        if (result < 0)
+            break;
+
+        uint64_t timestampNS = 0;
+        bool cameraTime = frameTimestamp(unpacked, timestampNS);
+        if (!cameraTime)
+            timestampNS = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                              std::chrono::steady_clock::now().time_since_epoch()).count();
+
+        newFrame(unpacked, grabSize, timestampNS, cameraTime);
+    }
+
+    return result;
+}
+
+}
@@ -0,0 +1,96 @@
+/*
+    Kepler video frames, read one at a time and dated by the camera.
+    Copyright (C) 2026 INDI 3rd party contributors
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+
+    Only depends on libflipro, so the tests build it against the fake SDK
+    in test/fake instead.
+*/
+
+#pragma once
+
+#include <libflipro.h>
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+namespace KeplerStream
+{
+
+// Start of the frame on the camera clock in nanoseconds, from the unpacked metadata.
+// False if the metadata was not unpacked or the SDK cannot parse it.
+bool frameTimestamp(const FPROUNPACKEDIMAGES &unpacked, uint64_t &timestampNS);
+
+// Frame interval statistics over a run of frames.
+class FrameIntervals
+{
+    public:
+        // Adds the start of the next frame. An interval is only counted between two frames
+        // dated by the same clock, and timestamps that do not advance are skipped.
+        void add(uint64_t timestampNS, bool cameraTime);
+        // Starts a new run, the last frame stays the start of the next interval.
+        void restart();
+
+        uint32_t count() const
+        {
+            return m_Count;
+        }
+        bool cameraTime() const
+        {
+            return m_CameraTime;
+        }
+        double minMS() const
+        {
+            return m_MinMS;
+        }
+        double maxMS() const
+        {
+            return m_MaxMS;
+        }
+        double averageMS() const
+        {
+            return m_Count ? m_TotalMS / m_Count : 0;
+        }
+        double fps() const
+        {
+            return m_TotalMS > 0 ? 1000.0 * m_Count / m_TotalMS : 0;
+        }
+
+    private:
+        bool m_HasLast {false};
+        bool m_CameraTime {false};
+        uint64_t m_LastNS {0};
+        uint32_t m_Count {0};
+        double m_MinMS {0}, m_MaxMS {0}, m_TotalMS {0};
+};
+
+// Called before every read, sizes the raw buffer and requests the planes.
+using PrepareFrame = std::function<void(std::vector<uint8_t> &raw, FPROUNPACKEDIMAGES &unpacked)>;
+// Called with every frame read. The timestamp is from the metadata if cameraTime is set,
+// otherwise from the host clock when the read returned.
+using NewFrame = std::function<void(const FPROUNPACKEDIMAGES &unpacked, uint32_t grabSize, uint64_t timestampNS,
+                                    bool cameraTime)>;
+
+// Reads the frames of a started capture into raw and unpacked, one after the other, until
+// isAboutToQuit is set or a read fails. The reads are synchronous, so the planes of a frame
+// are handed to newFrame before the next read overwrites them. Returns the last read result.
+int32_t readFrames(int32_t handle, const std::atomic_bool &isAboutToQuit, uint32_t timeoutMS,
+                   std::vector<uint8_t> &raw, FPROUNPACKEDIMAGES &unpacked,
+                   const PrepareFrame &prepare, const NewFrame &newFrame);
+
+}
@@ -0,0 +1,103 @@
+/*
+    Fake of the parts of libflipro used by kepler_stream.cpp.
+    Copyright (C) 2026 INDI 3rd party contributors
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+
+    The test targets put this directory first on the include path, so
+    <libflipro.h> resolves here at compile time and no camera or SDK is
+    needed. Frames are queued by the test and handed out by
+    FPROFrame_GetVideoFrameUnpacked in order.
+*/
+
+#pragma once
+
+#include <cstdint>
+
+#define LIBFLIPRO_API int32_t
+
+typedef enum
+{
+    IFORMAT_NONE,
+    IFORMAT_RCD,
+    IFORMAT_TIFF,
+    IFORMAT_FITS
+} FPRO_IMAGE_FORMAT;
+
+typedef struct
+{
+    uint8_t *pMetaData;
+    uint32_t uiMetaDataSize;
+    bool bMetaDataRequest;
+    uint16_t *pLowImage;
+    uint64_t uiLowBufferSize;
+    bool bLowImageRequest;
+    uint16_t *pHighImage;
+    uint64_t uiHighBufferSize;
+    bool bHighImageRequest;
+    uint16_t *pMergedImage;
+    uint64_t uiMergedBufferSize;
+    bool bMergedImageRequest;
+    FPRO_IMAGE_FORMAT eMergeFormat;
+} FPROUNPACKEDIMAGES;
+
+typedef struct
+{
+    bool bLowRequest;
+    bool bHighRequest;
+    bool bMergedRequest;
+} FPROUNPACKEDSTATS;
+
+typedef enum
+{
+    FPRO_META_KEY_FRAME_NUMBER,
+    FPRO_META_KEY_EXPOSURE_START_TIMESTAMP
+} FPRO_META_KEYS;
+
+typedef struct
+{
+    FPRO_META_KEYS eMetaKey;
+    double dblValue;
+} FPRO_META_VALUE;
+
+LIBFLIPRO_API FPROFrame_GetVideoFrameUnpacked(int32_t iHandle, uint8_t *pFrameData, uint32_t *pSize, uint32_t uiTimeoutMS,
+        FPROUNPACKEDIMAGES *pUPBuffers, FPROUNPACKEDSTATS *pUPStats);
+LIBFLIPRO_API FPROFrame_FreeUnpackedBuffers(FPROUNPACKEDIMAGES *pUPBuffers);
+LIBFLIPRO_API FPROFrame_MetaValueInit(uint8_t *pMetaData, uint32_t uiMetaSize);
+LIBFLIPRO_API FPROFrame_MetaValueGet(FPRO_META_KEYS eMetaKey, FPRO_META_VALUE *pMetaValue);
+
+namespace FPROFake
+{
+
+struct Frame
+{
+    // Result of the read, negative to fail it.
+    int32_t result {0};
+    // Start of the exposure written to the metadata, none if zero.
+    uint64_t timestampNS {0};
+    // Value of every pixel of the unpacked planes.
+    uint16_t pixel {0};
+};
+
+// Drops queued frames, frees nothing, clears the counters.
+void reset(uint32_t planePixels);
+void queueFrame(const Frame &frame);
+
+uint32_t reads();
+// Planes the fake allocated because the caller passed none, and planes freed.
+uint32_t planeAllocations();
+uint32_t planeFrees();
+
+}
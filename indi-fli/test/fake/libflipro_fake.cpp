@@ -0,0 +1,164 @@
+/*
+    Fake of the parts of libflipro used by kepler_stream.cpp.
+    Copyright (C) 2026 INDI 3rd party contributors
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#include "libflipro.h"
+
+#include <algorithm>
+#include <cstring>
+#include <deque>
+
+namespace
+{
+
+// Metadata of a fake frame: the frame number and the exposure start.
+constexpr uint32_t META_SIZE = 2 * sizeof(uint64_t);
+
+std::deque<FPROFake::Frame> queuedFrames;
+uint32_t framePixels = 0;
+uint32_t frameNumber = 0;
+uint32_t readCount = 0;
+uint32_t allocationCount = 0;
+uint32_t freeCount = 0;
+
+const uint8_t *metaData = nullptr;
+
+void fillPlane(bool requested, uint16_t *&plane, uint64_t &size, uint16_t pixel)
+{
+    if (!requested)
+        return;
+    if (plane == nullptr)
+    {
+        plane = new uint16_t[framePixels];
+        allocationCount++;
+    }
+    std::fill(plane, plane + framePixels, pixel);
+    size = framePixels * sizeof(uint16_t);
+}
+
+void freePlane(uint16_t *&plane)
+{
+    if (plane == nullptr)
+        return;
+    delete [] plane;
+    plane = nullptr;
+    freeCount++;
+}
+
+}
+
+LIBFLIPRO_API FPROFrame_GetVideoFrameUnpacked(int32_t iHandle, uint8_t *pFrameData, uint32_t *pSize, uint32_t uiTimeoutMS,
+        FPROUNPACKEDIMAGES *pUPBuffers, FPROUNPACKEDSTATS *pUPStats)
+{
+    (void)iHandle;
+    (void)uiTimeoutMS;
+    (void)pUPStats;
+
+    readCount++;
+    // Nothing queued is a timeout.
+    if (queuedFrames.empty())
+        return -1;
+
+    FPROFake::Frame frame = queuedFrames.front();
+    queuedFrames.pop_front();
+    if (frame.result < 0)
+        return frame.result;
+
+    memset(pFrameData, 0, *pSize);
+    fillPlane(pUPBuffers->bLowImageRequest, pUPBuffers->pLowImage, pUPBuffers->uiLowBufferSize, frame.pixel);
+    fillPlane(pUPBuffers->bHighImageRequest, pUPBuffers->pHighImage, pUPBuffers->uiHighBufferSize, frame.pixel);
+    fillPlane(pUPBuffers->bMergedImageRequest, pUPBuffers->pMergedImage, pUPBuffers->uiMergedBufferSize, frame.pixel);
+
+    if (pUPBuffers->bMetaDataRequest)
+    {
+        if (pUPBuffers->pMetaData == nullptr)
+            pUPBuffers->pMetaData = new uint8_t[META_SIZE];
+        uint64_t fields[2] = { ++frameNumber, frame.timestampNS };
+        memcpy(pUPBuffers->pMetaData, fields, META_SIZE);
+        pUPBuffers->uiMetaDataSize = META_SIZE;
+    }
+
+    return frame.result;
+}
+
+LIBFLIPRO_API FPROFrame_FreeUnpackedBuffers(FPROUNPACKEDIMAGES *pUPBuffers)
+{
+    freePlane(pUPBuffers->pLowImage);
+    freePlane(pUPBuffers->pHighImage);
+    freePlane(pUPBuffers->pMergedImage);
+    delete [] pUPBuffers->pMetaData;
+    pUPBuffers->pMetaData = nullptr;
+    return 0;
+}
+
+LIBFLIPRO_API FPROFrame_MetaValueInit(uint8_t *pMetaData, uint32_t uiMetaSize)
+{
+    if (pMetaData == nullptr || uiMetaSize < META_SIZE)
+        return -1;
+    metaData = pMetaData;
+    return 0;
+}
+
+LIBFLIPRO_API FPROFrame_MetaValueGet(FPRO_META_KEYS eMetaKey, FPRO_META_VALUE *pMetaValue)
+{
+    if (metaData == nullptr)
+        return -1;
+
+    uint64_t fields[2];
+    memcpy(fields, metaData, META_SIZE);
+    uint64_t value = (eMetaKey == FPRO_META_KEY_FRAME_NUMBER) ? fields[0] : fields[1];
+    if (value == 0)
+        return -1;
+
+    pMetaValue->eMetaKey = eMetaKey;
+    pMetaValue->dblValue = static_cast<double>(value);
+    return 0;
+}
+
+namespace FPROFake
+{
+
+void reset(uint32_t planePixels)
+{
+    queuedFrames.clear();
+    framePixels = planePixels;
+    frameNumber = readCount = allocationCount = freeCount = 0;
+    metaData = nullptr;
+}
+
+void queueFrame(const Frame &frame)
+{
+    queuedFrames.push_back(frame);
+}
+
+uint32_t reads()
+{
+    return readCount;
+}
+
+uint32_t planeAllocations()
+{
+    return allocationCount;
+}
+
+uint32_t planeFrees()
+{
+    return freeCount;
+}
+
+}
@@ -0,0 +1,190 @@
+/*
+    Kepler video stream against the fake libflipro in test/fake.
+    Copyright (C) 2026 INDI 3rd party contributors
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#include "kepler_stream.h"
+
+#include <gtest/gtest.h>
+
+#include <cstring>
+#include <vector>
+
+namespace
+{
+
+const uint32_t PIXELS = 64 * 48;
+const uint64_t START_NS = 5000000000ull;
+
+struct StreamRun
+{
+    std::vector<uint16_t> pixels;
+    std::vector<uint64_t> timestamps;
+    std::vector<bool> cameraTime;
+    uint32_t prepares {0};
+};
+
+// Streams until the fake runs out of frames, or until quitAfter frames arrived.
+int32_t stream(StreamRun &run, FPROUNPACKEDIMAGES &unpacked, uint32_t quitAfter = 0)
+{
+    std::atomic_bool isAboutToQuit {false};
+    std::vector<uint8_t> raw;
+
+    return KeplerStream::readFrames(1, isAboutToQuit, 1000, raw, unpacked,
+                                    [&](std::vector<uint8_t> &raw, FPROUNPACKEDIMAGES &unpacked)
+    {
+        raw.resize(PIXELS * 2 + 1024);
+        unpacked.bMergedImageRequest = true;
+        unpacked.bMetaDataRequest = true;
+        run.prepares++;
+    },
+    [&](const FPROUNPACKEDIMAGES &unpacked, uint32_t, uint64_t timestampNS, bool cameraTime)
+    {
+        ASSERT_NE(unpacked.pMergedImage, nullptr);
+        EXPECT_EQ(unpacked.uiMergedBufferSize, PIXELS * sizeof(uint16_t));
+        run.pixels.push_back(unpacked.pMergedImage[PIXELS - 1]);
+        run.timestamps.push_back(timestampNS);
+        run.cameraTime.push_back(cameraTime);
+        if (quitAfter && run.pixels.size() == quitAfter)
+            isAboutToQuit = true;
+    });
+}
+
+class KeplerStreamTest : public ::testing::Test
+{
+    protected:
+        void SetUp() override
+        {
+            FPROFake::reset(PIXELS);
+            memset(&unpacked, 0, sizeof(unpacked));
+        }
+
+        void TearDown() override
+        {
+            FPROFrame_FreeUnpackedBuffers(&unpacked);
+        }
+
+        FPROUNPACKEDIMAGES unpacked;
+};
+
+}
+
+TEST_F(KeplerStreamTest, FramesAreDatedByTheCamera)
+{
+    for (uint16_t i = 0; i < 5; i++)
+        FPROFake::queueFrame({0, START_NS + i * 40000000ull, static_cast<uint16_t>(100 + i)});
+
+    StreamRun run;
+    EXPECT_EQ(stream(run, unpacked, 5), 0);
+
+    ASSERT_EQ(run.pixels.size(), 5u);
+    for (uint16_t i = 0; i < 5; i++)
+    {
+        EXPECT_EQ(run.pixels[i], 100 + i);
+        EXPECT_TRUE(run.cameraTime[i]);
+        EXPECT_EQ(run.timestamps[i], START_NS + i * 40000000ull);
+    }
+    EXPECT_EQ(FPROFake::reads(), 5u);
+    EXPECT_EQ(run.prepares, 5u);
+}
+
+TEST_F(KeplerStreamTest, PlanesAreAllocatedOnce)
+{
+    for (uint16_t i = 0; i < 20; i++)
+        FPROFake::queueFrame({0, START_NS + i * 1000000ull, i});
+
+    StreamRun run;
+    stream(run, unpacked, 20);
+
+    EXPECT_EQ(run.pixels.size(), 20u);
+    EXPECT_EQ(FPROFake::planeAllocations(), 1u);
+    EXPECT_EQ(FPROFake::planeFrees(), 0u);
+}
+
+TEST_F(KeplerStreamTest, FailedReadEndsTheStream)
+{
+    FPROFake::queueFrame({0, START_NS, 1});
+    FPROFake::queueFrame({0, START_NS + 1000000, 2});
+    FPROFake::queueFrame({-5, 0, 0});
+    FPROFake::queueFrame({0, START_NS + 3000000, 3});
+
+    StreamRun run;
+    EXPECT_EQ(stream(run, unpacked), -5);
+    EXPECT_EQ(run.pixels.size(), 2u);
+    EXPECT_EQ(FPROFake::reads(), 3u);
+}
+
+TEST_F(KeplerStreamTest, HostClockWithoutMetadataTimestamp)
+{
+    FPROFake::queueFrame({0, 0, 1});
+    FPROFake::queueFrame({0, 0, 2});
+
+    StreamRun run;
+    stream(run, unpacked, 2);
+
+    ASSERT_EQ(run.cameraTime.size(), 2u);
+    EXPECT_FALSE(run.cameraTime[0]);
+    EXPECT_FALSE(run.cameraTime[1]);
+    EXPECT_LE(run.timestamps[0], run.timestamps[1]);
+}
+
+TEST(KeplerFrameIntervals, CameraIntervals)
+{
+    KeplerStream::FrameIntervals intervals;
+    const uint64_t deltas[] = { 40, 38, 45, 41 };
+    uint64_t timestamp = START_NS;
+
+    intervals.add(timestamp, true);
+    for (uint64_t delta : deltas)
+    {
+        timestamp += delta * 1000000ull;
+        intervals.add(timestamp, true);
+    }
+
+    EXPECT_EQ(intervals.count(), 4u);
+    EXPECT_TRUE(intervals.cameraTime());
+    EXPECT_DOUBLE_EQ(intervals.minMS(), 38.0);
+    EXPECT_DOUBLE_EQ(intervals.maxMS(), 45.0);
+    EXPECT_DOUBLE_EQ(intervals.averageMS(), 41.0);
+    EXPECT_NEAR(intervals.fps(), 1000.0 / 41.0, 1e-9);
+
+    // The next run starts from the last frame.
+    intervals.restart();
+    intervals.add(timestamp + 50000000ull, true);
+    EXPECT_EQ(intervals.count(), 1u);
+    EXPECT_DOUBLE_EQ(intervals.averageMS(), 50.0);
+}
+
+TEST(KeplerFrameIntervals, ClockChangeStartsOver)
+{
+    KeplerStream::FrameIntervals intervals;
+    intervals.add(START_NS, true);
+    intervals.add(START_NS + 40000000ull, true);
+    EXPECT_EQ(intervals.count(), 1u);
+
+    // A host timestamp is not comparable with the camera clock.
+    intervals.add(123, false);
+    EXPECT_EQ(intervals.count(), 0u);
+    EXPECT_FALSE(intervals.cameraTime());
+    intervals.add(123 + 20000000ull, false);
+    EXPECT_EQ(intervals.count(), 1u);
+    EXPECT_DOUBLE_EQ(intervals.averageMS(), 20.0);
+
+    // A repeated timestamp is skipped.
+    intervals.add(123 + 20000000ull, false);
+    EXPECT_EQ(intervals.count(), 1u);
+}
@@ -1174,6 +1174,31 @@ void GPhotoCCD::UpdateExtendedOptions(bool force)
     optTID = IEAddTimer(1000, GPhotoCCD::UpdateExtendedOptions, this);
 }
 
+int GPhotoCCD::renderSyntheticFrame(uint8_t **memptr, size_t *memsize, int *w, int *h)
+{
+    // Use the last known sensor size, or a typical APS-C sensor before the first capture.
+    *w = PrimaryCCD.getXRes() > 0 ? PrimaryCCD.getXRes() : 6000;
+    *h = PrimaryCCD.getYRes() > 0 ? PrimaryCCD.getYRes() : 4000;
+    *memsize = static_cast<size_t>(*w) * *h * sizeof(uint16_t);
+    *memptr  = static_cast<uint8_t *>(IDSharedBlobRealloc(*memptr, *memsize));
+    if (*memptr == nullptr)
+        *memptr = static_cast<uint8_t *>(IDSharedBlobAlloc(*memsize));
+    if (*memptr == nullptr)
+        return -1;
+
+    // Rendered at full resolution, subframing and binning are applied below like for camera images.
+    SynthFrame::Params params;
+    params.sensorWidth  = *w;
+    params.sensorHeight = *h;
+    params.subW         = *w;
+    params.subH         = *h;
+    params.bpp          = 16;
+    params.frameType    = static_cast<SynthFrame::FrameType>(PrimaryCCD.getFrameType());
+    params.exposure     = ExposureRequest;
+    m_SimGenerator.render(params, *memptr);
+    return 0;
+}
+
 bool GPhotoCCD::grabImage()
 {
     uint8_t * memptr = PrimaryCCD.getFrameBuffer();
@@ -1190,14 +1215,14 @@ bool GPhotoCCD::grabImage()
     {
         char filename[MAXRBUF] = "/tmp/indi_XXXXXX";
         const char *extension = "unknown";
-        if (isSimulation())
+        // Without a sample file, simulation renders a synthetic mono frame.
+        bool synthetic = isSimulation() && (UploadFileT[0].text == nullptr || !UploadFileT[0].text[0]);
+        if (synthetic)
+        {
+            extension = "synthetic";
+        }
+        else if (isSimulation())
         {
-            if (UploadFileT[0].text == nullptr || !UploadFileT[0].text[0])
-            {
-                LOG_WARN("You must specify simulation file path under Options.");
-                return false;
-            }
-
             strncpy(filename, UploadFileT[0].text, MAXRBUF);
             const char *found = strchr(filename, '.');
             if (found == nullptr)
@@ -1239,7 +1264,18 @@ bool GPhotoCCD::grabImage()
         if (ExposureRequest > 3)
             LOG_INFO("Exposure done, downloading image...");
 
-        if (strcasecmp(extension, "jpg") == 0 || strcasecmp(extension, "jpeg") == 0)
+        if (synthetic)
+        {
+            if (renderSyntheticFrame(&memptr, &memsize, &w, &h))
+            {
+                LOG_ERROR("Exposure failed to render synthetic frame.");
+                return false;
+            }
+            naxis = 2;
+            bpp   = 16;
+            SetCCDCapability(GetCCDCapability() & ~CCD_HAS_BAYER);
+        }
+        else if (strcasecmp(extension, "jpg") == 0 || strcasecmp(extension, "jpeg") == 0)
         {
             if (read_jpeg(filename, &memptr, &memsize, &naxis, &w, &h))
             {
@@ -26,6 +26,7 @@
 
 #include <indiccd.h>
 #include <indifocuserinterface.h>
+#include <synthframe.h>
 
 #include <map>
 #include <future>
@@ -147,6 +148,7 @@ class GPhotoCCD : public INDI::CCD, public INDI::FocuserInterface
 
         double CalcTimeLeft();
         bool grabImage();
+        int renderSyntheticFrame(uint8_t **memptr, size_t *memsize, int *w, int *h);
 
         char name[MAXINDIDEVICE];
         char model[MAXINDINAME];
@@ -176,6 +178,9 @@ class GPhotoCCD : public INDI::CCD, public INDI::FocuserInterface
 	// binning ?
 	bool binning { false };
 
+        // Frame source in simulation mode when no upload file is set
+        SynthFrame::Generator m_SimGenerator;
+
         ISwitch mConnectS[2];
         ISwitchVectorProperty mConnectSP;
         IText mPortT[1] {};
@@ -31,6 +31,7 @@
 
 #include <algorithm>
 #include <cmath>
+#include <ctime>
 #include <vector>
 #include <map>
 #include <unistd.h>
@@ -48,33 +49,160 @@
 
 static std::unique_ptr<INDILibCamera> m_Camera(new INDILibCamera());
 
+static double clockSeconds(clockid_t clock)
+{
+    struct timespec ts;
+    clock_gettime(clock, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static inline uint8_t clampByte(int value)
+{
+    return static_cast<uint8_t>(value < 0 ? 0 : (value > 255 ? 255 : value));
+}
+
+// The video stream is configured with the JPEG colour space, i.e. full range BT.601, so this is
+// the same conversion libjpeg would do on decode. Each 2x2 block of luma shares one chroma pair.
+static void yuv420ToRGB(const uint8_t *Y, const StreamInfo &info, uint8_t *rgb)
+{
+    const unsigned int stride2 = info.stride / 2;
+    const uint8_t *U = Y + info.stride * info.height;
+    const uint8_t *V = U + stride2 * (info.height / 2);
+
+    for (unsigned int y = 0; y < info.height; y++)
+    {
+        const uint8_t *yRow = Y + y * info.stride;
+        const uint8_t *uRow = U + (y / 2) * stride2;
+        const uint8_t *vRow = V + (y / 2) * stride2;
+        int r = 0, g = 0, b = 0;
+        for (unsigned int x = 0; x < info.width; x++)
+        {
+            if ((x & 1) == 0)
+            {
+                int u = uRow[x / 2] - 128;
+                int v = vRow[x / 2] - 128;
+                r = (91881 * v) >> 16;
+                g = (22554 * u + 46802 * v) >> 16;
+                b = (116130 * u) >> 16;
+            }
+            int luma = yRow[x];
+            *rgb++ = clampByte(luma + r);
+            *rgb++ = clampByte(luma - g);
+            *rgb++ = clampByte(luma + b);
+        }
+    }
+}
+
+// Keeps the 8 most significant bits of each raw sample. For CSI2 packed formats those are the
+// leading bytes of each group (4 pixels in 5 bytes for 10 bit, 2 pixels in 3 bytes for 12 bit).
+static void bayerTo8Bit(const uint8_t *src, const StreamInfo &info, int bits, bool packed, uint8_t *dest)
+{
+    for (unsigned int y = 0; y < info.height; y++, src += info.stride, dest += info.width)
+    {
+        if (bits == 8)
+            memcpy(dest, src, info.width);
+        else if (packed && bits == 10)
+            for (unsigned int x = 0; x < info.width; x++)
+                dest[x] = src[(x / 4) * 5 + (x & 3)];
+        else if (packed && bits == 12)
+            for (unsigned int x = 0; x < info.width; x++)
+                dest[x] = src[(x / 2) * 3 + (x & 1)];
+        else
+        {
+            const uint16_t *samples = reinterpret_cast<const uint16_t *>(src);
+            for (unsigned int x = 0; x < info.width; x++)
+                dest[x] = static_cast<uint8_t>(samples[x] >> (bits - 8));
+        }
+    }
+}
+
+// Parses formats such as SRGGB10_CSI2P or SGBRG12. Compressed formats are not supported.
+static bool parseBayerFormat(const std::string &format, INDI_PIXEL_FORMAT &pixelFormat, int &bits, bool &packed)
+{
+    static const std::map<std::string, INDI_PIXEL_FORMAT> patterns =
+    {
+        {"RGGB", INDI_BAYER_RGGB}, {"GRBG", INDI_BAYER_GRBG}, {"GBRG", INDI_BAYER_GBRG}, {"BGGR", INDI_BAYER_BGGR}
+    };
+
+    if (format.size() < 6 || format[0] != 'S')
+        return false;
+
+    auto pattern = patterns.find(format.substr(1, 4));
+    if (pattern == patterns.end())
+        return false;
+
+    size_t suffix = format.find('_');
+    std::string depth = format.substr(5, suffix == std::string::npos ? std::string::npos : suffix - 5);
+    if (depth.empty() || depth.find_first_not_of("0123456789") != std::string::npos)
+        return false;
+
+    pixelFormat = pattern->second;
+    bits = std::stoi(depth);
+    packed = suffix != std::string::npos && format.substr(suffix) == "_CSI2P";
+    if (suffix != std::string::npos && !packed)
+        return false;
+
+    return bits == 8 || (bits > 8 && bits <= 16 && (!packed || bits == 10 || bits == 12));
+}
+
+void INDILibCamera::logStreamStats()
+{
+    if (m_StreamStats.frames == 0)
+        return;
+
+    double wall = clockSeconds(CLOCK_MONOTONIC) - m_StreamStats.wallStarted;
+    double cpu = clockSeconds(CLOCK_PROCESS_CPUTIME_ID) - m_StreamStats.cpuStarted;
+    if (wall <= 0)
+        return;
+
+    LOGF_INFO("Streamed %u frames in %.1f s (%.1f fps) in %s mode, %.2f ms per frame in driver, process CPU %.0f%% of one core.",
+              m_StreamStats.frames, wall, m_StreamStats.frames / wall, StreamModeSP.findOnSwitch()->getLabel(),
+              m_StreamStats.processingMs / m_StreamStats.frames, 100.0 * cpu / wall);
+    m_StreamStats.frames = 0;
+}
+
 void INDILibCamera::shutdownVideo()
 {
     m_CameraApp->StopCamera();
     m_CameraApp->StopEncoder();
     m_CameraApp->Teardown();
     if(REOPEN__CAMERA) m_CameraApp->CloseCamera();
+    logStreamStats();
     Streamer->setStream(false);
 }
 
 void INDILibCamera::workerStreamVideo(const std::atomic_bool &isAboutToQuit, double framerate)
 {
-    m_CameraApp->SetEncodeOutputReadyCallback(std::bind(&INDILibCamera::outputReady, this,
-            std::placeholders::_1,
-            std::placeholders::_2,
-            std::placeholders::_3,
-            std::placeholders::_4));
+    const int streamMode = StreamModeSP.findOnSwitchIndex();
 
     VideoOptions* options = m_CameraApp->GetOptions();
     initOptions(true);
-    options->codec = "mjpeg";
     options->framerate = framerate;
 
+    if (streamMode == STREAM_MJPEG)
+    {
+        m_CameraApp->SetEncodeOutputReadyCallback(std::bind(&INDILibCamera::outputReady, this,
+                std::placeholders::_1,
+                std::placeholders::_2,
+                std::placeholders::_3,
+                std::placeholders::_4));
+        options->codec = "mjpeg";
+    }
+
     try
     {
         if(REOPEN__CAMERA) m_CameraApp->OpenCamera();
-        m_CameraApp->ConfigureVideo(LibcameraEncoder::FLAG_VIDEO_JPEG_COLOURSPACE);
-        m_CameraApp->StartEncoder();
+        if (streamMode == STREAM_MJPEG)
+        {
+            m_CameraApp->ConfigureVideo(LibcameraEncoder::FLAG_VIDEO_JPEG_COLOURSPACE);
+            m_CameraApp->StartEncoder();
+        }
+        else
+        {
+            // No encoder, the buffers are read directly from the completed requests.
+            m_CameraApp->ConfigureVideo(LibcameraEncoder::FLAG_VIDEO_JPEG_COLOURSPACE |
+                                        (streamMode == STREAM_BAYER ? LibcameraEncoder::FLAG_VIDEO_RAW : 0));
+        }
         m_CameraApp->StartCamera();
     }
     catch (std::exception &e)
@@ -84,6 +212,37 @@ void INDILibCamera::workerStreamVideo(const std::atomic_bool &isAboutToQuit, dou
         return;
     }
 
+    StreamInfo info;
+    libcamera::Stream *stream = nullptr;
+    int rawBits = 0;
+    bool rawPacked = false;
+    if (streamMode != STREAM_MJPEG)
+    {
+        stream = streamMode == STREAM_BAYER ? m_CameraApp->RawStream(&info) : m_CameraApp->VideoStream(&info);
+        INDI_PIXEL_FORMAT pixelFormat = INDI_RGB;
+        if (stream == nullptr)
+        {
+            LOG_ERROR("Video Streaming failed: no stream.");
+            shutdownVideo();
+            return;
+        }
+        if (streamMode == STREAM_BAYER && !parseBayerFormat(info.pixel_format.toString(), pixelFormat, rawBits, rawPacked))
+        {
+            LOGF_ERROR("Raw format %s cannot be streamed, use the YUV stream mode.", info.pixel_format.toString().c_str());
+            shutdownVideo();
+            return;
+        }
+
+        m_StreamBuffer.resize(static_cast<size_t>(info.width) * info.height * (streamMode == STREAM_BAYER ? 1 : 3));
+        Streamer->setPixelFormat(pixelFormat, 8);
+        Streamer->setSize(info.width, info.height);
+    }
+
+    m_StreamStats.frames = 0;
+    m_StreamStats.processingMs = 0;
+    m_StreamStats.wallStarted = clockSeconds(CLOCK_MONOTONIC);
+    m_StreamStats.cpuStarted = clockSeconds(CLOCK_PROCESS_CPUTIME_ID);
+
     while (!isAboutToQuit)
     {
         LibcameraEncoder::Msg msg = m_CameraApp->Wait();
@@ -100,19 +259,44 @@ void INDILibCamera::workerStreamVideo(const std::atomic_bool &isAboutToQuit, dou
         }
 
         auto completed_request = std::get<CompletedRequestPtr>(msg.payload);
-        m_CameraApp->EncodeBuffer(completed_request, m_CameraApp->VideoStream());
+        if (streamMode == STREAM_MJPEG)
+            m_CameraApp->EncodeBuffer(completed_request, m_CameraApp->VideoStream());
+        else
+            streamDirectFrame(completed_request, stream, info, rawBits, rawPacked);
     }
 
     m_CameraApp->StopCamera();
     m_CameraApp->StopEncoder();
     m_CameraApp->Teardown();
     if(REOPEN__CAMERA) m_CameraApp->CloseCamera();
+    logStreamStats();
+}
+
+void INDILibCamera::streamDirectFrame(CompletedRequestPtr &completed_request, libcamera::Stream *stream,
+                                     const StreamInfo &info, int rawBits, bool rawPacked)
+{
+    INDI::ElapsedTimer timer;
+
+    const uint8_t *mem = m_CameraApp->Mmap(completed_request->buffers[stream])[0].data();
+    if (rawBits > 0)
+        bayerTo8Bit(mem, info, rawBits, rawPacked, m_StreamBuffer.data());
+    else
+        yuv420ToRGB(mem, info, m_StreamBuffer.data());
+
+    // The buffer goes back to the camera as soon as the request is released.
+    completed_request.reset();
+
+    Streamer->newFrame(m_StreamBuffer.data(), m_StreamBuffer.size());
+
+    m_StreamStats.frames++;
+    m_StreamStats.processingMs += timer.nsecsElapsed() / 1e6;
 }
 
 void INDILibCamera::outputReady(void *mem, size_t size, int64_t timestamp_us, bool keyframe)
 {
     INDI_UNUSED(timestamp_us);
     INDI_UNUSED(keyframe);
+    INDI::ElapsedTimer timer;
     uint8_t * cameraBuffer = PrimaryCCD.getFrameBuffer();
     size_t cameraBufferSize = 0;
     int w = 0, h = 0, naxis = 0;
@@ -135,6 +319,8 @@ void INDILibCamera::outputReady(void *mem, size_t size, int64_t timestamp_us, bo
         // We are done with writing to CCD buffer
         ccdguard.unlock();
         Streamer->newFrame(static_cast<uint8_t*>(mem), size);
+        m_StreamStats.frames++;
+        m_StreamStats.processingMs += timer.nsecsElapsed() / 1e6;
         return;
     }
 
@@ -161,6 +347,8 @@ void INDILibCamera::outputReady(void *mem, size_t size, int64_t timestamp_us, bo
     // We are done with writing to CCD buffer
     ccdguard.unlock();
     Streamer->newFrame(cameraBuffer, cameraBufferSize);
+    m_StreamStats.frames++;
+    m_StreamStats.processingMs += timer.nsecsElapsed() / 1e6;
 }
 
 void INDILibCamera::shutdownExposure()
@@ -531,6 +719,11 @@ bool INDILibCamera::initProperties()
     GainNP[0].fill("GAIN", "Gain", "%.2f", 0.00, 100.00, 1.00, 0.00);
     GainNP.fill(getDeviceName(), "CCD_GAIN", "Gain", IMAGE_CONTROLS_TAB, IP_RW, 60, IPS_IDLE);
 
+    StreamModeSP[STREAM_MJPEG].fill("STREAM_MJPEG", "MJPEG", ISS_ON);
+    StreamModeSP[STREAM_YUV].fill("STREAM_YUV", "YUV", ISS_OFF);
+    StreamModeSP[STREAM_BAYER].fill("STREAM_BAYER", "Bayer", ISS_OFF);
+    StreamModeSP.fill(getDeviceName(), "STREAM_MODE", "Stream Mode", "Streaming", IP_RW, ISR_1OFMANY, 60, IPS_IDLE);
+
     uint32_t cap = 0;
     cap |= CCD_HAS_BAYER;
     cap |= CCD_HAS_STREAMING;
@@ -565,6 +758,7 @@ void INDILibCamera::ISGetProperties(const char *dev)
     defineProperty(AdjustAwbModeSP);
     defineProperty(AdjustMeteringModeSP);
     defineProperty(AdjustDenoiseModeSP);
+    defineProperty(StreamModeSP);
 }
 
 /////////////////////////////////////////////////////////////////////////////
@@ -835,6 +1029,16 @@ bool INDILibCamera::ISNewSwitch(const char *dev, const char *name, ISState * sta
             options->metering_index = AdjustMeteringModeSP.findOnSwitchIndex();
             return true;
         }
+        if (StreamModeSP.isNameMatch(name))
+        {
+            StreamModeSP.update(states, names, n);
+            StreamModeSP.setState(IPS_OK);
+            StreamModeSP.apply();
+            saveConfig(StreamModeSP);
+            if (Streamer->isStreaming())
+                LOG_INFO("Stream mode takes effect when streaming is restarted.");
+            return true;
+        }
         if (AdjustDenoiseModeSP.isNameMatch(name))
         {
             AdjustDenoiseModeSP.update(states, names, n);
@@ -878,6 +1082,8 @@ bool INDILibCamera::AbortExposure()
 bool INDILibCamera::StartStreaming()
 {
     // do something dynamic here
+    if (StreamModeSP.findOnSwitchIndex() == STREAM_MJPEG)
+        Streamer->setPixelFormat(CaptureFormatSP.findOnSwitchIndex() == CAPTURE_JPG ? INDI_JPG : INDI_RGB);
     double framerate = Streamer.get()->getTargetFPS();
     m_Worker.start(std::bind(&INDILibCamera::workerStreamVideo, this, std::placeholders::_1, framerate));
     return true;
@@ -974,6 +1180,7 @@ bool INDILibCamera::saveConfigItems(FILE * fp)
     AdjustAwbModeSP.save(fp);
     AdjustMeteringModeSP.save(fp);
     AdjustDenoiseModeSP.save(fp);
+    StreamModeSP.save(fp);
 
     return true;
 }
@@ -81,6 +81,9 @@ class INDILibCamera : public INDI::CCD
         void workerStreamVideo(const std::atomic_bool &isAboutToQuit, double framerate);
         void workerExposure(const std::atomic_bool &isAboutToQuit, float duration);
         void outputReady(void *mem, size_t size, int64_t timestamp_us, bool keyframe);
+        void streamDirectFrame(CompletedRequestPtr &completed_request, libcamera::Stream *stream, const StreamInfo &info,
+                               int rawBits, bool rawPacked);
+        void logStreamStats();
         bool SetCaptureFormat(uint8_t index) override;
         void initOptions(bool video);
         void initSwitch(INDI::PropertySwitch &switchSP, int n, const char **names);
@@ -96,6 +99,15 @@ class INDILibCamera : public INDI::CCD
             CAPTURE_JPG
         };
 
+        // MJPEG runs every frame through the JPEG encoder (and decoder for DNG), the other modes
+        // copy the video or raw buffer straight into the stream.
+        enum
+        {
+            STREAM_MJPEG,
+            STREAM_YUV,
+            STREAM_BAYER
+        };
+
         bool processRAW(const char *filename, uint8_t **memptr, size_t *memsize, int *n_axis, int *w, int *h, int *bitsperpixel,
                         char *bayer_pattern);
 
@@ -121,9 +133,22 @@ class INDILibCamera : public INDI::CCD
         INDI::PropertySwitch AdjustExposureModeSP {0}, AdjustAwbModeSP {0}, AdjustMeteringModeSP {0}, AdjustDenoiseModeSP {0} ;
         INDI::PropertyNumber AdjustmentNP {AdjustAwbBlue+1};
         INDI::PropertyNumber GainNP {1};
+        INDI::PropertySwitch StreamModeSP {3};
 
         std::unique_ptr<LibcameraEncoder> m_CameraApp;
 
         int m_LiveVideoWidth {-1}, m_LiveVideoHeight {-1};
 
+        // Reused between frames by the direct stream modes.
+        std::vector<uint8_t> m_StreamBuffer;
+
+        // Per stream counters to compare the cost of the stream modes.
+        struct
+        {
+            uint32_t frames {0};
+            double processingMs {0};
+            double wallStarted {0};
+            double cpuStarted {0};
+        } m_StreamStats;
+
 };
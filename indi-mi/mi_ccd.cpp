@@ -25,15 +25,24 @@
 
 #include "config.h"
 
+#include <indielapsedtimer.h>
+
 #include <math.h>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
 #include <deque>
 #include <memory>
+#include <thread>
 #include <utility>
 
 #define TEMP_THRESHOLD  0.2  /* Differential temperature threshold (°C) */
 #define TEMP_COOLER_OFF 100  /* High enough temperature for the camera cooler to turn off (°C) */
 #define MAX_DEVICES     4    /* Max device cameraCount */
 #define MAX_ERROR_LEN   64   /* Max length of error buffer */
+#define READY_POLL_MS   50   /* Image ready polling period once the exposure time elapsed (ms) */
+#define READY_ERRORS    5    /* Consecutive image ready errors before the exposure fails */
+#define READY_TIMEOUT   30   /* Image ready errors are not retried this long after the exposure ended (s) */
 
 // There is _one_ binary for USB and ETH driver, but each binary is renamed
 // to its variant (indi_mi_ccd_usb and indi_mi_ccd_eth). The main function will
@@ -204,6 +213,11 @@ bool MICCD::initProperties()
     IUFillNumberVector(&PreflashNP, PreflashN, 2, getDeviceName(), "NIR_PRE_FLASH", "NIR Preflash",
                        MAIN_CONTROL_TAB, IP_RW, 60, IPS_IDLE);
 
+    // Duration of the last image download
+    IUFillNumber(&DownloadTimeN[0], "DOWNLOAD_TIME", "Download (s)", "%.3f", 0, 3600, 0, 0);
+    IUFillNumberVector(&DownloadTimeNP, DownloadTimeN, 1, getDeviceName(), "CCD_DOWNLOAD_TIME", "Download Time",
+                       IMAGE_INFO_TAB, IP_RO, 60, IPS_IDLE);
+
     addAuxControls();
 
     setDriverInterface(getDriverInterface() | FILTER_INTERFACE);
@@ -238,6 +252,8 @@ void MICCD::ISGetProperties(const char *dev)
         if (canDoPreflash)
             defineProperty(&PreflashNP);
 
+        defineProperty(&DownloadTimeNP);
+
         if (numFilters > 0)
         {
             INDI::FilterInterface::updateProperties();
@@ -273,6 +289,8 @@ bool MICCD::updateProperties()
         if (canDoPreflash)
             defineProperty(&PreflashNP);
 
+        defineProperty(&DownloadTimeNP);
+
         if (numFilters > 0)
         {
             INDI::FilterInterface::updateProperties();
@@ -280,8 +298,6 @@ bool MICCD::updateProperties()
 
         // Let's get parameters now from CCD
         setupParams();
-
-        timerID = SetTimer(getCurrentPollingPeriod());
     }
     else
     {
@@ -307,11 +323,12 @@ bool MICCD::updateProperties()
         if (canDoPreflash)
             deleteProperty(PreflashNP.name);
 
+        deleteProperty(DownloadTimeNP.name);
+
         if (numFilters > 0)
         {
             INDI::FilterInterface::updateProperties();
         }
-        RemoveTimer(timerID);
     }
 
     return true;
@@ -395,6 +412,7 @@ bool MICCD::Connect()
 
 bool MICCD::Disconnect()
 {
+    m_Worker.quit();
     LOGF_INFO("Disconnected from %s.", name);
     gxccd_release(cameraHandle);
     cameraHandle = nullptr;
@@ -506,13 +524,15 @@ bool MICCD::StartExposure(float duration)
 
     gettimeofday(&ExpStart, nullptr);
     InExposure  = true;
-    downloading = false;
     LOGF_DEBUG("Taking a %.3f seconds frame...", ExposureRequest);
+    m_Worker.start(std::bind(&MICCD::workerExposure, this, std::placeholders::_1));
     return true;
 }
 
 bool MICCD::AbortExposure()
 {
+    m_Worker.quit();
+
     if (InExposure && !isSimulation())
     {
         if (gxccd_abort_exposure(cameraHandle, false) < 0)
@@ -525,7 +545,6 @@ bool MICCD::AbortExposure()
     }
 
     InExposure  = false;
-    downloading = false;
     LOG_INFO("Exposure aborted.");
     return true;
 }
@@ -590,24 +609,14 @@ float MICCD::calcTimeLeft()
     return ExposureRequest - timesince / 1000.0;
 }
 
-static void mirror_image(void *buf, size_t w, size_t d)
+// libgxccd returns the bottom line first, swap whole lines to flip the image in a single pass.
+static void mirror_image(uint16_t *buf, size_t w, size_t d)
 {
-    size_t w2     = w * 2;
-    size_t half_d = d / 2;
+    if (d < 2)
+        return;
 
-    for (size_t line = 1; line <= half_d; line++)
-    {
-        uint16_t *sa = (uint16_t *)((char *)buf + (line - 1) * w2);
-        uint16_t *da = (uint16_t *)((char *)buf + (d - line) * w2);
-        for (size_t index = 1; index <= w; index++)
-        {
-            uint16_t tmp = *sa;
-            *sa          = *da;
-            *da          = tmp;
-            ++sa;
-            ++da;
-        }
-    }
+    for (size_t top = 0, bottom = d - 1; top < bottom; top++, bottom--)
+        std::swap_ranges(buf + top * w, buf + (top + 1) * w, buf + bottom * w);
 }
 
 /* Downloads the image from the CCD. */
@@ -618,6 +627,7 @@ int MICCD::grabImage()
     unsigned char *image = (unsigned char *)PrimaryCCD.getFrameBuffer();
     int width  = PrimaryCCD.getSubW() / PrimaryCCD.getBinX();
     int height = PrimaryCCD.getSubH() / PrimaryCCD.getBinY();
+    INDI::ElapsedTimer downloadTimer;
 
     if (isSimulation())
     {
@@ -638,59 +648,90 @@ int MICCD::grabImage()
         }
         else
         {
-            mirror_image(image, width, height);
+            mirror_image(reinterpret_cast<uint16_t *>(image), width, height);
         }
     }
 
     guard.unlock();
 
-    if (ExposureRequest > 5 && !ret)
+    DownloadTimeN[0].value = downloadTimer.nsecsElapsed() / 1e9;
+    DownloadTimeNP.s       = ret < 0 ? IPS_ALERT : IPS_OK;
+    IDSetNumber(&DownloadTimeNP, nullptr);
+    LOGF_DEBUG("Download took %.3f seconds.", DownloadTimeN[0].value);
+
+    if (ret < 0)
+    {
+        PrimaryCCD.setExposureFailed();
+        return ret;
+    }
+
+    if (ExposureRequest > 5)
         LOG_INFO("Download complete.");
 
-    downloading = false;
     ExposureComplete(&PrimaryCCD);
 
     return ret;
 }
 
-void MICCD::TimerHit()
+void MICCD::workerExposure(const std::atomic_bool &isAboutToQuit)
 {
-    if (!isConnected())
-        return; // No need to reset timer if we are not connected anymore
+    int errors = 0;
 
-    if (InExposure)
+    while (!isAboutToQuit)
     {
         float timeleft = calcTimeLeft();
         bool ready     = false;
 
-        if (!downloading && (gxccd_image_ready(cameraHandle, &ready) < 0))
+        if (isSimulation())
+            ready = timeleft <= 0;
+        else if (gxccd_image_ready(cameraHandle, &ready) < 0)
         {
             char errorStr[MAX_ERROR_LEN];
             gxccd_get_last_error(cameraHandle, errorStr, sizeof(errorStr));
-            LOGF_ERROR("Getting image ready failed: %s.", errorStr);
-        }
-        if (ready)
-        {
-            PrimaryCCD.setExposureLeft(0);
-            InExposure  = false;
-            downloading = true;
 
-            // Don't spam the session log unless it is a long exposure > 5 seconds
-            if (ExposureRequest > 5)
-                LOG_INFO("Exposure done, downloading image...");
+            // Transient errors, e.g. a dropped ETH packet, are retried
+            if (++errors >= READY_ERRORS || timeleft < -READY_TIMEOUT)
+            {
+                LOGF_ERROR("Getting image ready failed: %s.", errorStr);
+                InExposure = false;
+                PrimaryCCD.setExposureFailed();
+                return;
+            }
 
-            // grab and save image
-            grabImage();
+            LOGF_WARN("Getting image ready failed: %s. Retrying (%d/%d)...", errorStr, errors, READY_ERRORS - 1);
+            std::this_thread::sleep_for(std::chrono::milliseconds(READY_POLL_MS));
+            continue;
         }
+        else
+            errors = 0;
+
+        if (ready)
+            break;
+
         // camera may need some time for image download -> update client only for positive values
-        else if (timeleft >= 0)
+        double delay = READY_POLL_MS / 1000.0;
+        if (timeleft >= 0)
         {
             LOGF_DEBUG("Exposure in progress: Time left %.2fs", timeleft);
             PrimaryCCD.setExposureLeft(timeleft);
+            // Wake up on whole seconds so the countdown stays in step
+            delay = std::max(timeleft - std::trunc(timeleft), 0.01f);
         }
+        std::this_thread::sleep_for(std::chrono::microseconds(static_cast<int>(delay * 1e6)));
     }
 
-    SetTimer(getCurrentPollingPeriod());
+    if (isAboutToQuit)
+        return;
+
+    PrimaryCCD.setExposureLeft(0);
+    InExposure = false;
+
+    // Don't spam the session log unless it is a long exposure > 5 seconds
+    if (ExposureRequest > 5)
+        LOG_INFO("Exposure done, downloading image...");
+
+    // grab and save image
+    grabImage();
 }
 
 int MICCD::QueryFilter()
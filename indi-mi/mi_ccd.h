@@ -25,6 +25,7 @@
 
 #include <indiccd.h>
 #include <indifilterinterface.h>
+#include <indisinglethreadpool.h>
 
 class MICCD : public INDI::CCD, public INDI::FilterInterface
 {
@@ -56,7 +57,6 @@ class MICCD : public INDI::CCD, public INDI::FilterInterface
 
     protected:
         // Misc.
-        virtual void TimerHit() override;
         virtual bool saveConfigItems(FILE *fp) override;
         virtual void addFITSKeywords(INDI::CCDChip *targetChip, std::vector<INDI::FITSRecord> &fitsKeywords) override;
 
@@ -89,6 +89,9 @@ class MICCD : public INDI::CCD, public INDI::FilterInterface
         INumber PreflashN[2];
         INumberVectorProperty PreflashNP;
 
+        INumber DownloadTimeN[1];
+        INumberVectorProperty DownloadTimeNP;
+
     private:
         char name[MAXINDIDEVICE];
 
@@ -109,9 +112,6 @@ class MICCD : public INDI::CCD, public INDI::FilterInterface
         int maxGainValue;
 
         int temperatureID;
-        int timerID;
-
-        bool downloading;
 
         bool canDoPreflash;
 
@@ -126,6 +126,10 @@ class MICCD : public INDI::CCD, public INDI::FilterInterface
         float calcTimeLeft();
         int grabImage();
 
+        // Waits for the exposure and downloads the image, off the main thread.
+        void workerExposure(const std::atomic_bool &isAboutToQuit);
+        INDI::SingleThreadPool m_Worker;
+
         void updateTemperature();
         static void updateTemperatureHelper(void *);
 };
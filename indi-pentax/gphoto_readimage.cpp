@@ -15,6 +15,7 @@
 
 #include <unistd.h>
 #include <arpa/inet.h>
+#include <setjmp.h>
 
 
 char dcraw_cmd[] = "dcraw";
@@ -137,20 +138,11 @@ int dcraw_parse_header_info(const char *filename, struct dcraw_header *header)
     return 0;
 }
 
-int read_libraw(const char *filename, uint8_t **memptr, size_t *memsize, int *n_axis, int *w, int *h, int *bitsperpixel,
-                char *bayer_pattern)
+// Decodes the raw image opened in RawProcessor, filename is only used for messages
+static int decode_libraw(LibRaw &RawProcessor, const char *filename, uint8_t **memptr, size_t *memsize, int *n_axis,
+                         int *w, int *h, int *bitsperpixel, char *bayer_pattern)
 {
     int ret = 0;
-    // Creation of image processing object
-    LibRaw RawProcessor;
-
-    // Let us open the file
-    if ((ret = RawProcessor.open_file(filename)) != LIBRAW_SUCCESS)
-    {
-        DEBUGFDEVICE(device, INDI::Logger::DBG_ERROR, "Cannot open %s: %s", filename, libraw_strerror(ret));
-        RawProcessor.recycle();
-        return -1;
-    }
 
     // Let us unpack the image
     if ((ret = RawProcessor.unpack()) != LIBRAW_SUCCESS)
@@ -215,29 +207,82 @@ int read_libraw(const char *filename, uint8_t **memptr, size_t *memsize, int *n_
     return 0;
 }
 
-int read_jpeg(const char *filename, uint8_t **memptr, size_t *memsize, int *naxis, int *w, int *h)
+int read_libraw(const char *filename, uint8_t **memptr, size_t *memsize, int *n_axis, int *w, int *h, int *bitsperpixel,
+                char *bayer_pattern)
+{
+    int ret = 0;
+    // Creation of image processing object
+    LibRaw RawProcessor;
+
+    // Let us open the file
+    if ((ret = RawProcessor.open_file(filename)) != LIBRAW_SUCCESS)
+    {
+        DEBUGFDEVICE(device, INDI::Logger::DBG_ERROR, "Cannot open %s: %s", filename, libraw_strerror(ret));
+        RawProcessor.recycle();
+        return -1;
+    }
+
+    return decode_libraw(RawProcessor, filename, memptr, memsize, n_axis, w, h, bitsperpixel, bayer_pattern);
+}
+
+int read_libraw_mem(const uint8_t *inBuffer, size_t inSize, uint8_t **memptr, size_t *memsize, int *n_axis, int *w,
+                    int *h, int *bitsperpixel, char *bayer_pattern)
 {
-    unsigned char *r_data = nullptr, *g_data = nullptr, *b_data = nullptr;
+    int ret = 0;
+    LibRaw RawProcessor;
+
+    if ((ret = RawProcessor.open_buffer(const_cast<uint8_t *>(inBuffer), inSize)) != LIBRAW_SUCCESS)
+    {
+        DEBUGFDEVICE(device, INDI::Logger::DBG_ERROR, "Cannot open raw buffer: %s", libraw_strerror(ret));
+        RawProcessor.recycle();
+        return -1;
+    }
+
+    return decode_libraw(RawProcessor, "raw buffer", memptr, memsize, n_axis, w, h, bitsperpixel, bayer_pattern);
+}
+
+// libjpeg calls error_exit on corrupt data, and the default one exits the process
+struct jpeg_error_jump
+{
+    struct jpeg_error_mgr pub;
+    jmp_buf setjmp_buffer;
+};
 
+static void jpeg_error_jump_exit(j_common_ptr cinfo)
+{
+    char message[JMSG_LENGTH_MAX];
+    (*cinfo->err->format_message)(cinfo, message);
+    DEBUGFDEVICE(device, INDI::Logger::DBG_ERROR, "Cannot decode jpeg: %s", message);
+    longjmp(reinterpret_cast<jpeg_error_jump *>(cinfo->err)->setjmp_buffer, 1);
+}
+
+// Decodes a jpeg from infile, or from inBuffer if infile is null, into one plane per component
+static int decode_jpeg_planar(FILE *infile, const uint8_t *inBuffer, size_t inSize, uint8_t **memptr, size_t *memsize,
+                              int *naxis, int *w, int *h)
+{
     /* these are standard libjpeg structures for reading(decompression) */
     struct jpeg_decompress_struct cinfo;
-    struct jpeg_error_mgr jerr;
-    /* libjpeg data structure for storing one row, that is, scanline of an image */
-    JSAMPROW row_pointer[1] = { nullptr };
+    struct jpeg_error_jump jerr;
 
-    FILE *infile = fopen(filename, "rb");
+    /* libjpeg data structure for storing one row, that is, scanline of an image. Volatile as it is
+       freed after a longjmp from the error handler. */
+    unsigned char *volatile row_buffer = nullptr;
 
-    if (!infile)
+    cinfo.err = jpeg_std_error(&jerr.pub);
+    jerr.pub.error_exit = jpeg_error_jump_exit;
+    if (setjmp(jerr.setjmp_buffer))
     {
-        DEBUGFDEVICE(device, INDI::Logger::DBG_DEBUG, "Error opening jpeg file %s!", filename);
+        jpeg_destroy_decompress(&cinfo);
+        free(row_buffer);
         return -1;
     }
-    /* here we set up the standard libjpeg error handler */
-    cinfo.err = jpeg_std_error(&jerr);
-    /* setup decompression process and source, then read JPEG header */
+
     jpeg_create_decompress(&cinfo);
-    /* this makes the library read from infile */
-    jpeg_stdio_src(&cinfo, infile);
+    if (infile)
+        jpeg_stdio_src(&cinfo, infile);
+    else
+        jpeg_mem_src(&cinfo, const_cast<uint8_t *>(inBuffer), inSize);
+
     /* reading the image header which contains image information */
     jpeg_read_header(&cinfo, (boolean)TRUE);
 
@@ -250,25 +295,23 @@ int read_jpeg(const char *filename, uint8_t **memptr, size_t *memsize, int *naxi
         *memptr = static_cast<uint8_t *>(IDSharedBlobAlloc(*memsize));
     if (*memptr == nullptr)
     {
-        DEBUGFDEVICE(device, INDI::Logger::DBG_ERROR, "%s: Failed to allocate %d bytes of memory!", __PRETTY_FUNCTION__, *memsize);
+        DEBUGFDEVICE(device, INDI::Logger::DBG_ERROR, "%s: Failed to allocate %zu bytes of memory!", __PRETTY_FUNCTION__, *memsize);
+        jpeg_destroy_decompress(&cinfo);
         return -1;
     }
-    // if you do some ugly pointer math, remember to restore the original pointer or some random crashes will happen. This is why I do not like pointers!!
-    uint8_t *oldmem = *memptr;
     *naxis = cinfo.num_components;
     *w     = cinfo.output_width;
     *h     = cinfo.output_height;
 
     /* now actually read the jpeg into the raw buffer */
-    row_pointer[0] = (unsigned char *)malloc(cinfo.output_width * cinfo.num_components);
-    if (cinfo.num_components)
-    {
-        r_data = (unsigned char *)*memptr;
-        g_data = r_data + cinfo.output_width * cinfo.output_height;
-        b_data = r_data + 2 * cinfo.output_width * cinfo.output_height;
-    }
+    row_buffer = static_cast<unsigned char *>(malloc(cinfo.output_width * cinfo.num_components));
+    JSAMPROW row_pointer[1] = { row_buffer };
+    unsigned char *r_data = *memptr;
+    unsigned char *g_data = r_data + cinfo.output_width * cinfo.output_height;
+    unsigned char *b_data = r_data + 2 * cinfo.output_width * cinfo.output_height;
+
     /* read one scan line at a time */
-    for (unsigned int row = 0; row < cinfo.image_height; row++)
+    for (unsigned int row = 0; row < cinfo.output_height; row++)
     {
         unsigned char *ppm8 = row_pointer[0];
         jpeg_read_scanlines(&cinfo, row_pointer, 1);
@@ -284,23 +327,38 @@ int read_jpeg(const char *filename, uint8_t **memptr, size_t *memsize, int *naxi
         }
         else
         {
-            memcpy(*memptr, ppm8, cinfo.output_width);
-            *memptr += cinfo.output_width;
+            memcpy(r_data, ppm8, cinfo.output_width);
+            r_data += cinfo.output_width;
         }
     }
 
     /* wrap up decompression, destroy objects, free pointers and close open files */
     jpeg_finish_decompress(&cinfo);
     jpeg_destroy_decompress(&cinfo);
+    free(row_buffer);
 
-    if (row_pointer[0])
-        free(row_pointer[0]);
-    if (infile)
-        fclose(infile);
+    return 0;
+}
+
+int read_jpeg(const char *filename, uint8_t **memptr, size_t *memsize, int *naxis, int *w, int *h)
+{
+    FILE *infile = fopen(filename, "rb");
+
+    if (!infile)
+    {
+        DEBUGFDEVICE(device, INDI::Logger::DBG_DEBUG, "Error opening jpeg file %s!", filename);
+        return -1;
+    }
 
-    *memptr = oldmem;
+    int ret = decode_jpeg_planar(infile, nullptr, 0, memptr, memsize, naxis, w, h);
+    fclose(infile);
+    return ret;
+}
 
-    return 0;
+int read_jpeg_planar_mem(const uint8_t *inBuffer, size_t inSize, uint8_t **memptr, size_t *memsize, int *naxis, int *w,
+                         int *h)
+{
+    return decode_jpeg_planar(nullptr, inBuffer, inSize, memptr, memsize, naxis, w, h);
 }
 
 int read_jpeg_mem(unsigned char *inBuffer, unsigned long inSize, uint8_t **memptr, size_t *memsize, int *naxis, int *w,
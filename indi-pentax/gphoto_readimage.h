@@ -6,7 +6,13 @@
 
 int read_libraw(const char *filename, uint8_t **memptr, size_t *memsize, int *n_axis, int *w, int *h, int *bitsperpixel,
                 char *bayer_pattern);
+// Same as read_libraw, for a raw file that is already in memory
+int read_libraw_mem(const uint8_t *inBuffer, size_t inSize, uint8_t **memptr, size_t *memsize, int *n_axis, int *w,
+                    int *h, int *bitsperpixel, char *bayer_pattern);
 int read_jpeg(const char *filename, uint8_t **memptr, size_t *memsize, int *n_axis, int *w, int *h);
+// Same as read_jpeg, one plane per color. read_jpeg_mem interleaves the colors instead.
+int read_jpeg_planar_mem(const uint8_t *inBuffer, size_t inSize, uint8_t **memptr, size_t *memsize, int *naxis, int *w,
+                         int *h);
 int read_jpeg_mem(unsigned char *inBuffer, unsigned long inSize, uint8_t **memptr, size_t *memsize, int *naxis, int *w,
                   int *h);
 int read_jpeg_size(unsigned char *inBuffer, unsigned long inSize, int *w, int *h);
@@ -0,0 +1,180 @@
+/*
+    Pentax capture replay harness
+    Copyright (C) 2026 INDI 3rd party contributors
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+
+    Replays stored PEF, DNG and JPEG captures through the steps the
+    pktriggercord driver runs after the shutter closes, and reports the
+    latency from the downloaded bytes to the decoded frame buffer:
+
+    memory  the bytes are copied into a reused download buffer and decoded
+            from memory, as PkTriggerCordCCD::downloadImage and grabImage do.
+    file    the bytes are written to a temporary file and decoded from it,
+            as the driver did before the in-memory download.
+
+    Usage: pentax_replay [-n repeats] capture...
+*/
+
+#include "gphoto_readimage.h"
+
+#include <sharedblob.h>
+
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+#include <unistd.h>
+
+namespace
+{
+
+struct Frame
+{
+    uint8_t *memptr = nullptr;
+    size_t memsize = 0;
+    int naxis = 2, w = 0, h = 0, bpp = 8;
+};
+
+bool isJpeg(const std::string &path)
+{
+    std::string extension = path.substr(path.find_last_of('.') + 1);
+    std::transform(extension.begin(), extension.end(), extension.begin(), ::tolower);
+    return extension == "jpg" || extension == "jpeg";
+}
+
+bool decodeMemory(bool jpeg, const std::vector<uint8_t> &download, Frame &frame)
+{
+    if (jpeg)
+        return read_jpeg_planar_mem(download.data(), download.size(), &frame.memptr, &frame.memsize, &frame.naxis,
+                                    &frame.w, &frame.h) == 0;
+
+    char bayer_pattern[8] = {};
+    return read_libraw_mem(download.data(), download.size(), &frame.memptr, &frame.memsize, &frame.naxis, &frame.w,
+                           &frame.h, &frame.bpp, bayer_pattern) == 0;
+}
+
+bool decodeFile(bool jpeg, const std::vector<uint8_t> &capture, const char *tmpName, Frame &frame)
+{
+    FILE *f = fopen(tmpName, "wb");
+    if (f == nullptr)
+        return false;
+    bool written = fwrite(capture.data(), 1, capture.size(), f) == capture.size();
+    fclose(f);
+    if (!written)
+        return false;
+
+    if (jpeg)
+        return read_jpeg(tmpName, &frame.memptr, &frame.memsize, &frame.naxis, &frame.w, &frame.h) == 0;
+
+    char bayer_pattern[8] = {};
+    return read_libraw(tmpName, &frame.memptr, &frame.memsize, &frame.naxis, &frame.w, &frame.h, &frame.bpp,
+                       bayer_pattern) == 0;
+}
+
+double milliseconds(std::chrono::steady_clock::duration duration)
+{
+    return std::chrono::duration<double, std::milli>(duration).count();
+}
+
+void report(const char *path, const char *mode, std::vector<double> &latencies)
+{
+    std::sort(latencies.begin(), latencies.end());
+    printf("%-40s %-7s %9.2f %9.2f %9.2f\n", path, mode, latencies.front(), latencies[latencies.size() / 2],
+           latencies.back());
+}
+
+}
+
+int main(int argc, char *argv[])
+{
+    int repeats = 5;
+    int first = 1;
+    if (argc > 2 && !strcmp(argv[1], "-n"))
+    {
+        repeats = std::max(1, atoi(argv[2]));
+        first = 3;
+    }
+    if (first >= argc)
+    {
+        fprintf(stderr, "Usage: %s [-n repeats] capture...\n", argv[0]);
+        return 1;
+    }
+
+    char tmpName[] = "/tmp/pentax_replay_XXXXXX";
+    int fd = mkstemp(tmpName);
+    if (fd < 0)
+    {
+        perror("mkstemp");
+        return 1;
+    }
+    close(fd);
+
+    printf("%-40s %-7s %9s %9s %9s\n", "capture", "path", "min ms", "median ms", "max ms");
+
+    int failures = 0;
+    std::vector<uint8_t> download;
+    for (int i = first; i < argc; i++)
+    {
+        std::ifstream in(argv[i], std::ios::binary);
+        std::vector<uint8_t> capture((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+        if (capture.empty())
+        {
+            fprintf(stderr, "Cannot read %s\n", argv[i]);
+            failures++;
+            continue;
+        }
+
+        bool jpeg = isJpeg(argv[i]);
+        bool decoded = true;
+        std::vector<double> memory, file;
+        // The frame buffer is reused across exposures, as the driver's is
+        Frame frame;
+        for (int r = 0; r < repeats && decoded; r++)
+        {
+            auto start = std::chrono::steady_clock::now();
+            download.resize(capture.size());
+            memcpy(download.data(), capture.data(), capture.size());
+            decoded = decodeMemory(jpeg, download, frame);
+            memory.push_back(milliseconds(std::chrono::steady_clock::now() - start));
+
+            start = std::chrono::steady_clock::now();
+            decoded = decodeFile(jpeg, capture, tmpName, frame) && decoded;
+            file.push_back(milliseconds(std::chrono::steady_clock::now() - start));
+        }
+
+        if (decoded)
+        {
+            report(argv[i], "memory", memory);
+            report(argv[i], "file", file);
+        }
+        else
+        {
+            fprintf(stderr, "Cannot decode %s\n", argv[i]);
+            failures++;
+        }
+        IDSharedBlobFree(frame.memptr);
+    }
+
+    unlink(tmpName);
+    return failures ? 1 : 0;
+}
@@ -25,7 +25,6 @@
 #define MINISO 100
 #define MAXISO 102400
 
-#define TMPFILEBASE (char *)"/tmp/indipentax.tmp"
 
 PkTriggerCordCCD::PkTriggerCordCCD(const char * name)
 {
@@ -82,6 +81,12 @@ bool PkTriggerCordCCD::initProperties()
     IUFillSwitchVector(&preserveOriginalSP, preserveOriginalS, 2, getDeviceName(), "PRESERVE_ORIGINAL", "Copy Option",
                        OPTIONS_TAB, IP_RW, ISR_1OFMANY, 0, IPS_IDLE);
 
+    // Larger download blocks with fewer status polls, not validated on every model so off by default
+    IUFillSwitch(&fastDownloadS[0], "FAST_DOWNLOAD_ON", "On", ISS_OFF);
+    IUFillSwitch(&fastDownloadS[1], "FAST_DOWNLOAD_OFF", "Off", ISS_ON);
+    IUFillSwitchVector(&fastDownloadSP, fastDownloadS, 2, getDeviceName(), "FAST_DOWNLOAD", "Fast Download",
+                       OPTIONS_TAB, IP_RW, ISR_1OFMANY, 0, IPS_IDLE);
+
     PrimaryCCD.setMinMaxStep("CCD_EXPOSURE", "CCD_EXPOSURE_VALUE", 0.0001, 7200, 1, false);
 
     IUSaveText(&BayerT[2], "RGGB");
@@ -113,6 +118,7 @@ bool PkTriggerCordCCD::updateProperties()
 
         // defineProperty(&transferFormatSP);
         defineProperty(&autoFocusSP);
+        defineProperty(&fastDownloadSP);
         //if (transferFormatS[0].s == ISS_ON)        
         if (EncodeFormatSP[FORMAT_FITS].getState() == ISS_ON)
         {
@@ -126,6 +132,7 @@ bool PkTriggerCordCCD::updateProperties()
         deleteCaptureSwitches();
 
         deleteProperty(autoFocusSP.name);
+        deleteProperty(fastDownloadSP.name);
         // deleteProperty(transferFormatSP.name);
         deleteProperty(preserveOriginalSP.name);
 
@@ -258,6 +265,9 @@ bool PkTriggerCordCCD::Connect()
 
 bool PkTriggerCordCCD::Disconnect()
 {
+    // The capture thread still talks to the camera
+    if (shutter_result.valid())
+        shutter_result.wait();
     pslr_disconnect(device);
     pslr_shutdown(device);
     return true;
@@ -270,7 +280,7 @@ bool PkTriggerCordCCD::setupParams()
     return true;
 }
 
-bool PkTriggerCordCCD::shutterPress(pslr_rational_t shutter_speed)
+bool PkTriggerCordCCD::shutterPress(pslr_rational_t shutter_speed, user_file_format format)
 {
     if ( status.exposure_mode ==  PSLR_GUI_EXPOSURE_MODE_B )
     {
@@ -305,27 +315,65 @@ bool PkTriggerCordCCD::shutterPress(pslr_rational_t shutter_speed)
     LOG_DEBUG("Shutter pressed.");
     pslr_get_status(device, &status);
 
-    user_file_format_t ufft = *pslr_get_user_file_format_t(uff);
-    char * output_file = TMPFILEBASE;
-    int fd = open_file(output_file, 1, ufft);
+    bool downloaded = downloadImage(format);
 
-    int cnt = 0;
-    while ( save_buffer(device, 0, fd, &status, uff, quality ) )
+    pslr_delete_buffer(device, 0);
+    if (need_bulb_new_cleanup)
     {
-        LOGF_DEBUG("Saved buffer (%d)", cnt++);
+        bulb_new_cleanup(device);
     }
 
-    pslr_delete_buffer(device, 0);
-    if (fd != 1)
+    return downloaded;
+}
+
+// Reads camera buffer 0 into downloadBuffer, the same way save_buffer writes it to a file
+bool PkTriggerCordCCD::downloadImage(user_file_format format)
+{
+    pslr_buffer_type imagetype;
+    if (format == USER_FILE_FORMAT_PEF)
     {
-        close(fd);
+        imagetype = PSLR_BUF_PEF;
     }
-    if (need_bulb_new_cleanup)
+    else if (format == USER_FILE_FORMAT_DNG)
     {
-        bulb_new_cleanup(device);
+        imagetype = PSLR_BUF_DNG;
+    }
+    else
+    {
+        imagetype = pslr_get_jpeg_buffer_type(device, status.jpeg_quality);
     }
 
-    return 1;
+    pslr_set_fast_download(device, fastDownloadS[0].s == ISS_ON);
+
+    if (pslr_buffer_open(device, 0, imagetype, status.jpeg_resolution) != PSLR_OK)
+    {
+        LOG_ERROR("Could not open the image buffer on the camera.");
+        downloadBuffer.clear();
+        return false;
+    }
+
+    // The buffer keeps its capacity between exposures, so it only reallocates when images grow
+    size_t length = pslr_buffer_get_size(device);
+    downloadBuffer.resize(length);
+    size_t current = pslr_buffer_read_full(device, downloadBuffer.data(), length);
+    pslr_buffer_close(device);
+
+    LOGF_DEBUG("Downloaded %zu of %zu bytes.", current, length);
+    if (current < length)
+    {
+        LOG_ERROR("Image download from the camera was incomplete.");
+        downloadBuffer.clear();
+        return false;
+    }
+    return true;
+}
+
+// Runs on the capture thread so the event loop is not blocked by the download or the decoding
+bool PkTriggerCordCCD::captureImage(pslr_rational_t shutter_speed, CaptureOptions options)
+{
+    if (!shutterPress(shutter_speed, options.format))
+        return false;
+    return grabImage(options);
 }
 
 
@@ -404,11 +452,17 @@ bool PkTriggerCordCCD::StartExposure(float duration)
 
         if (autoFocusS[0].s == ISS_ON) pslr_focus(device);
 
+        CaptureOptions options;
+        options.format = uff;
+        options.fits = EncodeFormatSP[FORMAT_FITS].s == ISS_ON;
+        options.preserveOriginal = preserveOriginalS[1].s == ISS_ON;
+        options.uploadPrefix = getUploadFilePrefix();
+
         //start capture
         gettimeofday(&ExpStart, nullptr);
         LOGF_INFO("Taking a %g seconds frame...", ExposureRequest);
 
-        shutter_result = std::async(std::launch::async, &PkTriggerCordCCD::shutterPress, this, shutter_speed);
+        shutter_result = std::async(std::launch::async, &PkTriggerCordCCD::captureImage, this, shutter_speed, options);
 
         return true;
     }
@@ -549,12 +603,18 @@ void PkTriggerCordCCD::TimerHit()
         if ( shutter_result.wait_for(span) != std::future_status::timeout)
         {
             bool result = shutter_result.get();
-            INDI_UNUSED(result);
             InDownload = false;
             InExposure = false;
 
-            grabImage();
-            ExposureComplete(&PrimaryCCD);
+            if (result)
+            {
+                ExposureComplete(&PrimaryCCD);
+            }
+            else
+            {
+                LOG_ERROR("Exposure failed.");
+                PrimaryCCD.setExposureFailed();
+            }
         }
         else if (InDownload && isDebug())
         {
@@ -567,40 +627,24 @@ void PkTriggerCordCCD::TimerHit()
     return;
 }
 
-bool PkTriggerCordCCD::grabImage()
+bool PkTriggerCordCCD::grabImage(const CaptureOptions &options)
 {
-    //set correct tmpfile location
-    char tmpfile[256];
-    if (uff == USER_FILE_FORMAT_JPEG)
-    {
-        snprintf(tmpfile, 256, "%s-0001.jpg", TMPFILEBASE);
-    }
-    else if (uff == USER_FILE_FORMAT_DNG)
-    {
-        snprintf(tmpfile, 256, "%s-0001.dng", TMPFILEBASE);
-    }
-    else
-    {
-        snprintf(tmpfile, 256, "%s-0001.pef", TMPFILEBASE);
-    }
-    LOGF_DEBUG("Reading temp file from: %s", tmpfile);
-
-
     // fits handling code
     // if (transferFormatS[0].s == ISS_ON)    
-    if ( EncodeFormatSP[FORMAT_FITS].s == ISS_ON )
+    if (options.fits)
     {
+        std::unique_lock<std::mutex> guard(ccdBufferLock);
         PrimaryCCD.setImageExtension("fits");
         uint8_t * memptr = PrimaryCCD.getFrameBuffer();
         size_t memsize = 0;
         int naxis = 2, w = 0, h = 0, bpp = 8;
 
-        if (uff == USER_FILE_FORMAT_JPEG)
+        if (options.format == USER_FILE_FORMAT_JPEG)
         {
-            if (read_jpeg(tmpfile, &memptr, &memsize, &naxis, &w, &h))
+            if (read_jpeg_planar_mem(downloadBuffer.data(), downloadBuffer.size(), &memptr, &memsize, &naxis, &w, &h))
             {
+                keepFrameBuffer(memptr, memsize);
                 LOG_ERROR("Exposure failed to parse jpeg.");
-                unlink(tmpfile);
                 return false;
             }
 
@@ -614,10 +658,11 @@ bool PkTriggerCordCCD::grabImage()
         {
             char bayer_pattern[8] = {};
 
-            if (read_libraw(tmpfile, &memptr, &memsize, &naxis, &w, &h, &bpp, bayer_pattern))
+            if (read_libraw_mem(downloadBuffer.data(), downloadBuffer.size(), &memptr, &memsize, &naxis, &w, &h, &bpp,
+                                bayer_pattern))
             {
+                keepFrameBuffer(memptr, memsize);
                 LOG_ERROR("Exposure failed to parse raw image.");
-                unlink(tmpfile);
                 return false;
             }
 
@@ -639,8 +684,9 @@ bool PkTriggerCordCCD::grabImage()
         PrimaryCCD.setResolution(w, h);
         PrimaryCCD.setNAxis(naxis);
         PrimaryCCD.setBPP(bpp);
+        guard.unlock();
 
-        if (preserveOriginalS[1].s == ISS_ON)
+        if (options.preserveOriginal)
         {
             char ts[32];
             struct tm * tp;
@@ -648,54 +694,48 @@ bool PkTriggerCordCCD::grabImage()
             time(&t);
             tp = localtime(&t);
             strftime(ts, sizeof(ts), "%Y-%m-%dT%H-%M-%S", tp);
-            std::string prefix = getUploadFilePrefix();
-            prefix = std::regex_replace(prefix, std::regex("XXX"), string(ts));
+            std::string prefix = std::regex_replace(options.uploadPrefix, std::regex("XXX"), string(ts));
             char newname[255];
-            snprintf(newname, 255, "%s.%s", prefix.c_str(), getFormatFileExtension(uff));
-            if (std::rename(tmpfile, newname))
+            snprintf(newname, 255, "%s.%s", prefix.c_str(), getFormatFileExtension(options.format));
+            FILE* f = fopen(newname, "wb");
+            if (f == nullptr || fwrite(downloadBuffer.data(), 1, downloadBuffer.size(), f) != downloadBuffer.size())
             {
-                LOGF_ERROR("File system error prevented saving original image to %s.  Saved to %s instead.", newname, tmpfile);
+                LOGF_ERROR("File system error prevented saving original image to %s.", newname);
             }
             else
             {
                 LOGF_INFO("Saved original image to %s.", newname);
             }
-        }
-        else
-        {
-            std::remove(tmpfile);
+            if (f != nullptr)
+            {
+                fclose(f);
+            }
         }
 
     }
     // native handling code
     else
     {
-        PrimaryCCD.setImageExtension(getFormatFileExtension(uff));
-
-        FILE* f = fopen(tmpfile, "r");
-        fseek(f, 0, SEEK_END);
-        size_t size = ftell(f);
-        rewind(f);
-
-        PrimaryCCD.setFrameBufferSize(size);
-        char * memptr = (char *)PrimaryCCD.getFrameBuffer();
-        size_t readSize = fread(memptr, sizeof(char), size, f);
-        if (readSize != size)
-        {
-            LOGF_ERROR("Error, %u bytes of data read instead of %u.", readSize, size);
-        }
-        PrimaryCCD.setFrameBuffer((unsigned char *)memptr);
-        fclose(f);
-        LOG_DEBUG("Copied to frame buffer.  Leaving temp file for debug purposes.");
-        if (!isDebug())
-        {
-            std::remove(tmpfile);
-        }
+        std::unique_lock<std::mutex> guard(ccdBufferLock);
+        PrimaryCCD.setImageExtension(getFormatFileExtension(options.format));
+        PrimaryCCD.setFrameBufferSize(downloadBuffer.size());
+        memcpy(PrimaryCCD.getFrameBuffer(), downloadBuffer.data(), downloadBuffer.size());
+        LOG_DEBUG("Copied to frame buffer.");
     }
 
     return true;
 }
 
+// The decoders reallocate the frame buffer before they can fail, so the chip must not keep the old pointer
+void PkTriggerCordCCD::keepFrameBuffer(uint8_t *memptr, size_t memsize)
+{
+    if (memptr != nullptr && memptr != PrimaryCCD.getFrameBuffer())
+    {
+        PrimaryCCD.setFrameBuffer(memptr);
+        PrimaryCCD.setFrameBufferSize(memsize, false);
+    }
+}
+
 
 ISwitch * PkTriggerCordCCD::create_switch(const char * basestr, string options[], size_t numOptions, int setidx)
 {
@@ -744,6 +784,12 @@ bool PkTriggerCordCCD::ISNewSwitch(const char * dev, const char * name, ISState
         }
     }
     */
+    else if (!strcmp(name, fastDownloadSP.name))
+    {
+        IUUpdateSwitch(&fastDownloadSP, states, names, n);
+        fastDownloadSP.s = IPS_OK;
+        IDSetSwitch(&fastDownloadSP, nullptr);
+    }
     else if (!strcmp(name, preserveOriginalSP.name))
     {
         IUUpdateSwitch(&preserveOriginalSP, states, names, n);
@@ -828,6 +874,8 @@ bool PkTriggerCordCCD::saveConfigItems(FILE * fp)
         if (sw->nsp > 0) IUSaveConfigSwitch(fp, sw);
     }
 
+    IUSaveConfigSwitch(fp, &fastDownloadSP);
+
     // Save regular CCD properties
     return INDI::CCD::saveConfigItems(fp);
 }
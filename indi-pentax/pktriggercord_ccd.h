@@ -26,6 +26,7 @@
 #include <unistd.h>
 #include <regex>
 #include <future>
+#include <vector>
 
 #include "config.h"
 #include "eventloop.h"
@@ -69,7 +70,6 @@ protected:
     pslr_handle_t device;
     pslr_status status;
     user_file_format uff;
-    int quality;
     bool InDownload, need_bulb_new_cleanup;
     bool bufferIsBayered;
 
@@ -97,6 +97,9 @@ protected:
     ISwitch autoFocusS[2];
     ISwitchVectorProperty autoFocusSP;
 
+    ISwitch fastDownloadS[2];
+    ISwitchVectorProperty fastDownloadSP;
+
     ISwitch * create_switch(const char * basestr, string options[], size_t numOptions, int setidx);
 
     IText DeviceInfoT[6] {};
@@ -115,7 +118,8 @@ protected:
                             char *formats[], char *names[], int n);
 
     void updateCaptureSettingSwitch(ISwitchVectorProperty *sw, ISState *states, char *names[], int n);
-    bool grabImage();
+    bool grabImage(const CaptureOptions &options);
+    void keepFrameBuffer(uint8_t *memptr, size_t memsize);
     string getUploadFilePrefix();
     const char * getFormatFileExtension(user_file_format format);
     void refreshBatteryStatus();
@@ -123,8 +127,22 @@ protected:
     void deleteCaptureSwitches();
     void buildCaptureSettingSwitch(ISwitchVectorProperty *control, string optionList[], size_t numOptions, const char *label, const char *name, string currentsetting = "");
 
-    bool shutterPress(pslr_rational_t shutter_speed);
+    // Settings an exposure is downloaded and saved with, taken when it starts so the capture
+    // thread does not read properties the client changes in the meantime
+    struct CaptureOptions
+    {
+        user_file_format format;
+        bool fits;
+        bool preserveOriginal;
+        string uploadPrefix;
+    };
+
+    bool shutterPress(pslr_rational_t shutter_speed, user_file_format format);
+    bool downloadImage(user_file_format format);
+    bool captureImage(pslr_rational_t shutter_speed, CaptureOptions options);
     std::future<bool> shutter_result;
+    // Image file as downloaded from the camera, decoded by grabImage on the capture thread
+    std::vector<uint8_t> downloadBuffer;
 };
 
 #endif // PKTRIGGERCORD_CCD_H
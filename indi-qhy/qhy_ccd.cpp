@@ -1520,13 +1520,19 @@ int QHYCCD::grabImage()
     std::unique_lock<std::mutex> guard(ccdBufferLock);
     if (isSimulation())
     {
-        uint8_t *image = PrimaryCCD.getFrameBuffer();
-        int width      = PrimaryCCD.getSubW() / PrimaryCCD.getBinX() * PrimaryCCD.getBPP() / 8;
-        int height     = PrimaryCCD.getSubH() / PrimaryCCD.getBinY();
-
-        for (int i = 0; i < height; i++)
-            for (int j = 0; j < width; j++)
-                image[i * width + j] = rand() % 255;
+        SynthFrame::Params params;
+        params.sensorWidth  = PrimaryCCD.getXRes();
+        params.sensorHeight = PrimaryCCD.getYRes();
+        params.subX         = PrimaryCCD.getSubX();
+        params.subY         = PrimaryCCD.getSubY();
+        params.subW         = PrimaryCCD.getSubW();
+        params.subH         = PrimaryCCD.getSubH();
+        params.binX         = PrimaryCCD.getBinX();
+        params.binY         = PrimaryCCD.getBinY();
+        params.bpp          = PrimaryCCD.getBPP();
+        params.frameType    = static_cast<SynthFrame::FrameType>(PrimaryCCD.getFrameType());
+        params.exposure     = m_ExposureRequest;
+        m_SimGenerator.render(params, PrimaryCCD.getFrameBuffer());
     }
     else
     {
@@ -24,6 +24,7 @@
 #include <qhyccd.h>
 #include <indiccd.h>
 #include <indifilterinterface.h>
+#include <synthframe.h>
 #include <unistd.h>
 #include <functional>
 #include <pthread.h>
@@ -466,6 +467,8 @@ class QHYCCD : public INDI::CCD, public INDI::FilterInterface
         // Last exposure request in microseconds
         uint32_t m_LastExposureRequestuS;
         struct timeval ExpStart;
+        // Frame source in simulation mode
+        SynthFrame::Generator m_SimGenerator;
         // Gain
         double m_LastGainRequest = 1e6;
         // Filter Wheel Timeout
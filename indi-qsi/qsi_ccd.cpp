@@ -63,6 +63,7 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110 - 1301  USA
 #include <netdb.h>
 #include <zlib.h>
 
+#include <algorithm>
 #include <memory>
 
 #include <fitsio.h>
@@ -72,6 +73,8 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110 - 1301  USA
 #include "indidevapi.h"
 #include "eventloop.h"
 #include "indicom.h"
+#include "fitstime.h"
+#include "indielapsedtimer.h"
 #include "qsi_ccd.h"
 #include "config.h"
 
@@ -163,6 +166,11 @@ bool QSICCD::initProperties()
     IUFillSwitchVector(&ABSP, ABS, 2, getDeviceName(), "AntiBlooming", "", OPTIONS_TAB, IP_RW, ISR_1OFMANY, 60,
                        IPS_IDLE);
 
+    IUFillNumber(&FrameTimingN[TIMING_READOUT], "READOUT", "Readout (s)", "%.3f", 0, 3600, 0, 0);
+    IUFillNumber(&FrameTimingN[TIMING_DEAD_TIME], "DEAD_TIME", "Dead time (s)", "%.3f", 0, 86400, 0, 0);
+    IUFillNumberVector(&FrameTimingNP, FrameTimingN, 2, getDeviceName(), "CCD_FRAME_TIMING", "Frame Timing", IMAGE_INFO_TAB,
+                       IP_RO, 60, IPS_IDLE);
+
     INDI::FilterInterface::initProperties(FILTER_TAB);
 
     addDebugControl();
@@ -181,6 +189,7 @@ bool QSICCD::updateProperties()
         defineProperty(&CoolerSP);
         defineProperty(&ShutterSP);
         defineProperty(&CoolerNP);
+        defineProperty(&FrameTimingNP);
 
         setupParams();
 
@@ -198,6 +207,7 @@ bool QSICCD::updateProperties()
         deleteProperty(CoolerSP.name);
         deleteProperty(ShutterSP.name);
         deleteProperty(CoolerNP.name);
+        deleteProperty(FrameTimingNP.name);
 
         if (canSetGain)
             deleteProperty(GainSP.name);
@@ -703,6 +713,16 @@ bool QSICCD::ISNewNumber(const char *dev, const char *name, double values[], cha
 
 bool QSICCD::StartExposure(float duration)
 {
+    // The camera can be armed again as soon as the previous frame is read out,
+    // its upload carries on in the background.
+    if (m_ReadoutActive)
+    {
+        LOG_ERROR("Previous frame is still being read out.");
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(m_CameraLock);
+
     imageFrameType = PrimaryCCD.getFrameType();
 
     if (imageFrameType == INDI::CCDChip::BIAS_FRAME)
@@ -758,14 +778,36 @@ bool QSICCD::StartExposure(float duration)
     gettimeofday(&ExpStart, nullptr);
     LOGF_DEBUG("Taking a %g seconds frame...", ExposureRequest);
 
+    m_ExposureInfo.duration  = ExposureRequest;
+    m_ExposureInfo.start     = ExpStart;
+    m_ExposureInfo.frameType = imageFrameType;
+    m_ExposureInfo.binX      = PrimaryCCD.getBinX();
+
+    auto now = std::chrono::steady_clock::now();
+    if (m_HasExposureEnd)
+    {
+        FrameTimingN[TIMING_DEAD_TIME].value = std::chrono::duration<double>(now - m_ExposureEnd).count();
+        FrameTimingNP.s = IPS_OK;
+        IDSetNumber(&FrameTimingNP, nullptr);
+        LOGF_DEBUG("Dead time since the last exposure: %.3f seconds.", FrameTimingN[TIMING_DEAD_TIME].value);
+    }
+    m_ExposureEnd = now + std::chrono::microseconds(static_cast<long>(ExposureRequest * 1e6));
+    m_HasExposureEnd = true;
+
     InExposure = true;
     return true;
 }
 
 bool QSICCD::AbortExposure()
 {
+    m_ReadoutWorker.quit();
+    m_ReadoutActive = false;
+    // Aborted frames say nothing about the dead time of a sequence.
+    m_HasExposureEnd = false;
+
     if (canAbort)
     {
+        std::lock_guard<std::mutex> lock(m_CameraLock);
         try
         {
             QSICam.AbortExposure();
@@ -801,6 +843,13 @@ bool QSICCD::UpdateCCDFrame(int x, int y, int w, int h)
 {
     char errmsg[ERRMSG_SIZE];
 
+    // The frame in flight is published with the chip geometry, which must match it.
+    if (m_ReadoutActive || m_UploadPending)
+    {
+        LOG_ERROR("Cannot change the subframe while a frame is being downloaded.");
+        return false;
+    }
+
     /* Add the X and Y offsets */
     long x_1 = x / PrimaryCCD.getBinX();
     long y_1 = y / PrimaryCCD.getBinY();
@@ -850,6 +899,12 @@ bool QSICCD::UpdateCCDFrame(int x, int y, int w, int h)
 
 bool QSICCD::UpdateCCDBin(int binx, int biny)
 {
+    if (m_ReadoutActive || m_UploadPending)
+    {
+        LOG_ERROR("Cannot change the binning while a frame is being downloaded.");
+        return false;
+    }
+
     try
     {
         QSICam.put_BinX(binx);
@@ -877,57 +932,148 @@ bool QSICCD::UpdateCCDBin(int binx, int biny)
 
 /* Downloads the image from the CCD.
  N.B. No processing is done on the image */
-int QSICCD::grabImage()
+void QSICCD::workerReadout(const std::atomic_bool &isAboutToQuit)
 {
-    unsigned short *image = (unsigned short *)PrimaryCCD.getFrameBuffer();
+    auto &buffer = m_ReadoutBuffers[m_ReadoutIndex];
+    auto &info = m_ReadoutInfo[m_ReadoutIndex];
+    INDI::ElapsedTimer readoutTimer;
+
+    // StartExposure may run again as soon as the readout finishes.
+    info = m_ExposureInfo;
 
     int x, y, z;
-    try
     {
-        bool imageReady = false;
-        QSICam.get_ImageReady(&imageReady);
-        while (!imageReady)
+        std::lock_guard<std::mutex> lock(m_CameraLock);
+        try
         {
-            usleep(500);
+            bool imageReady = false;
             QSICam.get_ImageReady(&imageReady);
+            while (!imageReady)
+            {
+                if (isAboutToQuit)
+                    return;
+                usleep(1000);
+                QSICam.get_ImageReady(&imageReady);
+            }
+
+            QSICam.get_ImageArraySize(x, y, z);
+            buffer.resize(static_cast<size_t>(x) * y);
+            QSICam.get_ImageArray(buffer.data());
+        }
+        catch (std::runtime_error &err)
+        {
+            LOGF_ERROR("get_ImageArray() failed. %s.", err.what());
+            m_ReadoutActive = false;
+            PrimaryCCD.setExposureFailed();
+            return;
         }
 
-        QSICam.get_ImageArraySize(x, y, z);
-        QSICam.get_ImageArray(image);
-        imageWidth  = x;
-        imageHeight = y;
-    }
-    catch (std::runtime_error &err)
-    {
-        LOGF_ERROR("get_ImageArray() failed. %s.", err.what());
-        return -1;
+        try
+        {
+            QSICam.get_ElectronsPerADU(&info.electronsPerADU);
+            info.hasElectronsPerADU = true;
+        }
+        catch (std::runtime_error &err)
+        {
+            LOGF_ERROR("get_ElectronsPerADU failed. %s.", err.what());
+            info.hasElectronsPerADU = false;
+        }
     }
 
+    imageWidth  = x;
+    imageHeight = y;
+    info.width  = x;
+    info.height = y;
+
+    FrameTimingN[TIMING_READOUT].value = readoutTimer.elapsed() / 1000.0;
+    IDSetNumber(&FrameTimingNP, nullptr);
+
+    int index = m_ReadoutIndex;
+    m_ReadoutIndex ^= 1;
+    m_UploadPending = true;
+    m_ReadoutActive = false;
+
     LOG_INFO("Download complete.");
 
+    // Waits for the previous upload, which only holds the other buffer.
+    m_UploadWorker.start(std::bind(&QSICCD::workerUpload, this, std::placeholders::_1, index));
+}
+
+void QSICCD::workerUpload(const std::atomic_bool &isAboutToQuit, int index)
+{
+    INDI_UNUSED(isAboutToQuit);
+
+    const FrameInfo &info = m_ReadoutInfo[index];
+    {
+        std::lock_guard<std::mutex> guard(ccdBufferLock);
+        const auto &buffer = m_ReadoutBuffers[index];
+        size_t size = buffer.size() * sizeof(unsigned short);
+        int width = PrimaryCCD.getSubW() / PrimaryCCD.getBinX();
+        int height = PrimaryCCD.getSubH() / PrimaryCCD.getBinY();
+        if (info.width != width || info.height != height || size > static_cast<size_t>(PrimaryCCD.getFrameBufferSize()))
+        {
+            LOGF_ERROR("Downloaded frame is %dx%d but the subframe is %dx%d, dropping it.", info.width, info.height,
+                       width, height);
+            m_UploadPending = false;
+            PrimaryCCD.setExposureFailed();
+            return;
+        }
+        memcpy(PrimaryCCD.getFrameBuffer(), buffer.data(), size);
+    }
+
+    m_UploadInfo = info;
     ExposureComplete(&PrimaryCCD);
+    m_UploadPending = false;
 
-    return 0;
+    // ExposureComplete marks the exposure done, but the next one may already be running.
+    bool exposing;
+    float timeLeft = 0;
+    {
+        std::lock_guard<std::mutex> lock(m_CameraLock);
+        exposing = InExposure;
+        if (exposing)
+            timeLeft = CalcTimeLeft(ExpStart, ExposureRequest);
+    }
+    if (exposing)
+        PrimaryCCD.setExposureLeft(timeLeft);
 }
 
 void QSICCD::addFITSKeywords(INDI::CCDChip *targetChip, std::vector<INDI::FITSRecord> &fitsKeywords)
 {
     INDI::CCD::addFITSKeywords(targetChip, fitsKeywords);
 
-    double electronsPerADU;
+    // The chip already holds the settings of the next exposure, use those the frame was taken with.
+    const FrameInfo &info = m_UploadInfo;
 
-    try
+    const char *frameType = "Light";
+    switch (info.frameType)
     {
-        QSICam.get_ElectronsPerADU(&electronsPerADU);
+        case INDI::CCDChip::BIAS_FRAME:
+            frameType = "Bias";
+            break;
+        case INDI::CCDChip::DARK_FRAME:
+            frameType = "Dark";
+            break;
+        case INDI::CCDChip::FLAT_FRAME:
+            frameType = "Flat Field";
+            break;
+        default:
+            break;
     }
-    catch (std::runtime_error &err)
-    {
-        LOGF_ERROR("get_ElectronsPerADU failed. %s.", err.what());
+
+    // The base class filled these from the live exposure settings.
+    FITSTime::replaceRecord(fitsKeywords, INDI::FITSRecord("EXPTIME", info.duration, 6, "Total Exposure Time (s)"));
+    FITSTime::replaceRecord(fitsKeywords, INDI::FITSRecord("DATE-OBS", FITSTime::isoTimestamp(info.start).c_str(),
+                            "UTC start date of observation"));
+    FITSTime::replaceRecord(fitsKeywords, INDI::FITSRecord("IMAGETYP", frameType, "Frame Type"));
+
+    if (!info.hasElectronsPerADU)
         return;
-    }
+
+    double electronsPerADU = info.electronsPerADU;
 
     // 2017-09-17 JM: electronsPerADU is wrong in auto mode. So we have to change it manually here.
-    if (IUFindOnSwitchIndex(&GainSP) == GAIN_AUTO && PrimaryCCD.getBinX() > 1)
+    if (IUFindOnSwitchIndex(&GainSP) == GAIN_AUTO && info.binX > 1)
         electronsPerADU = 1.1;
 
     fitsKeywords.push_back({"EPERADU", electronsPerADU, 3, "Electrons per ADU"});
@@ -1038,6 +1184,12 @@ bool QSICCD::Disconnect()
 {
     bool connected;
 
+    m_ReadoutWorker.quit();
+    m_UploadWorker.quit();
+    m_ReadoutActive = false;
+    m_UploadPending = false;
+    m_HasExposureEnd = false;
+
     try
     {
         QSICam.get_Connected(&connected);
@@ -1216,26 +1368,20 @@ void QSICCD::TimerHit()
 
     if (InExposure)
     {
-        bool imageReady;
-
         timeleft = CalcTimeLeft(ExpStart, ExposureRequest);
 
         if (timeleft < 1)
         {
-            QSICam.get_ImageReady(&imageReady);
-
-            while (!imageReady)
-            {
-                usleep(100);
-                QSICam.get_ImageReady(&imageReady);
-            }
-
-            /* We're done exposing */
+            /* We're done exposing, the readout worker waits for the image */
             LOG_INFO("Exposure done, downloading image...");
             PrimaryCCD.setExposureLeft(0);
-            InExposure = false;
-            /* grab and save image */
-            grabImage();
+            {
+                // The upload thread looks at InExposure under the camera lock.
+                std::lock_guard<std::mutex> lock(m_CameraLock);
+                InExposure = false;
+            }
+            m_ReadoutActive = true;
+            m_ReadoutWorker.start(std::bind(&QSICCD::workerReadout, this, std::placeholders::_1));
         }
         else
         {
@@ -1243,6 +1389,14 @@ void QSICCD::TimerHit()
         }
     }
 
+    // Skip polling while the camera is busy reading out.
+    std::unique_lock<std::mutex> lock(m_CameraLock, std::try_to_lock);
+    if (!lock.owns_lock())
+    {
+        SetTimer(getCurrentPollingPeriod());
+        return;
+    }
+
     switch (TemperatureNP.s)
     {
         case IPS_IDLE:
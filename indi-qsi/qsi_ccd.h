@@ -35,7 +35,13 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
 #include <indiccd.h>
 #include <indiguiderinterface.h>
 #include <indifilterinterface.h>
+#include <indisinglethreadpool.h>
+#include <array>
+#include <atomic>
+#include <chrono>
 #include <iostream>
+#include <mutex>
+#include <vector>
 
 using namespace std;
 
@@ -105,6 +111,10 @@ protected:
     ISwitch ABS[2];
     ISwitchVectorProperty ABSP;
 
+    INumber FrameTimingN[2];
+    INumberVectorProperty FrameTimingNP;
+    enum { TIMING_READOUT, TIMING_DEAD_TIME };
+
 private:
 
     QSICamera QSICam;
@@ -127,7 +137,40 @@ private:
     // Image Data
     int imageWidth, imageHeight;
     INDI::CCDChip::CCD_FRAME imageFrameType;
-    int grabImage();
+
+    // Readout and upload run on their own threads. Frames are read into alternating
+    // buffers, so the next exposure can be armed while the previous frame is uploaded.
+    INDI::SingleThreadPool m_ReadoutWorker;
+    INDI::SingleThreadPool m_UploadWorker;
+    void workerReadout(const std::atomic_bool &isAboutToQuit);
+    void workerUpload(const std::atomic_bool &isAboutToQuit, int index);
+    std::array<std::vector<unsigned short>, 2> m_ReadoutBuffers;
+    int m_ReadoutIndex = 0;
+    std::atomic_bool m_ReadoutActive {false};
+    // Set from the end of the readout until the frame is uploaded, the subframe and binning
+    // of the chip must not change before ExposureComplete.
+    std::atomic_bool m_UploadPending {false};
+    // Serializes camera access between the readout thread and the main thread.
+    std::mutex m_CameraLock;
+    // Settings a frame was taken with, the camera may be exposing again while it is uploaded.
+    struct FrameInfo
+    {
+        double duration = 0;
+        timeval start {};
+        INDI::CCDChip::CCD_FRAME frameType = INDI::CCDChip::LIGHT_FRAME;
+        int binX = 1;
+        int width = 0;
+        int height = 0;
+        double electronsPerADU = 0;
+        bool hasElectronsPerADU = false;
+    };
+    // The armed exposure, each readout buffer and the frame being uploaded.
+    FrameInfo m_ExposureInfo;
+    std::array<FrameInfo, 2> m_ReadoutInfo;
+    FrameInfo m_UploadInfo;
+    // End of the last exposure, for the dead time until the next one starts.
+    std::chrono::steady_clock::time_point m_ExposureEnd;
+    bool m_HasExposureEnd = false;
 
     // Timers
     int timerID;
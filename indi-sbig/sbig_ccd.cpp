@@ -52,6 +52,8 @@
 #define MAX_DEVICES         20   /* Max device cameraCount */
 #define MAX_THREAD_RETRIES  3
 #define MAX_THREAD_WAIT     300000
+#define READOUT_LINE_BATCH  32   /* Lines read between checks for a pending guide frame */
+#define GUIDE_END_WAIT_MS   2000 /* Wait for a guide exposure queued on elapsed time to end */
 
 static class Loader
 {
@@ -306,6 +308,7 @@ SBIGCCD::SBIGCCD() : FilterInterface(this)
 
 SBIGCCD::~SBIGCCD()
 {
+    stopReadoutThread();
     CloseDevice();
     CloseDriver();
 }
@@ -383,6 +386,14 @@ bool SBIGCCD::initProperties()
     IUFillSwitchVector(&IgnoreErrorsSP, IgnoreErrorsS, 1, getDeviceName(), "CCD_IGNORE_ERRORS", "Ignore", OPTIONS_TAB, IP_RW,
                        ISR_NOFMANY, 0, IPS_OK);
 
+    // Readout statistics
+    IUFillNumber(&ReadoutStatsN[READOUT_PRIMARY_TIME], "PRIMARY_READOUT", "Primary readout (ms)", "%.f", 0, 1e6, 0, 0);
+    IUFillNumber(&ReadoutStatsN[READOUT_PRIMARY_DELAY], "PRIMARY_DELAY", "Primary queued (ms)", "%.f", 0, 1e6, 0, 0);
+    IUFillNumber(&ReadoutStatsN[READOUT_GUIDE_TIME], "GUIDE_READOUT", "Guide readout (ms)", "%.f", 0, 1e6, 0, 0);
+    IUFillNumber(&ReadoutStatsN[READOUT_GUIDE_DELAY], "GUIDE_DELAY", "Guide queued (ms)", "%.f", 0, 1e6, 0, 0);
+    IUFillNumberVector(&ReadoutStatsNP, ReadoutStatsN, 4, getDeviceName(), "CCD_READOUT_STATS", "Readout", IMAGE_INFO_TAB,
+                       IP_RO, 0, IPS_IDLE);
+
     // CFW PRODUCT
     IUFillText(&FilterProdcutT[0], "NAME", "Name", "");
     IUFillText(&FilterProdcutT[1], "ID", "ID", "");
@@ -530,6 +541,7 @@ bool SBIGCCD::updateProperties()
             defineProperty(&CoolerNP);
         }
         defineProperty(&IgnoreErrorsSP);
+        defineProperty(&ReadoutStatsNP);
         if (m_hasFilterWheel)
         {
             defineProperty(&FilterConnectionSP);
@@ -572,6 +584,7 @@ bool SBIGCCD::updateProperties()
             deleteProperty(CoolerNP.name);
         }
         deleteProperty(IgnoreErrorsSP.name);
+        deleteProperty(ReadoutStatsNP.name);
 
         if (m_hasAO)
         {
@@ -895,6 +908,8 @@ bool SBIGCCD::Connect()
 
     m_hasAO = AoCenter() == CE_NO_ERROR;
 
+    startReadoutThread();
+
     return true;
 }
 
@@ -902,15 +917,9 @@ bool SBIGCCD::Disconnect()
 {
     if (!isConnected())
         return true;
+    stopReadoutThread();
     m_useExternalTrackingCCD = false;
     m_hasGuideHead           = false;
-#ifdef ASYNC_READOUT
-    pthread_mutex_lock(&condMutex);
-    grabPredicate   = GRAB_PRIMARY_CCD;
-    terminateThread = true;
-    pthread_cond_signal(&cv);
-    pthread_mutex_unlock(&condMutex);
-#endif
     if (FilterConnectionS[0].s == ISS_ON)
         CFWDisconnect();
     if (CloseDevice() == CE_NO_ERROR)
@@ -1184,6 +1193,7 @@ int SBIGCCD::AbortExposure(INDI::CCDChip *targetChip)
     {
         ccd = m_useExternalTrackingCCD ? CCD_EXT_TRACKING : CCD_TRACKING;
     }
+    cancelReadout(targetChip);
     EndExposureParams eep;
     eep.ccd = ccd;
     std::unique_lock<std::mutex> guard(sbigLock);
@@ -1409,41 +1419,7 @@ IPState SBIGCCD::GuideWest(uint32_t ms)
     return (ActivateRelay(&rp) == CE_NO_ERROR ? IPS_BUSY : IPS_ALERT);
 }
 
-#ifdef ASYNC_READOUT
-void *SBIGCCD::grabCCDHelper(void *context)
-{
-    return ((SBIGCCD *)context)->grabCCD();
-}
-
-void *SBIGCCD::grabCCD()
-{
-    LOG_DEBUG("grabCCD thread started...");
-    INDI::CCDChip *targetChip = nullptr;
-    pthread_mutex_lock(&condMutex);
-    while (true)
-    {
-        while (grabPredicate == GRAB_NO_CCD)
-        {
-            pthread_cond_wait(&cv, &condMutex);
-        }
-        targetChip    = (grabPredicate == GRAB_PRIMARY_CCD) ? &PrimaryCCD : &GuideCCD;
-        grabPredicate = GRAB_NO_CCD;
-        if (terminateThread)
-            break;
-        pthread_mutex_unlock(&condMutex);
-        if (grabImage(targetChip) == false)
-        {
-            targetChip->setExposureFailed();
-        }
-        pthread_mutex_lock(&condMutex);
-    }
-    pthread_mutex_unlock(&condMutex);
-    LOG_DEBUG("grabCCD thread finished");
-    return 0;
-}
-#endif
-
-bool SBIGCCD::grabImage(INDI::CCDChip *targetChip)
+bool SBIGCCD::grabImage(INDI::CCDChip *targetChip, bool lockHeld)
 {
     uint16_t left   = targetChip->getSubX() / targetChip->getBinX();
     uint16_t top    = targetChip->getSubY() / targetChip->getBinX();
@@ -1454,14 +1430,20 @@ bool SBIGCCD::grabImage(INDI::CCDChip *targetChip)
 
     if (isSimulation())
     {
-        uint8_t *image = targetChip->getFrameBuffer();
-        for (int i = 0; i < height * 2; i++)
-        {
-            for (int j = 0; j < width; j++)
-            {
-                image[i * width + j] = rand() % 255;
-            }
-        }
+        SynthFrame::Params params;
+        params.sensorWidth  = targetChip->getXRes();
+        params.sensorHeight = targetChip->getYRes();
+        params.subX         = targetChip->getSubX();
+        params.subY         = targetChip->getSubY();
+        params.subW         = targetChip->getSubW();
+        params.subH         = targetChip->getSubH();
+        params.binX         = targetChip->getBinX();
+        params.binY         = targetChip->getBinY();
+        params.bpp          = targetChip->getBPP();
+        params.frameType    = static_cast<SynthFrame::FrameType>(targetChip->getFrameType());
+        params.exposure     = targetChip->getExposureDuration();
+        params.seed         = targetChip == &PrimaryCCD ? 1 : 2;
+        m_SimGenerator.render(params, targetChip->getFrameBuffer());
     }
     else
     {
@@ -1469,12 +1451,14 @@ bool SBIGCCD::grabImage(INDI::CCDChip *targetChip)
         int res                = 0;
         for (int i = 0; i < MAX_THREAD_RETRIES; i++)
         {
-            res = readoutCCD(left, top, width, height, buffer, targetChip);
-            if (res == CE_NO_ERROR)
+            res = readoutCCD(left, top, width, height, buffer, targetChip, lockHeld);
+            if (res == CE_NO_ERROR || res == CE_KBD_ESC)
                 break;
             LOGF_DEBUG("Readout error, retrying...", res);
             usleep(MAX_THREAD_WAIT);
         }
+        if (res == CE_KBD_ESC)
+            return false;
         if (res != CE_NO_ERROR)
         {
             LOGF_ERROR("%s readout error",
@@ -1518,11 +1502,10 @@ void SBIGCCD::TimerHit()
         double timeLeft = std::max(0.0, ExposureRequest - elapsed.count());
         if (isExposureDone(targetChip))
         {
-            LOG_DEBUG("Primay camera exposure done, downloading image...");
+            LOG_DEBUG("Primay camera exposure done, queuing readout...");
             targetChip->setExposureLeft(0);
             InExposure = false;
-            if (grabImage(targetChip) == false)
-                targetChip->setExposureFailed();
+            queueReadout(targetChip);
         }
         else
         {
@@ -1538,11 +1521,10 @@ void SBIGCCD::TimerHit()
         double timeLeft = std::max(0.0, GuideExposureRequest - elapsed.count());
         if (isExposureDone(targetChip))
         {
-            LOG_DEBUG("Guide head exposure done, downloading image...");
+            LOG_DEBUG("Guide head exposure done, queuing readout...");
             targetChip->setExposureLeft(0);
             InGuideExposure = false;
-            if (grabImage(targetChip) == false)
-                targetChip->setExposureFailed();
+            queueReadout(targetChip);
         }
         else
         {
@@ -1768,7 +1750,10 @@ double SBIGCCD::CalcTemperature(short thermistorType, short setpoint)
 
 int SBIGCCD::ActivateRelay(ActivateRelayParams *arp)
 {
+    // Waits for a readout in progress to end
+    std::unique_lock<std::mutex> guard(sbigLock);
     int res = SBIGUnivDrvCommand(CC_ACTIVATE_RELAY, arp, nullptr);
+    guard.unlock();
     if (res != CE_NO_ERROR)
     {
         LOGF_ERROR("%s: CC_ACTIVATE_RELAY -> (%s)", __FUNCTION__, GetErrorString(res));
@@ -2520,7 +2505,13 @@ void SBIGCCD::updateTemperature()
     bool enabled;
     double ccdTemp, setpointTemp, percentTE, power;
 
-    std::unique_lock<std::mutex> guard(sbigLock);
+    // Skip this poll rather than stall the main loop for the rest of a readout
+    std::unique_lock<std::mutex> guard(sbigLock, std::try_to_lock);
+    if (!guard.owns_lock())
+    {
+        IEAddTimer(TEMPERATURE_POLL_MS, SBIGCCD::updateTemperatureHelper, this);
+        return;
+    }
     int res = QueryTemperatureStatus(enabled, ccdTemp, setpointTemp, percentTE);
     guard.unlock();
 
@@ -2604,17 +2595,37 @@ bool SBIGCCD::isExposureDone(INDI::CCDChip *targetChip)
         ccd = m_useExternalTrackingCCD ? CCD_EXT_TRACKING : CCD_TRACKING;
     }
 
+    std::unique_lock<std::mutex> guard(sbigLock, std::try_to_lock);
+    if (!guard.owns_lock())
+    {
+        // The primary CCD is being read out. A guide frame that is due is queued anyway,
+        // the readout thread ends its exposure before reading it between imaging lines.
+        // Anything else is asked again on the next timer tick.
+        if (targetChip == &GuideCCD && canInterleaveGuideReadout())
+        {
+            std::chrono::duration<double> elapsed = std::chrono::system_clock::now() - GuideExpStart;
+            if (elapsed.count() >= GuideExposureRequest)
+            {
+                m_GuideEndExposurePending = true;
+                return true;
+            }
+        }
+        return false;
+    }
+    return endExposureIfDone(ccd);
+}
+
+bool SBIGCCD::endExposureIfDone(int ccd)
+{
     EndExposureParams eep;
     QueryCommandStatusParams qcsp;
     QueryCommandStatusResults qcsr;
 
     // Query command status:
     qcsp.command = CC_START_EXPOSURE2;
-    std::unique_lock<std::mutex> guard(sbigLock);
     int res = QueryCommandStatus(&qcsp, &qcsr);
     if (res != CE_NO_ERROR)
     {
-        guard.unlock();
         return false;
     }
 
@@ -2627,22 +2638,19 @@ bool SBIGCCD::isExposureDone(INDI::CCDChip *targetChip)
     // Check exposure progress:
     if ((qcsr.status & mask) != mask)
     {
-        // The exposure is still in progress, decrement an
-        // exposure time:
-        guard.unlock();
+        // The exposure is still in progress
         return false;
     }
     // Exposure done - update client's property:
     eep.ccd = ccd;
     EndExposure(&eep);
-    guard.unlock();
     return true;
 }
 
 //==========================================================================
 
 int SBIGCCD::readoutCCD(uint16_t left, uint16_t top, uint16_t width, uint16_t height,
-                        uint16_t *buffer, INDI::CCDChip *targetChip)
+                        uint16_t *buffer, INDI::CCDChip *targetChip, bool lockHeld)
 {
     int h, ccd, binning, res;
     if (targetChip == &PrimaryCCD)
@@ -2664,13 +2672,29 @@ int SBIGCCD::readoutCCD(uint16_t left, uint16_t top, uint16_t width, uint16_t he
     srp.top         = top;
     srp.width       = width;
     srp.height      = height;
-    std::unique_lock<std::mutex> guard(sbigLock);
+    // The driver is held from StartReadout to EndReadout, commands for the other chip,
+    // guide pulses and temperature queries wait for the end of the readout. An interleaved
+    // guide head readout runs on this thread and already holds it.
+    std::unique_lock<std::mutex> guard(sbigLock, std::defer_lock);
+    if (!lockHeld)
+        guard.lock();
+    if (targetChip == &GuideCCD && m_GuideEndExposurePending.exchange(false))
+    {
+        // Queued while the driver was busy, see isExposureDone
+        int wait;
+        for (wait = 0; wait < GUIDE_END_WAIT_MS && !endExposureIfDone(ccd); wait += 10)
+            usleep(10000);
+        if (wait >= GUIDE_END_WAIT_MS)
+        {
+            LOG_ERROR("Guide readoutCCD - exposure did not end!");
+            return CE_AD_TIMEOUT;
+        }
+    }
     res = StartReadout(&srp);
     if (res != CE_NO_ERROR)
     {
         LOGF_ERROR("%s readoutCCD - StartReadout error! (%s)",
                    (targetChip == &PrimaryCCD) ? "Primary" : "Guide", GetErrorString(res));
-        guard.unlock();
         return res;
     }
     ReadoutLineParams rlp;
@@ -2678,9 +2702,19 @@ int SBIGCCD::readoutCCD(uint16_t left, uint16_t top, uint16_t width, uint16_t he
     rlp.readoutMode = binning;
     rlp.pixelStart  = left;
     rlp.pixelLength = width;
+    bool interleave = (targetChip == &PrimaryCCD) && canInterleaveGuideReadout();
+    std::atomic_bool &cancel = (targetChip == &PrimaryCCD) ? m_PrimaryReadoutCancel : m_GuideReadoutCancel;
     for (h = 0; h < height; h++)
     {
+        if (cancel)
+        {
+            LOGF_DEBUG("%s readout cancelled at line %d of %d.",
+                       (targetChip == &PrimaryCCD) ? "Primary" : "Guide", h, height);
+            break;
+        }
         ReadoutLine(&rlp, buffer + (h * width), false);
+        if (interleave && (h + 1) % READOUT_LINE_BATCH == 0 && h + 1 < height)
+            serviceGuideReadout();
     }
     EndReadoutParams erp;
     erp.ccd = ccd;
@@ -2688,11 +2722,154 @@ int SBIGCCD::readoutCCD(uint16_t left, uint16_t top, uint16_t width, uint16_t he
     {
         LOGF_ERROR("%s readoutCCD - EndReadout error! (%s)",
                    (targetChip == &PrimaryCCD) ? "Primary" : "Guide", GetErrorString(res));
-        guard.unlock();
         return res;
     }
-    guard.unlock();
-    return res;
+    return cancel ? CE_KBD_ESC : CE_NO_ERROR;
+}
+
+//==========================================================================
+
+void SBIGCCD::startReadoutThread()
+{
+    std::lock_guard<std::mutex> lock(m_ReadoutMutex);
+    if (m_ReadoutThread.joinable())
+        return;
+    m_ReadoutTerminate      = false;
+    m_PrimaryReadoutPending = false;
+    m_GuideReadoutPending   = false;
+    m_ReadoutThread = std::thread(&SBIGCCD::readoutThread, this);
+}
+
+void SBIGCCD::stopReadoutThread()
+{
+    std::unique_lock<std::mutex> lock(m_ReadoutMutex);
+    if (!m_ReadoutThread.joinable())
+        return;
+    m_ReadoutTerminate = true;
+    m_ReadoutCV.notify_all();
+    lock.unlock();
+    m_ReadoutThread.join();
+}
+
+void SBIGCCD::queueReadout(INDI::CCDChip *targetChip)
+{
+    std::lock_guard<std::mutex> lock(m_ReadoutMutex);
+    if (targetChip == &PrimaryCCD)
+    {
+        m_PrimaryReadoutPending = true;
+        m_PrimaryReadoutCancel  = false;
+        m_PrimaryQueuedAt       = std::chrono::steady_clock::now();
+    }
+    else
+    {
+        m_GuideReadoutPending = true;
+        m_GuideReadoutCancel  = false;
+        m_GuideQueuedAt       = std::chrono::steady_clock::now();
+    }
+    m_ReadoutCV.notify_one();
+}
+
+void SBIGCCD::cancelReadout(INDI::CCDChip *targetChip)
+{
+    // A readout in progress stops at the next line
+    std::lock_guard<std::mutex> lock(m_ReadoutMutex);
+    if (targetChip == &PrimaryCCD)
+    {
+        m_PrimaryReadoutPending = false;
+        m_PrimaryReadoutCancel  = true;
+    }
+    else
+    {
+        m_GuideReadoutPending     = false;
+        m_GuideReadoutCancel      = true;
+        m_GuideEndExposurePending = false;
+    }
+}
+
+void SBIGCCD::readoutThread()
+{
+    LOG_DEBUG("Readout thread started...");
+    std::unique_lock<std::mutex> lock(m_ReadoutMutex);
+    while (true)
+    {
+        m_ReadoutCV.wait(lock, [this]
+        {
+            return m_ReadoutTerminate || m_PrimaryReadoutPending || m_GuideReadoutPending;
+        });
+        if (m_ReadoutTerminate)
+            break;
+
+        INDI::CCDChip *targetChip = nullptr;
+        std::chrono::steady_clock::time_point queuedAt;
+        // Guide head first, its frames are small and late guide frames cost tracking accuracy.
+        if (m_GuideReadoutPending)
+        {
+            targetChip            = &GuideCCD;
+            queuedAt              = m_GuideQueuedAt;
+            m_GuideReadoutPending = false;
+        }
+        else
+        {
+            targetChip              = &PrimaryCCD;
+            queuedAt                = m_PrimaryQueuedAt;
+            m_PrimaryReadoutPending = false;
+        }
+        lock.unlock();
+        processReadout(targetChip, queuedAt);
+        lock.lock();
+    }
+    LOG_DEBUG("Readout thread finished");
+}
+
+void SBIGCCD::processReadout(INDI::CCDChip *targetChip, std::chrono::steady_clock::time_point queuedAt, bool lockHeld)
+{
+    auto start = std::chrono::steady_clock::now();
+    bool rc = grabImage(targetChip, lockHeld);
+    auto end = std::chrono::steady_clock::now();
+
+    // After an abort, AbortExposure already reported the exposure state
+    bool cancelled = (targetChip == &PrimaryCCD) ? m_PrimaryReadoutCancel : m_GuideReadoutCancel;
+    if (rc == false && !cancelled)
+        targetChip->setExposureFailed();
+
+    double readoutMs = std::chrono::duration<double, std::milli>(end - start).count();
+    double delayMs   = std::chrono::duration<double, std::milli>(start - queuedAt).count();
+    if (targetChip == &PrimaryCCD)
+    {
+        ReadoutStatsN[READOUT_PRIMARY_TIME].value  = readoutMs;
+        ReadoutStatsN[READOUT_PRIMARY_DELAY].value = delayMs;
+    }
+    else
+    {
+        ReadoutStatsN[READOUT_GUIDE_TIME].value  = readoutMs;
+        ReadoutStatsN[READOUT_GUIDE_DELAY].value = delayMs;
+    }
+    ReadoutStatsNP.s = rc ? IPS_OK : IPS_ALERT;
+    IDSetNumber(&ReadoutStatsNP, nullptr);
+
+    LOGF_DEBUG("%s readout took %.f ms after %.f ms in queue.",
+               targetChip == &PrimaryCCD ? "Primary camera" : "Guide head", readoutMs, delayMs);
+}
+
+bool SBIGCCD::canInterleaveGuideReadout()
+{
+    // Only the built-in tracking CCD is read out between imaging CCD lines, as done
+    // for self-guiding. Frames from the external tracking CCD wait for the end of the
+    // imaging readout.
+    return m_hasGuideHead && !m_useExternalTrackingCCD && !isSimulation();
+}
+
+void SBIGCCD::serviceGuideReadout()
+{
+    std::unique_lock<std::mutex> lock(m_ReadoutMutex);
+    if (!m_GuideReadoutPending || m_ReadoutTerminate)
+        return;
+    std::chrono::steady_clock::time_point queuedAt = m_GuideQueuedAt;
+    m_GuideReadoutPending = false;
+    lock.unlock();
+
+    LOG_DEBUG("Interleaving guide head readout with primary camera readout...");
+    processReadout(&GuideCCD, queuedAt, true);
 }
 
 //==========================================================================
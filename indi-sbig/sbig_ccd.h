@@ -29,6 +29,7 @@
 
 #include <indiccd.h>
 #include <indifilterinterface.h>
+#include <synthframe.h>
 
 #ifdef __APPLE__
 #include <libusb-1.0/libusb.h>
@@ -38,6 +39,11 @@
 #endif
 
 #include <string>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
 
 #define DEVICE struct usb_device *
 
@@ -133,10 +139,9 @@ class SBIGCCD : public INDI::CCD, public INDI::FilterInterface
         virtual bool ISNewText(const char *dev, const char *name, char *texts[], char *names[], int n) override;
         void updateTemperature();
         static void updateTemperatureHelper(void *);
-#ifdef ASYNC_READOUT
-        static void *grabCCDHelper(void *context);
-#endif
         bool isExposureDone(INDI::CCDChip *targetChip);
+        // Ends the exposure when the camera reports it done, the caller holds sbigLock
+        bool endExposureIfDone(int ccd);
 
         static void NSGuideHelper(void *context);
         static void WEGuideHelper(void *context);
@@ -251,6 +256,19 @@ class SBIGCCD : public INDI::CCD, public INDI::FilterInterface
         ISwitch IgnoreErrorsS[1];
         ISwitchVectorProperty IgnoreErrorsSP;
 
+        /////////////////////////////////////////////////////////////////////////////
+        /// Readout Statistics Properties
+        /////////////////////////////////////////////////////////////////////////////
+        INumber ReadoutStatsN[4];
+        INumberVectorProperty ReadoutStatsNP;
+        enum
+        {
+            READOUT_PRIMARY_TIME,
+            READOUT_PRIMARY_DELAY,
+            READOUT_GUIDE_TIME,
+            READOUT_GUIDE_DELAY,
+        };
+
         /////////////////////////////////////////////////////////////////////////////
         /// Filter Wheel Properties
         /////////////////////////////////////////////////////////////////////////////
@@ -278,6 +296,24 @@ class SBIGCCD : public INDI::CCD, public INDI::FilterInterface
         /////////////////////////////////////////////////////////////////////////////
         std::mutex sbigLock;
 
+        // Readout scheduler. The scheduler thread is the only one that reads out
+        // the chips, guide head requests always take precedence over the primary CCD.
+        std::thread m_ReadoutThread;
+        std::mutex m_ReadoutMutex;
+        std::condition_variable m_ReadoutCV;
+        bool m_ReadoutTerminate { false };
+        bool m_PrimaryReadoutPending { false };
+        bool m_GuideReadoutPending { false };
+        // Set by cancelReadout, checked before every line of a readout in progress
+        std::atomic_bool m_PrimaryReadoutCancel { false };
+        std::atomic_bool m_GuideReadoutCancel { false };
+        // Guide frame queued while the driver was busy, its exposure is ended by the readout
+        std::atomic_bool m_GuideEndExposurePending { false };
+        std::chrono::steady_clock::time_point m_PrimaryQueuedAt, m_GuideQueuedAt;
+
+        // Frame source in simulation mode
+        SynthFrame::Generator m_SimGenerator;
+
         /////////////////////////////////////////////////////////////////////////////
         /// Exposure Variables
         /////////////////////////////////////////////////////////////////////////////
@@ -408,7 +444,20 @@ class SBIGCCD : public INDI::CCD, public INDI::FilterInterface
         int getFrameType(INDI::CCDChip *targetChip, INDI::CCDChip::CCD_FRAME *frameType);
         int getShutterMode(INDI::CCDChip *targetChip, int &shutter);
         int readoutCCD(unsigned short left, unsigned short top, unsigned short width, unsigned short height,
-                       unsigned short *buffer, INDI::CCDChip *targetChip);
+                       unsigned short *buffer, INDI::CCDChip *targetChip, bool lockHeld = false);
+
+        /////////////////////////////////////////////////////////////////////////////
+        /// Readout Scheduler Functions
+        /////////////////////////////////////////////////////////////////////////////
+        void startReadoutThread();
+        void stopReadoutThread();
+        void queueReadout(INDI::CCDChip *targetChip);
+        void cancelReadout(INDI::CCDChip *targetChip);
+        void readoutThread();
+        void processReadout(INDI::CCDChip *targetChip, std::chrono::steady_clock::time_point queuedAt,
+                            bool lockHeld = false);
+        bool canInterleaveGuideReadout();
+        void serviceGuideReadout();
 
         /////////////////////////////////////////////////////////////////////////////
         /// Filter Wheel Functions
@@ -433,7 +482,7 @@ class SBIGCCD : public INDI::CCD, public INDI::FilterInterface
         /////////////////////////////////////////////////////////////////////////////
         /// Utility Functions
         /////////////////////////////////////////////////////////////////////////////
-        bool grabImage(INDI::CCDChip *targetChip);
+        bool grabImage(INDI::CCDChip *targetChip, bool lockHeld = false);
         bool setupParams();
         // SBIG's software interface to the Universal Driver Library function:
         int SBIGUnivDrvCommand(PAR_COMMAND, void *, void *);
@@ -265,6 +265,7 @@ bool
 INDIStarbookTen::Handshake() {
     auto http = httpConnection->getClient();
     starbook->setHttpClient(http);
+    starbook->setPollUrl(httpConnection->host());
 
     try {
         starbook->getFirmwareVersion();
@@ -335,8 +336,10 @@ INDIStarbookTen::fetchStartupInfo() {
 bool
 INDIStarbookTen::ReadScopeStatus() {
     try {
-        auto stat = retry<StarbookTen::MountStatus>(2, &StarbookTen::getStatus, starbook);
-        bool isTracking = retry<bool>(2, &StarbookTen::isTracking, starbook);
+        // Status, tracking, pier side and guiding are queried concurrently.
+        auto snap = starbook->getStatusSnapshot(isPropGuidingRA || isPropGuidingDE);
+        auto &stat = snap.status;
+        bool isTracking = snap.tracking;
 
         updateStarbookState(stat);
 
@@ -364,19 +367,17 @@ INDIStarbookTen::ReadScopeStatus() {
 
         NewRaDec(stat.ra, stat.dec);
 
-        auto ps = retry<StarbookTen::PierSide>(2, &StarbookTen::getPierSide, starbook);
-        setPierSide((ps == StarbookTen::PIERSIDE_EAST) ? INDI::Telescope::PIER_EAST : INDI::Telescope::PIER_WEST);
+        setPierSide((snap.pierside == StarbookTen::PIERSIDE_EAST) ? INDI::Telescope::PIER_EAST : INDI::Telescope::PIER_WEST);
 
-        if (isPropGuidingRA || isPropGuidingDE) {
-            auto gs = retry<std::tuple<bool,bool> >(2, &StarbookTen::getGuidingRaDec, starbook);
-            LOGF_DEBUG("Prop guiding status: RA=%d, DEC=%d", !!(std::get<0>(gs)), !!(std::get<1>(gs)));
-            if (isPropGuidingRA && !std::get<0>(gs)) {
+        if (snap.has_guiding) {
+            LOGF_DEBUG("Prop guiding status: RA=%d, DEC=%d", !!snap.guiding_ra, !!snap.guiding_dec);
+            if (isPropGuidingRA && !snap.guiding_ra) {
                 LOG_DEBUG("Prop guiding in RA finished");
                 isPropGuidingRA = false;
                 INDI::GuiderInterface::GuideComplete(AXIS_RA);
             }
 
-            if (isPropGuidingDE && !std::get<1>(gs)) {
+            if (isPropGuidingDE && !snap.guiding_dec) {
                 LOG_DEBUG("Prop guiding in DE finished");
                 isPropGuidingDE = false;
                 INDI::GuiderInterface::GuideComplete(AXIS_DE);
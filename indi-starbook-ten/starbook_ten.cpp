@@ -1,5 +1,6 @@
 #include <regex>
 #include <cmath>
+#include <future>
 #include <stdio.h>
 #include "starbook_ten.h"
 
@@ -11,15 +12,11 @@ StarbookTen::StarbookTen(httplib::Client *http) : http(http) {
 StarbookTen::StarbookTen(const char *base_url) {
     http = new httplib::Client(base_url);
 
-    http->set_connection_timeout(2, 0);
-    http->set_read_timeout(3, 0);
-    http->set_write_timeout(3, 0);
-
-    http->set_keep_alive(true);
-
-    http->set_url_encode(false);
+    configureClient(http);
 
     destroyClient = true;
+
+    setPollUrl(base_url);
 }
 
 
@@ -32,22 +29,60 @@ StarbookTen::~StarbookTen() {
 void
 StarbookTen::setHttpClient(httplib::Client *http) {
     if (http) {
-        http->set_connection_timeout(2, 0);
-        http->set_read_timeout(3, 0);
-        http->set_write_timeout(3, 0);
-
-        http->set_keep_alive(true);
-
-        http->set_url_encode(false);
+        configureClient(http);
     }
 
     this->http = http;
     destroyClient = false;
+
+    invalidateStatusSnapshot();
+}
+
+
+void
+StarbookTen::setPollUrl(const char *base_url) {
+    for (auto &client : pollClients) {
+        if (base_url && base_url[0]) {
+            client.reset(new httplib::Client(base_url));
+            configureClient(client.get());
+        } else {
+            client.reset();
+        }
+    }
+
+    invalidateStatusSnapshot();
+}
+
+
+void
+StarbookTen::configureClient(httplib::Client *client) {
+    client->set_connection_timeout(2, 0);
+    client->set_read_timeout(3, 0);
+    client->set_write_timeout(3, 0);
+
+    client->set_keep_alive(true);
+
+    client->set_url_encode(false);
+}
+
+
+std::string
+StarbookTen::fetch(httplib::Client *client, const char *path) {
+    auto res = (client ? client : http)->Get(path);
+
+    if (!res || res->status != 200) {
+        throw std::runtime_error("HTTP get failed");
+    }
+
+    return res->body;
 }
 
 
 bool
 StarbookTen::sendBasicCmd(const char *cmd) {
+    // Any command may change what the mount reports.
+    invalidateStatusSnapshot();
+
     auto res = http->Get(cmd);
 
     if (!res || res->status != 200) {
@@ -86,16 +121,16 @@ StarbookTen::getFirmwareVersion() {
 
 StarbookTen::PierSide
 StarbookTen::getPierSide() {
-    auto res = http->Get("/get_pierside");
+    return parsePierSide(fetch(http, "/get_pierside"));
+}
 
-    if (!res || res->status != 200) {
-        throw std::runtime_error("HTTP get failed");
-    }
 
+StarbookTen::PierSide
+StarbookTen::parsePierSide(const std::string &body) {
     std::regex r(R"(PIERSIDE=([01]))");
     std::smatch sm;
 
-    if (std::regex_search(res->body, sm, r)) {
+    if (std::regex_search(body, sm, r)) {
         return static_cast<StarbookTen::PierSide>(std::stoi(sm[1]));
     } else {
         throw std::runtime_error("Could not get pier side");
@@ -275,16 +310,16 @@ StarbookTen::setCoordType(CoordType ct) {
 
 StarbookTen::MountStatus
 StarbookTen::getStatus() {
-    auto res = http->Get("/getstatus2");
+    return parseStatus(fetch(http, "/getstatus2"));
+}
 
-    if (!res || res->status != 200) {
-        throw std::runtime_error("HTTP get failed");
-    }
 
+StarbookTen::MountStatus
+StarbookTen::parseStatus(const std::string &body) {
     std::regex r(R"(<!--RA=(\-?\d+\.\d+)&DEC=(\-?\d+\.\d+)&GOTO=([01])&STATE=([A-Z]+)-->)");
     std::smatch sm;
 
-    if (std::regex_search(res->body, sm, r)) {
+    if (std::regex_search(body, sm, r)) {
         MountStatus stat;
 
         stat.ra = std::stod(sm[1]);
@@ -303,18 +338,18 @@ StarbookTen::getStatus() {
 
 bool
 StarbookTen::isTracking() {
-    auto res = http->Get("/gettrackstatus");
+    return parseTracking(fetch(http, "/gettrackstatus"));
+}
 
-    if (!res || res->status != 200) {
-        throw std::runtime_error("HTTP get failed");
-    }
 
+bool
+StarbookTen::parseTracking(const std::string &body) {
     // TRACK=2 seems to be used during gotos, but since we can already figure
     // gotos out from the getstatus2 call, there's no need to handle it here.
     std::regex r(R"(<!--TRACK=([012])-->)");
     std::smatch sm;
 
-    if (std::regex_search(res->body, sm, r)) {
+    if (std::regex_search(body, sm, r)) {
         return !(sm[1].compare("1"));
     } else {
         throw std::runtime_error("Could not get track status");
@@ -324,16 +359,16 @@ StarbookTen::isTracking() {
 
 std::tuple<bool,bool>
 StarbookTen::getGuidingRaDec() {
-    auto res = http->Get("/getguidestatus");
+    return parseGuidingRaDec(fetch(http, "/getguidestatus"));
+}
 
-    if (!res || res->status != 200) {
-        throw std::runtime_error("HTTP get failed");
-    }
 
+std::tuple<bool,bool>
+StarbookTen::parseGuidingRaDec(const std::string &body) {
     std::regex r(R"(<!--RA\+=([01])&RA\-=([01])&DEC\+=([01])&DEC\-=([01])-->)");
     std::smatch sm;
 
-    if (std::regex_search(res->body, sm, r)) {
+    if (std::regex_search(body, sm, r)) {
         return std::tuple<bool,bool>((!(sm[1].compare("1")) || !(sm[2].compare("1"))),
                                      (!(sm[3].compare("1")) || !(sm[4].compare("1"))));
     } else {
@@ -350,6 +385,72 @@ StarbookTen::getRaDec() {
 }
 
 
+StarbookTen::StatusSnapshot
+StarbookTen::getStatusSnapshot(bool with_guiding, int retries) {
+    // Callers within the TTL share the same snapshot, and concurrent callers
+    // wait for the fetch in progress instead of starting their own.
+    std::lock_guard<std::mutex> lock(snapshotMutex);
+
+    auto now = std::chrono::steady_clock::now();
+    if (snapshotValid && (now - snapshotTime) < snapshotTTL && (snapshot.has_guiding || !with_guiding)) {
+        return snapshot;
+    }
+
+    auto query = [this, retries](int index, const char *path) {
+        httplib::Client *client = pollClients[index].get();
+        for (int left = retries;; left--) {
+            try {
+                return fetch(client, path);
+            } catch (std::exception &) {
+                if (left <= 0) {
+                    throw;
+                }
+            }
+        }
+    };
+
+    // Without dedicated connections the queries are serialized on the main client anyway.
+    auto policy = pollClients[POLL_STATUS] ? std::launch::async : std::launch::deferred;
+
+    auto status   = std::async(policy, query, POLL_STATUS, "/getstatus2");
+    auto track    = std::async(policy, query, POLL_TRACK, "/gettrackstatus");
+    auto pierside = std::async(policy, query, POLL_PIERSIDE, "/get_pierside");
+    std::future<std::string> guide;
+    if (with_guiding) {
+        guide = std::async(policy, query, POLL_GUIDE, "/getguidestatus");
+    }
+
+    StatusSnapshot result {};
+    result.status   = parseStatus(status.get());
+    result.tracking = parseTracking(track.get());
+    result.pierside = parsePierSide(pierside.get());
+    result.has_guiding = with_guiding;
+    if (with_guiding) {
+        std::tie(result.guiding_ra, result.guiding_dec) = parseGuidingRaDec(guide.get());
+    }
+
+    snapshot = result;
+    snapshotTime = std::chrono::steady_clock::now();
+    snapshotValid = true;
+
+    return snapshot;
+}
+
+
+void
+StarbookTen::invalidateStatusSnapshot() {
+    std::lock_guard<std::mutex> lock(snapshotMutex);
+    snapshotValid = false;
+}
+
+
+void
+StarbookTen::setStatusSnapshotTTL(std::chrono::milliseconds ttl) {
+    std::lock_guard<std::mutex> lock(snapshotMutex);
+    snapshotTTL = ttl;
+}
+
+
 bool
 StarbookTen::setPulseRate(int ra_arcsec_per_sec, int dec_arcsec_per_sec) {
     std::stringstream cmd_ss;
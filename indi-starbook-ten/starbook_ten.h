@@ -2,6 +2,9 @@
 #define _STARBOOK_TEN_H_
 
 #include <string>
+#include <chrono>
+#include <memory>
+#include <mutex>
 #include <libnova/julian_day.h>
 #include <libnova/utility.h>
 #include "httplib.h"
@@ -9,12 +12,6 @@
 #define STARBOOK_TEN_DEFAULT_PULSE_RATE 288
 
 class StarbookTen {
-private:
-    httplib::Client *http;
-
-    bool sendBasicCmd(const char *cmd);
-    std::string sxfmt(double x);
-
 public:
     enum Axis {
         AXIS_PRIMARY   = 0,
@@ -52,6 +49,16 @@ public:
         State  state;
     };
 
+    // Everything ReadScopeStatus needs, fetched in one go.
+    struct StatusSnapshot {
+        MountStatus status;
+        bool        tracking;
+        PierSide    pierside;
+        bool        has_guiding;
+        bool        guiding_ra;
+        bool        guiding_dec;
+    };
+
     static const double slewRates[];
 
     StarbookTen(httplib::Client *http);
@@ -61,6 +68,7 @@ public:
     bool destroyClient;
 
     void setHttpClient(httplib::Client *http);
+    void setPollUrl(const char *base_url);
 
     std::tuple<int,int> getFirmwareVersion();
 
@@ -81,6 +89,10 @@ public:
     bool isTracking();
     std::tuple<bool,bool> getGuidingRaDec();
 
+    StatusSnapshot getStatusSnapshot(bool with_guiding, int retries = 2);
+    void invalidateStatusSnapshot();
+    void setStatusSnapshotTTL(std::chrono::milliseconds ttl);
+
     std::tuple<double,double> getRaDec();
 
     bool setPulseRate(int ra_arcsec_per_sec, int dec_arcsec_per_sec);
@@ -100,6 +112,37 @@ public:
     bool goTo(double ra, double dec);
 
     bool move(Axis axis, double rate);
+
+private:
+    httplib::Client *http;
+
+    // Status queries are sent concurrently, one keep-alive connection each,
+    // since a httplib::Client only handles one request at a time.
+    enum {
+        POLL_STATUS,
+        POLL_TRACK,
+        POLL_PIERSIDE,
+        POLL_GUIDE,
+        POLL_LAST
+    };
+    std::unique_ptr<httplib::Client> pollClients[POLL_LAST];
+
+    std::mutex snapshotMutex;
+    StatusSnapshot snapshot;
+    bool snapshotValid = false;
+    std::chrono::steady_clock::time_point snapshotTime;
+    std::chrono::milliseconds snapshotTTL { 250 };
+
+    static void configureClient(httplib::Client *client);
+    std::string fetch(httplib::Client *client, const char *path);
+
+    static MountStatus parseStatus(const std::string &body);
+    static bool parseTracking(const std::string &body);
+    static PierSide parsePierSide(const std::string &body);
+    static std::tuple<bool,bool> parseGuidingRaDec(const std::string &body);
+
+    bool sendBasicCmd(const char *cmd);
+    std::string sxfmt(double x);
 };
 
 #endif /* _STARBOOK_TEN_H_ */
@@ -0,0 +1,138 @@
+/*
+    Starbook Ten status polling tests against a local mock Starbook.
+    Copyright (C) 2026 INDI 3rd party contributors
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+#include "starbook_ten.h"
+
+class MockStarbook {
+public:
+    std::atomic<int> requests { 0 };
+    std::atomic<int> delay_ms { 0 };
+
+    MockStarbook() {
+        route("/getstatus2", "<!--RA=12.5&DEC=-45.25&GOTO=0&STATE=SCOPE-->");
+        route("/gettrackstatus", "<!--TRACK=1-->");
+        route("/get_pierside", "<!--PIERSIDE=1-->");
+        route("/getguidestatus", "<!--RA+=1&RA-=0&DEC+=0&DEC-=0-->");
+        route("/stop", "<!--OK-->");
+
+        port = server.bind_to_any_port("127.0.0.1");
+        thread = std::thread([this]() { server.listen_after_bind(); });
+        while (!server.is_running()) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    }
+
+    ~MockStarbook() {
+        server.stop();
+        thread.join();
+    }
+
+    std::string url() const {
+        return "http://127.0.0.1:" + std::to_string(port);
+    }
+
+private:
+    void route(const char *path, const char *body) {
+        std::string reply(body);
+        server.Get(path, [this, reply](const httplib::Request &, httplib::Response &res) {
+            requests++;
+            if (delay_ms > 0) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(delay_ms));
+            }
+            res.set_content(reply, "text/html");
+        });
+    }
+
+    httplib::Server server;
+    std::thread thread;
+    int port;
+};
+
+
+TEST(StarbookTen, snapshot) {
+    MockStarbook mock;
+    StarbookTen starbook(mock.url().c_str());
+
+    auto snap = starbook.getStatusSnapshot(true);
+
+    ASSERT_DOUBLE_EQ(snap.status.ra, 12.5);
+    ASSERT_DOUBLE_EQ(snap.status.dec, -45.25);
+    ASSERT_FALSE(snap.status.goto_busy);
+    ASSERT_EQ(snap.status.state, StarbookTen::STATE_SCOPE);
+    ASSERT_TRUE(snap.tracking);
+    ASSERT_EQ(snap.pierside, StarbookTen::PIERSIDE_EAST);
+    ASSERT_TRUE(snap.has_guiding);
+    ASSERT_TRUE(snap.guiding_ra);
+    ASSERT_FALSE(snap.guiding_dec);
+    ASSERT_EQ(mock.requests, 4);
+}
+
+
+TEST(StarbookTen, snapshot_cache) {
+    MockStarbook mock;
+    StarbookTen starbook(mock.url().c_str());
+    starbook.setStatusSnapshotTTL(std::chrono::seconds(10));
+
+    starbook.getStatusSnapshot(false);
+    ASSERT_EQ(mock.requests, 3);
+
+    // Served from the cache
+    starbook.getStatusSnapshot(false);
+    ASSERT_EQ(mock.requests, 3);
+
+    // Cached snapshot has no guiding state, so it is fetched again
+    starbook.getStatusSnapshot(true);
+    ASSERT_EQ(mock.requests, 7);
+
+    // Commands drop the cached snapshot
+    starbook.stop();
+    ASSERT_EQ(mock.requests, 8);
+    starbook.getStatusSnapshot(false);
+    ASSERT_EQ(mock.requests, 11);
+}
+
+
+TEST(StarbookTen, snapshot_concurrent) {
+    MockStarbook mock;
+    StarbookTen starbook(mock.url().c_str());
+
+    // Establish the keep-alive connections first
+    starbook.getStatusSnapshot(true);
+    starbook.invalidateStatusSnapshot();
+
+    mock.delay_ms = 200;
+    auto start = std::chrono::steady_clock::now();
+    starbook.getStatusSnapshot(true);
+    auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start);
+
+    // Four sequential requests would take at least 800 ms
+    ASSERT_LT(elapsed.count(), 600);
+}
+
+
+int main(int argc, char **argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -31,62 +31,59 @@ namespace starbook
 
 CommandInterface::CommandInterface(Connection::Curl *new_connection) : connection(new_connection) {}
 
-static std::string read_buffer;
+CommandInterface::CommandInterface(std::string new_host, uint32_t new_port) : host(std::move(new_host)), port(new_port) {}
 
-static size_t WriteCallback(void *contents, size_t size, size_t nmemb, void *userp)
+void CommandInterface::UpdateEndpoint()
 {
-    INDI_UNUSED(userp);
-    size_t real_size = size * nmemb;
-    read_buffer.append(static_cast<char *>(contents), real_size);
-    return real_size;
+    // address can be edited while disconnected, so it is read from the connection every time
+    if (connection != nullptr)
+        session.setEndpoint(connection->host(), connection->port());
+    else
+        session.setEndpoint(host, port);
 }
 
 CommandResponse CommandInterface::SendCommand(const std::string &cmd)
 {
-    CURLcode rc;
-    CURL *handle = connection->getHandle();
+    UpdateEndpoint();
 
-    last_response.clear();
-    read_buffer.clear();
-    std::ostringstream cmd_url;
-
-    cmd_url << "http://" << connection->host() << ":" << connection->port() << "/" << cmd;
-    last_cmd_url = cmd_url.str();
-
-    DEBUGFDEVICE(m_Device.c_str(), INDI::Logger::DBG_DEBUG, "CMD <%s>", last_cmd_url.c_str());
-
-    curl_easy_setopt(handle, CURLOPT_USERAGENT, "curl/7.58.0");
-    /* send all data to this function  */
-    curl_easy_setopt(handle, CURLOPT_WRITEFUNCTION, WriteCallback);
-    curl_easy_setopt(handle, CURLOPT_WRITEDATA, &read_buffer);
-    curl_easy_setopt(handle, CURLOPT_URL, cmd_url.str().c_str());
-
-    rc = curl_easy_perform(handle);
-
-    if (rc != CURLE_OK)
     {
-        throw std::runtime_error(curl_easy_strerror(rc));
+        std::lock_guard<std::mutex> lock(last_mutex);
+        last_cmd_url = cmd;
+        last_response.clear();
     }
 
-    DEBUGFDEVICE(m_Device.c_str(), INDI::Logger::DBG_DEBUG, "RES_RAW <%s>", read_buffer.c_str());
+    DEBUGFDEVICE(m_Device.c_str(), INDI::Logger::DBG_DEBUG, "CMD <%s>", cmd.c_str());
+
+    return ParseRawResponse(cmd, session.Get(cmd));
+}
+
+CommandResponse CommandInterface::ParseRawResponse(const std::string &cmd, const std::string &raw)
+{
+    DEBUGFDEVICE(m_Device.c_str(), INDI::Logger::DBG_DEBUG, "RES_RAW <%s>", raw.c_str());
 
     // all responses are hidden in HTML comments ...
-    std::regex response_comment_re("<!--(.*)-->", std::regex_constants::ECMAScript);
+    static const std::regex response_comment_re("<!--(.*)-->", std::regex_constants::ECMAScript);
     std::smatch comment_match;
-    if (!regex_search(read_buffer, comment_match, response_comment_re))
+    if (!regex_search(raw, comment_match, response_comment_re))
     {
         throw std::runtime_error("parsing error, response not found ");
     }
 
-    last_response = comment_match[1].str();
-    if (last_response.empty())
+    std::string response = comment_match[1].str();
+    {
+        std::lock_guard<std::mutex> lock(last_mutex);
+        last_cmd_url = cmd;
+        last_response = response;
+    }
+
+    if (response.empty())
     {
         throw std::runtime_error("parsing error, response empty");
     }
 
-    DEBUGFDEVICE(m_Device.c_str(), INDI::Logger::DBG_DEBUG, "RES_PRO <%s>", last_response.c_str());
+    DEBUGFDEVICE(m_Device.c_str(), INDI::Logger::DBG_DEBUG, "RES_PRO <%s>", response.c_str());
 
-    return CommandResponse(comment_match[1].str());
+    return CommandResponse(response);
 }
 
 ResponseCode CommandInterface::SendOkCommand(const std::string &cmd)
@@ -208,13 +205,15 @@ ResponseCode CommandInterface::Move(INDI_DIR_WE dir, INDI::Telescope::TelescopeM
     return SendOkCommand(cmd.str());
 }
 
-const std::string &CommandInterface::getLastCmdUrl() const
+std::string CommandInterface::getLastCmdUrl() const
 {
+    std::lock_guard<std::mutex> lock(last_mutex);
     return last_cmd_url;
 }
 
-const std::string &CommandInterface::getLastResponse() const
+std::string CommandInterface::getLastResponse() const
 {
+    std::lock_guard<std::mutex> lock(last_mutex);
     return last_response;
 }
 
@@ -270,13 +269,13 @@ StarbookState CommandInterface::ParseState(const std::string &value)
 
 PlaceResponse CommandInterface::ParsePlaceResponse(const CommandResponse &response)
 {
-    if (!response.status) throw std::runtime_error("Cannot parse place");
+    if (response.status != OK) throw std::runtime_error("Cannot parse place");
     return {{0, 0}, 0}; // TODO
 }
 
 ln_date CommandInterface::ParseTimeResponse(const CommandResponse &response)
 {
-    if (!response.status) throw std::runtime_error("Cannot parse time");
+    if (response.status != OK) throw std::runtime_error("Cannot parse time");
     std::stringstream ss{response.payload.at("time")};
     DateTime time{0, 0, 0, 0, 0, 0};
     ss >> time;
@@ -285,7 +284,7 @@ ln_date CommandInterface::ParseTimeResponse(const CommandResponse &response)
 
 XYResponse CommandInterface::ParseXYResponse(const CommandResponse &response)
 {
-    if (!response.status) throw std::runtime_error("Cannot parse xy");
+    if (response.status != OK) throw std::runtime_error("Cannot parse xy");
     return
     {
         .x = std::stod(response.payload.at("X")),
@@ -295,7 +294,7 @@ XYResponse CommandInterface::ParseXYResponse(const CommandResponse &response)
 
 long int CommandInterface::ParseRoundResponse(const CommandResponse &response)
 {
-    if (!response.status) throw std::runtime_error("Cannot parse round");
+    if (response.status != OK) throw std::runtime_error("Cannot parse round");
     return std::stol(response.payload.at("ROUND"));
 }
 }
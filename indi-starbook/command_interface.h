@@ -22,8 +22,10 @@
 #pragma once
 
 #include <inditelescope.h>
+#include <mutex>
 #include "starbook_types.h"
 #include "connectioncurl.h"
+#include "http_session.h"
 
 namespace starbook
 {
@@ -62,9 +64,12 @@ class CommandInterface
 
         explicit CommandInterface(Connection::Curl *connection);
 
-        const std::string &getLastCmdUrl() const;
+        /// @brief interface talking directly to host:port, without a connection plugin
+        CommandInterface(std::string host, uint32_t port);
 
-        const std::string &getLastResponse() const;
+        std::string getLastCmdUrl() const;
+
+        std::string getLastResponse() const;
 
         ResponseCode Start()
         {
@@ -123,18 +128,41 @@ class CommandInterface
             return SendOkCommand("SAVESETTING");
         }
 
+        /// @brief drop keep-alive connections, e.g. after disconnecting
+        void CloseSession()
+        {
+            session.Close();
+        }
+
+        LatencyHistogram getLatency() const
+        {
+            return session.getLatency();
+        }
+
     private:
 
         Connection::Curl *connection = nullptr;
 
+        HttpSession session;
+
+        std::string host;
+
+        uint32_t port = 0;
+
+        mutable std::mutex last_mutex;
+
         std::string last_cmd_url;
 
         std::string last_response;
 
         std::string m_Device {"Starbook"};
 
+        void UpdateEndpoint();
+
         CommandResponse SendCommand(const std::string &command);
 
+        CommandResponse ParseRawResponse(const std::string &cmd, const std::string &raw);
+
         ResponseCode SendOkCommand(const std::string &cmd);
 
         StarbookState ParseState(const std::string &value);
@@ -25,8 +25,6 @@
 
 namespace Connection {
     Curl::Curl(INDI::DefaultDevice *dev) : Interface(dev, CONNECTION_CUSTOM) {
-        curl_global_init(CURL_GLOBAL_ALL);
-
         IUFillText(&AddressT[0], "ADDRESS", "Address", "");
         IUFillText(&AddressT[1], "PORT", "Port", "");
         IUFillTextVector(&AddressTP, AddressT, 2, getDeviceName(), "DEVICE_ADDRESS", "Server", CONNECTION_TAB,
@@ -35,7 +33,6 @@ namespace Connection {
 
     Curl::~Curl() {
         Disconnect();
-        curl_global_cleanup();
     }
 
     bool Curl::Connect() {
@@ -48,20 +45,9 @@ namespace Connection {
         const char *hostname = AddressT[0].text;
         const char *port = AddressT[1].text;
 
-        LOGF_INFO("Creating HTTP handle for %s@%s", hostname, port);
-        if (handle != nullptr) {
-            LOG_DEBUG("Found old handle, reusing");
-        } else {
-            handle = curl_easy_init();
-        }
-        if (handle == nullptr) {
-            LOG_ERROR("Cannot create HTTP handle");
-            return false;
-        }
-
-        SetupHandle();
-
-        LOG_DEBUG("Handle creation successful, attempting handshake...");
+        // requests go through the driver's keep-alive session, see starbook::HttpSession
+        LOGF_INFO("Connecting to %s@%s", hostname, port);
+        LOG_DEBUG("Attempting handshake...");
         bool rc = Handshake();
 
         if (rc) {
@@ -74,16 +60,7 @@ namespace Connection {
         return rc;
     }
 
-    void Curl::SetupHandle() const {
-        curl_easy_setopt(handle, CURLOPT_TIMEOUT, HANDLE_TIMEOUT);
-        curl_easy_setopt(handle, CURLOPT_NOPROGRESS, 1L);
-        // if debug
-//        curl_easy_setopt(handle, CURLOPT_VERBOSE, 0);
-    }
-
     bool Curl::Disconnect() {
-        curl_easy_cleanup(handle);
-        handle = nullptr;
         return true;
     }
 
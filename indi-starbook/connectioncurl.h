@@ -24,7 +24,6 @@
 #include <connectionplugins/connectioninterface.h>
 #include <string>
 #include <cstdlib>
-#include <curl/curl.h>
 #include <inditelescope.h>
 
 
@@ -59,20 +58,9 @@ namespace Connection {
 
         void setDefaultPort(uint32_t addressPort);
 
-        CURL *getHandle() const {
-            if (handle == nullptr) throw std::runtime_error("connection error, no handle");
-            return handle;
-        }
-
     protected:
         ITextVectorProperty AddressTP;
         IText AddressT[2]{};
-
-        const unsigned long HANDLE_TIMEOUT = 2;
-
-        CURL *handle = nullptr;
-
-        void SetupHandle() const;
     };
 
 }
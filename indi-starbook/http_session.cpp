@@ -0,0 +1,204 @@
+/*
+ Starbook mount driver
+
+ Copyright (C) 2018 Norbert Szulc (not7cd)
+
+ This library is free software; you can redistribute it and/or
+ modify it under the terms of the GNU Lesser General Public
+ License as published by the Free Software Foundation; either
+ version 2.1 of the License, or (at your option) any later version.
+
+ This library is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public
+ License along with this library; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+
+ */
+
+#include "http_session.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <sstream>
+#include <stdexcept>
+
+namespace starbook
+{
+
+void LatencyHistogram::record(double ms)
+{
+    size_t bucket = 0;
+    while (bucket < BUCKETS - 1 && ms >= upperBound(bucket))
+        bucket++;
+    counts[bucket]++;
+    total++;
+    if (ms > max_ms)
+        max_ms = ms;
+}
+
+void LatencyHistogram::reset()
+{
+    counts.fill(0);
+    total = 0;
+    max_ms = 0;
+}
+
+double LatencyHistogram::percentile(double p) const
+{
+    if (total == 0)
+        return 0;
+
+    auto rank = static_cast<uint64_t>(std::ceil(p / 100.0 * total));
+    uint64_t seen = 0;
+    for (size_t i = 0; i < BUCKETS; i++)
+    {
+        seen += counts[i];
+        if (seen >= rank && counts[i] > 0)
+            return std::min(upperBound(i), max_ms);
+    }
+    return max_ms;
+}
+
+double LatencyHistogram::upperBound(size_t bucket)
+{
+    if (bucket >= BUCKETS - 1)
+        return std::numeric_limits<double>::infinity();
+    return std::ldexp(1.0, static_cast<int>(bucket));
+}
+
+static size_t WriteCallback(void *contents, size_t size, size_t nmemb, void *userp)
+{
+    size_t real_size = size * nmemb;
+    static_cast<std::string *>(userp)->append(static_cast<char *>(contents), real_size);
+    return real_size;
+}
+
+HttpSession::HttpSession(long timeout) : timeout(timeout)
+{
+    curl_global_init(CURL_GLOBAL_ALL);
+}
+
+HttpSession::~HttpSession()
+{
+    Close();
+    curl_global_cleanup();
+}
+
+void HttpSession::setEndpoint(const std::string &host, uint32_t port)
+{
+    std::ostringstream url;
+    url << "http://" << host << ":" << port << "/";
+
+    std::lock_guard<std::mutex> lock(mutex);
+    if (url.str() != base_url)
+    {
+        // connections to the old address are of no use anymore
+        CloseLocked();
+        base_url = url.str();
+    }
+}
+
+void HttpSession::Open()
+{
+    if (share != nullptr)
+        return;
+
+    // connections and DNS lookups outlive the easy handle, so they survive a handle being recreated
+    share = curl_share_init();
+    curl_share_setopt(share, CURLSHOPT_SHARE, CURL_LOCK_DATA_CONNECT);
+    curl_share_setopt(share, CURLSHOPT_SHARE, CURL_LOCK_DATA_DNS);
+
+    if (share == nullptr)
+    {
+        CloseLocked();
+        throw std::runtime_error("connection error, cannot create HTTP session");
+    }
+}
+
+void HttpSession::Close()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    CloseLocked();
+}
+
+void HttpSession::CloseLocked()
+{
+    for (auto &transfer : transfers)
+        curl_easy_cleanup(transfer.handle);
+    transfers.clear();
+
+    if (share != nullptr)
+        curl_share_cleanup(share);
+    share = nullptr;
+}
+
+CURL *HttpSession::Prepare(size_t index, const std::string &path)
+{
+    if (base_url.empty())
+        throw std::runtime_error("connection error, no address");
+
+    Transfer &transfer = transfers.at(index);
+    if (transfer.handle == nullptr)
+    {
+        transfer.handle = curl_easy_init();
+        if (transfer.handle == nullptr)
+            throw std::runtime_error("connection error, no handle");
+    }
+
+    CURL *handle = transfer.handle;
+    transfer.body.clear();
+
+    curl_easy_setopt(handle, CURLOPT_SHARE, share);
+    curl_easy_setopt(handle, CURLOPT_TIMEOUT, timeout);
+    curl_easy_setopt(handle, CURLOPT_NOPROGRESS, 1L);
+    curl_easy_setopt(handle, CURLOPT_NOSIGNAL, 1L);
+    curl_easy_setopt(handle, CURLOPT_TCP_KEEPALIVE, 1L);
+    curl_easy_setopt(handle, CURLOPT_USERAGENT, "curl/7.58.0");
+    curl_easy_setopt(handle, CURLOPT_WRITEFUNCTION, WriteCallback);
+    curl_easy_setopt(handle, CURLOPT_WRITEDATA, &transfer.body);
+    curl_easy_setopt(handle, CURLOPT_URL, (base_url + path).c_str());
+
+    return handle;
+}
+
+void HttpSession::Record(CURL *handle)
+{
+    double seconds = 0;
+    if (curl_easy_getinfo(handle, CURLINFO_TOTAL_TIME, &seconds) == CURLE_OK)
+        latency.record(seconds * 1000.0);
+}
+
+std::string HttpSession::Get(const std::string &path)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    Open();
+    if (transfers.empty())
+        transfers.resize(1);
+
+    CURL *handle = Prepare(0, path);
+    CURLcode rc = curl_easy_perform(handle);
+    if (rc != CURLE_OK)
+        throw std::runtime_error(curl_easy_strerror(rc));
+
+    Record(handle);
+    return transfers[0].body;
+}
+
+LatencyHistogram HttpSession::getLatency() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return latency;
+}
+
+void HttpSession::resetLatency()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    latency.reset();
+}
+
+}
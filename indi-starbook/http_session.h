@@ -0,0 +1,129 @@
+/*
+ Starbook mount driver
+
+ Copyright (C) 2018 Norbert Szulc (not7cd)
+
+ This library is free software; you can redistribute it and/or
+ modify it under the terms of the GNU Lesser General Public
+ License as published by the Free Software Foundation; either
+ version 2.1 of the License, or (at your option) any later version.
+
+ This library is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public
+ License along with this library; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+
+ */
+
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <curl/curl.h>
+
+namespace starbook
+{
+
+/// @brief request latency in power of two millisecond buckets, the last bucket collects everything slower
+class LatencyHistogram
+{
+    public:
+        static constexpr size_t BUCKETS = 13;
+
+        void record(double ms);
+
+        void reset();
+
+        uint64_t count() const
+        {
+            return total;
+        }
+
+        double max() const
+        {
+            return max_ms;
+        }
+
+        /// @return upper bound of the bucket holding the given percentile (0 - 100), in ms
+        double percentile(double p) const;
+
+        const std::array<uint64_t, BUCKETS> &buckets() const
+        {
+            return counts;
+        }
+
+        /// @return upper bound of a bucket in ms, infinity for the last one
+        static double upperBound(size_t bucket);
+
+    private:
+        std::array<uint64_t, BUCKETS> counts {};
+        uint64_t total = 0;
+        double max_ms = 0;
+};
+
+/**
+ * @brief Keep-alive HTTP session to the Starbook
+ *
+ * Easy handles are created once and share one connection cache, so every request reuses an already
+ * open connection when the Starbook allows it. All methods are serialized on an internal mutex, so only
+ * one request is in flight at a time.
+ */
+class HttpSession
+{
+    public:
+        explicit HttpSession(long timeout = 2);
+
+        ~HttpSession();
+
+        HttpSession(const HttpSession &) = delete;
+
+        HttpSession &operator=(const HttpSession &) = delete;
+
+        void setEndpoint(const std::string &host, uint32_t port);
+
+        /// @brief blocking GET of http://host:port/path, throws std::runtime_error on transport errors
+        std::string Get(const std::string &path);
+
+        /// @brief close all connections, handles are recreated on the next request
+        void Close();
+
+        LatencyHistogram getLatency() const;
+
+        void resetLatency();
+
+    private:
+        struct Transfer
+        {
+            CURL *handle = nullptr;
+            std::string body;
+        };
+
+        void Open();
+
+        void CloseLocked();
+
+        CURL *Prepare(size_t index, const std::string &path);
+
+        void Record(CURL *handle);
+
+        mutable std::mutex mutex;
+
+        std::string base_url;
+
+        long timeout;
+
+        CURLSH *share = nullptr;
+
+        std::vector<Transfer> transfers;
+
+        LatencyHistogram latency;
+};
+
+}
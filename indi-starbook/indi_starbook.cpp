@@ -67,6 +67,15 @@ bool StarbookDriver::initProperties()
     IUFillSwitchVector(&StartSP, StartS, 1, getDeviceName(), "Basic", "Basic control", MAIN_CONTROL_TAB,
                        IP_RW, ISR_ATMOST1, 60, IPS_IDLE);
 
+    IUFillNumber(&LatencyN[LATENCY_COUNT], "LATENCY_COUNT", "Requests", "%.0f", 0, 1e9, 0, 0);
+    IUFillNumber(&LatencyN[LATENCY_P50], "LATENCY_P50", "50% below (ms)", "%.0f", 0, 1e6, 0, 0);
+    IUFillNumber(&LatencyN[LATENCY_P90], "LATENCY_P90", "90% below (ms)", "%.0f", 0, 1e6, 0, 0);
+    IUFillNumber(&LatencyN[LATENCY_P99], "LATENCY_P99", "99% below (ms)", "%.0f", 0, 1e6, 0, 0);
+    IUFillNumber(&LatencyN[LATENCY_MAX], "LATENCY_MAX", "Max (ms)", "%.0f", 0, 1e6, 0, 0);
+    IUFillNumberVector(&LatencyNP, LatencyN, 5, getDeviceName(), "HTTP_LATENCY", "HTTP latency", CONNECTION_TAB,
+                       IP_RO, 0, IPS_IDLE);
+
+
 
     curlConnection = new Connection::Curl(this);
     curlConnection->registerHandshake([&]()
@@ -99,12 +108,14 @@ bool StarbookDriver::updateProperties()
         defineProperty(&VersionTP);
         defineProperty(&StateTP);
         defineProperty(&StartSP);
+        defineProperty(&LatencyNP);
     }
     else
     {
         deleteProperty(VersionTP.name);
         deleteProperty(StateTP.name);
         deleteProperty(StartSP.name);
+        deleteProperty(LatencyNP.name);
     }
     return true;
 }
@@ -133,6 +144,7 @@ bool StarbookDriver::Disconnect()
     {
         bool rc = Telescope::Disconnect();
         last_known_state = starbook::UNKNOWN;
+        cmd_interface->CloseSession();
         // Disconnection is successful, set it IDLE and updateProperties.
         if (rc)
         {
@@ -160,21 +172,17 @@ bool StarbookDriver::ReadScopeStatus()
     starbook::StatusResponse res;
     try
     {
-        cmd_interface->GetStatus(res);
+        starbook::ResponseCode rc = cmd_interface->GetStatus(res);
+        if (rc != starbook::OK)
+        {
+            LogResponse("Status", rc);
+            return statusFailed();
+        }
     }
     catch (std::exception &e)
     {
-        StateTP.s = IPS_ALERT;
-        failed_res++;
         LOG_ERROR(e.what());
-
-        if (failed_res > 3)
-        {
-            LOG_ERROR("Failed to keep connection, disconnecting");
-            StarbookDriver::Disconnect();
-            failed_res = 0;
-        }
-        return false;
+        return statusFailed();
     }
 
     last_known_state = res.state;
@@ -182,12 +190,28 @@ bool StarbookDriver::ReadScopeStatus()
     setTrackState(res);
     setStarbookState(res.state);
     NewRaDec(res.equ.ra / 15, res.equ.dec); // CONVERSION
+    updateLatency();
 
     failed_res = 0;
     LOG_DEBUG("STATUS");
     return true;
 }
 
+bool StarbookDriver::statusFailed()
+{
+    StateTP.s = IPS_ALERT;
+    IDSetText(&StateTP, nullptr);
+    failed_res++;
+
+    if (failed_res > 3)
+    {
+        LOG_ERROR("Failed to keep connection, disconnecting");
+        StarbookDriver::Disconnect();
+        failed_res = 0;
+    }
+    return false;
+}
+
 void StarbookDriver::setStarbookState(const starbook::StarbookState &state)
 {
     IUSaveText(&StateT[0], starbook::STATE_TO_STR.at(state).c_str());
@@ -195,6 +219,18 @@ void StarbookDriver::setStarbookState(const starbook::StarbookState &state)
     IDSetText(&StateTP, nullptr);
 }
 
+void StarbookDriver::updateLatency()
+{
+    starbook::LatencyHistogram latency = cmd_interface->getLatency();
+    LatencyN[LATENCY_COUNT].value = latency.count();
+    LatencyN[LATENCY_P50].value = latency.percentile(50);
+    LatencyN[LATENCY_P90].value = latency.percentile(90);
+    LatencyN[LATENCY_P99].value = latency.percentile(99);
+    LatencyN[LATENCY_MAX].value = latency.max();
+    LatencyNP.s = IPS_OK;
+    IDSetNumber(&LatencyNP, nullptr);
+}
+
 void StarbookDriver::setTrackState(const starbook::StatusResponse &res)
 {
     switch (res.state)
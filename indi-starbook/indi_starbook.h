@@ -70,6 +70,18 @@ protected:
 
     ISwitchVectorProperty StartSP;
 
+    enum
+    {
+        LATENCY_COUNT,
+        LATENCY_P50,
+        LATENCY_P90,
+        LATENCY_P99,
+        LATENCY_MAX,
+    };
+    INumber LatencyN[5];
+
+    INumberVectorProperty LatencyNP;
+
     bool Connect() override;
 
     bool Disconnect() override;
@@ -105,4 +117,9 @@ protected:
     void setTrackState(const starbook::StatusResponse &res);
 
     void setStarbookState(const starbook::StarbookState &state);
+
+    /// @brief marks the status ALERT and disconnects after repeated failures, returns false
+    bool statusFailed();
+
+    void updateLatency();
 };
@@ -3,7 +3,107 @@
 //
 
 #include <gtest/gtest.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
 #include "starbook_types.h"
+#include "command_interface.h"
+
+/// Minimal keep-alive HTTP/1.1 server answering like a Starbook, one thread per connection
+class StarbookStub {
+public:
+    std::atomic<int> connections{0};
+    std::atomic<int> requests{0};
+    std::atomic<int> delay_ms{0};
+
+    StarbookStub() {
+        listen_fd = socket(AF_INET, SOCK_STREAM, 0);
+        int yes = 1;
+        setsockopt(listen_fd, SOL_SOCKET, SO_REUSEADDR, &yes, sizeof(yes));
+        sockaddr_in addr{};
+        addr.sin_family = AF_INET;
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        addr.sin_port = 0;
+        bind(listen_fd, reinterpret_cast<sockaddr *>(&addr), sizeof(addr));
+        socklen_t len = sizeof(addr);
+        getsockname(listen_fd, reinterpret_cast<sockaddr *>(&addr), &len);
+        port = ntohs(addr.sin_port);
+        listen(listen_fd, 8);
+        acceptor = std::thread([this]() { acceptLoop(); });
+    }
+
+    ~StarbookStub() {
+        shutdown(listen_fd, SHUT_RDWR);
+        close(listen_fd);
+        acceptor.join();
+        for (int fd : client_fds)
+            shutdown(fd, SHUT_RDWR);
+        for (auto &worker : workers)
+            worker.join();
+        for (int fd : client_fds)
+            close(fd);
+    }
+
+    uint32_t port;
+
+private:
+    void acceptLoop() {
+        while (true) {
+            int fd = accept(listen_fd, nullptr, nullptr);
+            if (fd < 0)
+                return;
+            connections++;
+            client_fds.push_back(fd);
+            workers.emplace_back([this, fd]() { serve(fd); });
+        }
+    }
+
+    void serve(int fd) {
+        std::string buffer;
+        char chunk[1024];
+        while (true) {
+            size_t end;
+            while ((end = buffer.find("\r\n\r\n")) == std::string::npos) {
+                ssize_t n = recv(fd, chunk, sizeof(chunk), 0);
+                if (n <= 0)
+                    return;
+                buffer.append(chunk, n);
+            }
+            std::string request = buffer.substr(0, end);
+            buffer.erase(0, end + 4);
+            requests++;
+
+            if (delay_ms > 0)
+                std::this_thread::sleep_for(std::chrono::milliseconds(delay_ms));
+
+            std::string path = request.substr(4, request.find(' ', 4) - 4);
+            std::string body = "<html><body><!--" + reply(path) + "--></body></html>";
+            std::string response = "HTTP/1.1 200 OK\r\nContent-Type: text/html\r\nContent-Length: " +
+                                   std::to_string(body.size()) + "\r\n\r\n" + body;
+            send(fd, response.data(), response.size(), MSG_NOSIGNAL);
+        }
+    }
+
+    static std::string reply(const std::string &path) {
+        if (path == "/GETSTATUS")
+            return "RA=12+30.0&DEC=-45+15&GOTO=0&STATE=SCOPE";
+        if (path == "/GETXY")
+            return "X=1234&Y=-567";
+        if (path == "/GETROUND")
+            return "ROUND=8640000";
+        return "OK";
+    }
+
+    int listen_fd;
+    std::thread acceptor;
+    std::vector<std::thread> workers;
+    std::vector<int> client_fds;
+};
 
 TEST(StarbookDriver, cmd_res) {
     starbook::CommandResponse res1("OK");
@@ -41,6 +141,68 @@ TEST(StarbookDriver, time) {
     ASSERT_EQ(result.str(), "2345+12+29+23+59+59");
 }
 
+TEST(StarbookDriver, latency_histogram) {
+    starbook::LatencyHistogram hist;
+    ASSERT_EQ(hist.percentile(50), 0);
+
+    for (int i = 0; i < 98; i++)
+        hist.record(3);
+    hist.record(100);
+    hist.record(5000);
+
+    ASSERT_EQ(hist.count(), 100u);
+    ASSERT_EQ(hist.buckets()[2], 98u);
+    ASSERT_EQ(hist.buckets()[starbook::LatencyHistogram::BUCKETS - 1], 1u);
+    ASSERT_DOUBLE_EQ(hist.percentile(50), 4);
+    ASSERT_DOUBLE_EQ(hist.percentile(99), 128);
+    ASSERT_DOUBLE_EQ(hist.percentile(100), 5000);
+    ASSERT_DOUBLE_EQ(hist.max(), 5000);
+}
+
+TEST(StarbookDriver, keep_alive) {
+    StarbookStub stub;
+    starbook::CommandInterface cmd("127.0.0.1", stub.port);
+
+    starbook::StatusResponse res{};
+    for (int i = 0; i < 5; i++)
+        ASSERT_EQ(cmd.GetStatus(res), starbook::OK);
+    ASSERT_EQ(cmd.Stop(), starbook::OK);
+
+    ASSERT_EQ(res.state, starbook::SCOPE);
+    ASSERT_FALSE(res.executing_goto);
+    ASSERT_EQ(stub.requests, 6);
+    ASSERT_EQ(stub.connections, 1);
+    ASSERT_EQ(cmd.getLatency().count(), 6u);
+    ASSERT_EQ(cmd.getLastCmdUrl(), "STOP");
+    ASSERT_EQ(cmd.getLastResponse(), "OK");
+}
+
+TEST(StarbookDriver, threads) {
+    StarbookStub stub;
+    starbook::CommandInterface cmd("127.0.0.1", stub.port);
+
+    std::atomic<int> failures{0};
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; t++) {
+        threads.emplace_back([&]() {
+            for (int i = 0; i < 20; i++) {
+                try {
+                    starbook::StatusResponse res{};
+                    if (cmd.GetStatus(res) != starbook::OK || res.state != starbook::SCOPE)
+                        failures++;
+                } catch (std::exception &e) {
+                    failures++;
+                }
+            }
+        });
+    }
+    for (auto &thread : threads)
+        thread.join();
+
+    ASSERT_EQ(failures, 0);
+    ASSERT_EQ(stub.requests, 80);
+}
+
 
 int main(int argc, char **argv) {
     ::testing::InitGoogleTest(&argc, argv);
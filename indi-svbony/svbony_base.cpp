@@ -31,6 +31,7 @@
 
 #include <algorithm>
 #include <cmath>
+#include <cstring>
 #include <vector>
 #include <map>
 #include <unistd.h>
@@ -56,7 +57,7 @@ bool SVBONYBase::SetROIFormat(int x, int y, int w, int h, int bin)
     SVB_ERROR_CODE ret;
     int currentX = 0, currentY = 0, currentW = 0, currentH = 0, currentBin = 0;
 
-    ret = SVBGetROIFormat(mCameraInfo.CameraID, &currentY, &currentY, &currentW, &currentH, &currentBin);
+    ret = SVBGetROIFormat(mCameraInfo.CameraID, &currentX, &currentY, &currentW, &currentH, &currentBin);
     if (ret != SVB_SUCCESS)
     {
         LOGF_ERROR("Failed to get ROI format (%s).", Helpers::toString(ret));
@@ -69,6 +70,8 @@ bool SVBONYBase::SetROIFormat(int x, int y, int w, int h, int bin)
         return true; // both the requested ROI and Bin are same as current ones. So don't need to change it to what are requested.
     }
 
+    disarmTriggerSession();
+
     LOGF_DEBUG("SVBSetROIFormat (%d,%d-%d,%d,  bin:%d)", x, y, w, h, bin);
     ret = SVBSetROIFormat(mCameraInfo.CameraID, x, y, w, h, bin);
     if (ret != SVB_SUCCESS)
@@ -79,6 +82,30 @@ bool SVBONYBase::SetROIFormat(int x, int y, int w, int h, int bin)
     return true;
 }
 
+// Puts the camera in soft trigger mode and starts capturing, unless the session is still armed
+// from the previous exposure.
+bool SVBONYBase::armTriggerSession()
+{
+    const char *failedCall = "";
+    SVB_ERROR_CODE ret = mTriggerSession.arm(mCameraInfo.CameraID, failedCall);
+    if (ret != SVB_SUCCESS)
+    {
+        LOGF_ERROR("Failed to arm soft trigger session, %s (%s).", failedCall, Helpers::toString(ret));
+        return false;
+    }
+    return true;
+}
+
+// Stops the soft trigger session. Needed before ROI, bin or format changes, before streaming,
+// and whenever a triggered frame was not retrieved, which would otherwise be returned by the
+// next exposure.
+void SVBONYBase::disarmTriggerSession()
+{
+    SVB_ERROR_CODE ret = mTriggerSession.disarm();
+    if (ret != SVB_SUCCESS)
+        LOGF_DEBUG("Failed to stop video capture (%s).", Helpers::toString(ret));
+}
+
 void SVBONYBase::workerStreamVideo(const std::atomic_bool &isAboutToQuit)
 {
     SVB_ERROR_CODE ret;
@@ -92,6 +119,8 @@ void SVBONYBase::workerStreamVideo(const std::atomic_bool &isAboutToQuit)
         return;
     }
 
+    disarmTriggerSession();
+
     // set camera normal mode
     ret = SVBSetCameraMode(mCameraInfo.CameraID, SVB_MODE_NORMAL);
     if(ret != SVB_SUCCESS)
@@ -160,21 +189,8 @@ void SVBONYBase::workerExposure(const std::atomic_bool &isAboutToQuit, float dur
 {
     SVB_ERROR_CODE ret;
 
-    // set camera soft trigger mode
-    ret = SVBSetCameraMode(mCameraInfo.CameraID, SVB_MODE_TRIG_SOFT);
-    if(ret != SVB_SUCCESS)
-    {
-        LOGF_ERROR("Failed to set soft trigger mode (%s).", Helpers::toString(ret));
+    if (!armTriggerSession())
         return;
-    }
-    LOG_DEBUG("Camera soft trigger mode");
-
-    ret = SVBStartVideoCapture(mCameraInfo.CameraID);
-    if (ret != SVB_SUCCESS)
-    {
-        LOGF_ERROR("Failed to start video capture (%s).", Helpers::toString(ret));
-        return;
-    }
 
     PrimaryCCD.setExposureDuration(duration);
 
@@ -197,9 +213,10 @@ void SVBONYBase::workerExposure(const std::atomic_bool &isAboutToQuit, float dur
         // Wait 100ms before trying again
         usleep(100 * 1000);
     }
-    if (!nRetry)
+    if (ret != SVB_SUCCESS)
     {
         LOG_ERROR("Failed to start exposure three times.");
+        disarmTriggerSession();
         return;
     }
 
@@ -209,26 +226,26 @@ void SVBONYBase::workerExposure(const std::atomic_bool &isAboutToQuit, float dur
         LOGF_INFO("Taking a %g seconds frame...", duration);
 
     /*
-        Prepare a read buffer for SVB_IMG_RGB24 and SVB_IMG_RGB32
+        Prepare the read buffer, frames are read into it and then copied or deinterleaved into the frame buffer.
+        The frame buffer is only locked for the copy, not for the exposure or the download.
     */
     SVB_IMG_TYPE type = getImageType();
 
-    std::unique_lock<std::mutex> guard(ccdBufferLock);
-    uint8_t *image = PrimaryCCD.getFrameBuffer();
-    uint8_t *buffer = image;
-
     uint16_t subW = PrimaryCCD.getSubW() / PrimaryCCD.getBinX();
     uint16_t subH = PrimaryCCD.getSubH() / PrimaryCCD.getBinY();
     int nChannels = Helpers::getNChannels(type);
     size_t nTotalBytes = subW * subH * nChannels * (PrimaryCCD.getBPP() / 8);
 
-    if (Helpers::isRGB(type))
+    if (mReadBuffer.size() < nTotalBytes)
     {
-        buffer = static_cast<uint8_t *>(malloc(nTotalBytes));
-        if (buffer == nullptr)
+        try
+        {
+            mReadBuffer.resize(nTotalBytes);
+        }
+        catch (const std::bad_alloc &)
         {
-            LOGF_ERROR("%s: %d malloc failed (RGB 24/32).", getDeviceName(), nTotalBytes);
-            guard.unlock();
+            LOGF_ERROR("%s: %d malloc failed (read buffer).", getDeviceName(), nTotalBytes);
+            disarmTriggerSession();
             return;
         }
     }
@@ -241,11 +258,8 @@ void SVBONYBase::workerExposure(const std::atomic_bool &isAboutToQuit, float dur
     {
         if (isAboutToQuit)
         {
-            ret = SVBGetVideoData(mCameraInfo.CameraID, buffer, nTotalBytes,  1000);
-            LOGF_DEBUG("Discard unretrieved exposure data: SVBGetVideoData(%s)", Helpers::toString(ret));
-            if (Helpers::isRGB(type))
-                free(buffer);
-            guard.unlock();
+            // Stopping the capture drops the frame that is still on its way
+            disarmTriggerSession();
             PrimaryCCD.setExposureLeft(0);
             return;
         }
@@ -273,13 +287,29 @@ void SVBONYBase::workerExposure(const std::atomic_bool &isAboutToQuit, float dur
         }
         else
         {
-            ret = SVBGetVideoData(mCameraInfo.CameraID, buffer, nTotalBytes, 1000);
+            // The frame buffer is locked once the data arrived, not while waiting for it
+            const uint8_t *buffer = mReadBuffer.data();
+            ret = SVBGetVideoData(mCameraInfo.CameraID, mReadBuffer.data(), nTotalBytes, 1000);
             LOGF_DEBUG("Retrieved exposure data: SVBGetVideoData(%s)", Helpers::toString(ret));
+
+            std::unique_lock<std::mutex> guard(ccdBufferLock, std::defer_lock);
+            if (ret == SVB_SUCCESS)
+            {
+                guard.lock();
+                // The frame may have changed during the exposure
+                if (static_cast<size_t>(PrimaryCCD.getFrameBufferSize()) < nTotalBytes)
+                    ret = SVB_ERROR_BUFFER_TOO_SMALL;
+            }
             switch (ret)
             {
                 case SVB_SUCCESS:
-                    if (Helpers::isRGB(type))
+                    if (!Helpers::isRGB(type))
+                    {
+                        memcpy(PrimaryCCD.getFrameBuffer(), buffer, nTotalBytes);
+                    }
+                    else
                     {
+                        uint8_t *image = PrimaryCCD.getFrameBuffer();
                         uint8_t *dstR = image;
                         uint8_t *dstG = image + subW * subH;
                         uint8_t *dstB = image + subW * subH * 2;
@@ -311,7 +341,6 @@ void SVBONYBase::workerExposure(const std::atomic_bool &isAboutToQuit, float dur
                                 *dstR++ = *src++;
                             }
                         }
-                        free(buffer);
                     }
                     guard.unlock();
                     sendImage(type, duration);
@@ -334,9 +363,9 @@ void SVBONYBase::workerExposure(const std::atomic_bool &isAboutToQuit, float dur
                     }
                     //fall through
                 default: // Cannot continue to retrive image data when ret is any error except timeout.
-                    if (Helpers::isRGB(type))
-                        free(buffer);
-                    guard.unlock();
+                    if (guard.owns_lock())
+                        guard.unlock();
+                    disarmTriggerSession();
                     PrimaryCCD.setExposureLeft(0);
                     PrimaryCCD.setExposureFailed();
                     return;
@@ -672,7 +701,7 @@ bool SVBONYBase::Disconnect()
 
     if (isSimulation() == false)
     {
-        SVBStopVideoCapture(mCameraInfo.CameraID);
+        disarmTriggerSession();
         SVBCloseCamera(mCameraInfo.CameraID);
     }
 
@@ -1053,7 +1082,7 @@ bool SVBONYBase::AbortExposure()
 
     mWorker.quit();
 
-    SVBStopVideoCapture(mCameraInfo.CameraID);
+    disarmTriggerSession();
     return true;
 }
 
@@ -1112,11 +1141,16 @@ bool SVBONYBase::UpdateCCDFrame(int x, int y, int w, int h)
         return false;
     }
 
-    mCurrentVideoFormat = getImageType();
+    SVB_IMG_TYPE type = getImageType();
+    if (type != mCurrentVideoFormat)
+    {
+        // The output type can only be changed while the camera is not capturing
+        disarmTriggerSession();
+        mCurrentVideoFormat = type;
+        SVBSetOutputImageType(mCameraInfo.CameraID, mCurrentVideoFormat);
+    }
     PrimaryCCD.setBPP(Helpers::getBPP(mCurrentVideoFormat));
 
-    SVBSetOutputImageType(mCameraInfo.CameraID, mCurrentVideoFormat);
-
     // Set UNBINNED coords
     PrimaryCCD.setFrame(subX * binX, subY * binY, subW * binX, subH * binY);
 
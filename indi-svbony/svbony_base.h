@@ -25,11 +25,14 @@
 
 #include <SVBCameraSDK.h>
 
+#include "svbony_trigger.h"
+
 #include "indipropertyswitch.h"
 #include "indipropertynumber.h"
 #include "indipropertytext.h"
 #include "indisinglethreadpool.h"
 
+#include <mutex>
 #include <vector>
 
 #include <indiccd.h>
@@ -92,6 +95,14 @@ class SVBONYBase : public INDI::CCD
         void workerStreamVideo(const std::atomic_bool &isAboutToQuit);
         void workerExposure(const std::atomic_bool &isAboutToQuit, float duration);
 
+        /** Soft trigger capture session, kept armed across exposures until the frame changes */
+        bool armTriggerSession();
+        void disarmTriggerSession();
+        SVBONYTriggerSession mTriggerSession;
+
+        /** Read buffer for all frames, reused across exposures */
+        std::vector<uint8_t> mReadBuffer;
+
         /** Send CCD image to client */
         void sendImage(SVB_IMG_TYPE type, float duration);
 
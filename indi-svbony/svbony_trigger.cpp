@@ -0,0 +1,62 @@
+/*
+    SVBony soft trigger session
+    Copyright (C) 2026 INDI 3rd party contributors
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#include "svbony_trigger.h"
+
+SVB_ERROR_CODE SVBONYTriggerSession::arm(int cameraID, const char *&failedCall)
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    if (mArmed)
+        return SVB_SUCCESS;
+
+    SVB_ERROR_CODE ret = SVBSetCameraMode(cameraID, SVB_MODE_TRIG_SOFT);
+    if (ret != SVB_SUCCESS)
+    {
+        failedCall = "SVBSetCameraMode";
+        return ret;
+    }
+
+    ret = SVBStartVideoCapture(cameraID);
+    if (ret != SVB_SUCCESS)
+    {
+        failedCall = "SVBStartVideoCapture";
+        return ret;
+    }
+
+    mArmed = true;
+    mCameraID = cameraID;
+    return SVB_SUCCESS;
+}
+
+SVB_ERROR_CODE SVBONYTriggerSession::disarm()
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    if (!mArmed)
+        return SVB_SUCCESS;
+
+    // The session is over even if stopping failed, the next exposure starts a new one
+    mArmed = false;
+    return SVBStopVideoCapture(mCameraID);
+}
+
+bool SVBONYTriggerSession::isArmed()
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    return mArmed;
+}
@@ -0,0 +1,51 @@
+/*
+    SVBony soft trigger session
+    Copyright (C) 2026 INDI 3rd party contributors
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+
+    Only depends on the SVBony SDK, so the tests link it against the SDK
+    shim in test/fake instead.
+*/
+
+#pragma once
+
+#include <SVBCameraSDK.h>
+
+#include <mutex>
+
+/**
+ * Soft trigger capture session of one camera. It is armed by the first exposure and kept armed
+ * across exposures, until it is disarmed because the frame changed or a frame was not retrieved.
+ */
+class SVBONYTriggerSession
+{
+    public:
+        /**
+         * Puts the camera in soft trigger mode and starts capturing, unless the session is armed.
+         * On failure nothing is armed and failedCall names the SDK call that failed.
+         */
+        SVB_ERROR_CODE arm(int cameraID, const char *&failedCall);
+
+        /** Stops capturing, if the session is armed. Returns the result of SVBStopVideoCapture. */
+        SVB_ERROR_CODE disarm();
+
+        bool isArmed();
+
+    private:
+        std::mutex mMutex;
+        bool mArmed {false};
+        int mCameraID {0};
+};
@@ -0,0 +1,107 @@
+/*
+    Shim of the parts of the SVBony SDK used by the SDK-only driver sources.
+    Copyright (C) 2026 INDI 3rd party contributors
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#include "svbony_fake.h"
+
+#include <map>
+#include <mutex>
+
+namespace
+{
+
+std::mutex fakeLock;
+std::vector<std::string> callLog;
+std::map<std::string, SVB_ERROR_CODE> failures;
+bool isCapturing = false;
+SVB_CAMERA_MODE cameraMode = SVB_MODE_NORMAL;
+
+// Records the call and returns its injected result
+SVB_ERROR_CODE record(const std::string &call, const std::string &arguments)
+{
+    callLog.push_back(call + "(" + arguments + ")");
+    auto failure = failures.find(call);
+    return failure != failures.end() ? failure->second : SVB_SUCCESS;
+}
+
+}
+
+SVB_ERROR_CODE SVBSetCameraMode(int iCameraID, SVB_CAMERA_MODE mode)
+{
+    std::lock_guard<std::mutex> lock(fakeLock);
+    SVB_ERROR_CODE ret = record("SVBSetCameraMode", std::to_string(iCameraID) + ", " + std::to_string(mode));
+    if (ret == SVB_SUCCESS)
+        cameraMode = mode;
+    return ret;
+}
+
+SVB_ERROR_CODE SVBStartVideoCapture(int iCameraID)
+{
+    std::lock_guard<std::mutex> lock(fakeLock);
+    SVB_ERROR_CODE ret = record("SVBStartVideoCapture", std::to_string(iCameraID));
+    if (ret == SVB_SUCCESS)
+        isCapturing = true;
+    return ret;
+}
+
+SVB_ERROR_CODE SVBStopVideoCapture(int iCameraID)
+{
+    std::lock_guard<std::mutex> lock(fakeLock);
+    SVB_ERROR_CODE ret = record("SVBStopVideoCapture", std::to_string(iCameraID));
+    if (ret == SVB_SUCCESS)
+        isCapturing = false;
+    return ret;
+}
+
+namespace SVBFake
+{
+
+void reset()
+{
+    std::lock_guard<std::mutex> lock(fakeLock);
+    callLog.clear();
+    failures.clear();
+    isCapturing = false;
+    cameraMode = SVB_MODE_NORMAL;
+}
+
+void fail(const std::string &call, SVB_ERROR_CODE code)
+{
+    std::lock_guard<std::mutex> lock(fakeLock);
+    if (code == SVB_SUCCESS)
+        failures.erase(call);
+    else
+        failures[call] = code;
+}
+
+const std::vector<std::string> &calls()
+{
+    return callLog;
+}
+
+bool capturing()
+{
+    return isCapturing;
+}
+
+SVB_CAMERA_MODE mode()
+{
+    return cameraMode;
+}
+
+}
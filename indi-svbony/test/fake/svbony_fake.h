@@ -0,0 +1,46 @@
+/*
+    Shim of the parts of the SVBony SDK used by the SDK-only driver sources.
+    Copyright (C) 2026 INDI 3rd party contributors
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+
+    The tests compile against the real SVBCameraSDK.h and link svbony_fake.cpp
+    instead of libSVBCameraSDK, so no camera is needed. The shim records every
+    call and the camera state the calls leave behind.
+*/
+
+#pragma once
+
+#include <SVBCameraSDK.h>
+
+#include <string>
+#include <vector>
+
+namespace SVBFake
+{
+
+// Clears the calls and failures, the camera is idle in normal mode.
+void reset();
+
+// Makes the named SDK call return code, SVB_SUCCESS to make it succeed again.
+void fail(const std::string &call, SVB_ERROR_CODE code);
+
+// Calls made so far, as "SVBSetCameraMode(1, 2)".
+const std::vector<std::string> &calls();
+
+bool capturing();
+SVB_CAMERA_MODE mode();
+
+}
@@ -0,0 +1,146 @@
+/*
+    SVBony soft trigger session against the SDK shim in test/fake.
+    Copyright (C) 2026 INDI 3rd party contributors
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#include "svbony_trigger.h"
+#include "fake/svbony_fake.h"
+
+#include <gtest/gtest.h>
+
+#include <thread>
+
+namespace
+{
+
+const int CAMERA = 3;
+
+const std::string SET_TRIGGER_MODE = "SVBSetCameraMode(3, " + std::to_string(SVB_MODE_TRIG_SOFT) + ")";
+const std::string START_CAPTURE = "SVBStartVideoCapture(3)";
+const std::string STOP_CAPTURE = "SVBStopVideoCapture(3)";
+
+class SVBONYTriggerTest : public ::testing::Test
+{
+    protected:
+        void SetUp() override
+        {
+            SVBFake::reset();
+        }
+
+        SVB_ERROR_CODE arm()
+        {
+            failedCall = "";
+            return session.arm(CAMERA, failedCall);
+        }
+
+        SVBONYTriggerSession session;
+        const char *failedCall = "";
+};
+
+}
+
+TEST_F(SVBONYTriggerTest, ArmedOnceAcrossExposures)
+{
+    for (int i = 0; i < 5; i++)
+        ASSERT_EQ(arm(), SVB_SUCCESS);
+
+    EXPECT_TRUE(session.isArmed());
+    EXPECT_TRUE(SVBFake::capturing());
+    EXPECT_EQ(SVBFake::mode(), SVB_MODE_TRIG_SOFT);
+    EXPECT_EQ(SVBFake::calls(), std::vector<std::string>({SET_TRIGGER_MODE, START_CAPTURE}));
+}
+
+TEST_F(SVBONYTriggerTest, FrameChangeStartsANewSession)
+{
+    // The driver disarms before a ROI, bin or format change, and the next exposure arms again
+    ASSERT_EQ(arm(), SVB_SUCCESS);
+    EXPECT_EQ(session.disarm(), SVB_SUCCESS);
+    EXPECT_FALSE(session.isArmed());
+    EXPECT_FALSE(SVBFake::capturing());
+    ASSERT_EQ(arm(), SVB_SUCCESS);
+
+    EXPECT_EQ(SVBFake::calls(), std::vector<std::string>({SET_TRIGGER_MODE, START_CAPTURE, STOP_CAPTURE,
+              SET_TRIGGER_MODE, START_CAPTURE}));
+}
+
+TEST_F(SVBONYTriggerTest, DisarmWithoutSessionDoesNothing)
+{
+    EXPECT_EQ(session.disarm(), SVB_SUCCESS);
+    ASSERT_EQ(arm(), SVB_SUCCESS);
+    EXPECT_EQ(session.disarm(), SVB_SUCCESS);
+    EXPECT_EQ(session.disarm(), SVB_SUCCESS);
+
+    EXPECT_EQ(SVBFake::calls(), std::vector<std::string>({SET_TRIGGER_MODE, START_CAPTURE, STOP_CAPTURE}));
+}
+
+TEST_F(SVBONYTriggerTest, FailedModeArmsNothing)
+{
+    SVBFake::fail("SVBSetCameraMode", SVB_ERROR_CAMERA_CLOSED);
+    EXPECT_EQ(arm(), SVB_ERROR_CAMERA_CLOSED);
+    EXPECT_STREQ(failedCall, "SVBSetCameraMode");
+    EXPECT_FALSE(session.isArmed());
+    EXPECT_FALSE(SVBFake::capturing());
+
+    // Nothing to stop, and the next exposure tries again
+    EXPECT_EQ(session.disarm(), SVB_SUCCESS);
+    SVBFake::fail("SVBSetCameraMode", SVB_SUCCESS);
+    EXPECT_EQ(arm(), SVB_SUCCESS);
+    EXPECT_EQ(SVBFake::calls(), std::vector<std::string>({SET_TRIGGER_MODE, SET_TRIGGER_MODE, START_CAPTURE}));
+}
+
+TEST_F(SVBONYTriggerTest, FailedCaptureArmsNothing)
+{
+    SVBFake::fail("SVBStartVideoCapture", SVB_ERROR_GENERAL_ERROR);
+    EXPECT_EQ(arm(), SVB_ERROR_GENERAL_ERROR);
+    EXPECT_STREQ(failedCall, "SVBStartVideoCapture");
+    EXPECT_FALSE(session.isArmed());
+
+    SVBFake::fail("SVBStartVideoCapture", SVB_SUCCESS);
+    EXPECT_EQ(arm(), SVB_SUCCESS);
+    EXPECT_TRUE(SVBFake::capturing());
+}
+
+TEST_F(SVBONYTriggerTest, FailedStopEndsTheSession)
+{
+    ASSERT_EQ(arm(), SVB_SUCCESS);
+    SVBFake::fail("SVBStopVideoCapture", SVB_ERROR_GENERAL_ERROR);
+    EXPECT_EQ(session.disarm(), SVB_ERROR_GENERAL_ERROR);
+    EXPECT_FALSE(session.isArmed());
+
+    // The next exposure arms a new session rather than reusing a broken one
+    SVBFake::fail("SVBStopVideoCapture", SVB_SUCCESS);
+    ASSERT_EQ(arm(), SVB_SUCCESS);
+    EXPECT_EQ(SVBFake::calls().back(), START_CAPTURE);
+}
+
+TEST_F(SVBONYTriggerTest, AbortRacesTheExposure)
+{
+    // An abort disarms from the client thread while the worker arms for the next exposure
+    for (int i = 0; i < 200; i++)
+    {
+        std::thread worker([this]()
+        {
+            const char *failed = "";
+            session.arm(CAMERA, failed);
+        });
+        session.disarm();
+        worker.join();
+        session.disarm();
+        ASSERT_FALSE(session.isArmed());
+        ASSERT_FALSE(SVBFake::capturing());
+    }
+}
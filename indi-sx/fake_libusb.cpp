@@ -0,0 +1,439 @@
+/*
+ Starlight Xpress CCD INDI Driver
+
+ In-process libusb replacement simulating a single SX camera, used by the unit tests.
+
+ This program is free software; you can redistribute it and/or modify it
+ under the terms of the GNU General Public License as published by the Free
+ Software Foundation; either version 2 of the License, or (at your option)
+ any later version.
+
+ This program is distributed in the hope that it will be useful, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ more details.
+
+ You should have received a copy of the GNU General Public License along with
+ this program; if not, write to the Free Software Foundation, Inc., 59
+ Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+ The full GNU General Public License is included in this distribution in the
+ file called LICENSE.
+ */
+
+#include "fake_libusb.h"
+
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <string.h>
+#include <thread>
+
+#define SX_VID 0x1278
+#define SX_PID 0x507
+
+#define FAKE_BULK_IN  0x82
+#define FAKE_BULK_OUT 0x01
+
+#define SXUSB_GET_FIRMWARE_VERSION 255
+#define SXUSB_READ_PIXELS          3
+#define SXUSB_GET_CCD              8
+#define SXUSB_SET_STAR2K           9
+#define SXUSB_CAMERA_MODEL         14
+#define SXUSB_BUILD_NUMBER         19
+#define SXUSB_COOLER               30
+#define SXUSB_SHUTTER              32
+
+struct libusb_context
+{
+    int unused;
+};
+
+struct libusb_device
+{
+    int refs;
+};
+
+struct libusb_device_handle
+{
+    libusb_device *device;
+};
+
+namespace
+{
+
+typedef std::chrono::steady_clock Clock;
+
+struct PendingTransfer
+{
+    libusb_transfer *transfer;
+    Clock::time_point deadline;
+    bool cancelled;
+};
+
+struct Camera
+{
+    std::mutex lock;
+    std::condition_variable changed;
+
+    unsigned short model { 0x16 };
+    unsigned short width { 640 };
+    unsigned short height { 480 };
+    unsigned char caps { 0 };
+    double pixelRate { 40e6 };
+
+    // Reply to the last command, read back on the bulk in pipe
+    std::vector<unsigned char> reply;
+    // Latched frame being streamed
+    unsigned long streamed { 0 };
+    unsigned long streamSize { 0 };
+    Clock::time_point streamStart;
+    // Time at which the last queued bulk in transfer completes
+    Clock::time_point streamTail;
+    std::deque<PendingTransfer> pending;
+
+    int collisions { 0 };
+    std::vector<FakeSX::Star2000Write> star2000;
+} camera;
+
+libusb_context context;
+libusb_device device { 1 };
+
+bool downloading()
+{
+    return camera.streamed < camera.streamSize;
+}
+
+void pushReply(std::initializer_list<unsigned char> bytes)
+{
+    if (downloading())
+        camera.collisions++;
+    camera.reply.assign(bytes);
+}
+
+void command(const unsigned char *data, int length)
+{
+    if (length < 8)
+        return;
+    switch (data[1])
+    {
+        case SXUSB_CAMERA_MODEL:
+            pushReply({ (unsigned char)camera.model, (unsigned char)(camera.model >> 8) });
+            break;
+        case SXUSB_GET_FIRMWARE_VERSION:
+            pushReply({ 1, 0, 1, 0 });
+            break;
+        case SXUSB_BUILD_NUMBER:
+            pushReply({ 1, 0 });
+            break;
+        case SXUSB_GET_CCD:
+            pushReply({ 0, 0, (unsigned char)camera.width, (unsigned char)(camera.width >> 8), 0, 0,
+                        (unsigned char)camera.height, (unsigned char)(camera.height >> 8), 0x00, 0x06, 0x00, 0x06,
+                        0xFF, 0x0F, 16, 0, camera.caps });
+            break;
+        case SXUSB_COOLER:
+            pushReply({ 0xAA, 0x0A, data[4] });
+            break;
+        case SXUSB_SHUTTER:
+            pushReply({ 0, 0 });
+            break;
+        case SXUSB_SET_STAR2K:
+            camera.star2000.push_back({ data[2], Clock::now(), downloading() });
+            break;
+        case SXUSB_READ_PIXELS:
+        {
+            if (length < 18)
+                return;
+            unsigned long width  = data[12] | (data[13] << 8);
+            unsigned long height = data[14] | (data[15] << 8);
+            unsigned long xbin   = std::max<unsigned long>(data[16], 1);
+            unsigned long ybin   = std::max<unsigned long>(data[17], 1);
+            camera.streamed    = 0;
+            camera.streamSize  = (width / xbin) * (height / ybin) * 2;
+            camera.streamStart = Clock::now();
+            camera.streamTail  = camera.streamStart;
+            break;
+        }
+        default:
+            break;
+    }
+}
+
+// Copies the next pixels of the latched frame, the caller holds the camera lock
+int stream(unsigned char *data, int length)
+{
+    unsigned long count = std::min<unsigned long>(length, camera.streamSize - camera.streamed);
+    for (unsigned long i = 0; i < count; i++)
+        data[i] = FakeSX::pixelAt(camera.streamed + i);
+    camera.streamed += count;
+    return count;
+}
+
+Clock::duration streamTime(int length)
+{
+    return std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(length / camera.pixelRate));
+}
+
+}
+
+namespace FakeSX
+{
+
+void reset(unsigned short model, unsigned short width, unsigned short height, unsigned char caps)
+{
+    std::lock_guard<std::mutex> guard(camera.lock);
+    camera.model      = model;
+    camera.width      = width;
+    camera.height     = height;
+    camera.caps       = caps;
+    camera.streamed   = 0;
+    camera.streamSize = 0;
+    camera.collisions = 0;
+    camera.reply.clear();
+    camera.star2000.clear();
+}
+
+void setPixelRate(double bytesPerSecond)
+{
+    std::lock_guard<std::mutex> guard(camera.lock);
+    camera.pixelRate = bytesPerSecond;
+}
+
+unsigned char pixelAt(unsigned long offset)
+{
+    return (unsigned char)(offset * 7 + offset / 509);
+}
+
+bool isDownloading()
+{
+    std::lock_guard<std::mutex> guard(camera.lock);
+    return downloading();
+}
+
+int collisions()
+{
+    std::lock_guard<std::mutex> guard(camera.lock);
+    return camera.collisions;
+}
+
+std::vector<Star2000Write> star2000Writes()
+{
+    std::lock_guard<std::mutex> guard(camera.lock);
+    return camera.star2000;
+}
+
+}
+
+int LIBUSB_CALL libusb_init(libusb_context **ctx)
+{
+    if (ctx)
+        *ctx = &context;
+    return 0;
+}
+
+void LIBUSB_CALL libusb_exit(libusb_context *)
+{
+}
+
+const char *LIBUSB_CALL libusb_error_name(int)
+{
+    return "LIBUSB_ERROR";
+}
+
+ssize_t LIBUSB_CALL libusb_get_device_list(libusb_context *, libusb_device ***list)
+{
+    static libusb_device *devices[2] = { &device, nullptr };
+    *list = devices;
+    return 1;
+}
+
+void LIBUSB_CALL libusb_free_device_list(libusb_device **, int)
+{
+}
+
+libusb_device *LIBUSB_CALL libusb_ref_device(libusb_device *dev)
+{
+    dev->refs++;
+    return dev;
+}
+
+void LIBUSB_CALL libusb_unref_device(libusb_device *dev)
+{
+    dev->refs--;
+}
+
+int LIBUSB_CALL libusb_get_device_descriptor(libusb_device *, struct libusb_device_descriptor *desc)
+{
+    memset(desc, 0, sizeof(*desc));
+    desc->idVendor  = SX_VID;
+    desc->idProduct = SX_PID;
+    return 0;
+}
+
+int LIBUSB_CALL libusb_get_config_descriptor(libusb_device *, uint8_t, struct libusb_config_descriptor **config)
+{
+    static struct libusb_interface_descriptor altsetting;
+    static struct libusb_interface interface;
+    static struct libusb_config_descriptor descriptor;
+    interface.altsetting      = &altsetting;
+    interface.num_altsetting  = 1;
+    descriptor.interface      = &interface;
+    descriptor.bNumInterfaces = 1;
+    *config                   = &descriptor;
+    return 0;
+}
+
+void LIBUSB_CALL libusb_free_config_descriptor(struct libusb_config_descriptor *)
+{
+}
+
+int LIBUSB_CALL libusb_open(libusb_device *dev, libusb_device_handle **dev_handle)
+{
+    *dev_handle = new libusb_device_handle { dev };
+    return 0;
+}
+
+void LIBUSB_CALL libusb_close(libusb_device_handle *dev_handle)
+{
+    delete dev_handle;
+}
+
+int LIBUSB_CALL libusb_kernel_driver_active(libusb_device_handle *, int)
+{
+    return 0;
+}
+
+int LIBUSB_CALL libusb_detach_kernel_driver(libusb_device_handle *, int)
+{
+    return 0;
+}
+
+int LIBUSB_CALL libusb_claim_interface(libusb_device_handle *, int)
+{
+    return 0;
+}
+
+int LIBUSB_CALL libusb_release_interface(libusb_device_handle *, int)
+{
+    return 0;
+}
+
+int LIBUSB_CALL libusb_bulk_transfer(libusb_device_handle *, unsigned char endpoint, unsigned char *data, int length,
+                                     int *actual_length, unsigned int timeout)
+{
+    std::unique_lock<std::mutex> guard(camera.lock);
+    if (endpoint == FAKE_BULK_OUT)
+    {
+        command(data, length);
+        *actual_length = length;
+        return 0;
+    }
+    if (!camera.reply.empty())
+    {
+        int count = std::min<int>(length, camera.reply.size());
+        memcpy(data, camera.reply.data(), count);
+        camera.reply.clear();
+        *actual_length = count;
+        return 0;
+    }
+    if (downloading())
+    {
+        camera.streamTail = std::max(camera.streamTail, Clock::now()) + streamTime(length);
+        Clock::time_point ready = camera.streamTail;
+        while (Clock::now() < ready)
+            camera.changed.wait_until(guard, ready);
+        *actual_length = stream(data, length);
+        return 0;
+    }
+    guard.unlock();
+    std::this_thread::sleep_for(std::chrono::milliseconds(std::min(timeout, 100u)));
+    *actual_length = 0;
+    return LIBUSB_ERROR_TIMEOUT;
+}
+
+struct libusb_transfer *LIBUSB_CALL libusb_alloc_transfer(int)
+{
+    return new libusb_transfer();
+}
+
+void LIBUSB_CALL libusb_free_transfer(struct libusb_transfer *transfer)
+{
+    delete transfer;
+}
+
+int LIBUSB_CALL libusb_submit_transfer(struct libusb_transfer *transfer)
+{
+    std::lock_guard<std::mutex> guard(camera.lock);
+    if (transfer->endpoint != FAKE_BULK_IN || transfer->type != LIBUSB_TRANSFER_TYPE_BULK)
+        return LIBUSB_ERROR_NOT_SUPPORTED;
+    camera.streamTail = std::max(camera.streamTail, Clock::now()) + streamTime(transfer->length);
+    camera.pending.push_back({ transfer, camera.streamTail, false });
+    camera.changed.notify_all();
+    return 0;
+}
+
+int LIBUSB_CALL libusb_cancel_transfer(struct libusb_transfer *transfer)
+{
+    std::lock_guard<std::mutex> guard(camera.lock);
+    for (auto &pending : camera.pending)
+        if (pending.transfer == transfer)
+        {
+            pending.cancelled = true;
+            camera.changed.notify_all();
+            return 0;
+        }
+    return LIBUSB_ERROR_NOT_FOUND;
+}
+
+int LIBUSB_CALL libusb_handle_events_timeout_completed(libusb_context *, struct timeval *tv, int *)
+{
+    Clock::time_point until = Clock::now() + std::chrono::seconds(tv->tv_sec) + std::chrono::microseconds(tv->tv_usec);
+    std::vector<libusb_transfer *> done;
+    {
+        std::unique_lock<std::mutex> guard(camera.lock);
+        while (done.empty())
+        {
+            Clock::time_point now = Clock::now();
+            // Transfers complete in submission order, like the endpoint queue of a real device
+            while (!camera.pending.empty() && (camera.pending.front().cancelled || camera.pending.front().deadline <= now))
+            {
+                PendingTransfer pending = camera.pending.front();
+                camera.pending.pop_front();
+                libusb_transfer *transfer = pending.transfer;
+                if (pending.cancelled)
+                {
+                    transfer->status        = LIBUSB_TRANSFER_CANCELLED;
+                    transfer->actual_length = 0;
+                }
+                else if (downloading())
+                {
+                    transfer->status        = LIBUSB_TRANSFER_COMPLETED;
+                    transfer->actual_length = stream(transfer->buffer, transfer->length);
+                }
+                else
+                {
+                    transfer->status        = LIBUSB_TRANSFER_TIMED_OUT;
+                    transfer->actual_length = 0;
+                }
+                done.push_back(transfer);
+            }
+            if (!done.empty() || now >= until)
+                break;
+            Clock::time_point wake = until;
+            if (!camera.pending.empty())
+                wake = std::min(wake, camera.pending.front().deadline);
+            camera.changed.wait_until(guard, wake);
+        }
+    }
+    // Callbacks may submit the next chunk, so they run without the camera lock
+    for (auto transfer : done)
+        transfer->callback(transfer);
+    return 0;
+}
+
+int LIBUSB_CALL libusb_handle_events(libusb_context *ctx)
+{
+    struct timeval tv = { 60, 0 };
+    return libusb_handle_events_timeout_completed(ctx, &tv, nullptr);
+}
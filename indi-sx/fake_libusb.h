@@ -0,0 +1,65 @@
+/*
+ Starlight Xpress CCD INDI Driver
+
+ In-process libusb replacement simulating a single SX camera, used by the unit tests.
+
+ This program is free software; you can redistribute it and/or modify it
+ under the terms of the GNU General Public License as published by the Free
+ Software Foundation; either version 2 of the License, or (at your option)
+ any later version.
+
+ This program is distributed in the hope that it will be useful, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ more details.
+
+ You should have received a copy of the GNU General Public License along with
+ this program; if not, write to the Free Software Foundation, Inc., 59
+ Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+ The full GNU General Public License is included in this distribution in the
+ file called LICENSE.
+ */
+
+#pragma once
+
+#ifdef OSX_EMBEDED_MODE
+#include <libusb.h>
+#else
+#include <libusb-1.0/libusb.h>
+#endif
+
+#include <chrono>
+#include <vector>
+
+namespace FakeSX
+{
+
+// One write to the ST4 port as seen by the camera
+struct Star2000Write
+{
+    unsigned char value;
+    std::chrono::steady_clock::time_point time;
+    // True when the write arrived while pixels were still streaming
+    bool downloading;
+};
+
+// Configures the simulated camera, clears all logs and drops a pending frame
+void reset(unsigned short model, unsigned short width, unsigned short height, unsigned char caps);
+
+// Rate at which latched pixels become readable on the bulk in pipe
+void setPixelRate(double bytesPerSecond);
+
+// Value of the byte at the given offset of a latched frame
+unsigned char pixelAt(unsigned long offset);
+
+// True while latched pixels have not been read yet
+bool isDownloading();
+
+// Commands answered on the bulk in pipe which arrived while pixels were streaming. A real camera
+// would interleave the reply with the pixels, so a correct driver never sends them.
+int collisions();
+
+std::vector<Star2000Write> star2000Writes();
+
+}
@@ -34,7 +34,9 @@
 #include "sxconfig.h"
 
 #include <cmath>
+#include <chrono>
 #include <deque>
+#include <functional>
 #include <memory>
 #include <unistd.h>
 
@@ -46,6 +48,8 @@
 #define SX_CLEAR_WE    0x06
 
 #define TIMER 1000
+// Retry interval for guide chip commands that wait for a main frame download
+#define DEFER_INTERVAL 50
 
 static class Loader
 {
@@ -73,16 +77,6 @@ void GuideExposureTimerCallback(void *p)
     ((SXCCD *)p)->GuideExposureTimerHit();
 }
 
-void WEGuiderTimerCallback(void *p)
-{
-    ((SXCCD *)p)->WEGuiderTimerHit();
-}
-
-void NSGuiderTimerCallback(void *p)
-{
-    ((SXCCD *)p)->NSGuiderTimerHit();
-}
-
 SXCCD::SXCCD(DEVICE device, const char *name)
 {
     this->device          = device;
@@ -106,8 +100,9 @@ SXCCD::SXCCD(DEVICE device, const char *name)
     GuideExposureTimerID  = 0;
     InGuideExposure       = false;
     DidGuideLatch         = false;
-    NSGuiderTimerID       = 0;
-    WEGuiderTimerID       = 0;
+    DidGuideClear         = false;
+    ShutterPending        = false;
+    pulseQuit             = false;
     snprintf(this->name, 32, "SX CCD %s", name);
     setDeviceName(this->name);
     setVersion(VERSION_MAJOR, VERSION_MINOR);
@@ -115,6 +110,8 @@ SXCCD::SXCCD(DEVICE device, const char *name)
 
 SXCCD::~SXCCD()
 {
+    readoutWorker.quit();
+    StopPulseThread();
     if (handle)
         sxClose(&handle);
 }
@@ -289,6 +286,9 @@ bool SXCCD::Connect()
 
             SetCCDCapability(cap);
 
+            if (HasST4Port)
+                StartPulseThread();
+
             return true;
         }
     }
@@ -297,8 +297,12 @@ bool SXCCD::Connect()
 
 bool SXCCD::Disconnect()
 {
+    // Cancels a download in progress
+    readoutWorker.quit();
+    StopPulseThread();
     if (handle != nullptr)
     {
+        std::lock_guard<std::mutex> lock(usbMutex);
         sxClose(&handle);
     }
     return true;
@@ -359,24 +363,31 @@ void SXCCD::SetupParms()
 
 void SXCCD::TimerHit()
 {
-    if (isConnected() && HasCooler)
+    // Commands answered on the bulk in pipe would mix with the pixels of a download,
+    // they are sent on a later tick.
+    if (isConnected() && HasShutter && ShutterPending && !DidLatch)
+    {
+        std::lock_guard<std::mutex> lock(usbMutex);
+        sxSetShutter(handle, ShutterS[0].s != ISS_ON);
+        ShutterPending = false;
+    }
+    if (isConnected() && HasCooler && !DidLatch)
     {
-        if (!DidLatch && !DidGuideLatch)
+        unsigned char status;
+        unsigned short temperature;
+        std::unique_lock<std::mutex> lock(usbMutex);
+        sxSetCooler(handle, (unsigned char)(CoolerS[0].s == ISS_ON),
+                    (unsigned short)(TemperatureRequest * 10 + 2730), &status, &temperature);
+        lock.unlock();
+        TemperatureN[0].value = (temperature - 2730) / 10.0;
+        if (TemperatureReported != TemperatureN[0].value)
         {
-            unsigned char status;
-            unsigned short temperature;
-            sxSetCooler(handle, (unsigned char)(CoolerS[0].s == ISS_ON),
-                        (unsigned short)(TemperatureRequest * 10 + 2730), &status, &temperature);
-            TemperatureN[0].value = (temperature - 2730) / 10.0;
-            if (TemperatureReported != TemperatureN[0].value)
-            {
-                TemperatureReported = TemperatureN[0].value;
-                //                if (std::fabs(TemperatureRequest - TemperatureReported) < 1)
-                //                    TemperatureNP.s = IPS_OK;
-                //                else
-                //TemperatureNP.s = IPS_BUSY;
-                IDSetNumber(&TemperatureNP, nullptr);
-            }
+            TemperatureReported = TemperatureN[0].value;
+            //                if (std::fabs(TemperatureRequest - TemperatureReported) < 1)
+            //                    TemperatureNP.s = IPS_OK;
+            //                else
+            //TemperatureNP.s = IPS_BUSY;
+            IDSetNumber(&TemperatureNP, nullptr);
         }
     }
     if (InExposure && ExposureTimeLeft >= 0)
@@ -391,19 +402,27 @@ int SXCCD::SetTemperature(double temperature)
 {
     int result         = 0;
     TemperatureRequest = temperature;
+    CoolerSP.s   = IPS_OK;
+    CoolerS[0].s = ISS_ON;
+    CoolerS[1].s = ISS_OFF;
+    if (DidLatch)
+    {
+        // TimerHit sends the new set point once the download is over
+        IDSetSwitch(&CoolerSP, nullptr);
+        return 0;
+    }
     unsigned char status;
     unsigned short sx_temperature;
+    std::unique_lock<std::mutex> lock(usbMutex);
     sxSetCooler(handle, (unsigned char)(CoolerS[0].s == ISS_ON), (unsigned short)(TemperatureRequest * 10 + 2730),
                 &status, &sx_temperature);
+    lock.unlock();
     TemperatureReported = TemperatureN[0].value = (sx_temperature - 2730) / 10.0;
     if (std::fabs(TemperatureRequest - TemperatureReported) < 1)
         result = 1;
     else
         result = 0;
 
-    CoolerSP.s   = IPS_OK;
-    CoolerS[0].s = ISS_ON;
-    CoolerS[1].s = ISS_OFF;
     IDSetSwitch(&CoolerSP, nullptr);
 
     return result;
@@ -411,8 +430,14 @@ int SXCCD::SetTemperature(double temperature)
 
 bool SXCCD::StartExposure(float n)
 {
+    if (DidLatch)
+    {
+        LOG_ERROR("The previous frame is still downloading.");
+        return false;
+    }
     InExposure = true;
     PrimaryCCD.setExposureDuration(n);
+    std::unique_lock<std::mutex> lock(usbMutex);
     if (sxIsInterlaced(model) && PrimaryCCD.getBinY() == 1)
     {
         sxClearPixels(handle, CCD_EXP_FLAGS_FIELD_EVEN | CCD_EXP_FLAGS_NOWIPE_FRAME, 0);
@@ -423,6 +448,7 @@ bool SXCCD::StartExposure(float n)
         sxClearPixels(handle, CCD_EXP_FLAGS_FIELD_BOTH, 0);
     if (HasShutter && PrimaryCCD.getFrameType() != INDI::CCDChip::DARK_FRAME)
         sxSetShutter(handle, 0);
+    lock.unlock();
     int time = (int)(1000 * n);
     if (time < 1)
         time = 1;
@@ -445,11 +471,19 @@ bool SXCCD::AbortExposure()
     {
         if (ExposureTimerID)
             IERmTimer(ExposureTimerID);
-        if (HasShutter)
+        if (DidLatch)
+        {
+            // Cancelling the bulk transfers mid frame would leave the camera out of step, so the
+            // worker finishes the download and drops the frame.
+            readoutAborted = true;
+        }
+        else if (HasShutter)
+        {
+            std::lock_guard<std::mutex> lock(usbMutex);
             sxSetShutter(handle, 1);
+        }
         ExposureTimerID = 0;
         PrimaryCCD.setExposureLeft(ExposureTimeLeft = 0);
-        DidLatch = false;
         DidFlush = false;
         return true;
     }
@@ -463,138 +497,173 @@ void SXCCD::ExposureTimerHit()
         if (!DidFlush)
         {
             ExposureTimerID = IEAddTimer(3000, ExposureTimerCallback, this);
+            std::lock_guard<std::mutex> lock(usbMutex);
             sxClearPixels(handle, CCD_EXP_FLAGS_NOWIPE_FRAME, 0);
             DidFlush = true;
         }
         else
         {
-            int rc;
-            ExposureTimerID   = 0;
-            bool isInterlaced = sxIsInterlaced(model);
-            int subX          = PrimaryCCD.getSubX();
-            int subY          = PrimaryCCD.getSubY();
-            int subW          = PrimaryCCD.getSubW();
-            int subH          = PrimaryCCD.getSubH();
-            int binX          = PrimaryCCD.getBinX();
-            int binY          = PrimaryCCD.getBinY();
-            int subWW         = subW * 2;
-            bool isICX453     = sxIsICX453(model);
-            uint8_t *buf      = PrimaryCCD.getFrameBuffer();
-            int size;
-            if (isInterlaced && binY > 1)
-                size = subW * subH / 2 / binX / (binY / 2);
+            ExposureTimerID = 0;
+            DidLatch        = true;
+            readoutAborted  = false;
+            readoutWorker.start(std::bind(&SXCCD::workerReadout, this, std::placeholders::_1));
+        }
+    }
+}
+
+void SXCCD::workerReadout(const std::atomic_bool &isAboutToQuit)
+{
+    int rc;
+    {
+        // usbMutex is only held for the commands. While the pixels stream in, other threads may
+        // send commands that are not answered on the bulk in pipe, the ST4 port in particular.
+        // Everything else waits for DidLatch to clear.
+        auto latch = [this](unsigned short flags, unsigned short xoffset, unsigned short yoffset, unsigned short width,
+                            unsigned short height, unsigned short xbin, unsigned short ybin)
+        {
+            std::lock_guard<std::mutex> usbLock(usbMutex);
+            return sxLatchPixels(handle, flags, 0, xoffset, yoffset, width, height, xbin, ybin);
+        };
+        std::unique_lock<std::mutex> guard(ccdBufferLock);
+        bool isInterlaced = sxIsInterlaced(model);
+        int subX          = PrimaryCCD.getSubX();
+        int subY          = PrimaryCCD.getSubY();
+        int subW          = PrimaryCCD.getSubW();
+        int subH          = PrimaryCCD.getSubH();
+        int binX          = PrimaryCCD.getBinX();
+        int binY          = PrimaryCCD.getBinY();
+        int subWW         = subW * 2;
+        bool isICX453     = sxIsICX453(model);
+        uint8_t *buf      = PrimaryCCD.getFrameBuffer();
+        int size;
+        if (isInterlaced && binY > 1)
+            size = subW * subH / 2 / binX / (binY / 2);
+        else
+            size = subW * subH / binX / binY;
+        if (HasShutter)
+        {
+            std::lock_guard<std::mutex> usbLock(usbMutex);
+            sxSetShutter(handle, 1);
+        }
+        if (isInterlaced)
+        {
+            if (binY > 1)
+            {
+                rc = latch(CCD_EXP_FLAGS_FIELD_BOTH, subX, subY / binY, subW, subH / 2, binX, binY / 2);
+                if (rc)
+                    rc = sxReadPixelsAsync(handle, buf, size * 2, &isAboutToQuit);
+            }
             else
-                size = subW * subH / binX / binY;
-            if (HasShutter)
-                sxSetShutter(handle, 1);
-            DidLatch = true;
-            if (isInterlaced)
             {
-                if (binY > 1)
-                {
-                    rc = sxLatchPixels(handle, CCD_EXP_FLAGS_FIELD_BOTH, 0, subX, subY / binY, subW, subH / 2, binX,
-                                       binY / 2);
-                    if (rc)
-                        rc = sxReadPixels(handle, buf, size * 2);
-                }
-                else
+                rc = latch(CCD_EXP_FLAGS_FIELD_EVEN | CCD_EXP_FLAGS_SPARE2, subX, subY / 2, subW, subH / 2, binX, 1);
+                struct timeval tv;
+                gettimeofday(&tv, nullptr);
+                long startTime = tv.tv_sec * 1000000 + tv.tv_usec;
+                if (rc)
+                    rc = sxReadPixelsAsync(handle, evenBuf, size, &isAboutToQuit);
+                gettimeofday(&tv, nullptr);
+                wipeDelay = tv.tv_sec * 1000000 + tv.tv_usec - startTime;
+                if (rc)
+                    rc = latch(CCD_EXP_FLAGS_FIELD_ODD | CCD_EXP_FLAGS_SPARE2, subX, subY / 2, subW, subH / 2, binX, 1);
+                if (rc)
+                    rc = sxReadPixelsAsync(handle, oddBuf, size, &isAboutToQuit);
+                if (rc)
                 {
-                    rc = sxLatchPixels(handle, CCD_EXP_FLAGS_FIELD_EVEN | CCD_EXP_FLAGS_SPARE2, 0, subX, subY / 2, subW,
-                                       subH / 2, binX, 1);
-                    struct timeval tv;
-                    gettimeofday(&tv, nullptr);
-                    long startTime = tv.tv_sec * 1000000 + tv.tv_usec;
-                    if (rc)
-                        rc = sxReadPixels(handle, evenBuf, size);
-                    gettimeofday(&tv, nullptr);
-                    wipeDelay = tv.tv_sec * 1000000 + tv.tv_usec - startTime;
-                    if (rc)
-                        rc = sxLatchPixels(handle, CCD_EXP_FLAGS_FIELD_ODD | CCD_EXP_FLAGS_SPARE2, 0, subX, subY / 2,
-                                           subW, subH / 2, binX, 1);
-                    if (rc)
-                        rc = sxReadPixels(handle, oddBuf, size);
-                    if (rc)
+                    for (int i = 0, j = 0; i < subH; i += 2, j++)
                     {
-                        for (int i = 0, j = 0; i < subH; i += 2, j++)
-                        {
-                            memcpy(buf + i * subWW, oddBuf + (j * subWW), subWW);
-                            memcpy(buf + ((i + 1) * subWW), evenBuf + (j * subWW), subWW);
-                        }
-                        //            deinterlace((unsigned short *)buf, subW, subH);
+                        memcpy(buf + i * subWW, oddBuf + (j * subWW), subWW);
+                        memcpy(buf + ((i + 1) * subWW), evenBuf + (j * subWW), subWW);
                     }
+                    //            deinterlace((unsigned short *)buf, subW, subH);
                 }
             }
-            else if (isICX453)
+        }
+        else if (isICX453)
+        {
+            rc = latch(CCD_EXP_FLAGS_FIELD_BOTH, subX * 2, subY / 2, subW * 2, subH / 2, binX, binY);
+            if (rc)
             {
-                rc = sxLatchPixels(handle, CCD_EXP_FLAGS_FIELD_BOTH, 0, subX * 2, subY / 2, subW * 2, subH / 2, binX, binY);
-                if (rc)
+                if (binX == 1 && binY == 1)
                 {
-                    if (binX == 1 && binY == 1)
+                    rc = sxReadPixelsAsync(handle, evenBuf, size * 2, &isAboutToQuit);
+                    if (rc)
                     {
-                        rc = sxReadPixels(handle, evenBuf, size * 2);
-                        if (rc)
+                        uint16_t *buf16 = reinterpret_cast<uint16_t *>(buf);
+                        uint16_t *evenBuf16 = reinterpret_cast<uint16_t *>(evenBuf);
+
+                        int offset_1 = 2, offset_2 = 3;
+                        if (strstr(getDeviceName(), "SXVF-M25C"))
                         {
-                            uint16_t *buf16 = reinterpret_cast<uint16_t *>(buf);
-                            uint16_t *evenBuf16 = reinterpret_cast<uint16_t *>(evenBuf);
+                            // Patch by Greg Bosch on 2020-01-02 to fix bayer pattern
+                            // on SXVF-M25C.
+                            offset_1 = 3;
+                            offset_2 = 2;
+                        }
 
-                            int offset_1 = 2, offset_2 = 3;
-                            if (strstr(getDeviceName(), "SXVF-M25C"))
+                        for (int i = 0; i < subH; i += 2)
+                        {
+                            for (int j = 0; j < subW; j += 2)
                             {
-                                // Patch by Greg Bosch on 2020-01-02 to fix bayer pattern
-                                // on SXVF-M25C.
-                                offset_1 = 3;
-                                offset_2 = 2;
-                            }
+                                int isubW = i * subW;
+                                int i1subW = (i + 1) * subW;
+                                int j2 = j * 2;
+
+                                buf16[isubW + j]  = evenBuf16[isubW + j2];
+                                buf16[isubW + j + 1]  = evenBuf16[isubW + j2 + offset_1];
+                                buf16[i1subW + j]  = evenBuf16[isubW + j2 + 1];
+                                buf16[i1subW + j + 1]  = evenBuf16[isubW + j2 + offset_2];
 
-                            for (int i = 0; i < subH; i += 2)
-                            {
-                                for (int j = 0; j < subW; j += 2)
-                                {
-                                    int isubW = i * subW;
-                                    int i1subW = (i + 1) * subW;
-                                    int j2 = j * 2;
-
-                                    buf16[isubW + j]  = evenBuf16[isubW + j2];
-                                    buf16[isubW + j + 1]  = evenBuf16[isubW + j2 + offset_1];
-                                    buf16[i1subW + j]  = evenBuf16[isubW + j2 + 1];
-                                    buf16[i1subW + j + 1]  = evenBuf16[isubW + j2 + offset_2];
-
-                                }
                             }
                         }
                     }
-                    else
-                    {
-                        rc = sxReadPixels(handle, buf, size * 2);
-                    }
+                }
+                else
+                {
+                    rc = sxReadPixelsAsync(handle, buf, size * 2, &isAboutToQuit);
                 }
             }
-            else
-            {
-                rc = sxLatchPixels(handle, CCD_EXP_FLAGS_FIELD_BOTH, 0, subX, subY, subW, subH, binX, binY);
-                if (rc)
-                    rc = sxReadPixels(handle, buf, size * 2);
-            }
-            DidLatch   = false;
-            InExposure = false;
-            PrimaryCCD.setExposureLeft(ExposureTimeLeft = 0);
+        }
+        else
+        {
+            rc = latch(CCD_EXP_FLAGS_FIELD_BOTH, subX, subY, subW, subH, binX, binY);
             if (rc)
-                ExposureComplete(&PrimaryCCD);
+                rc = sxReadPixelsAsync(handle, buf, size * 2, &isAboutToQuit);
         }
     }
+    DidLatch   = false;
+    InExposure = false;
+    PrimaryCCD.setExposureLeft(ExposureTimeLeft = 0);
+    if (rc && !readoutAborted && !isAboutToQuit)
+        ExposureComplete(&PrimaryCCD);
 }
 
 bool SXCCD::StartGuideExposure(float n)
 {
     InGuideExposure = true;
     GuideCCD.setExposureDuration(n);
-    sxClearPixels(handle, CCD_EXP_FLAGS_FIELD_BOTH, 1);
-    int time = (int)(1000 * n);
+    ExposureTimeLeft = n;
+    if (DidLatch)
+    {
+        // The guide chip is wiped once the main frame download is over, the exposure starts then
+        DidGuideClear        = false;
+        GuideExposureTimerID = IEAddTimer(DEFER_INTERVAL, GuideExposureTimerCallback, this);
+        return true;
+    }
+    ClearGuideChip();
+    return true;
+}
+
+void SXCCD::ClearGuideChip()
+{
+    {
+        std::lock_guard<std::mutex> lock(usbMutex);
+        sxClearPixels(handle, CCD_EXP_FLAGS_FIELD_BOTH, 1);
+    }
+    DidGuideClear = true;
+    int time = (int)(1000 * GuideCCD.getExposureDuration());
     if (time < 1)
         time = 1;
-    ExposureTimeLeft     = n;
     GuideExposureTimerID = IEAddTimer(time, GuideExposureTimerCallback, this);
-    return true;
 }
 
 bool SXCCD::AbortGuideExposure()
@@ -617,6 +686,17 @@ void SXCCD::GuideExposureTimerHit()
     {
         int rc;
         GuideExposureTimerID = 0;
+        if (DidLatch)
+        {
+            // The guide pixels would mix with the main frame on the bulk in pipe
+            GuideExposureTimerID = IEAddTimer(DEFER_INTERVAL, GuideExposureTimerCallback, this);
+            return;
+        }
+        if (!DidGuideClear)
+        {
+            ClearGuideChip();
+            return;
+        }
         int subX             = GuideCCD.getSubX();
         int subY             = GuideCCD.getSubY();
         int subW             = GuideCCD.getSubW();
@@ -625,11 +705,13 @@ void SXCCD::GuideExposureTimerHit()
         int binY             = GuideCCD.getBinY();
         int size             = subW * subH / binX / binY;
         uint8_t *buf         = GuideCCD.getFrameBuffer();
+        std::unique_lock<std::mutex> lock(usbMutex);
         DidGuideLatch        = true;
         rc                   = sxLatchPixels(handle, CCD_EXP_FLAGS_FIELD_BOTH, 1, subX, subY, subW, subH, binX, binY);
         if (rc)
             rc = sxReadPixels(handle, buf, size);
         DidGuideLatch   = false;
+        lock.unlock();
         InGuideExposure = false;
         GuideCCD.setExposureLeft(GuideExposureTimeLeft = 0);
         if (rc)
@@ -637,120 +719,164 @@ void SXCCD::GuideExposureTimerHit()
     }
 }
 
-IPState SXCCD::GuideWest(uint32_t ms)
+void SXCCD::WriteGuideStatus(char status)
 {
-    if (!HasST4Port || ms < 1)
-    {
-        return IPS_ALERT;
-    }
-    if (WEGuiderTimerID)
-    {
-        IERmTimer(WEGuiderTimerID);
-        WEGuiderTimerID = 0;
-    }
-    GuideStatus &= SX_CLEAR_WE;
-    GuideStatus |= SX_GUIDE_WEST;
-    sxSetSTAR2000(handle, GuideStatus);
-    if (ms < 100)
-    {
-        usleep(ms * 1000);
-        GuideStatus &= SX_CLEAR_WE;
-        sxSetSTAR2000(handle, GuideStatus);
-    }
-    else
-        WEGuiderTimerID = IEAddTimer(ms, WEGuiderTimerCallback, this);
-    return IPS_OK;
+    std::lock_guard<std::mutex> lock(usbMutex);
+    sxSetSTAR2000(handle, status);
 }
 
-IPState SXCCD::GuideEast(uint32_t ms)
+IPState SXCCD::StartPulse(INDI_EQ_AXIS axis, char direction, uint32_t ms)
 {
     if (!HasST4Port || ms < 1)
     {
         return IPS_ALERT;
     }
-    if (WEGuiderTimerID)
     {
-        IERmTimer(WEGuiderTimerID);
-        WEGuiderTimerID = 0;
+        std::lock_guard<std::mutex> lock(pulseMutex);
+        GuidePulse &pulse = Pulses[axis];
+        pulse.requested   = true;
+        pulse.direction   = direction;
+        pulse.duration    = std::chrono::milliseconds(ms);
     }
-    GuideStatus &= SX_CLEAR_WE;
-    GuideStatus |= SX_GUIDE_EAST;
-    sxSetSTAR2000(handle, GuideStatus);
-    if (ms < 100)
-    {
-        usleep(ms * 1000);
-        GuideStatus &= SX_CLEAR_WE;
-        sxSetSTAR2000(handle, GuideStatus);
-    }
-    else
-        WEGuiderTimerID = IEAddTimer(ms, WEGuiderTimerCallback, this);
-    return IPS_OK;
+    pulseCondition.notify_one();
+    // The pulse thread reports the end of the pulse through GuideComplete
+    return IPS_BUSY;
 }
 
-void SXCCD::WEGuiderTimerHit()
+IPState SXCCD::GuideWest(uint32_t ms)
 {
-    GuideStatus &= SX_CLEAR_WE;
-    sxSetSTAR2000(handle, GuideStatus);
-    WEGuiderTimerID = 0;
-    GuideComplete(AXIS_RA);
+    return StartPulse(AXIS_RA, SX_GUIDE_WEST, ms);
+}
+
+IPState SXCCD::GuideEast(uint32_t ms)
+{
+    return StartPulse(AXIS_RA, SX_GUIDE_EAST, ms);
 }
 
 IPState SXCCD::GuideNorth(uint32_t ms)
 {
-    if (!HasST4Port || ms < 1)
-    {
-        return IPS_ALERT;
-    }
-    if (NSGuiderTimerID)
-    {
-        IERmTimer(NSGuiderTimerID);
-        NSGuiderTimerID = 0;
-    }
-    GuideStatus &= SX_CLEAR_NS;
-    GuideStatus |= SX_GUIDE_NORTH;
-    sxSetSTAR2000(handle, GuideStatus);
-    if (ms < 100)
-    {
-        usleep(ms * 1000);
-        GuideStatus &= SX_CLEAR_NS;
-        sxSetSTAR2000(handle, GuideStatus);
-    }
-    else
-        NSGuiderTimerID = IEAddTimer(ms, NSGuiderTimerCallback, this);
-    return IPS_OK;
+    return StartPulse(AXIS_DE, SX_GUIDE_NORTH, ms);
 }
 
 IPState SXCCD::GuideSouth(uint32_t ms)
 {
-    if (!HasST4Port || ms < 1)
-    {
-        return IPS_ALERT;
-    }
-    if (NSGuiderTimerID)
+    return StartPulse(AXIS_DE, SX_GUIDE_SOUTH, ms);
+}
+
+void SXCCD::StartPulseThread()
+{
+    std::lock_guard<std::mutex> lock(pulseMutex);
+    if (pulseThread.joinable())
+        return;
+    GuideStatus = 0;
+    Pulses[AXIS_RA] = GuidePulse();
+    Pulses[AXIS_DE] = GuidePulse();
+    pulseQuit   = false;
+    pulseThread = std::thread(&SXCCD::PulseThread, this);
+}
+
+void SXCCD::StopPulseThread()
+{
     {
-        IERmTimer(NSGuiderTimerID);
-        NSGuiderTimerID = 0;
+        std::lock_guard<std::mutex> lock(pulseMutex);
+        if (!pulseThread.joinable())
+            return;
+        pulseQuit = true;
     }
-    GuideStatus &= SX_CLEAR_NS;
-    GuideStatus |= SX_GUIDE_SOUTH;
-    sxSetSTAR2000(handle, GuideStatus);
-    if (ms < 100)
+    pulseCondition.notify_one();
+    pulseThread.join();
+    // Do not leave a relay closed behind
+    if (GuideStatus != 0 && handle != nullptr)
     {
-        usleep(ms * 1000);
-        GuideStatus &= SX_CLEAR_NS;
-        sxSetSTAR2000(handle, GuideStatus);
+        GuideStatus = 0;
+        WriteGuideStatus(GuideStatus);
     }
-    else
-        NSGuiderTimerID = IEAddTimer(ms, NSGuiderTimerCallback, this);
-    return IPS_OK;
 }
 
-void SXCCD::NSGuiderTimerHit()
-{
-    GuideStatus &= SX_CLEAR_NS;
-    sxSetSTAR2000(handle, GuideStatus);
-    NSGuiderTimerID = 0;
-    GuideComplete(AXIS_DE);
+/*
+ * Starts and ends ST4 pulses against the steady clock. Each pulse ends at a deadline computed
+ * when its start edge was written, so RA and Dec pulses overlap freely and the main loop is
+ * never blocked. The writes only wait for usbMutex while another command is exchanged, a frame
+ * download does not hold it. Pulse widths are measured between the two writes.
+ */
+void SXCCD::PulseThread()
+{
+    const char clearMask[2] = { SX_CLEAR_WE, SX_CLEAR_NS };
+    std::unique_lock<std::mutex> lock(pulseMutex);
+    while (!pulseQuit)
+    {
+        auto now = std::chrono::steady_clock::now();
+        char status = GuideStatus;
+        bool starting[2] = { false, false };
+        bool ending[2] = { false, false };
+        std::chrono::steady_clock::duration duration[2];
+        for (int axis = 0; axis < 2; axis++)
+        {
+            GuidePulse &pulse = Pulses[axis];
+            if (pulse.requested)
+            {
+                // A new pulse on a busy axis replaces the one in progress
+                starting[axis]  = true;
+                duration[axis]  = pulse.duration;
+                pulse.requested = false;
+                status = (status & clearMask[axis]) | pulse.direction;
+            }
+            else if (pulse.active && pulse.deadline <= now)
+            {
+                ending[axis] = true;
+                pulse.active = false;
+                status &= clearMask[axis];
+            }
+        }
+
+        if (starting[AXIS_RA] || starting[AXIS_DE] || ending[AXIS_RA] || ending[AXIS_DE])
+        {
+            lock.unlock();
+            WriteGuideStatus(status);
+            auto edge = std::chrono::steady_clock::now();
+            lock.lock();
+            GuideStatus = status;
+            for (int axis = 0; axis < 2; axis++)
+            {
+                GuidePulse &pulse = Pulses[axis];
+                if (starting[axis])
+                {
+                    pulse.active   = true;
+                    pulse.start    = edge;
+                    pulse.deadline = edge + duration[axis];
+                    pulse.length   = duration[axis];
+                }
+                else if (ending[axis])
+                {
+                    double requested = std::chrono::duration<double, std::milli>(pulse.length).count();
+                    double actual    = std::chrono::duration<double, std::milli>(edge - pulse.start).count();
+                    LOGF_DEBUG("%s pulse of %.0f ms took %.2f ms (%+.2f ms)", axis == AXIS_RA ? "RA" : "DEC",
+                               requested, actual, actual - requested);
+                }
+            }
+            lock.unlock();
+            for (int axis = 0; axis < 2; axis++)
+                if (ending[axis])
+                    GuideComplete(static_cast<INDI_EQ_AXIS>(axis));
+            lock.lock();
+            continue;
+        }
+
+        auto wake = [this]()
+        {
+            return pulseQuit || Pulses[AXIS_RA].requested || Pulses[AXIS_DE].requested;
+        };
+        if (Pulses[AXIS_RA].active || Pulses[AXIS_DE].active)
+        {
+            auto deadline = std::chrono::steady_clock::time_point::max();
+            for (int axis = 0; axis < 2; axis++)
+                if (Pulses[axis].active && Pulses[axis].deadline < deadline)
+                    deadline = Pulses[axis].deadline;
+            pulseCondition.wait_until(lock, deadline, wake);
+        }
+        else
+            pulseCondition.wait(lock, wake);
+    }
 }
 
 void SXCCD::ISGetProperties(const char *dev)
@@ -768,7 +894,16 @@ bool SXCCD::ISNewSwitch(const char *dev, const char *name, ISState *states, char
         IUUpdateSwitch(&ShutterSP, states, names, n);
         ShutterSP.s = IPS_OK;
         IDSetSwitch(&ShutterSP, nullptr);
-        sxSetShutter(handle, ShutterS[0].s != ISS_ON);
+        if (DidLatch)
+        {
+            // TimerHit moves the shutter once the download is over
+            ShutterPending = true;
+        }
+        else
+        {
+            std::lock_guard<std::mutex> lock(usbMutex);
+            sxSetShutter(handle, ShutterS[0].s != ISS_ON);
+        }
         result = true;
     }
     else if (strcmp(name, CoolerSP.name) == 0)
@@ -776,10 +911,15 @@ bool SXCCD::ISNewSwitch(const char *dev, const char *name, ISState *states, char
         IUUpdateSwitch(&CoolerSP, states, names, n);
         CoolerSP.s = IPS_OK;
         IDSetSwitch(&CoolerSP, nullptr);
+        // TimerHit sends the cooler state once the download is over
+        if (DidLatch)
+            return true;
         unsigned char status;
         unsigned short temperature;
+        std::unique_lock<std::mutex> lock(usbMutex);
         sxSetCooler(handle, (unsigned char)(CoolerS[0].s == ISS_ON), (unsigned short)(TemperatureRequest * 10 + 2730),
                     &status, &temperature);
+        lock.unlock();
         TemperatureReported = TemperatureN[0].value = (temperature - 2730) / 10.0;
         TemperatureNP.s                             = IPS_OK;
         IDSetNumber(&TemperatureNP, nullptr);
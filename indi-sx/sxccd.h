@@ -34,11 +34,16 @@
 #include "sxccdusb.h"
 
 #include <indiccd.h>
+#include <indisinglethreadpool.h>
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
 
 void ExposureTimerCallback(void *p);
 void GuideExposureTimerCallback(void *p);
-void WEGuiderTimerCallback(void *p);
-void NSGuiderTimerCallback(void *p);
 
 class SXCCD : public INDI::CCD
 {
@@ -61,13 +66,37 @@ class SXCCD : public INDI::CCD
         float GuideExposureTimeLeft;
         int ExposureTimerID;
         int GuideExposureTimerID;
-        int WEGuiderTimerID;
-        int NSGuiderTimerID;
         bool DidFlush;
-        bool DidLatch;
+        std::atomic_bool DidLatch;
         bool DidGuideLatch;
+        // Set once the guide chip was wiped, the wipe waits for a main frame download
+        bool DidGuideClear;
+        // A shutter change requested during a download, applied by TimerHit
+        bool ShutterPending;
         bool InGuideExposure;
         char GuideStatus;
+        // ST4 pulse per axis, indexed by INDI_EQ_AXIS and guarded by pulseMutex
+        struct GuidePulse
+        {
+            bool requested { false };
+            bool active { false };
+            char direction { 0 };
+            std::chrono::steady_clock::duration duration { 0 };
+            std::chrono::steady_clock::duration length { 0 };
+            std::chrono::steady_clock::time_point start;
+            std::chrono::steady_clock::time_point deadline;
+        } Pulses[2];
+        std::thread pulseThread;
+        std::mutex pulseMutex;
+        std::condition_variable pulseCondition;
+        bool pulseQuit;
+        // Downloads the primary frame while the main loop keeps serving properties
+        INDI::SingleThreadPool readoutWorker;
+        // Serializes USB commands and their replies between the main loop, the pulse thread and the
+        // readout worker. It is not held while the pixels of a frame are downloaded.
+        std::mutex usbMutex;
+        // Set by AbortExposure while the worker downloads, the frame is then discarded
+        std::atomic_bool readoutAborted { false };
 
     protected:
         const char *getDefaultName();
@@ -85,9 +114,14 @@ class SXCCD : public INDI::CCD
         bool AbortGuideExposure();
         void TimerHit();
         void ExposureTimerHit();
+        void workerReadout(const std::atomic_bool &isAboutToQuit);
         void GuideExposureTimerHit();
-        void WEGuiderTimerHit();
-        void NSGuiderTimerHit();
+        void ClearGuideChip();
+        void WriteGuideStatus(char status);
+        IPState StartPulse(INDI_EQ_AXIS axis, char direction, uint32_t ms);
+        void StartPulseThread();
+        void StopPulseThread();
+        void PulseThread();
         //bool saveConfigItems(FILE *fp);
         IPState GuideWest(uint32_t ms);
         IPState GuideEast(uint32_t ms);
@@ -109,8 +143,6 @@ class SXCCD : public INDI::CCD
 
         friend void ::ExposureTimerCallback(void *p);
         friend void ::GuideExposureTimerCallback(void *p);
-        friend void ::WEGuiderTimerCallback(void *p);
-        friend void ::NSGuiderTimerCallback(void *p);
         friend void ::ISGetProperties(const char *dev);
         friend void ::ISNewSwitch(const char *dev, const char *name, ISState *states, char *names[], int num);
         friend void ::ISNewText(const char *dev, const char *name, char *texts[], char *names[], int num);
@@ -39,6 +39,7 @@
 
 #include <indidevapi.h>
 
+#include <chrono>
 #include <memory>
 
 #include <stdarg.h>
@@ -125,6 +126,13 @@
 //#warning "Intel mode, 16MB CHUNK_SIZE"
 #endif
 
+/*
+ * Asynchronous pixel reads keep ASYNC_TRANSFERS bulk transfers of ASYNC_CHUNK_SIZE in flight.
+ * The chunk is a multiple of the bulk packet size, so only the last transfer of a frame can be short.
+ */
+#define ASYNC_TRANSFERS  4
+#define ASYNC_CHUNK_SIZE (1024 * 1024)
+
 #if 1
 #define TRACE(c) (c)
 #define DEBUG(c) (c)
@@ -755,6 +763,117 @@ int sxReadPixels(HANDLE sxHandle, void *pixels, unsigned long count)
     return rc >= 0;
 }
 
+struct AsyncPixelRead
+{
+    unsigned char *pixels;
+    unsigned long count;
+    unsigned long submitted;
+    unsigned long received;
+    int pending;
+    int status;
+    const std::atomic_bool *cancel;
+};
+
+static void LIBUSB_CALL sxReadPixelsCallback(struct libusb_transfer *transfer);
+
+static int sxSubmitPixelChunk(struct libusb_transfer *transfer, AsyncPixelRead *read)
+{
+    unsigned long size = read->count - read->submitted;
+    if (size > ASYNC_CHUNK_SIZE)
+        size = ASYNC_CHUNK_SIZE;
+    libusb_fill_bulk_transfer(transfer, transfer->dev_handle, BULK_IN, read->pixels + read->submitted, size,
+                              sxReadPixelsCallback, read, BULK_DATA_TIMEOUT);
+    int rc = libusb_submit_transfer(transfer);
+    if (rc < 0)
+        return rc;
+    read->submitted += size;
+    read->pending++;
+    return 0;
+}
+
+// Runs from whichever thread handles libusb events, the reading thread or a thread waiting for a
+// synchronous command such as the ST4 port. libusb runs callbacks one at a time under its event
+// lock, and the reading thread only looks at the state after handling events, so no locking is needed.
+static void LIBUSB_CALL sxReadPixelsCallback(struct libusb_transfer *transfer)
+{
+    AsyncPixelRead *read = static_cast<AsyncPixelRead *>(transfer->user_data);
+    read->pending--;
+    if (transfer->status == LIBUSB_TRANSFER_COMPLETED)
+    {
+        read->received += transfer->actual_length;
+        // A short transfer before the end of the frame leaves the following ones misplaced
+        if (transfer->actual_length < transfer->length && read->received < read->count && read->status == 0)
+            read->status = LIBUSB_ERROR_IO;
+    }
+    else if (read->status == 0)
+    {
+        if (transfer->status == LIBUSB_TRANSFER_TIMED_OUT)
+            read->status = LIBUSB_ERROR_TIMEOUT;
+        else if (transfer->status == LIBUSB_TRANSFER_CANCELLED)
+            read->status = LIBUSB_ERROR_INTERRUPTED;
+        else
+            read->status = LIBUSB_ERROR_IO;
+    }
+
+    if (read->status == 0 && read->submitted < read->count && !(read->cancel && *read->cancel))
+    {
+        int rc = sxSubmitPixelChunk(transfer, read);
+        if (rc < 0)
+            read->status = rc;
+    }
+}
+
+int sxReadPixelsAsync(HANDLE sxHandle, void *pixels, unsigned long count, const std::atomic_bool *cancel)
+{
+    AsyncPixelRead read = { static_cast<unsigned char *>(pixels), count, 0, 0, 0, 0, cancel };
+    struct libusb_transfer *transfers[ASYNC_TRANSFERS] = { nullptr };
+    auto start = std::chrono::steady_clock::now();
+
+    for (int i = 0; i < ASYNC_TRANSFERS && read.submitted < count && read.status == 0; i++)
+    {
+        transfers[i] = libusb_alloc_transfer(0);
+        if (transfers[i] == nullptr)
+            break;
+        transfers[i]->dev_handle = sxHandle;
+        int rc = sxSubmitPixelChunk(transfers[i], &read);
+        if (rc < 0)
+            read.status = rc;
+    }
+
+    if (read.pending == 0)
+    {
+        // Nothing could be submitted, the synchronous path still works in that case
+        for (int i = 0; i < ASYNC_TRANSFERS; i++)
+            libusb_free_transfer(transfers[i]);
+        DEBUG(log(true, "sxReadPixelsAsync: submit -> %s, reading synchronously\n", libusb_error_name(read.status)));
+        return sxReadPixels(sxHandle, pixels, count);
+    }
+
+    bool cancelling = false;
+    while (read.pending > 0)
+    {
+        if (!cancelling && (read.status != 0 || (cancel && *cancel)))
+        {
+            cancelling = true;
+            if (read.status == 0)
+                read.status = LIBUSB_ERROR_INTERRUPTED;
+            for (int i = 0; i < ASYNC_TRANSFERS; i++)
+                if (transfers[i])
+                    libusb_cancel_transfer(transfers[i]);
+        }
+        struct timeval tv = { 0, 100000 };
+        libusb_handle_events_timeout_completed(ctx, &tv, nullptr);
+    }
+
+    for (int i = 0; i < ASYNC_TRANSFERS; i++)
+        libusb_free_transfer(transfers[i]);
+
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    DEBUG(log(true, "sxReadPixelsAsync: %lu of %lu bytes in %.3f s (%.1f MB/s) -> %s\n", read.received, count, seconds,
+              seconds > 0 ? read.received / seconds / 1048576.0 : 0, read.status < 0 ? libusb_error_name(read.status) : "OK"));
+    return read.status == 0 && read.received == count;
+}
+
 int sxSetSTAR2000(HANDLE sxHandle, char star2k)
 {
     unsigned char setup_data[8];
@@ -43,6 +43,8 @@
 #include <libusb-1.0/libusb.h>
 #endif
 
+#include <atomic>
+
 /*
  * CCD color representation.
  *  Packed colors allow individual sizes up to 16 bits.
@@ -160,6 +162,8 @@ int sxExposePixelsGated(HANDLE sxHandle, unsigned short flags, unsigned short ca
                         unsigned short yoffset, unsigned short width, unsigned short height, unsigned short xbin,
                         unsigned short ybin, unsigned long msec);
 int sxReadPixels(HANDLE sxHandle, void *pixels, unsigned long count);
+// Same as sxReadPixels with several bulk transfers in flight. Setting *cancel stops the read, which fails then.
+int sxReadPixelsAsync(HANDLE sxHandle, void *pixels, unsigned long count, const std::atomic_bool *cancel = nullptr);
 int sxSetShutter(HANDLE sxHandle, unsigned short state);
 int sxSetTimer(HANDLE sxHandle, unsigned long msec);
 unsigned long sxGetTimer(HANDLE sxHandle);
@@ -0,0 +1,246 @@
+/*
+ Starlight Xpress CCD INDI Driver
+
+ Unit tests running the driver against the simulated camera of fake_libusb.cpp.
+
+ This program is free software; you can redistribute it and/or modify it
+ under the terms of the GNU General Public License as published by the Free
+ Software Foundation; either version 2 of the License, or (at your option)
+ any later version.
+
+ This program is distributed in the hope that it will be useful, but WITHOUT
+ ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ more details.
+
+ You should have received a copy of the GNU General Public License along with
+ this program; if not, write to the Free Software Foundation, Inc., 59
+ Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+ The full GNU General Public License is included in this distribution in the
+ file called LICENSE.
+ */
+
+#include "fake_libusb.h"
+#include "sxccd.h"
+#include "sxccdusb.h"
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <thread>
+#include <vector>
+
+#define TEST_WIDTH  1392
+#define TEST_HEIGHT 1040
+#define TEST_MODEL  0x16
+
+namespace
+{
+
+typedef std::chrono::steady_clock Clock;
+
+DEVICE fakeDevice()
+{
+    DEVICE devices[20];
+    const char *names[20];
+    int count = sxList(devices, names, 20);
+    return count > 0 ? devices[0] : nullptr;
+}
+
+template <typename Predicate>
+bool waitFor(Predicate predicate, std::chrono::milliseconds timeout)
+{
+    auto deadline = Clock::now() + timeout;
+    while (!predicate())
+    {
+        if (Clock::now() > deadline)
+            return false;
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    return true;
+}
+
+// Opens the protected driver entry points the INDI framework normally calls
+class TestSXCCD : public SXCCD
+{
+    public:
+        explicit TestSXCCD(DEVICE device) : SXCCD(device, "SX Test") {}
+
+        bool connect()
+        {
+            initProperties();
+            if (!Connect())
+                return false;
+            SetupParms();
+            return true;
+        }
+        bool startExposure(float seconds)
+        {
+            return StartExposure(seconds);
+        }
+        // Ends the exposure, the frame is then downloaded by the readout worker
+        void exposureTimerHit()
+        {
+            ExposureTimerHit();
+        }
+        bool abortExposure()
+        {
+            return AbortExposure();
+        }
+        void timerHit()
+        {
+            TimerHit();
+        }
+        int setTemperature(double temperature)
+        {
+            return SetTemperature(temperature);
+        }
+        IPState guideNorth(uint32_t ms)
+        {
+            return GuideNorth(ms);
+        }
+        IPState guideWest(uint32_t ms)
+        {
+            return GuideWest(ms);
+        }
+};
+
+}
+
+TEST(SXCCDUSB, ReadPixelsAsyncThroughput)
+{
+    const double rate = 40e6;
+    FakeSX::reset(TEST_MODEL, TEST_WIDTH, TEST_HEIGHT, 0);
+    FakeSX::setPixelRate(rate);
+
+    HANDLE handle = nullptr;
+    ASSERT_TRUE(sxOpen(fakeDevice(), &handle));
+    unsigned long size = TEST_WIDTH * TEST_HEIGHT * 2;
+    std::vector<unsigned char> pixels(size);
+
+    auto start = Clock::now();
+    ASSERT_TRUE(sxLatchPixels(handle, CCD_EXP_FLAGS_FIELD_BOTH, 0, 0, 0, TEST_WIDTH, TEST_HEIGHT, 1, 1));
+    ASSERT_TRUE(sxReadPixelsAsync(handle, pixels.data(), size));
+    double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+    for (unsigned long i = 0; i < size; i++)
+        ASSERT_EQ(pixels[i], FakeSX::pixelAt(i)) << "at offset " << i;
+
+    // The queued transfers keep the pipe busy, so the download runs at the rate of the camera
+    double expected = size / rate;
+    EXPECT_LT(seconds, expected * 1.25 + 0.02);
+    printf("%lu bytes in %.3f s, %.1f MB/s (camera %.1f MB/s)\n", size, seconds, size / seconds / 1e6, rate / 1e6);
+
+    sxClose(&handle);
+}
+
+TEST(SXCCDUSB, ReadPixelsAsyncCancel)
+{
+    FakeSX::reset(TEST_MODEL, TEST_WIDTH, TEST_HEIGHT, 0);
+    FakeSX::setPixelRate(2e6);
+
+    HANDLE handle = nullptr;
+    ASSERT_TRUE(sxOpen(fakeDevice(), &handle));
+    unsigned long size = TEST_WIDTH * TEST_HEIGHT * 2;
+    std::vector<unsigned char> pixels(size);
+    std::atomic_bool cancel { false };
+
+    ASSERT_TRUE(sxLatchPixels(handle, CCD_EXP_FLAGS_FIELD_BOTH, 0, 0, 0, TEST_WIDTH, TEST_HEIGHT, 1, 1));
+    std::thread canceller([&cancel]()
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        cancel = true;
+    });
+    auto start = Clock::now();
+    EXPECT_FALSE(sxReadPixelsAsync(handle, pixels.data(), size, &cancel));
+    canceller.join();
+    EXPECT_LT(std::chrono::duration<double>(Clock::now() - start).count(), 0.5);
+
+    sxClose(&handle);
+}
+
+TEST(SXCCD, CommandsDuringDownload)
+{
+    FakeSX::reset(TEST_MODEL, TEST_WIDTH, TEST_HEIGHT, SXUSB_CAPS_COOLER | SXUSB_CAPS_SHUTTER | SXCCD_CAPS_STAR2K);
+    // About 1.5 s for the full frame
+    FakeSX::setPixelRate(2e6);
+
+    TestSXCCD camera(fakeDevice());
+    ASSERT_TRUE(camera.connect());
+    ASSERT_TRUE(camera.startExposure(0.01));
+    camera.exposureTimerHit();
+    ASSERT_TRUE(waitFor(FakeSX::isDownloading, std::chrono::milliseconds(500)));
+
+    // Cooler polls and set points are answered on the bulk in pipe, they must wait for the
+    // download and return right away instead of blocking the main loop.
+    auto start = Clock::now();
+    camera.timerHit();
+    EXPECT_EQ(camera.setTemperature(-10), 0);
+    EXPECT_LT(std::chrono::duration<double>(Clock::now() - start).count(), 0.1);
+    EXPECT_TRUE(FakeSX::isDownloading());
+
+    // A second exposure is refused until the frame is in
+    EXPECT_FALSE(camera.startExposure(0.01));
+
+    EXPECT_TRUE(camera.abortExposure());
+    ASSERT_TRUE(waitFor([]()
+    {
+        return !FakeSX::isDownloading();
+    }, std::chrono::milliseconds(5000)));
+    // The readout worker leaves the camera after the last pixels
+    ASSERT_TRUE(waitFor([&camera]()
+    {
+        return camera.startExposure(0.01);
+    }, std::chrono::milliseconds(1000)));
+    camera.abortExposure();
+    camera.timerHit();
+
+    EXPECT_EQ(FakeSX::collisions(), 0);
+}
+
+TEST(SXCCD, PulseJitterDuringDownload)
+{
+    FakeSX::reset(TEST_MODEL, TEST_WIDTH, TEST_HEIGHT, SXUSB_CAPS_COOLER | SXCCD_CAPS_STAR2K);
+    FakeSX::setPixelRate(2e6);
+
+    TestSXCCD camera(fakeDevice());
+    ASSERT_TRUE(camera.connect());
+    ASSERT_TRUE(camera.startExposure(0.01));
+    camera.exposureTimerHit();
+    ASSERT_TRUE(waitFor(FakeSX::isDownloading, std::chrono::milliseconds(500)));
+
+    // Pulses complete asynchronously, GuideComplete reports their end
+    for (int i = 0; i < 4; i++)
+    {
+        EXPECT_EQ(camera.guideNorth(100), IPS_BUSY);
+        std::this_thread::sleep_for(std::chrono::milliseconds(150));
+    }
+    EXPECT_EQ(camera.guideWest(50), IPS_BUSY);
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    EXPECT_TRUE(FakeSX::isDownloading());
+
+    camera.abortExposure();
+    ASSERT_TRUE(waitFor([]()
+    {
+        return !FakeSX::isDownloading();
+    }, std::chrono::milliseconds(5000)));
+
+    // Every pulse starts with a relay bit set and ends with all relays open
+    std::vector<FakeSX::Star2000Write> writes = FakeSX::star2000Writes();
+    ASSERT_EQ(writes.size(), 10u);
+    const int expected[5] = { 100, 100, 100, 100, 50 };
+    for (int i = 0; i < 5; i++)
+    {
+        const FakeSX::Star2000Write &start = writes[2 * i];
+        const FakeSX::Star2000Write &end   = writes[2 * i + 1];
+        EXPECT_NE(start.value, 0);
+        EXPECT_EQ(end.value, 0);
+        // The writes go out while the pixels stream in
+        EXPECT_TRUE(start.downloading);
+        EXPECT_TRUE(end.downloading);
+        double width = std::chrono::duration<double, std::milli>(end.time - start.time).count();
+        EXPECT_NEAR(width, expected[i], 10) << "pulse " << i;
+    }
+    EXPECT_EQ(FakeSX::collisions(), 0);
+}
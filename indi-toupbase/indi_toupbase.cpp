@@ -21,9 +21,11 @@
 
 #include "indi_toupbase.h"
 #include "config.h"
+#include "fitstime.h"
 #include <stream/streammanager.h>
 #include <unistd.h>
 #include <deque>
+#include <algorithm>
 
 #define BITDEPTH_FLAG       (CP(FLAG_RAW10) | CP(FLAG_RAW12) | CP(FLAG_RAW14) | CP(FLAG_RAW16))
 #define CONTROL_TAB         "Control"
@@ -70,6 +72,7 @@ ToupBase::ToupBase(const XP(DeviceV2) *instance) : m_Instance(instance)
 
 ToupBase::~ToupBase()
 {
+    stopEventThread();
     delete[] m_FanS;
     delete[] m_HeatS;
 }
@@ -222,6 +225,12 @@ bool ToupBase::initProperties()
     IUFillNumberVector(&m_TimeoutFactorNP, &m_TimeoutFactorN, 1, getDeviceName(), "TIMEOUT_FACTOR", "Timeout", OPTIONS_TAB,
                        IP_RW, 60, IPS_IDLE);
 
+    ///////////////////////////////////////////////////////////////////////////////////
+    /// Trigger Sequence
+    ///////////////////////////////////////////////////////////////////////////////////
+    m_SequenceNP[0].fill("SEQUENCE_COUNT", "Frames per exposure", "%.0f", 1, 10000, 1, 1);
+    m_SequenceNP.fill(getDeviceName(), "TRIGGER_SEQUENCE", "Sequence", CONTROL_TAB, IP_RW, 60, IPS_IDLE);
+
     if (m_Instance->model->flag & (CP(FLAG_CG) | CP(FLAG_CGHDR)))
     {
         ///////////////////////////////////////////////////////////////////////////////////
@@ -342,6 +351,7 @@ bool ToupBase::updateProperties()
             defineProperty(&m_FanSP);
 
         defineProperty(&m_TimeoutFactorNP);
+        defineProperty(m_SequenceNP);
         defineProperty(&m_ControlNP);
         defineProperty(&m_AutoExposureSP);
         defineProperty(&m_ResolutionSP);
@@ -391,6 +401,7 @@ bool ToupBase::updateProperties()
             deleteProperty(m_FanSP.name);
 
         deleteProperty(m_TimeoutFactorNP.name);
+        deleteProperty(m_SequenceNP);
         deleteProperty(m_ControlNP.name);
         deleteProperty(m_AutoExposureSP.name);
         deleteProperty(m_ResolutionSP.name);
@@ -458,6 +469,8 @@ bool ToupBase::Connect()
     PrimaryCCD.setMinMaxStep("CCD_EXPOSURE", "CCD_EXPOSURE_VALUE", min / 1000000.0, max / 1000000.0, 0, false);
     PrimaryCCD.setBin(1, 1);
 
+    startEventThread();
+
     LOGF_INFO("%s connect", getDeviceName());
     return true;
 }
@@ -467,6 +480,14 @@ bool ToupBase::Disconnect()
     stopTimerNS();
     stopTimerWE();
 
+    FP(Trigger(m_Handle, 0));
+    stopSequence();
+
+    // Stop the callbacks and the event thread before the handle goes away, events still
+    // queued for a stopped camera are discarded.
+    FP(Stop(m_Handle));
+    stopEventThread();
+
     FP(Close(m_Handle));
 
     if (m_rgbBuffer)
@@ -744,6 +765,8 @@ void ToupBase::setupParams()
 
 void ToupBase::allocateFrameBuffer()
 {
+    std::unique_lock<std::mutex> guard(ccdBufferLock);
+
     // Allocate memory
     if (m_MonoCamera)
     {
@@ -977,6 +1000,18 @@ bool ToupBase::ISNewNumber(const char *dev, const char *name, double values[], c
             IDSetNumber(&m_TimeoutFactorNP, nullptr);
             return true;
         }
+
+        //////////////////////////////////////////////////////////////////////
+        /// Trigger Sequence
+        //////////////////////////////////////////////////////////////////////
+        if (m_SequenceNP.isNameMatch(name))
+        {
+            m_SequenceNP.setState(m_SequenceNP.update(values, names, n) ? IPS_OK : IPS_ALERT);
+            m_SequenceNP.apply();
+            if (m_SequenceNP[0].getValue() > 1)
+                LOGF_INFO("Each exposure now captures a sequence of %.0f triggered frames.", m_SequenceNP[0].getValue());
+            return true;
+        }
     }
 
     return INDI::CCD::ISNewNumber(dev, name, values, names, n);
@@ -1335,6 +1370,14 @@ bool ToupBase::activateCooler(bool enable)
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 bool ToupBase::StartExposure(float duration)
 {
+    if (m_SequenceRunning)
+    {
+        LOG_ERROR("Cannot start an exposure while a trigger sequence is in progress.");
+        return false;
+    }
+    // Collect the delivery thread of the previous sequence
+    stopSequence();
+
     PrimaryCCD.setExposureDuration(static_cast<double>(duration));
 
     HRESULT rc = 0;
@@ -1355,16 +1398,33 @@ bool ToupBase::StartExposure(float duration)
         m_CurrentTriggerMode = TRIGGER_SOFTWARE;
     }
 
+    uint32_t count = static_cast<uint32_t>(m_SequenceNP[0].getValue());
+    if (count < 1)
+        count = 1;
+
+    // The countdown covers the whole sequence
     timeval current_time, exposure_time;
-    exposure_time.tv_sec = uSecs / 1000000;
-    exposure_time.tv_usec = uSecs % 1000000;
+    exposure_time.tv_sec = uSecs * count / 1000000;
+    exposure_time.tv_usec = uSecs * count % 1000000;
     gettimeofday(&current_time, nullptr);
     timeradd(&current_time, &exposure_time, &m_ExposureEnd);
 
-    InExposure = true;
-    if (FAILED(rc = FP(Trigger(m_Handle, 1))))// Trigger an exposure
+    if (count > 1 && startSequence(count) == false)
+        return false;
+
+    {
+        std::unique_lock<std::mutex> guard(m_ExposureMutex);
+        InExposure = true;
+    }
+    // Trigger one exposure, or count exposures that the camera takes back to back
+    if (FAILED(rc = FP(Trigger(m_Handle, count))))
     {
         LOGF_ERROR("Failed to trigger exposure. %s", errorCodes(rc).c_str());
+        {
+            std::unique_lock<std::mutex> guard(m_ExposureMutex);
+            InExposure = false;
+        }
+        stopSequence();
         return false;
     }
 
@@ -1377,6 +1437,8 @@ bool ToupBase::StartExposure(float duration)
 bool ToupBase::AbortExposure()
 {
     FP(Trigger(m_Handle, 0));
+    stopSequence();
+    std::unique_lock<std::mutex> guard(m_ExposureMutex);
     InExposure = false;
     return true;
 }
@@ -1418,7 +1480,10 @@ bool ToupBase::UpdateCCDFrame(int x, int y, int w, int h)
     // Total bytes required for image buffer
     uint32_t nbuf = (w * h * PrimaryCCD.getBPP() / 8) * m_Channels;
     LOGF_DEBUG("Updating frame buffer size to %d bytes", nbuf);
-    PrimaryCCD.setFrameBufferSize(nbuf);
+    {
+        std::unique_lock<std::mutex> guard(ccdBufferLock);
+        PrimaryCCD.setFrameBufferSize(nbuf);
+    }
 
     // Always set BINNED size
     Streamer->setSize(w / PrimaryCCD.getBinX(), h / PrimaryCCD.getBinY());
@@ -1735,6 +1800,17 @@ void ToupBase::addFITSKeywords(INDI::CCDChip *targetChip, std::vector<INDI::FITS
     fitsKeywords.push_back({"PRODATE", m_CameraT[TC_CAMERA_DATE].text, "Production Date"});
     fitsKeywords.push_back({"FIRMVER", m_CameraT[TC_CAMERA_FW_VERSION].text, "Firmware Version"});
     fitsKeywords.push_back({"HARDVER", m_CameraT[TC_CAMERA_HW_VERSION].text, "Hardware Version"});
+    // Same keywords as the burst frames of other drivers. The base class dates every frame from
+    // the trigger, the start of each frame is its arrival minus the exposure.
+    uint32_t sequenceIndex = m_SequenceFrameIndex;
+    if (sequenceIndex > 0)
+    {
+        FITSTime::replaceRecord(fitsKeywords, INDI::FITSRecord("DATE-OBS",
+                                FITSTime::isoTimestamp(m_SequenceFrameStart).c_str(),
+                                "UTC start, frame arrival minus exposure"));
+        fitsKeywords.push_back({"BURSTIDX", static_cast<int>(sequenceIndex), "Frame number in burst"});
+        fitsKeywords.push_back({"BURSTLEN", static_cast<int>(m_SequenceLength), "Frames in burst"});
+    }
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -1787,80 +1863,440 @@ uint8_t* ToupBase::getRgbBuffer()
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 void ToupBase::eventCallBack(unsigned event)
 {
-    LOGF_DEBUG("%s: 0x%08x", __func__, event);
-    switch (event)
+    // Runs on the SDK thread: queue the event and return, the event thread does the rest.
+    if (pushEvent({event, std::chrono::steady_clock::now()}) == false)
     {
-        case CP(EVENT_EXPOSURE):
+        m_EventsDropped++;
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_EventWakeMutex);
+    }
+    m_EventWake.notify_one();
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+///
+////////////////////////////////////////////////////////////////////////////////////////////////////
+bool ToupBase::pushEvent(const EventDescriptor &descriptor)
+{
+    size_t head = m_EventHead.load(std::memory_order_relaxed);
+    size_t next = (head + 1) % EVENT_QUEUE_SIZE;
+    if (next == m_EventTail.load(std::memory_order_acquire))
+        return false;
+
+    m_EventQueue[head] = descriptor;
+    m_EventHead.store(next, std::memory_order_release);
+    return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+///
+////////////////////////////////////////////////////////////////////////////////////////////////////
+bool ToupBase::popEvent(EventDescriptor &descriptor)
+{
+    size_t tail = m_EventTail.load(std::memory_order_relaxed);
+    if (tail == m_EventHead.load(std::memory_order_acquire))
+        return false;
+
+    descriptor = m_EventQueue[tail];
+    m_EventTail.store((tail + 1) % EVENT_QUEUE_SIZE, std::memory_order_release);
+    return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+///
+////////////////////////////////////////////////////////////////////////////////////////////////////
+void ToupBase::startEventThread()
+{
+    if (m_EventThread.joinable())
+        return;
+
+    m_EventHead = 0;
+    m_EventTail = 0;
+    m_EventsDropped = 0;
+    m_LatencyFrames = 0;
+    m_LatencySumMs = m_LatencyMaxMs = 0;
+    m_EventThreadQuit = false;
+    m_EventThread = std::thread(&ToupBase::eventLoop, this);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+///
+////////////////////////////////////////////////////////////////////////////////////////////////////
+void ToupBase::stopEventThread()
+{
+    if (m_EventThread.joinable() == false)
+        return;
+
+    {
+        std::lock_guard<std::mutex> lock(m_EventWakeMutex);
+        m_EventThreadQuit = true;
+    }
+    m_EventWake.notify_one();
+    m_EventThread.join();
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+///
+////////////////////////////////////////////////////////////////////////////////////////////////////
+void ToupBase::eventLoop()
+{
+    EventDescriptor descriptor;
+    while (true)
+    {
+        while (popEvent(descriptor))
+            processEvent(descriptor);
+
+        uint32_t dropped = m_EventsDropped.exchange(0);
+        if (dropped > 0)
+            LOGF_WARN("Event queue full, %u camera events dropped.", dropped);
+
+        std::unique_lock<std::mutex> lock(m_EventWakeMutex);
+        m_EventWake.wait(lock, [this]()
         {
-            uint16_t expoGain = CP(EXPOGAIN_MIN);
-            FP(get_ExpoAGain(m_Handle, &expoGain));
-            m_ControlN[TC_GAIN].value = expoGain;
-            m_ControlNP.s = IPS_OK;
-            IDSetNumber(&m_ControlNP, nullptr);
+            return m_EventThreadQuit || m_EventTail.load() != m_EventHead.load();
+        });
+        if (m_EventThreadQuit)
+            break;
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+///
+////////////////////////////////////////////////////////////////////////////////////////////////////
+void ToupBase::recordLatency(const EventDescriptor &descriptor, bool exposure)
+{
+    double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - descriptor.received).count();
+
+    if (exposure)
+    {
+        LOGF_DEBUG("Callback to BLOB latency: %.1f ms", ms);
+        return;
+    }
+
+    m_LatencyFrames++;
+    m_LatencySumMs += ms;
+    m_LatencyMaxMs = std::max(m_LatencyMaxMs, ms);
+    if (m_LatencyFrames >= LATENCY_REPORT_FRAMES)
+    {
+        LOGF_DEBUG("Callback to stream latency over %u frames: avg %.2f ms, max %.2f ms", m_LatencyFrames,
+                   m_LatencySumMs / m_LatencyFrames, m_LatencyMaxMs);
+        m_LatencyFrames = 0;
+        m_LatencySumMs = m_LatencyMaxMs = 0;
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+///
+////////////////////////////////////////////////////////////////////////////////////////////////////
+void ToupBase::processImage(const EventDescriptor &descriptor)
+{
+    int captureBits = m_BitsPerPixel == 8 ? 8 : m_maxBitDepth;
+    if (Streamer->isStreaming() || Streamer->isRecording())
+    {
+        std::unique_lock<std::mutex> guard(ccdBufferLock);
+        HRESULT rc = FP(PullImageWithRowPitchV2(m_Handle, PrimaryCCD.getFrameBuffer(), captureBits * m_Channels, -1, nullptr));
+        if (SUCCEEDED(rc))
+        {
+            Streamer->newFrame(PrimaryCCD.getFrameBuffer(), PrimaryCCD.getFrameBufferSize());
+            guard.unlock();
+            recordLatency(descriptor, false);
         }
-        break;
-        case CP(EVENT_IMAGE):
+        return;
+    }
+
+    if (m_SequenceActive)
+    {
+        pullSequenceFrame(descriptor);
+        return;
+    }
+
+    bool expected = false;
+    {
+        std::unique_lock<std::mutex> guard(m_ExposureMutex);
+        expected = InExposure;
+        InExposure = false;
+    }
+
+    if (expected == false)
+    {
+        HRESULT rc = FP(put_Option(m_Handle, CP(OPTION_FLUSH), 3));
+        if (FAILED(rc))
+            LOGF_ERROR("Failed to flush image. %s", errorCodes(rc).c_str());
+        return;
+    }
+
+    PrimaryCCD.setExposureLeft(0);
+
+    XP(FrameInfoV2) info;
+    memset(&info, 0, sizeof(XP(FrameInfoV2)));
+
+    std::unique_lock<std::mutex> guard(ccdBufferLock);
+    uint8_t *buffer = PrimaryCCD.getFrameBuffer();
+    if (m_MonoCamera == false && (0 == m_CurrentVideoFormat))
+        buffer = getRgbBuffer();
+
+    HRESULT rc = FP(PullImageWithRowPitchV2(m_Handle, buffer, captureBits * m_Channels, -1, &info));
+    if (FAILED(rc))
+    {
+        guard.unlock();
+        LOGF_ERROR("Failed to pull image. %s", errorCodes(rc).c_str());
+        PrimaryCCD.setExposureFailed();
+        return;
+    }
+
+    if (m_MonoCamera == false && (0 == m_CurrentVideoFormat))
+        splitRgb(buffer);
+    guard.unlock();
+
+    LOGF_DEBUG("Image received. Width: %d, Height: %d, flag: %d, timestamp: %ld", info.width, info.height, info.flag,
+               info.timestamp);
+    ExposureComplete(&PrimaryCCD);
+    recordLatency(descriptor, true);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+///
+////////////////////////////////////////////////////////////////////////////////////////////////////
+void ToupBase::splitRgb(const uint8_t *rgb)
+{
+    uint8_t *image  = PrimaryCCD.getFrameBuffer();
+    uint32_t width  = PrimaryCCD.getSubW() / PrimaryCCD.getBinX() * (PrimaryCCD.getBPP() / 8);
+    uint32_t height = PrimaryCCD.getSubH() / PrimaryCCD.getBinY() * (PrimaryCCD.getBPP() / 8);
+
+    uint8_t *subR = image;
+    uint8_t *subG = image + width * height;
+    uint8_t *subB = image + width * height * 2;
+    int size      = width * height * 3 - 3;
+
+    // RGB to three sepearate R-frame, G-frame, and B-frame for color FITS
+    for (int i = 0; i <= size; i += 3)
+    {
+        *subR++ = rgb[i];
+        *subG++ = rgb[i + 1];
+        *subB++ = rgb[i + 2];
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+///
+////////////////////////////////////////////////////////////////////////////////////////////////////
+bool ToupBase::startSequence(uint32_t count)
+{
+    if (count > 0xfffe)
+    {
+        LOGF_ERROR("Trigger sequence of %u frames exceeds the camera limit of %u.", count, 0xfffe);
+        return false;
+    }
+
+    // Slots keep their allocation between sequences of the same frame size
+    size_t bytes = PrimaryCCD.getFrameBufferSize();
+    m_SequencePool.resize(SEQUENCE_POOL_SIZE);
+    for (auto &frame : m_SequencePool)
+        frame.data.resize(bytes);
+
+    m_SequenceFree.clear();
+    m_SequenceReady.clear();
+    for (size_t i = 0; i < m_SequencePool.size(); i++)
+        m_SequenceFree.push_back(i);
+    m_SequenceCancel = false;
+    m_SequenceFailed = false;
+    m_SequenceLength = count;
+    m_SequencePulled = 0;
+
+    m_SequenceRunning = true;
+    m_SequenceActive = true;
+    m_SequenceThread = std::thread(&ToupBase::sequenceDelivery, this);
+
+    LOGF_DEBUG("Starting trigger sequence of %u frames.", count);
+    return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+///
+////////////////////////////////////////////////////////////////////////////////////////////////////
+void ToupBase::cancelSequence()
+{
+    m_SequenceActive = false;
+    {
+        std::lock_guard<std::mutex> lock(m_SequenceMutex);
+        m_SequenceCancel = true;
+    }
+    m_SequenceCondition.notify_all();
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+///
+////////////////////////////////////////////////////////////////////////////////////////////////////
+void ToupBase::stopSequence()
+{
+    if (m_SequenceThread.joinable() == false)
+        return;
+
+    cancelSequence();
+    m_SequenceThread.join();
+    m_SequenceRunning = false;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+/// Runs on the event thread, waits for a free slot if sending the images falls behind.
+/// Frames not pulled yet stay in the SDK's buffers meanwhile.
+////////////////////////////////////////////////////////////////////////////////////////////////////
+void ToupBase::pullSequenceFrame(const EventDescriptor &descriptor)
+{
+    size_t slot;
+    {
+        std::unique_lock<std::mutex> lock(m_SequenceMutex);
+        m_SequenceCondition.wait(lock, [this]()
         {
-            int captureBits = m_BitsPerPixel == 8 ? 8 : m_maxBitDepth;
-            if (Streamer->isStreaming() || Streamer->isRecording())
-            {
-                HRESULT rc = FP(PullImageWithRowPitchV2(m_Handle, PrimaryCCD.getFrameBuffer(), captureBits * m_Channels, -1, nullptr));
-                if (SUCCEEDED(rc))
-                    Streamer->newFrame(PrimaryCCD.getFrameBuffer(), PrimaryCCD.getFrameBufferSize());
-            }
-            else if (InExposure)
-            {
-                InExposure = false;
-                PrimaryCCD.setExposureLeft(0);
+            return m_SequenceCancel || !m_SequenceFree.empty();
+        });
+        if (m_SequenceCancel)
+        {
+            lock.unlock();
+            FP(put_Option(m_Handle, CP(OPTION_FLUSH), 3));
+            return;
+        }
+        slot = m_SequenceFree.front();
+        m_SequenceFree.pop_front();
+    }
 
-                XP(FrameInfoV2) info;
-                memset(&info, 0, sizeof(XP(FrameInfoV2)));
+    SequenceFrame &frame = m_SequencePool[slot];
+    int captureBits = m_BitsPerPixel == 8 ? 8 : m_maxBitDepth;
+    HRESULT rc = FP(PullImageWithRowPitchV2(m_Handle, frame.data.data(), captureBits * m_Channels, -1, nullptr));
 
-                uint8_t *buffer = PrimaryCCD.getFrameBuffer();
-                if (m_MonoCamera == false && (0 == m_CurrentVideoFormat))
-                    buffer = getRgbBuffer();
+    std::unique_lock<std::mutex> lock(m_SequenceMutex);
+    if (FAILED(rc))
+    {
+        LOGF_ERROR("Failed to pull image %u of the trigger sequence. %s", m_SequencePulled + 1, errorCodes(rc).c_str());
+        m_SequenceFree.push_back(slot);
+        m_SequenceFailed = true;
+        m_SequenceCancel = true;
+        m_SequenceActive = false;
+    }
+    else
+    {
+        frame.index = ++m_SequencePulled;
+        frame.received = descriptor.received;
+        // Frames are read out right after their exposure, the event was received a little earlier
+        frame.start = std::chrono::system_clock::now() - (std::chrono::steady_clock::now() - descriptor.received) -
+                      std::chrono::duration_cast<std::chrono::system_clock::duration>(
+                          std::chrono::duration<double>(m_ExposureRequest));
+        m_SequenceReady.push_back(slot);
+        if (m_SequencePulled == m_SequenceLength)
+            m_SequenceActive = false;
+    }
+    lock.unlock();
+    m_SequenceCondition.notify_all();
+}
 
-                HRESULT rc = FP(PullImageWithRowPitchV2(m_Handle, buffer, captureBits * m_Channels, -1, &info));
-                if (FAILED(rc))
-                {
-                    LOGF_ERROR("Failed to pull image. %s", errorCodes(rc).c_str());
-                    PrimaryCCD.setExposureFailed();
-                }
-                else
-                {
-                    if (m_MonoCamera == false && (0 == m_CurrentVideoFormat))
-                    {
-                        uint8_t *image  = PrimaryCCD.getFrameBuffer();
-                        uint32_t width  = PrimaryCCD.getSubW() / PrimaryCCD.getBinX() * (PrimaryCCD.getBPP() / 8);
-                        uint32_t height = PrimaryCCD.getSubH() / PrimaryCCD.getBinY() * (PrimaryCCD.getBPP() / 8);
-
-                        uint8_t *subR = image;
-                        uint8_t *subG = image + width * height;
-                        uint8_t *subB = image + width * height * 2;
-                        int size      = width * height * 3 - 3;
-
-                        // RGB to three sepearate R-frame, G-frame, and B-frame for color FITS
-                        for (int i = 0; i <= size; i += 3)
-                        {
-                            *subR++ = buffer[i];
-                            *subG++ = buffer[i + 1];
-                            *subB++ = buffer[i + 2];
-                        }
-                    }
-
-                    LOGF_DEBUG("Image received. Width: %d, Height: %d, flag: %d, timestamp: %ld", info.width, info.height, info.flag,
-                               info.timestamp);
-                    ExposureComplete(&PrimaryCCD);
-                }
-            }
-            else
+////////////////////////////////////////////////////////////////////////////////////////////////////
+///
+////////////////////////////////////////////////////////////////////////////////////////////////////
+void ToupBase::sequenceDelivery()
+{
+    auto start = std::chrono::steady_clock::now();
+    uint32_t delivered = 0;
+    bool failed = false;
+
+    while (delivered < m_SequenceLength)
+    {
+        size_t slot;
+        {
+            std::unique_lock<std::mutex> lock(m_SequenceMutex);
+            m_SequenceCondition.wait(lock, [this]()
             {
-                HRESULT rc = FP(put_Option(m_Handle, CP(OPTION_FLUSH), 3));
-                if (FAILED(rc))
-                    LOGF_ERROR("Failed to flush image. %s", errorCodes(rc).c_str());
+                return m_SequenceCancel || !m_SequenceReady.empty();
+            });
+            if (m_SequenceCancel)
+            {
+                failed = m_SequenceFailed;
+                m_SequenceReady.clear();
+                break;
             }
+            slot = m_SequenceReady.front();
+            m_SequenceReady.pop_front();
+        }
+
+        const SequenceFrame &frame = m_SequencePool[slot];
+        {
+            std::unique_lock<std::mutex> guard(ccdBufferLock);
+            if (m_MonoCamera == false && (0 == m_CurrentVideoFormat))
+                splitRgb(frame.data.data());
+            else
+                memcpy(PrimaryCCD.getFrameBuffer(), frame.data.data(),
+                       std::min<size_t>(frame.data.size(), PrimaryCCD.getFrameBufferSize()));
+        }
+
+        delivered = frame.index;
+        if (delivered == m_SequenceLength)
+        {
+            std::unique_lock<std::mutex> guard(m_ExposureMutex);
+            InExposure = false;
+            guard.unlock();
+            // A client starts the next exposure as soon as the last frame completes
+            m_SequenceRunning = false;
+        }
+
+        m_SequenceFrameIndex = frame.index;
+        m_SequenceFrameStart = frame.start;
+        PrimaryCCD.setExposureLeft(0);
+        ExposureComplete(&PrimaryCCD);
+        // ExposureComplete reports the exposure done, it is only done after the last frame
+        if (delivered < m_SequenceLength)
+            PrimaryCCD.setExposureLeft((m_SequenceLength - delivered) * m_ExposureRequest);
+        LOGF_DEBUG("Sequence frame %u/%u sent, callback to BLOB latency: %.1f ms", frame.index, m_SequenceLength,
+                   std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - frame.received).count());
+
+        {
+            std::lock_guard<std::mutex> lock(m_SequenceMutex);
+            m_SequenceFree.push_back(slot);
+        }
+        m_SequenceCondition.notify_all();
+    }
+    m_SequenceFrameIndex = 0;
+
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    if (delivered == m_SequenceLength)
+        LOGF_INFO("Trigger sequence of %u frames done in %.2f seconds (%.2f fps).", delivered, seconds,
+                  seconds > 0 ? delivered / seconds : 0);
+    else
+    {
+        LOGF_WARN("Trigger sequence stopped after %u of %u frames.", delivered, m_SequenceLength);
+        if (failed)
+        {
+            std::unique_lock<std::mutex> guard(m_ExposureMutex);
+            InExposure = false;
+            guard.unlock();
+            PrimaryCCD.setExposureFailed();
+        }
+    }
+
+    m_SequenceRunning = false;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+///
+////////////////////////////////////////////////////////////////////////////////////////////////////
+void ToupBase::processEvent(const EventDescriptor &descriptor)
+{
+    LOGF_DEBUG("%s: 0x%08x", __func__, descriptor.event);
+    switch (descriptor.event)
+    {
+        case CP(EVENT_EXPOSURE):
+        {
+            uint16_t expoGain = CP(EXPOGAIN_MIN);
+            FP(get_ExpoAGain(m_Handle, &expoGain));
+            m_ControlN[TC_GAIN].value = expoGain;
+            m_ControlNP.s = IPS_OK;
+            IDSetNumber(&m_ControlNP, nullptr);
         }
         break;
+        case CP(EVENT_IMAGE):
+            processImage(descriptor);
+            break;
         case CP(EVENT_WBGAIN):
         {
             int aGain[3] = { 0 };
@@ -1890,9 +2326,16 @@ void ToupBase::eventCallBack(unsigned event)
             LOG_ERROR("Camera disconnected");
             break;
         case CP(EVENT_NOFRAMETIMEOUT):
+        {
             LOG_ERROR("Camera timed out");
+            if (m_SequenceActive)
+                cancelSequence();
+            std::unique_lock<std::mutex> guard(m_ExposureMutex);
+            InExposure = false;
+            guard.unlock();
             PrimaryCCD.setExposureFailed();
-            break;
+        }
+        break;
         default:
             break;
     }
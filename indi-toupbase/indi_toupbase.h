@@ -25,6 +25,15 @@
 #include <inditimer.h>
 #include "libtoupbase.h"
 
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
 class ToupBase : public INDI::CCD
 {
     public:
@@ -144,6 +153,86 @@ class ToupBase : public INDI::CCD
         static void eventCB(unsigned event, void* pCtx);
         void eventCallBack(unsigned event);
 
+        //#############################################################################
+        // Event Processing
+        //#############################################################################
+        // The SDK callback only queues the event, everything else runs on m_EventThread.
+        struct EventDescriptor
+        {
+            unsigned event;
+            std::chrono::steady_clock::time_point received;
+        };
+        void startEventThread();
+        void stopEventThread();
+        void eventLoop();
+        // Single producer (SDK callback thread), single consumer (m_EventThread) ring.
+        bool pushEvent(const EventDescriptor &descriptor);
+        bool popEvent(EventDescriptor &descriptor);
+        void processEvent(const EventDescriptor &descriptor);
+        void processImage(const EventDescriptor &descriptor);
+        void recordLatency(const EventDescriptor &descriptor, bool exposure);
+
+        static constexpr size_t EVENT_QUEUE_SIZE = 64;
+        std::array<EventDescriptor, EVENT_QUEUE_SIZE> m_EventQueue;
+        std::atomic<size_t> m_EventHead {0};
+        std::atomic<size_t> m_EventTail {0};
+        std::atomic<uint32_t> m_EventsDropped {0};
+        // Only used to sleep while the queue is empty
+        std::mutex m_EventWakeMutex;
+        std::condition_variable m_EventWake;
+        std::atomic_bool m_EventThreadQuit {false};
+        std::thread m_EventThread;
+
+        // Guards InExposure, which StartExposure and AbortExposure change on the main thread
+        std::mutex m_ExposureMutex;
+
+        // Callback to BLOB (exposure) or callback to streamer (video) latency
+        static constexpr uint32_t LATENCY_REPORT_FRAMES = 100;
+        uint32_t m_LatencyFrames {0};
+        double m_LatencySumMs {0};
+        double m_LatencyMaxMs {0};
+
+        //#############################################################################
+        // Trigger Sequence
+        //#############################################################################
+        // One Trigger(N) call captures N frames back to back. The event thread pulls each
+        // frame into a pool slot, m_SequenceThread sends them as individual images.
+        struct SequenceFrame
+        {
+            std::vector<uint8_t> data;
+            uint32_t index {0};
+            std::chrono::steady_clock::time_point received;
+            // Estimated from the arrival of the frame, for DATE-OBS
+            std::chrono::system_clock::time_point start;
+        };
+        bool startSequence(uint32_t count);
+        void stopSequence();
+        void pullSequenceFrame(const EventDescriptor &descriptor);
+        void cancelSequence();
+        void sequenceDelivery();
+        // RGB24 to the planar layout of color FITS, in the frame buffer
+        void splitRgb(const uint8_t *rgb);
+
+        static constexpr size_t SEQUENCE_POOL_SIZE = 4;
+        INDI::PropertyNumber m_SequenceNP {1};
+        std::vector<SequenceFrame> m_SequencePool;
+        std::deque<size_t> m_SequenceFree;
+        std::deque<size_t> m_SequenceReady;
+        std::mutex m_SequenceMutex;
+        std::condition_variable m_SequenceCondition;
+        std::thread m_SequenceThread;
+        // Set while frames of the sequence are still expected from the camera
+        std::atomic_bool m_SequenceActive {false};
+        // Set while m_SequenceThread has frames left to send
+        std::atomic_bool m_SequenceRunning {false};
+        bool m_SequenceCancel {false};
+        bool m_SequenceFailed {false};
+        uint32_t m_SequenceLength {0};
+        uint32_t m_SequencePulled {0};
+        // Index and start of the frame being sent, the index is 0 outside of a sequence
+        std::atomic<uint32_t> m_SequenceFrameIndex {0};
+        std::chrono::system_clock::time_point m_SequenceFrameStart;
+
         //#############################################################################
         // Camera Handle & Instance
         //#############################################################################
@@ -529,6 +529,12 @@ bool indi_webcam::initProperties()
                        MAIN_CONTROL_TAB, IP_RW, ISR_1OFMANY, 60, IPS_IDLE);
     defineProperty(&RapidStackingSelection);
 
+    IUFillNumber(&LiveStackT[0], "QUEUE_DEPTH", "Queue (frames)", "%.0f", 1, 64, 1, stackQueueDepth);
+    IUFillNumber(&LiveStackT[1], "MAX_SHIFT", "Max Shift (px)", "%.0f", 0, 512, 1, stackMaxShift);
+    IUFillNumberVector(&LiveStackTP, LiveStackT, NARRAY(LiveStackT), getDeviceName(), "LIVE_STACK_OPTIONS",
+                       "Stack Alignment", MAIN_CONTROL_TAB, IP_RW, 0, IPS_IDLE);
+    defineProperty(&LiveStackTP);
+
     OutputFormats = new ISwitch[3];
     IUFillSwitch(&OutputFormats[0], "16 bit Grayscale", "16 bit Grayscale", ISS_OFF);
     IUFillSwitch(&OutputFormats[1], "16 bit RGB", "16 bit RGB", ISS_OFF);
@@ -538,6 +544,12 @@ bool indi_webcam::initProperties()
                        MAIN_CONTROL_TAB, IP_RW, ISR_1OFMANY, 60, IPS_IDLE);
     defineProperty(&OutputFormatSelection);
 
+    IUFillSwitch(&StreamPassthroughS[0], "PASSTHROUGH_ON", "On", ISS_OFF);
+    IUFillSwitch(&StreamPassthroughS[1], "PASSTHROUGH_OFF", "Off", ISS_ON);
+    IUFillSwitchVector(&StreamPassthroughSP, StreamPassthroughS, 2, getDeviceName(), "STREAM_PASSTHROUGH", "MJPEG Passthrough",
+                       OPTIONS_TAB, IP_RW, ISR_1OFMANY, 60, IPS_IDLE);
+    defineProperty(&StreamPassthroughSP);
+
     IUFillNumber(&TimeoutOptionsT[0], "FFMPEG_TIMEOUT", "FFMPEG", "%.0f", 0 , 100000000, 1, ffmpegTimeout);
     IUFillNumber(&TimeoutOptionsT[1], "BUFFER_TIMEOUT", "Buffer", "%.0f", 0 , 10000000, 1, bufferTimeout);
     IUFillNumberVector(&TimeoutOptionsTP, TimeoutOptionsT, NARRAY(TimeoutOptionsT), getDeviceName(), "TIMEOUT_OPTIONS",
@@ -667,7 +679,9 @@ bool indi_webcam::initProperties()
     SetCCDCapability(cap);
 
     loadConfig(true, RapidStackingSelection.name);
+    loadConfig(true, LiveStackTP.name);
     loadConfig(true, OutputFormatSelection.name);
+    loadConfig(true, StreamPassthroughSP.name);
     loadConfig(true, PixelSizeTP.name);
     loadConfig(true, InputOptionsTP.name);
     loadConfig(true, TimeoutOptionsTP.name);
@@ -897,6 +911,17 @@ bool indi_webcam::ISNewNumber (const char *dev, const char *name, double values[
         return true;
     }
 
+    if (!strcmp(name, LiveStackTP.name) )
+    {
+        IUUpdateNumber(&LiveStackTP, values, names, n);
+        stackQueueDepth = IUFindNumber( &LiveStackTP, "QUEUE_DEPTH" )->value;
+        stackMaxShift = IUFindNumber( &LiveStackTP, "MAX_SHIFT" )->value;
+        DEBUGF(INDI::Logger::DBG_SESSION, "New Stack Options: queue: %d frames, max shift: %d px", stackQueueDepth, stackMaxShift);
+        LiveStackTP.s = IPS_OK;
+        IDSetNumber (&LiveStackTP, nullptr);
+        return true;
+    }
+
     if (!strcmp(name, TimeoutOptionsTP.name) )
     {
         IUUpdateNumber(&TimeoutOptionsTP, values, names, n);
@@ -1075,6 +1100,15 @@ bool indi_webcam::ISNewSwitch (const char *dev, const char *name, ISState *state
         return false;
     }
 
+    if (!strcmp(svp->name, StreamPassthroughSP.name))
+    {
+        IUUpdateSwitch(&StreamPassthroughSP, states, names, n);
+        streamPassthrough = (IUFindOnSwitchIndex(&StreamPassthroughSP) == 0);
+        StreamPassthroughSP.s = IPS_OK;
+        IDSetSwitch(&StreamPassthroughSP, nullptr);
+        return true;
+    }
+
     if (!strcmp(svp->name, PixelSizeSelection.name))
     {
         IUUpdateSwitch(&PixelSizeSelection, states, names, n);
@@ -1233,14 +1267,6 @@ bool indi_webcam::StartExposure(float duration)
         return false;
     }
 
-    //This resets the stack buffer
-    if(webcamStacking)
-    {
-        if(stackBuffer)
-            free(stackBuffer);
-        stackBuffer = nullptr;
-    }
-
     //This sets up the output format for the exposure
     if(outputFormat == "16 bit RGB")
     {
@@ -1287,7 +1313,16 @@ bool indi_webcam::StartExposure(float duration)
     }
     */
 
+    //This starts a new stack
+    if(webcamStacking && !startStacker(false))
+    {
+        DEBUG(INDI::Logger::DBG_SESSION, "Error starting the stacker.");
+        freeMemory();
+        return false;
+    }
+
     //This sets up the exposure time settings
+    stageTiming = StageTiming();
     ExposureRequest = duration;
     PrimaryCCD.setExposureDuration(duration);
     gettimeofday(&ExpStart, nullptr);
@@ -1299,8 +1334,7 @@ bool indi_webcam::StartExposure(float duration)
 
 bool indi_webcam::AbortExposure()
 {
-    if(stackBuffer)
-        free(stackBuffer);
+    stacker.stop();
     InExposure = false;
     return true;
 }
@@ -1352,6 +1386,7 @@ void indi_webcam::TimerHit()
                 copyFinalStackToPrimaryFrameBuffer();
             PrimaryCCD.setExposureLeft(0);
             InExposure = false;
+            logStageTiming(false);
             LOG_INFO("Download complete.");
             finishExposure();
             freeMemory();
@@ -1370,13 +1405,15 @@ bool indi_webcam::grabImage()
 {
     if(getStreamFrame())
     {
-        if(PrimaryCCD.getNAxis() == 3)
-            convertINDI_RGBtoFITS_RGB(pFrameOUT->data[0], PrimaryCCD.getFrameBuffer());
-        else
-            memcpy(PrimaryCCD.getFrameBuffer(), pFrameOUT->data[0], numBytes);
+        //When stacking, the frame only has to be queued, the stacker aligns and adds it.
         if(webcamStacking)
-            addToStack();
+            stacker.push(outputFrame);
+        else if(PrimaryCCD.getNAxis() == 3)
+            convertINDI_RGBtoFITS_RGB(outputFrame, PrimaryCCD.getFrameBuffer());
+        else
+            memcpy(PrimaryCCD.getFrameBuffer(), outputFrame, numBytes);
         gotAnImageAlready = true;
+        stageTiming.frames++;
     }
     else
     {
@@ -1387,98 +1424,37 @@ bool indi_webcam::grabImage()
     return true;
 }
 
-//This adds each image to the running stack
-bool indi_webcam::addToStack()
+//This starts the stacker for frames in the current output format.
+//For streaming, the averaged stack is sent to the stream instead of the single frames.
+bool indi_webcam::startStacker(bool forStreaming)
 {
-    if(!stackBuffer)
-    {
-        stackBuffer = (float *)malloc(numBytes * sizeof(float_t));
-        numberOfFramesInStack = 0;
-    }
-
-    int w = pCodecCtx->width  * ((PrimaryCCD.getNAxis() == 3) ? 3 : 1);
-    int h = pCodecCtx->height;
-
-    for (int i = 0; i < w * h; i++)
-    {
-        int x = i % w;
-        int y = i / w;
-        if(x >= 0 && y >= 0 && x < w && y < h)
-        {
-            if(numberOfFramesInStack == 0)
-                stackBuffer[i] = getImageDataFloatValue(x, y);
-            else
-                stackBuffer[i] += getImageDataFloatValue(x, y);
-        }
-    }
-    numberOfFramesInStack++;
-    return true;
-}
+    int channels = (PrimaryCCD.getNAxis() == 3) ? 3 : 1;
+    if(!stacker.start(pCodecCtx->width, pCodecCtx->height, channels, PrimaryCCD.getBPP() / 8, stackQueueDepth, stackMaxShift))
+        return false;
 
-//This gets the pixel value at an x, y position in the image
-float indi_webcam::getImageDataFloatValue(int x, int y)
-{
-    int w = pCodecCtx->width  * ((PrimaryCCD.getNAxis() == 3) ? 3 : 1);
-    uint8_t *primaryBuffer = PrimaryCCD.getFrameBuffer();
-    if(PrimaryCCD.getBPP() == 8)
-        return (float) primaryBuffer[y * w + x];
-    else if(PrimaryCCD.getBPP() == 16)
+    if(forStreaming)
+        stacker.setPreviewCallback([this](const uint8_t *frame, size_t size)
     {
-        uint16_t *newBuffer = reinterpret_cast<uint16_t *>(primaryBuffer);
-        return (float) newBuffer[y * w + x];
-    }
+        Streamer->newFrame(frame, size);
+    }, 100);
     else
-        return 0;
-}
-//This sets the pixel value at an x, y position in the image
-void indi_webcam::setImageDataValueFromFloat(int x, int y, float value, bool roundAnswer)
-{
-    uint8_t *primaryBuffer = PrimaryCCD.getFrameBuffer();
-    int w = pCodecCtx->width * ((PrimaryCCD.getNAxis() == 3) ? 3 : 1);
-    if(!stackBuffer)
-        return;
-    if(PrimaryCCD.getBPP() == 8)
-    {
-        int max = std::numeric_limits<uint8_t>::max();
-        if (value > max)
-            value = max;
-        if(roundAnswer)
-            primaryBuffer[y * w + x] = round(value);
-        else
-            primaryBuffer[y * w + x] = value;
-    }
-    else if(PrimaryCCD.getBPP() == 16)
-    {
-        int max = std::numeric_limits<uint16_t>::max();
-        if (value > max)
-            value = max;
-        uint16_t *newBuffer = reinterpret_cast<uint16_t *>(primaryBuffer);
-        if(roundAnswer)
-            newBuffer[y * w + x] = round(value);
-        else
-            newBuffer[y * w + x] = value;
-    }
+        stacker.setPreviewCallback(nullptr, 0);
+    return true;
 }
 
-//This will take the final image stack and copy it back to the primary buffer for final download.
+//This waits for the stacker to finish the queued frames and copies the stack to the primary buffer for final download.
 void indi_webcam::copyFinalStackToPrimaryFrameBuffer()
 {
-    int w = pCodecCtx->width  * ((PrimaryCCD.getNAxis() == 3) ? 3 : 1);
-    int h = pCodecCtx->height;
-    for (int i = 0; i < w * h; i++)
-    {
-        int x = i % w;
-        int y = i / w;
-        if(x >= 0 && y >= 0 && x < w && y < h)
-        {
-            if(averaging)
-                setImageDataValueFromFloat(x, y, round(stackBuffer[i] / numberOfFramesInStack), true);
-            else //Integrating
-                setImageDataValueFromFloat(x, y, round(stackBuffer[i]), true);
-        }
-    }
+    stacker.flush();
+    std::vector<uint8_t> stack(stacker.frameSize());
+    stacker.render(stack.data(), averaging);
+    if(PrimaryCCD.getNAxis() == 3)
+        convertINDI_RGBtoFITS_RGB(stack.data(), PrimaryCCD.getFrameBuffer());
+    else
+        memcpy(PrimaryCCD.getFrameBuffer(), stack.data(), std::min(stack.size(), static_cast<size_t>(numBytes)));
 
-    LOGF_INFO("Final Image is a stack of %u exposures.", numberOfFramesInStack);
+    LOGF_INFO("Final Image is a stack of %d exposures, %d frames dropped.", stacker.stackedFrames(), stacker.droppedFrames());
+    stacker.stop();
 }
 
 //This will crop the image to a subframe if desired.
@@ -1609,7 +1585,7 @@ void indi_webcam::RunCaptureThread(indi_webcam *webcam)
 }
 
 //This is the loop that runs during streaming
-//Note that it ONLY supports RGB24 aka INDI_RGB format.
+//Note that it ONLY supports RGB24 aka INDI_RGB format, or JPEG when MJPEG frames are passed through.
 void indi_webcam::run_capture()
 {
 
@@ -1648,6 +1624,17 @@ void indi_webcam::run_capture()
     Streamer->setSize(w, h);
     PrimaryCCD.setFrame(0, 0, w, h);
 
+    //An MJPEG source can be streamed as is, but stacking needs the decoded frames
+    bool passthrough = streamPassthrough && !webcamStacking && pCodecCtx->codec_id == AV_CODEC_ID_MJPEG;
+    if(streamPassthrough && !passthrough)
+        LOG_INFO("MJPEG passthrough needs an MJPEG source and rapid stacking off, decoding frames instead.");
+    if(passthrough)
+    {
+        LOG_INFO("Streaming MJPEG frames without decoding.");
+        Streamer->setPixelFormat(INDI_JPG);
+    }
+    stageTiming = StageTiming();
+
     //This will clear the frame button before streaming is started so that the frames are all current.
     if(!flush_frame_buffer())
         DEBUG(INDI::Logger::DBG_SESSION, "FFMPEG Issue in flushing buffer");
@@ -1662,11 +1649,46 @@ void indi_webcam::run_capture()
     }
     */
 
+    //With rapid stacking on, the stream shows the live stack
+    bool stacking = webcamStacking && startStacker(true);
+    if(stacking)
+        LOG_INFO("Streaming the live stack.");
+
     while (is_capturing && is_streaming)
     {
+        bool gotFrame;
+        if(passthrough)
+        {
+            AVPacket packet;
+            gotFrame = readPacket(&packet);
+            if(gotFrame)
+            {
+                auto start = std::chrono::steady_clock::now();
+                Streamer->newFrame(packet.data, packet.size);
+                stageTiming.publish += std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+                av_packet_unref(&packet);
+            }
+        }
+        else
+        {
+            gotFrame = getStreamFrame();
+            if(gotFrame)
+            {
+                auto start = std::chrono::steady_clock::now();
+                if(stacking)
+                    stacker.push(outputFrame);
+                else
+                    Streamer->newFrame(outputFrame, numBytes);
+                stageTiming.publish += std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+            }
+        }
 
-        if(getStreamFrame())
-            Streamer->newFrame(pFrameOUT->data[0], numBytes);
+        if(gotFrame)
+        {
+            stageTiming.frames++;
+            if(stageTiming.frames % 300 == 0)
+                logStageTiming(false);
+        }
         else
         {
             is_capturing = false;
@@ -1674,6 +1696,14 @@ void indi_webcam::run_capture()
         }
     }
 
+    logStageTiming(true);
+
+    if(stacking)
+    {
+        LOGF_INFO("Live stack of %d frames, %d frames dropped.", stacker.stackedFrames(), stacker.droppedFrames());
+        stacker.stop();
+    }
+
     freeMemory();
 
     DEBUG(INDI::Logger::DBG_SESSION, "Capture thread releasing device.");
@@ -1739,15 +1769,11 @@ bool indi_webcam::setupStreaming()
     av_image_fill_arrays (pFrameOUT->data, pFrameOUT->linesize, buffer, out_pix_fmt,
                           pCodecCtx->width, pCodecCtx->height, 1);
 
-    // initialize SWS context for software scaling
-    sws_ctx = sws_getContext( pCodecCtx->width, pCodecCtx->height,
-                              pCodecCtx->pix_fmt, pCodecCtx->width, pCodecCtx->height,
-                              out_pix_fmt, SWS_BILINEAR, nullptr, nullptr, nullptr
-                            );
-    if(sws_ctx == nullptr)
-        return false;
-
-    updateVideoAdjustments();
+    // The SWS context for software scaling is created with the first frame that needs converting,
+    // when the decoder already delivers out_pix_fmt it is not needed at all.
+    sws_ctx = nullptr;
+    swsInputFormat = AV_PIX_FMT_NONE;
+    outputFrame = buffer;
 
     PrimaryCCD.setFrameBufferSize(numBytes);
     PrimaryCCD.setResolution(pCodecCtx->width, pCodecCtx->height);
@@ -1767,11 +1793,11 @@ void indi_webcam::updateVideoAdjustments()
                              (int)(brightness * 65536), (int)(contrast * 65536), (int)(saturation * 65536));
 }
 
-//This gets one image from the camera.
-//It is used for both the streaming and exposing algorithms
-bool indi_webcam::getStreamFrame()
+//This reads the next video packet from the camera, reconnecting the source if it stops responding.
+//The caller must unref the packet.
+bool indi_webcam::readPacket(AVPacket *packet)
 {
-    AVPacket packet;
+    auto start = std::chrono::steady_clock::now();
     //If at first you don't succees to get a frame, try again.
     int ret = -1;
     while(ret < 0)
@@ -1779,9 +1805,15 @@ bool indi_webcam::getStreamFrame()
         int tries = 0;
         while(tries < 10) //Try a maximum of 10 times before trying to reconnect the source
         {
-            ret = av_read_frame(pFormatCtx, &packet);
+            ret = av_read_frame(pFormatCtx, packet);
             if(ret == 0)
-                break;
+            {
+                if(packet->stream_index == videoStream)
+                    break;
+                //Not our stream, for example audio, read again.
+                av_packet_unref(packet);
+                continue;
+            }
             else
             {
                 if(ret != -35) // Don't display "Resource Temporarily Unavailable"
@@ -1810,45 +1842,113 @@ bool indi_webcam::getStreamFrame()
             else
             {
                 DEBUG(INDI::Logger::DBG_SESSION, "Device did not reconnect after 10 tries.");
-                av_packet_unref(&packet);
                 return false;
             }
         }
     }
-    if(packet.stream_index == videoStream)
+    stageTiming.read += std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+    return true;
+}
+
+//This gets one image from the camera.
+//It is used for both the streaming and exposing algorithms
+bool indi_webcam::getStreamFrame()
+{
+    AVPacket packet;
+    while(true)
     {
-        int ret;
-        ret = avcodec_send_packet(pCodecCtx, &packet);
-        char errbuff[200];
-        av_make_error_string(errbuff, 200, ret);
+        if(!readPacket(&packet))
+            return false;
+
+        auto start = std::chrono::steady_clock::now();
+        int ret = avcodec_send_packet(pCodecCtx, &packet);
+        av_packet_unref(&packet);
         if (ret < 0)
         {
+            char errbuff[200];
+            av_make_error_string(errbuff, 200, ret);
             DEBUGF(INDI::Logger::DBG_SESSION, "Error sending a packet for decoding:%s", errbuff);
-            av_packet_unref(&packet);
             return false;
         }
-        while (ret >= 0)
+        ret = avcodec_receive_frame(pCodecCtx, pFrame);
+        stageTiming.decode += std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+        if (ret == AVERROR(EAGAIN))
+            continue; //The decoder needs more packets for this frame
+        else if (ret < 0)
         {
-            ret = avcodec_receive_frame(pCodecCtx, pFrame);
-            if (ret == AVERROR(EAGAIN) || ret == AVERROR_EOF)
-                continue;
-            else if (ret < 0)
-            {
-                DEBUG(INDI::Logger::DBG_SESSION, "Error during decoding");
-                av_packet_unref(&packet);
-                return false;
-            }
-            // We have a frame at that point
-            // Convert the image from its native format to our output format
-            sws_scale(sws_ctx, (uint8_t const * const *)pFrame->data,
-                      pFrame->linesize, 0, pCodecCtx->height,
-                      pFrameOUT->data, pFrameOUT->linesize);
-            av_packet_unref(&packet);
-            return true;
+            DEBUG(INDI::Logger::DBG_SESSION, "Error during decoding");
+            return false;
+        }
+        break;
+    }
+
+    // We have a frame at that point
+    auto start = std::chrono::steady_clock::now();
+    bool converted = convertFrame();
+    stageTiming.convert += std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+    return converted;
+}
+
+//This puts the decoded frame in our output format and points outputFrame at it.
+bool indi_webcam::convertFrame()
+{
+    int w = pCodecCtx->width;
+    int h = pCodecCtx->height;
+    bool adjusted = brightness != 0.0 || contrast != 1.0 || saturation != 1.0;
+
+    // The decoder already delivers our output format, so there is nothing for swscale to do.
+    // All output formats are packed into one plane, so the frame can be used in place unless its rows are padded.
+    if(pFrame->format == out_pix_fmt && !adjusted && pFrame->width == w && pFrame->height == h)
+    {
+        if(pFrame->linesize[0] == pFrameOUT->linesize[0])
+            outputFrame = pFrame->data[0];
+        else
+        {
+            av_image_copy(pFrameOUT->data, pFrameOUT->linesize, (const uint8_t **)pFrame->data, pFrame->linesize, out_pix_fmt, w, h);
+            outputFrame = pFrameOUT->data[0];
         }
+        return true;
+    }
 
+    if(sws_ctx == nullptr || swsInputFormat != pFrame->format)
+    {
+        if(sws_ctx)
+            sws_freeContext(sws_ctx);
+        // initialize SWS context for software scaling
+        sws_ctx = sws_getContext(w, h, (AVPixelFormat)pFrame->format, w, h,
+                                 out_pix_fmt, SWS_BILINEAR, nullptr, nullptr, nullptr);
+        if(sws_ctx == nullptr)
+        {
+            DEBUG(INDI::Logger::DBG_SESSION, "Error creating the frame converter.");
+            return false;
+        }
+        swsInputFormat = pFrame->format;
+        updateVideoAdjustments();
     }
-    return false;
+
+    // Convert the image from its native format to our output format
+    sws_scale(sws_ctx, (uint8_t const * const *)pFrame->data,
+              pFrame->linesize, 0, h,
+              pFrameOUT->data, pFrameOUT->linesize);
+    outputFrame = pFrameOUT->data[0];
+    return true;
+}
+
+//This reports the average time per frame of each capture stage.
+void indi_webcam::logStageTiming(bool final)
+{
+    if(stageTiming.frames == 0)
+        return;
+
+    double n = stageTiming.frames;
+    if(final)
+        LOGF_INFO("Capture timing over %d frames (ms/frame): read %.2f, decode %.2f, convert %.2f, publish %.2f",
+                  stageTiming.frames, stageTiming.read / n / 1000, stageTiming.decode / n / 1000,
+                  stageTiming.convert / n / 1000, stageTiming.publish / n / 1000);
+    else
+        LOGF_DEBUG("Capture timing over %d frames (ms/frame): read %.2f, decode %.2f, convert %.2f, publish %.2f",
+                   stageTiming.frames, stageTiming.read / n / 1000, stageTiming.decode / n / 1000,
+                   stageTiming.convert / n / 1000, stageTiming.publish / n / 1000);
 }
 
 //This will clear out the frame buffer of any unread frames.
@@ -1888,6 +1988,8 @@ void indi_webcam::freeMemory()
     if(sws_ctx)
         sws_freeContext(sws_ctx);
     sws_ctx = nullptr;
+    swsInputFormat = AV_PIX_FMT_NONE;
+    outputFrame = nullptr;
 
     // Free the Buffer
     if(buffer)
@@ -1911,7 +2013,9 @@ bool indi_webcam::saveConfigItems(FILE *fp)
     INDI::CCD::saveConfigItems(fp);
     IUSaveConfigSwitch(fp, &CaptureDeviceSelection);
     IUSaveConfigSwitch(fp, &RapidStackingSelection);
+    IUSaveConfigNumber(fp, &LiveStackTP);
     IUSaveConfigSwitch(fp, &OutputFormatSelection);
+    IUSaveConfigSwitch(fp, &StreamPassthroughSP);
     IUSaveConfigSwitch(fp, &OnlineProtocolSelection);
     IUSaveConfigNumber(fp, &PixelSizeTP);
     IUSaveConfigText(fp, &InputOptionsTP);
@@ -42,8 +42,11 @@ extern "C" {
 }
 #endif
 //#include <ctime>
+#include <chrono>
 #include <thread>
 
+#include "live_stacker.h"
+
 //These are required to check for AVFoundation Devices
 //The reason is that we have to print and parse the output
 //These can't be in indi_webcam class declaration because the callback method has to be passed to FFMpeg
@@ -118,14 +121,12 @@ private:
     bool gotAnImageAlready = false;
     bool loadingSettings = false;
     bool averaging = false;
-    float *stackBuffer = nullptr;
-    int numberOfFramesInStack = 0;
-    bool addToStack();
+    //Frames are aligned and stacked on the stacker's own thread
+    LiveStacker stacker;
+    int stackQueueDepth = 4;
+    int stackMaxShift = 32;
+    bool startStacker(bool forStreaming);
     void copyFinalStackToPrimaryFrameBuffer();
-    void setImageDataValueFromFloat(int x, int y, float value, bool roundAnswer);
-    void setRGBImageDataValueFromFloat(int x, int y, int channel, float value, bool roundAnswer);
-    float getImageDataFloatValue(int x, int y);
-    float getRGBImageDataFloatValue(int x, int y, int channel);
 
     //These are our device capture settings
     bool use16Bit = true;
@@ -176,6 +177,8 @@ private:
     ISwitchVectorProperty RapidStackingSelection;
     ISwitch *OutputFormats = nullptr;
     ISwitchVectorProperty OutputFormatSelection;
+    ISwitch StreamPassthroughS[2];
+    ISwitchVectorProperty StreamPassthroughSP;
     ISwitch *PixelSizes = nullptr;
     ISwitchVectorProperty PixelSizeSelection;
 
@@ -185,13 +188,36 @@ private:
     INumberVectorProperty PixelSizeTP;
     INumber VideoAdjustmentsT[3] {};
     INumberVectorProperty VideoAdjustmentsTP;
+    INumber LiveStackT[2] {};
+    INumberVectorProperty LiveStackTP;
 
 
     //Webcam setup, release, and frame capture
     bool flush_frame_buffer();
     bool setupStreaming();
     void freeMemory();
+    bool readPacket(AVPacket *packet);
     bool getStreamFrame();
+    bool convertFrame();
+    //Points at the last frame in the output format, either in pFrameOUT or straight in pFrame
+    uint8_t *outputFrame = nullptr;
+    //Input format of sws_ctx, the converter is created for the first frame that needs it
+    int swsInputFormat = AV_PIX_FMT_NONE;
+
+    //MJPEG packets are sent to the stream without decoding
+    bool streamPassthrough = false;
+
+    //Time spent in each stage of the capture pipeline, in microseconds
+    struct StageTiming
+    {
+        double read = 0;
+        double decode = 0;
+        double convert = 0;
+        double publish = 0;
+        int frames = 0;
+    };
+    StageTiming stageTiming;
+    void logStageTiming(bool final);
 
     //Related to streaming
     std::thread capture_thread;
@@ -0,0 +1,449 @@
+/*
+INDI Webcam CCD Driver - Live Stacker
+
+Copyright (C) 2026 INDI 3rd party contributors
+
+This driver is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) any later version.
+
+This library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public
+License along with this library; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+
+*/
+
+#include "live_stacker.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+LiveStacker::LiveStacker()
+{
+}
+
+LiveStacker::~LiveStacker()
+{
+    stop();
+}
+
+bool LiveStacker::start(int newWidth, int newHeight, int newChannels, int newBytesPerSample, int queueDepth, int newMaxShift)
+{
+    stop();
+
+    if(newWidth <= 0 || newHeight <= 0 || (newChannels != 1 && newChannels != 3) ||
+            (newBytesPerSample != 1 && newBytesPerSample != 2))
+        return false;
+
+    width = newWidth;
+    height = newHeight;
+    channels = newChannels;
+    bytesPerSample = newBytesPerSample;
+    //The shift can never be more than half the frame or there would be nothing left to compare.
+    maxShift = std::max(0, std::min(newMaxShift, std::min(width, height) / 2));
+    frameBytes = static_cast<size_t>(width) * height * channels * bytesPerSample;
+
+    //One slot more than the queue depth for the frame the worker is stacking.
+    int slotCount = std::max(1, queueDepth) + 1;
+    slots.assign(slotCount, std::vector<uint8_t>(frameBytes));
+    freeSlots.clear();
+    readySlots.clear();
+    for(int i = 0; i < slotCount; i++)
+        freeSlots.push_back(i);
+    busySlot = -1;
+    dropped = 0;
+
+    sum.assign(static_cast<size_t>(width) * height * channels, 0.0);
+    coverage.assign(static_cast<size_t>(width) * height, 0);
+    reference = FrameStars();
+    haveReference = false;
+    stacked = 0;
+    lastPreview = std::chrono::steady_clock::time_point();
+
+    terminate = false;
+    running = true;
+    worker = std::thread(&LiveStacker::run, this);
+    return true;
+}
+
+void LiveStacker::stop()
+{
+    if(!running)
+        return;
+
+    {
+        std::lock_guard<std::mutex> lock(queueMutex);
+        terminate = true;
+    }
+    queueCondition.notify_all();
+    worker.join();
+    running = false;
+
+    slots.clear();
+    freeSlots.clear();
+    readySlots.clear();
+    sum.clear();
+    coverage.clear();
+    luminance.clear();
+    visited.clear();
+    blob.clear();
+    levels.clear();
+    preview.clear();
+}
+
+void LiveStacker::push(const uint8_t *frame)
+{
+    if(!running)
+        return;
+
+    int slot;
+    {
+        std::lock_guard<std::mutex> lock(queueMutex);
+        if(freeSlots.empty())
+        {
+            //The worker is behind, replace the oldest frame that is still waiting.
+            slot = readySlots.front();
+            readySlots.pop_front();
+            dropped++;
+        }
+        else
+        {
+            slot = freeSlots.front();
+            freeSlots.pop_front();
+        }
+    }
+
+    memcpy(slots[slot].data(), frame, frameBytes);
+
+    {
+        std::lock_guard<std::mutex> lock(queueMutex);
+        readySlots.push_back(slot);
+    }
+    queueCondition.notify_one();
+}
+
+void LiveStacker::flush()
+{
+    if(!running)
+        return;
+
+    std::unique_lock<std::mutex> lock(queueMutex);
+    idleCondition.wait(lock, [this]()
+    {
+        return readySlots.empty() && busySlot < 0;
+    });
+}
+
+void LiveStacker::run()
+{
+    while(true)
+    {
+        int slot;
+        {
+            std::unique_lock<std::mutex> lock(queueMutex);
+            queueCondition.wait(lock, [this]()
+            {
+                return terminate || !readySlots.empty();
+            });
+            if(terminate)
+                break;
+            slot = readySlots.front();
+            readySlots.pop_front();
+            busySlot = slot;
+        }
+
+        addFrame(slots[slot].data());
+
+        {
+            std::lock_guard<std::mutex> lock(queueMutex);
+            freeSlots.push_back(slot);
+            busySlot = -1;
+        }
+        idleCondition.notify_all();
+    }
+    idleCondition.notify_all();
+}
+
+float LiveStacker::sample(const uint8_t *frame, size_t index) const
+{
+    if(bytesPerSample == 2)
+        return reinterpret_cast<const uint16_t *>(frame)[index];
+    return frame[index];
+}
+
+//Stars are groups of connected pixels more than STAR_SIGMA standard deviations above the
+//background, placed at their brightness weighted centroid. Single pixels are skipped, they are
+//more likely hot pixels that would pull the shift towards zero. The centroid of everything above
+//the threshold is kept as well, for frames of an extended object such as the Moon or a planet.
+void LiveStacker::findStars(const uint8_t *frame, FrameStars &result)
+{
+    const size_t pixels = static_cast<size_t>(width) * height;
+    luminance.resize(pixels);
+    size_t index = 0;
+    for(size_t p = 0; p < pixels; p++)
+    {
+        double value = 0;
+        for(int c = 0; c < channels; c++)
+            value += sample(frame, index++);
+        luminance[p] = value;
+    }
+
+    //Median and median absolute deviation of a subsample, so that neither stars nor a bright
+    //object filling part of the frame raise the threshold.
+    levels.clear();
+    for(size_t p = 0; p < pixels; p += BACKGROUND_STEP)
+        levels.push_back(luminance[p]);
+    auto middle = levels.begin() + levels.size() / 2;
+    std::nth_element(levels.begin(), middle, levels.end());
+    const double background = *middle;
+    for(double &level : levels)
+        level = std::fabs(level - background);
+    std::nth_element(levels.begin(), middle, levels.end());
+    const double sigma = 1.4826 * *middle;
+    const double threshold = background + STAR_SIGMA * std::max(sigma, 1.0);
+
+    result.stars.clear();
+    visited.assign(pixels, 0);
+    double mass = 0, massX = 0, massY = 0;
+    for(size_t start = 0; start < pixels; start++)
+    {
+        if(visited[start] || luminance[start] <= threshold)
+            continue;
+
+        //Flood fill of the pixels above the threshold connected to this one.
+        Star star = {0, 0, 0};
+        size_t count = 0;
+        blob.clear();
+        blob.push_back(start);
+        visited[start] = 1;
+        while(!blob.empty())
+        {
+            const size_t p = blob.back();
+            blob.pop_back();
+            const int x = static_cast<int>(p % width);
+            const int y = static_cast<int>(p / width);
+            const double weight = luminance[p] - background;
+            star.x += weight * x;
+            star.y += weight * y;
+            star.flux += weight;
+            count++;
+
+            for(int ny = std::max(0, y - 1); ny <= std::min(height - 1, y + 1); ny++)
+                for(int nx = std::max(0, x - 1); nx <= std::min(width - 1, x + 1); nx++)
+                {
+                    const size_t neighbour = static_cast<size_t>(ny) * width + nx;
+                    if(!visited[neighbour] && luminance[neighbour] > threshold)
+                    {
+                        visited[neighbour] = 1;
+                        blob.push_back(neighbour);
+                    }
+                }
+        }
+
+        mass += star.flux;
+        massX += star.x;
+        massY += star.y;
+        if(count < STAR_MIN_PIXELS)
+            continue;
+        star.x /= star.flux;
+        star.y /= star.flux;
+        result.stars.push_back(star);
+    }
+
+    //Only the brightest stars are matched, faint ones are the most likely to be noise.
+    std::sort(result.stars.begin(), result.stars.end(), [](const Star & a, const Star & b)
+    {
+        return a.flux > b.flux;
+    });
+    if(result.stars.size() > MATCH_STARS)
+        result.stars.resize(MATCH_STARS);
+
+    result.hasCentroid = mass > 0;
+    result.centroidX = result.hasCentroid ? massX / mass : 0;
+    result.centroidY = result.hasCentroid ? massY / mass : 0;
+}
+
+//The translation is the offset between a reference star and a frame star that brings the most
+//other reference stars within MATCH_TOLERANCE of a frame star, averaged over those matches.
+//Without enough stars it falls back to the shift of the centroid of the bright pixels.
+bool LiveStacker::findShift(const FrameStars &current, double &dx, double &dy)
+{
+    const std::vector<Star> &stars = current.stars;
+    const std::vector<Star> &referenceList = reference.stars;
+    const size_t required = std::min<size_t>(MIN_MATCHES, std::min(stars.size(), referenceList.size()));
+
+    int bestVotes = 0;
+    double bestX = 0, bestY = 0;
+    if(required > 0)
+    {
+        for(const Star &r : referenceList)
+            for(const Star &c : stars)
+            {
+                const double offsetX = c.x - r.x;
+                const double offsetY = c.y - r.y;
+                if(std::fabs(offsetX) > maxShift || std::fabs(offsetY) > maxShift)
+                    continue;
+
+                int votes = 0;
+                double sumX = 0, sumY = 0;
+                for(const Star &r2 : referenceList)
+                    for(const Star &c2 : stars)
+                    {
+                        const double errorX = c2.x - r2.x - offsetX;
+                        const double errorY = c2.y - r2.y - offsetY;
+                        if(errorX * errorX + errorY * errorY <= MATCH_TOLERANCE * MATCH_TOLERANCE)
+                        {
+                            votes++;
+                            sumX += c2.x - r2.x;
+                            sumY += c2.y - r2.y;
+                            break;
+                        }
+                    }
+                if(votes > bestVotes)
+                {
+                    bestVotes = votes;
+                    bestX = sumX / votes;
+                    bestY = sumY / votes;
+                }
+            }
+    }
+
+    if(required > 0 && bestVotes >= static_cast<int>(required))
+    {
+        dx = bestX;
+        dy = bestY;
+        return true;
+    }
+
+    if(current.hasCentroid && reference.hasCentroid)
+    {
+        dx = std::max(-1.0 * maxShift, std::min(1.0 * maxShift, current.centroidX - reference.centroidX));
+        dy = std::max(-1.0 * maxShift, std::min(1.0 * maxShift, current.centroidY - reference.centroidY));
+        return true;
+    }
+    return false;
+}
+
+void LiveStacker::addFrame(const uint8_t *frame)
+{
+    int dx = 0, dy = 0;
+    if(maxShift > 0)
+    {
+        if(!haveReference)
+        {
+            findStars(frame, reference);
+            haveReference = true;
+        }
+        else
+        {
+            double shiftX = 0, shiftY = 0;
+            findStars(frame, current);
+            if(findShift(current, shiftX, shiftY))
+            {
+                //The stack is kept on the pixel grid, the shift is rounded to whole pixels.
+                dx = static_cast<int>(std::lround(shiftX));
+                dy = static_cast<int>(std::lround(shiftY));
+            }
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(stackMutex);
+
+    //Pixel (x, y) of the stack is pixel (x + dx, y + dy) of this frame.
+    int x0 = std::max(0, -dx);
+    int x1 = std::min(width, width - dx);
+    int y0 = std::max(0, -dy);
+    int y1 = std::min(height, height - dy);
+    for(int y = y0; y < y1; y++)
+    {
+        double *destination = sum.data() + (static_cast<size_t>(y) * width + x0) * channels;
+        size_t source = (static_cast<size_t>(y + dy) * width + x0 + dx) * channels;
+        size_t count = static_cast<size_t>(x1 - x0) * channels;
+        if(bytesPerSample == 1)
+        {
+            const uint8_t *in = frame + source;
+            for(size_t i = 0; i < count; i++)
+                destination[i] += in[i];
+        }
+        else
+        {
+            const uint16_t *in = reinterpret_cast<const uint16_t *>(frame) + source;
+            for(size_t i = 0; i < count; i++)
+                destination[i] += in[i];
+        }
+        uint32_t *covered = coverage.data() + static_cast<size_t>(y) * width;
+        for(int x = x0; x < x1; x++)
+            covered[x]++;
+    }
+    stacked++;
+
+    if(previewCallback)
+    {
+        auto now = std::chrono::steady_clock::now();
+        if(now - lastPreview >= std::chrono::milliseconds(previewInterval))
+        {
+            lastPreview = now;
+            preview.resize(frameBytes);
+            renderLocked(preview.data(), true);
+            previewCallback(preview.data(), preview.size());
+        }
+    }
+}
+
+void LiveStacker::render(uint8_t *destination, bool average)
+{
+    std::lock_guard<std::mutex> lock(stackMutex);
+    renderLocked(destination, average);
+}
+
+//Pixels near the edges are covered by fewer frames once frames are shifted, so integration
+//scales each pixel up to the full number of frames instead of leaving darker borders.
+void LiveStacker::renderLocked(uint8_t *destination, bool average)
+{
+    if(coverage.empty())
+        return;
+
+    const double maxValue = bytesPerSample == 2 ? 65535.0 : 255.0;
+    const size_t pixels = static_cast<size_t>(width) * height;
+    for(size_t p = 0; p < pixels; p++)
+    {
+        double scale = 0;
+        if(coverage[p] > 0)
+            scale = average ? 1.0 / coverage[p] : static_cast<double>(stacked) / coverage[p];
+        for(int c = 0; c < channels; c++)
+        {
+            size_t index = p * channels + c;
+            double value = std::min(maxValue, std::round(sum[index] * scale));
+            if(bytesPerSample == 2)
+                reinterpret_cast<uint16_t *>(destination)[index] = static_cast<uint16_t>(value);
+            else
+                destination[index] = static_cast<uint8_t>(value);
+        }
+    }
+}
+
+void LiveStacker::setPreviewCallback(std::function<void(const uint8_t *, size_t)> callback, int intervalMs)
+{
+    std::lock_guard<std::mutex> lock(stackMutex);
+    previewCallback = callback;
+    previewInterval = intervalMs;
+}
+
+int LiveStacker::stackedFrames()
+{
+    std::lock_guard<std::mutex> lock(stackMutex);
+    return stacked;
+}
+
+int LiveStacker::droppedFrames()
+{
+    std::lock_guard<std::mutex> lock(queueMutex);
+    return dropped;
+}
@@ -0,0 +1,136 @@
+/*
+INDI Webcam CCD Driver - Live Stacker
+
+Copyright (C) 2026 INDI 3rd party contributors
+
+This driver is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) any later version.
+
+This library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public
+License along with this library; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+
+*/
+
+#ifndef live_stacker_H
+#define live_stacker_H
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+//The live stacker registers and accumulates frames on its own thread so that the capture loop
+//only has to copy each frame into a queue slot. Frames are aligned to the first frame with the
+//translation that matches the most star centroids, or that moves the centroid of an extended
+//object back in place when there are not enough stars.
+//When the stacker falls behind, the oldest queued frame is dropped so the stack stays current.
+class LiveStacker
+{
+public:
+    LiveStacker();
+    ~LiveStacker();
+
+    //Starts the worker for interleaved frames with 1 or 3 channels of 1 or 2 bytes per sample.
+    //maxShift is the largest alignment shift searched in pixels, 0 stacks without alignment.
+    bool start(int width, int height, int channels, int bytesPerSample, int queueDepth, int maxShift);
+    //Stops the worker and discards the queue and the stack.
+    void stop();
+    bool isRunning() const { return running; }
+
+    //Copies a frame into the queue, dropping the oldest queued frame if the queue is full.
+    void push(const uint8_t *frame);
+    //Waits until all queued frames have been added to the stack.
+    void flush();
+    //Writes the stack in the input format, either averaged or integrated.
+    void render(uint8_t *destination, bool average);
+
+    //Called on the worker thread with the averaged stack, at most every intervalMs.
+    void setPreviewCallback(std::function<void(const uint8_t *, size_t)> callback, int intervalMs);
+
+    int stackedFrames();
+    int droppedFrames();
+    size_t frameSize() const { return frameBytes; }
+
+private:
+    void run();
+    void addFrame(const uint8_t *frame);
+    struct Star
+    {
+        double x;
+        double y;
+        double flux;
+    };
+    //The brightest stars of a frame and the centroid of all pixels above the star threshold.
+    struct FrameStars
+    {
+        std::vector<Star> stars;
+        bool hasCentroid = false;
+        double centroidX = 0;
+        double centroidY = 0;
+    };
+    void findStars(const uint8_t *frame, FrameStars &result);
+    bool findShift(const FrameStars &current, double &dx, double &dy);
+    float sample(const uint8_t *frame, size_t index) const;
+    void renderLocked(uint8_t *destination, bool average);
+
+    int width = 0;
+    int height = 0;
+    int channels = 1;
+    int bytesPerSample = 1;
+    int maxShift = 0;
+    size_t frameBytes = 0;
+
+    //Queue of frame slots, indices move between freeSlots and readySlots.
+    std::vector<std::vector<uint8_t>> slots;
+    std::deque<int> freeSlots;
+    std::deque<int> readySlots;
+    int busySlot = -1;
+    int dropped = 0;
+    std::mutex queueMutex;
+    std::condition_variable queueCondition;
+    std::condition_variable idleCondition;
+
+    //Alignment, only used on the worker thread.
+    static constexpr double STAR_SIGMA = 5;
+    static constexpr size_t STAR_MIN_PIXELS = 2;
+    static constexpr size_t BACKGROUND_STEP = 16;
+    static constexpr size_t MATCH_STARS = 20;
+    static constexpr size_t MIN_MATCHES = 3;
+    static constexpr double MATCH_TOLERANCE = 1.5;
+    FrameStars reference;
+    FrameStars current;
+    bool haveReference = false;
+    std::vector<double> luminance;
+    std::vector<uint8_t> visited;
+    std::vector<size_t> blob;
+    std::vector<double> levels;
+
+    //The stack itself, guarded by stackMutex.
+    std::vector<double> sum;
+    std::vector<uint32_t> coverage;
+    int stacked = 0;
+    std::mutex stackMutex;
+
+    std::function<void(const uint8_t *, size_t)> previewCallback;
+    int previewInterval = 0;
+    std::chrono::steady_clock::time_point lastPreview;
+    std::vector<uint8_t> preview;
+
+    std::thread worker;
+    bool running = false;
+    bool terminate = false;
+};
+
+#endif // live_stacker_H
@@ -478,6 +478,34 @@ Apg::Status Alta::GetImagingStatus()
 //////////////////////////// 
 // GET  IMAGE 
 void Alta::GetImage( std::vector<uint16_t> & out )
+{
+    uint16_t r=0, c = 0;
+    ExposureAndGetImgRC( r, c );
+    const int32_t numCols = GetRoiNumCols();
+    const size_t len = static_cast<size_t>( r ) * GetImageZ() * numCols;
+
+    if( len != out.size() )
+    {
+        out.clear();
+        out.resize( len );
+    }
+
+    DownloadImage( r, c, out.data(), out.size(), numCols );
+}
+
+//////////////////////////// 
+// GET  IMAGE 
+void Alta::GetImage( uint16_t * out, const size_t outLen, const int32_t rowStride )
+{
+    uint16_t r=0, c = 0;
+    ExposureAndGetImgRC( r, c );
+    DownloadImage( r, c, out, outLen, rowStride );
+}
+
+//////////////////////////// 
+// DOWNLOAD  IMAGE 
+void Alta::DownloadImage( const uint16_t r, const uint16_t c,
+    uint16_t * out, const size_t outLen, const int32_t rowStride )
 {
 #ifdef DEBUGGING_CAMERA
     apgHelper::DebugMsg( "Alta::GetImage -> BEGINNING" );
@@ -512,25 +540,16 @@ void Alta::GetImage( std::vector<uint16_t> & out )
         }
     }
 
-    // allocating the buffers for the image
-    // doing this outside of the try / catch, so that
-    // even if the GetImage function throws
-    // we can try to copy whatever data we managed
-    // to fetch from the camera into the user supplied
-    // vector
-    uint16_t r=0, c = 0;
-    ExposureAndGetImgRC( r, c );
+    // the scratch buffer is kept between downloads, after a failed
+    // or short read it holds stale data and is not copied out
     const uint16_t z = GetImageZ();
-    std::vector<uint16_t> datafromCam( r*c*z, 0 ); 
+    m_ImgScratch.resize( r*c*z );
+    std::vector<uint16_t> & datafromCam = m_ImgScratch;
 
     const int32_t dataLen = r*z;
-    const int32_t numCols = GetRoiNumCols();  
+    const int32_t numCols = GetRoiNumCols();
 
-    if( dataLen*numCols != apgHelper::SizeT2Int32( out.size() ) )
-    {
-        out.clear();
-        out.resize( dataLen*numCols );
-    }
+    CheckImgBuffer( outLen, rowStride, dataLen, numCols );
 
     try
     {
@@ -539,13 +558,12 @@ void Alta::GetImage( std::vector<uint16_t> & out )
     catch(std::exception & err )
     {
         m_ImageInProgress = false;
-        
-        // log and remove the AD garbage pixels at the beginning of every row
-        std::string msg( "Removing AD latency pixels in exception handler" );
+
+        // the caller's buffer is left alone, it gets no partial image
+        std::string msg( "Image download failed, no image data returned" );
         ApgLogger::Instance().Write(ApgLogger::LEVEL_RELEASE,"error",
         apgHelper::mkMsg( m_fileName, msg, __LINE__) );
 
-        FixImgFromCamera( datafromCam, out, dataLen, numCols );
         throw;
     }
     
@@ -580,7 +598,7 @@ void Alta::GetImage( std::vector<uint16_t> & out )
 #endif
 
     // removing the AD garbage pixels at the beginning of every row
-    FixImgFromCamera( datafromCam, out, dataLen, numCols );
+    FixImgFromCamera( datafromCam, out, rowStride, dataLen, numCols );
   
     ApgLogger::Instance().Write(ApgLogger::LEVEL_DEBUG,"info","Get Image Completed.");
 
@@ -955,11 +973,11 @@ Apg::FanMode Alta::GetFanMode()
 //////////////////////////// 
 //      FIX      IMG        FROM          CAMERA
 void Alta::FixImgFromCamera( const std::vector<uint16_t> & data,
-                              std::vector<uint16_t> & out,  const int32_t rows, 
+                              uint16_t * out, const int32_t outStride, const int32_t rows, 
                               const int32_t cols )
 {
     const int32_t offset = m_CcdAcqSettings->GetPixelShift();
-    ImgFix::SingleOuputCopy( data, out, rows, cols, offset );
+    ImgFix::SingleOuputCopy( data, out, outStride, rows, cols, offset );
 }
 
 //////////////////////////// 
@@ -40,6 +40,7 @@ class DLL_EXPORT Alta : public ApogeeCam
         Apg::Status GetImagingStatus();
       
         void GetImage( std::vector<uint16_t> & out );
+        void GetImage( uint16_t * out, size_t outLen, int32_t rowStride );
 
         void StopExposure( bool Digitize );
 
@@ -199,6 +200,8 @@ class DLL_EXPORT Alta : public ApogeeCam
              const std::string & DeviceAddr);
 
         void ExposureAndGetImgRC(uint16_t & r, uint16_t & c);
+        void DownloadImage( uint16_t r, uint16_t c,
+            uint16_t * out, size_t outLen, int32_t rowStride );
         uint16_t ExposureZ();
         uint16_t GetImageZ();
         uint16_t GetIlluminationMask();
@@ -206,7 +209,7 @@ class DLL_EXPORT Alta : public ApogeeCam
             const std::string & DeviceAddr);
 
         void FixImgFromCamera( const std::vector<uint16_t> & data,
-            std::vector<uint16_t> & out,  int32_t rows, int32_t cols);
+            uint16_t * out, int32_t outStride, int32_t rows, int32_t cols);
 
     private:
         
@@ -105,7 +105,8 @@ namespace
 //////////////////////////// 
 // CTOR 
 AltaEthernetIo::AltaEthernetIo( const std::string url ) : m_url( url ),
-                                                          m_fileName( __BASE_FILE__ )
+                                                          m_fileName( __BASE_FILE__ ),
+                                                          m_libcurl( new CLibCurlWrap )
 
 { 
     //open a session with the camera
@@ -133,10 +134,8 @@ void AltaEthernetIo::OpenSession()
 {
     const std::string fullUrl = m_url + "/SESSION?Open";
 
-    CLibCurlWrap theCurl;
-
     std::string result;
-    theCurl.HttpGet( fullUrl, result );
+    m_libcurl->HttpGet( fullUrl, result );
 
      if( std::string::npos == result.find("SessionId=") )
     {
@@ -157,10 +156,8 @@ void AltaEthernetIo::CloseSession()
 {
     const std::string fullUrl = m_url + "/SESSION?Close";
 
-    CLibCurlWrap theCurl;
-
     std::string result;
-    theCurl.HttpGet( fullUrl, result );
+    m_libcurl->HttpGet( fullUrl, result );
 
      if( std::string::npos == result.find("SessionId=") )
     {
@@ -184,9 +181,8 @@ uint16_t AltaEthernetIo::ReadReg( uint16_t reg ) const
 
     const std::string finalUrl = m_url + "/FPGA?RR="+ help::uShort2Str( reg );
         
-    CLibCurlWrap theCurl;
     std::string result;
-    theCurl.HttpGet( finalUrl, result );
+    m_libcurl->HttpGet( finalUrl, result );
 
     std::vector<std::string> tokens = help::MakeTokens(result,"=");
 
@@ -228,9 +224,8 @@ std::map<uint16_t,uint16_t> AltaEthernetIo::ReadRegs(const std::vector<uint16_t>
          if( MAX_READS_PER_URL-1 == count )
         {
             //send the max data
-            CLibCurlWrap theCurl;
             std::string result;
-            theCurl.HttpGet( finalUrl, result );
+            m_libcurl->HttpGet( finalUrl, result );
             finalResult.append( result );
 
             //reset
@@ -248,9 +243,8 @@ std::map<uint16_t,uint16_t> AltaEthernetIo::ReadRegs(const std::vector<uint16_t>
     if( count )
     {
         //send the cmd
-        CLibCurlWrap theCurl;
         std::string result;
-        theCurl.HttpGet( finalUrl, result );
+        m_libcurl->HttpGet( finalUrl, result );
         finalResult.append( result );
     }
 
@@ -299,10 +293,8 @@ void AltaEthernetIo::WriteReg( uint16_t reg, uint16_t val )
     std::string fullUrl = m_url + "/FPGA?WR=" +
         help::uShort2Str(reg) + "&WD=" + help::uShort2Str(val, true);
 
-    CLibCurlWrap theCurl;
-
     std::string result;
-    theCurl.HttpGet( fullUrl, result );
+    m_libcurl->HttpGet( fullUrl, result );
 
 }
 
@@ -322,20 +314,19 @@ void AltaEthernetIo::WriteMRMD(const uint16_t reg, const std::vector<uint16_t> &
 // GET  IMAGE   DATA
 void AltaEthernetIo::GetImageData(std::vector<uint16_t> & ImageData)
 {
-    const int32_t NumBytesExpected = 
-        apgHelper::SizeT2Int32( ImageData.size() )*sizeof(uint16_t);
+    const size_t NumBytesExpected = ImageData.size()*sizeof(uint16_t);
 
-    //grab the data
+    //grab the data, the camera sends big endian samples that are
+    //swapped into ImageData as they arrive
     std::string fullUrl = m_url + "/UE/image.bin";
 
-    CLibCurlWrap theCurl;
-    std::string result;
-    theCurl.HttpGet( fullUrl, result );
+    const size_t NumBytesReceived = m_libcurl->HttpGet( fullUrl, 
+        ImageData.data(), ImageData.size() );
 
-    if( NumBytesExpected !=  apgHelper::SizeT2Int32( result.size() ) )
+    if( NumBytesExpected != NumBytesReceived )
     {
         std::stringstream received;
-        received <<  result.size();
+        received <<  NumBytesReceived;
 
         std::stringstream requested;
         requested << NumBytesExpected;
@@ -345,22 +336,6 @@ void AltaEthernetIo::GetImageData(std::vector<uint16_t> & ImageData)
         apgHelper::throwRuntimeException( m_fileName, errMsg, 
             __LINE__, Apg::ErrorType_Critical );
     }
-    
-    std::string::iterator strIter;
-    std::string::iterator strIterNext;
-    std::vector<uint16_t>::iterator dataIter;
-    int32_t i=0;
-
-    for(strIter = result.begin(); strIter != result.end(); strIter+=2, ++i)
-    {
-        strIterNext = strIter+1;
-        uint8_t a = (*strIter);
-        uint8_t b = (*strIterNext);
-
-        //TODO verify this works on mac...
-        uint16_t v = ((a << 8) | b);
-        ImageData.at(i) = v;
-    }
 }
 
 //////////////////////////// 
@@ -386,10 +361,8 @@ void AltaEthernetIo::SetupImgXfer(const uint16_t Rows,
     const std::string fullUrl = m_url + "/FPGA?CI=0,0," + help::uShort2Str(Cols)
         + "," + rolled.str() + ",0xFFFFFFFF"; 
 
-    CLibCurlWrap theCurl;
-
     std::string result;
-    theCurl.HttpGet( fullUrl, result );
+    m_libcurl->HttpGet( fullUrl, result );
 
 }
 
@@ -472,13 +445,11 @@ void AltaEthernetIo::GetMacAddress( std::string & Mac )
    
     const std::string fullUrl = m_url + "/NVRAM?Tag=10&Length=6&Get";
 
-    CLibCurlWrap theCurl;
-
     std::string result;
-    theCurl.HttpGet( fullUrl, result );
+    m_libcurl->HttpGet( fullUrl, result );
 
     const std::string dataUrl = m_url + "/UE/nvram.bin";
-    theCurl.HttpGet( dataUrl, Mac );
+    m_libcurl->HttpGet( dataUrl, Mac );
 
 }
 
@@ -488,10 +459,8 @@ void AltaEthernetIo::Reboot()
 {
     const std::string fullUrl = m_url + "/REBOOT?Submit=Reboot";
 
-    CLibCurlWrap theCurl;
-
     std::string result;
-    theCurl.HttpGet( fullUrl, result );
+    m_libcurl->HttpGet( fullUrl, result );
 
 }
 
@@ -513,9 +482,8 @@ void AltaEthernetIo::WriteSRMD(const uint16_t reg, const std::vector<uint16_t> &
         if( MAX_WRITES_PER_URL-1 == count )
         {
             //send the max data
-            CLibCurlWrap theCurl;
             std::string result;
-            theCurl.HttpGet( fullUrl, result );
+            m_libcurl->HttpGet( fullUrl, result );
 
             //reset
             count = 0;
@@ -530,9 +498,8 @@ void AltaEthernetIo::WriteSRMD(const uint16_t reg, const std::vector<uint16_t> &
     //send any remaining data
     if( count )
     {
-        CLibCurlWrap theCurl;
         std::string result;
-        theCurl.HttpGet( fullUrl, result );
+        m_libcurl->HttpGet( fullUrl, result );
     }
 }
 
@@ -552,8 +519,7 @@ std::string AltaEthernetIo::GetNetworkSettings()
 //      GET    DRIVER   VERSION
 std::string AltaEthernetIo::GetDriverVersion()
 {
-    CLibCurlWrap theCurl;
-    return theCurl.GetVerison();
+    return m_libcurl->GetVerison();
 }
         
 //////////////////////////// 
@@ -583,10 +549,8 @@ void AltaEthernetIo::SetSerialBaudRate( const uint16_t PortId , const uint32_t B
      std::string fullUrl = m_url + "/SERCFG?SetBitRate=" +
         GetPortStr( PortId ) + "," + uint32ToStr( BaudRate );
 
-    CLibCurlWrap theCurl;
-
     std::string result;
-    theCurl.HttpGet( fullUrl, result );
+    m_libcurl->HttpGet( fullUrl, result );
 }
 
 //////////////////////////// 
@@ -595,9 +559,8 @@ uint32_t AltaEthernetIo::GetSerialBaudRate(  const uint16_t PortId  )
 {
     const std::string finalUrl = m_url + "/SERCFG?GetBitRate="+ GetPortStr( PortId );
         
-    CLibCurlWrap theCurl;
     std::string result;
-    theCurl.HttpGet( finalUrl, result );
+    m_libcurl->HttpGet( finalUrl, result );
 
     std::vector<std::string> tokens = help::MakeTokens(result,",");
 
@@ -615,9 +578,8 @@ Apg::SerialFC AltaEthernetIo::GetSerialFlowControl( uint16_t PortId )
 {
     const std::string finalUrl = m_url + "/SERCFG?GetFlowControl="+ GetPortStr( PortId );
         
-    CLibCurlWrap theCurl;
     std::string result;
-    theCurl.HttpGet( finalUrl, result );
+    m_libcurl->HttpGet( finalUrl, result );
 
     std::vector<std::string> tokens = help::MakeTokens(result,",");
 
@@ -665,10 +627,8 @@ void AltaEthernetIo::SetSerialFlowControl( uint16_t PortId,
     const std::string fullUrl = m_url + "/SERCFG?SetFlowControl="+ GetPortStr( PortId ) +
         "," + cflowStr;
 
-    CLibCurlWrap theCurl;
-
     std::string result;
-    theCurl.HttpGet( fullUrl, result );
+    m_libcurl->HttpGet( fullUrl, result );
 
 }
 
@@ -678,9 +638,8 @@ Apg::SerialParity AltaEthernetIo::GetSerialParity( uint16_t PortId )
 {
     const std::string finalUrl = m_url + "/SERCFG?GetParityBits="+ GetPortStr( PortId );
         
-    CLibCurlWrap theCurl;
     std::string result;
-    theCurl.HttpGet( finalUrl, result );
+    m_libcurl->HttpGet( finalUrl, result );
 
     std::vector<std::string> tokens = help::MakeTokens(result,",");
     
@@ -737,10 +696,8 @@ void AltaEthernetIo::SetSerialParity( uint16_t PortId,
     const std::string fullUrl = m_url + "/SERCFG?SetParityBits="+ GetPortStr( PortId ) +
         "," + parityStr;
 
-    CLibCurlWrap theCurl;
-
     std::string result;
-    theCurl.HttpGet( fullUrl, result );
+    m_libcurl->HttpGet( fullUrl, result );
 
 }
 
@@ -3234,6 +3234,32 @@ Apg::FanMode ApogeeCam::DefaultGetFanMode()
     return Apg::FanMode_Off;
 }
 
+//////////////////////////// 
+//      CHECK      IMG        BUFFER
+void ApogeeCam::CheckImgBuffer( const size_t outLen, const int32_t rowStride,
+                                const int32_t rows, const int32_t cols )
+{
+    if( rowStride < cols )
+    {
+        std::stringstream msg;
+        msg << "Invalid row stride " << rowStride << " for " << cols << " columns";
+        apgHelper::throwRuntimeException( m_fileName, msg.str(), 
+            __LINE__, Apg::ErrorType_InvalidUsage );
+    }
+
+    // the last row does not need the padding of the stride
+    const size_t needed = rows > 0 ?
+        static_cast<size_t>( rows - 1 ) * rowStride + cols : 0;
+
+    if( outLen < needed )
+    {
+        std::stringstream msg;
+        msg << "Image buffer too small, " << outLen << " pixels for " << needed;
+        apgHelper::throwRuntimeException( m_fileName, msg.str(), 
+            __LINE__, Apg::ErrorType_InvalidUsage );
+    }
+}
+
 
 CamInfo::StrDb ApogeeCam::ReadStrDatabase()
 { 
@@ -1166,6 +1166,20 @@ class DLL_EXPORT ApogeeCam
          */
         virtual void GetImage( std::vector<uint16_t> & out ) = 0;
 
+        /*! 
+         * Downloads the image data from the camera into a caller supplied buffer,
+         * without an intermediate copy.  The buffer receives GetRoiNumRows() rows
+         * of GetRoiNumCols() pixels for every image of the download (one row in
+         * TDI mode, GetImageCount() images in bulk download mode).
+         * \param [out] out Buffer that will recieve the image data
+         * \param [in] outLen Size of out in pixels
+         * \param [in] rowStride Distance between the start of two rows of out in
+         * pixels, must be at least GetRoiNumCols()
+         * \exception std::runtime_error, also when the camera sends less data than
+         * expected.  out is then left unchanged.
+         */
+        virtual void GetImage( uint16_t * out, size_t outLen, int32_t rowStride ) = 0;
+
         /*! 
          * This method halts an in progress exposure. If this method is called 
          * and there is no exposure in progress a std::runtime_error exception is thrown.
@@ -1276,6 +1290,7 @@ class DLL_EXPORT ApogeeCam
         void DefaultSetFanMode( Apg::FanMode mode, bool PreCondCheck );
         Apg::FanMode DefaultGetFanMode();
         void DefaultCloseConnection();
+        void CheckImgBuffer( size_t outLen, int32_t rowStride, int32_t rows, int32_t cols );
 
          // ****** PURE VIRTUAL INTERFACE ********
         virtual void CfgCamFromId( uint16_t CameraId ) = 0;
@@ -1284,7 +1299,7 @@ class DLL_EXPORT ApogeeCam
         virtual uint16_t GetImageZ() = 0;
         virtual uint16_t GetIlluminationMask() = 0;
         virtual void FixImgFromCamera( const std::vector<uint16_t> & data,
-            std::vector<uint16_t> & out,  int32_t rows, int32_t cols) = 0;
+            uint16_t * out, int32_t outStride, int32_t rows, int32_t cols) = 0;
                 
 //this code removes vc++ compiler warning C4251
 //from http://www.unknownroad.com/rtfm/VisualStudio/warningC4251.html
@@ -1316,6 +1331,10 @@ class DLL_EXPORT ApogeeCam
         bool m_IsInitialized;
         bool m_IsConnected;
 		double m_LastExposureTime;
+
+        // camera data before the latency pixels are removed, kept between
+        // downloads so that it is only allocated when the image size grows
+        std::vector<uint16_t> m_ImgScratch;
      
     private:
 
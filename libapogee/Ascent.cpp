@@ -476,7 +476,7 @@ void Ascent::VerifyCamId()
 //////////////////////////// 
 //      FIX      IMG        FROM          CAMERA
 void Ascent::FixImgFromCamera( const std::vector<uint16_t> & data,
-                              std::vector<uint16_t> & out,  const int32_t rows, 
+                              uint16_t * out, const int32_t outStride, const int32_t rows, 
                               const int32_t cols )
 {
     int32_t offset = 0; 
@@ -485,12 +485,12 @@ void Ascent::FixImgFromCamera( const std::vector<uint16_t> & data,
     {
         case 1:
             offset = m_CcdAcqSettings->GetPixelShift();
-            ImgFix::SingleOuputCopy( data, out, rows, cols, offset );
+            ImgFix::SingleOuputCopy( data, out, outStride, rows, cols, offset );
         break;
 
         case 2:
             offset = m_CcdAcqSettings->GetPixelShift() * 2;
-            ImgFix::DualOuputFix( data, out, rows, cols, offset );
+            ImgFix::DualOuputFix( data, out, outStride, rows, cols, offset );
         break;
 
         default:
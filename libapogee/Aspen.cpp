@@ -230,7 +230,7 @@ void Aspen::UpdateCfgWithStrDbInfo()
 //////////////////////////// 
 //      FIX      IMG        FROM          CAMERA
 void Aspen::FixImgFromCamera( const std::vector<uint16_t> & data,
-                           std::vector<uint16_t> & out,  const int32_t rows, 
+                           uint16_t * out, const int32_t outStride, const int32_t rows, 
                            const int32_t cols )
 {
      int32_t offset = 0; 
@@ -239,12 +239,12 @@ void Aspen::FixImgFromCamera( const std::vector<uint16_t> & data,
     {
         case 1:
             offset = m_CcdAcqSettings->GetPixelShift();
-            ImgFix::SingleOuputCopy( data, out, rows, cols, offset );
+            ImgFix::SingleOuputCopy( data, out, outStride, rows, cols, offset );
         break;
 
         case 2:
             offset = m_CcdAcqSettings->GetPixelShift() * 2;
-            ImgFix::DualOuputFix( data, out, rows, cols, offset );
+            ImgFix::DualOuputFix( data, out, outStride, rows, cols, offset );
         break;
 
         default:
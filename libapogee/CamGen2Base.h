@@ -25,6 +25,7 @@ class DLL_EXPORT CamGen2Base  : public ApogeeCam
         Apg::Status GetImagingStatus();
 
         void GetImage( std::vector<uint16_t> & out );
+        void GetImage( uint16_t * out, size_t outLen, int32_t rowStride );
 
         void StopExposure( bool Digitize );
 
@@ -47,6 +48,9 @@ class DLL_EXPORT CamGen2Base  : public ApogeeCam
 
         uint16_t GetImageZ();
 
+        void DownloadImage( uint16_t r, uint16_t c,
+            uint16_t * out, size_t outLen, int32_t rowStride );
+
         uint16_t GetIlluminationMask();
 
         void DefaultStartExposure( double Duration, bool IsLight, bool IssueReset=true );
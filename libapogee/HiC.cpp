@@ -95,6 +95,16 @@ void HiC::Get4kby4kImage( std::vector<uint16_t> & out )
 
     const int32_t dataLen = GetRoiNumRows()*z;
     const int32_t numCols = GetRoiNumCols();
+
+    // sized before the download, so that the exception handler has
+    // somewhere to put the data
+    const uint16_t HIC_ROWS = 4096;
+    const uint16_t HIC_COLS = 4096;
+    if( HIC_ROWS*HIC_COLS != out.size() )
+    {
+        out.clear();
+        out.resize( HIC_ROWS*HIC_COLS );
+    }
     
     try
     {
@@ -108,7 +118,7 @@ void HiC::Get4kby4kImage( std::vector<uint16_t> & out )
         ApgLogger::Instance().Write(ApgLogger::LEVEL_RELEASE,"error",
         apgHelper::mkMsg( m_fileName, msg, __LINE__) );
 
-        FixImgFromCamera( datafromCam, out, dataLen, numCols );
+        FixImgFromCamera( datafromCam, out.data(), numCols, dataLen, numCols );
         throw;
     }
         
@@ -123,15 +133,6 @@ void HiC::Get4kby4kImage( std::vector<uint16_t> & out )
         m_ImageInProgress = false;
     }
     
-    // at a minimum removing the AD garbage pixels at the end of every row
-    const uint16_t HIC_ROWS = 4096;
-    const uint16_t HIC_COLS = 4096;
-    if( HIC_ROWS*HIC_COLS != out.size() )
-    {
-        out.clear();
-        out.resize( HIC_ROWS*HIC_COLS );
-    }
-
     // first see if the buffer from the camera is a good size
     // and the number of columns is good.  if either of these conditions
     // fail then just get as much data out as you can and then throw
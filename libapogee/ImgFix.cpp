@@ -32,17 +32,23 @@ void ImgFix::SingleOuputCopy( const std::vector<uint16_t> & data,
       std::vector<uint16_t> & out, const int32_t rows,  const int32_t numImgCols,  
       const int32_t numLatencyPixels )
 {
+    SingleOuputCopy( data, out.data(), numImgCols, rows, numImgCols, numLatencyPixels );
+}
+
+//////////////////////////// 
+//      SINGLE       OUPUT       COPY
+void ImgFix::SingleOuputCopy( const std::vector<uint16_t> & data, 
+      uint16_t * out, const int32_t outStride, const int32_t rows,
+      const int32_t numImgCols, const int32_t numLatencyPixels )
+{
 
     // in testing found that this function is much faster than the erase function
     const int32_t actNumCols = numImgCols + numLatencyPixels;
 
-    for(int32_t r = 0, actColsOffset=numLatencyPixels, outColsOffset=0; r < rows;
-		    actColsOffset += actNumCols, outColsOffset += numImgCols, ++r)
+    const uint16_t * in = data.data() + numLatencyPixels;
+    for(int32_t r = 0; r < rows; in += actNumCols, out += outStride, ++r)
     {
-        std::vector<uint16_t>::const_iterator start = data.begin()+actColsOffset;
-        std::vector<uint16_t>::const_iterator end = start + numImgCols;
-        std::vector<uint16_t>::iterator outStart = out.begin() + outColsOffset;
-        std::copy( start, end, outStart );
+        std::copy( in, in + numImgCols, out );
     }
 }
 
@@ -82,6 +88,16 @@ void ImgFix::QuadOuputFix( const std::vector<uint16_t> & data,
                                              std::vector<uint16_t> & out,
                                              const int32_t rows,  const int32_t cols,
                                              const int32_t numLatencyPixels)
+{
+    QuadOuputFix( data, out.data(), cols, rows, cols, numLatencyPixels );
+}
+
+//////////////////////////// 
+//      QUAD       OUPUT       FIX
+void ImgFix::QuadOuputFix( const std::vector<uint16_t> & data, 
+                                             uint16_t * out, const int32_t outStride,
+                                             const int32_t rows,  const int32_t cols,
+                                             const int32_t numLatencyPixels)
 {
     const int32_t HALF_COLS = cols / 2;
     const int32_t HALF_ROWS = rows / 2;
@@ -90,8 +106,8 @@ void ImgFix::QuadOuputFix( const std::vector<uint16_t> & data,
   
     for( int32_t r=0; r < HALF_ROWS; ++r )
     {
-        int32_t topOffset = cols*r;
-        int32_t bottomOffset = (cols*(rows-(r+1)));
+        int32_t topOffset = outStride*r;
+        int32_t bottomOffset = (outStride*(rows-(r+1)));
 
         for( int32_t c=0; c < HALF_COLS; ++c)
         {
@@ -125,6 +141,16 @@ void ImgFix::DualOuputFix( const std::vector<uint16_t> & data,
                                              const int32_t rows,  const int32_t cols,
                                              const int32_t numLatencyPixels)
 {
+    DualOuputFix( data, out.data(), cols, rows, cols, numLatencyPixels );
+}
+
+//////////////////////////// 
+//      DUAL       OUPUT       FIX
+void ImgFix::DualOuputFix( const std::vector<uint16_t> & data, 
+                                             uint16_t * out, const int32_t outStride,
+                                             const int32_t rows,  const int32_t cols,
+                                             const int32_t numLatencyPixels)
+{
    
     const int32_t HALF_COLS = cols / 2;
 
@@ -136,7 +162,7 @@ void ImgFix::DualOuputFix( const std::vector<uint16_t> & data,
   
     for( int32_t r=0; r < rows; ++r )
     {
-        int32_t topOffset = cols*r;
+        int32_t topOffset = outStride*r;
 
         for( int32_t c=0; c < HALF_COLS; ++c)
         {
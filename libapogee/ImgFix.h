@@ -38,6 +38,23 @@ namespace ImgFix
                                      std::vector<uint16_t> & out,
                                      const int32_t rows,  const int32_t cols,
                                      const int32_t numLatencyPixels );
+
+    // the same operations writing into a caller supplied buffer, where
+    // outStride is the distance between the start of two rows of out
+    // in pixels
+    void SingleOuputCopy( const std::vector<uint16_t> & data,   
+        uint16_t * out, int32_t outStride, int32_t rows, int32_t numImgCols,  
+        int32_t numLatencyPixels );
+
+    void QuadOuputFix( const std::vector<uint16_t> & data, 
+                                     uint16_t * out, int32_t outStride,
+                                     const int32_t rows,  const int32_t cols,
+                                     const int32_t numLatencyPixels );
+
+    void DualOuputFix( const std::vector<uint16_t> & data, 
+                                     uint16_t * out, int32_t outStride,
+                                     const int32_t rows,  const int32_t cols,
+                                     const int32_t numLatencyPixels );
 }; 
 
 #endif
@@ -22,6 +22,7 @@
 #include "indimacros.h"
 
 #include <sstream>
+#include <algorithm>
 
 //////////////////////////// 
 // CTOR 
@@ -201,7 +202,7 @@ void Quad::VerifyCamId()
 //////////////////////////// 
 //      FIX      IMG        FROM          CAMERA
 void Quad::FixImgFromCamera( const std::vector<uint16_t> & data,
-                                            std::vector<uint16_t> & out,  const int32_t rows, 
+                                            uint16_t * out, const int32_t outStride, const int32_t rows, 
                                             const int32_t cols)
 {
     int32_t offset = 0; 
@@ -210,7 +211,7 @@ void Quad::FixImgFromCamera( const std::vector<uint16_t> & data,
     {
         case 1:
             offset = m_CcdAcqSettings->GetPixelShift();
-            ImgFix::SingleOuputCopy( data, out, rows, cols, offset );
+            ImgFix::SingleOuputCopy( data, out, outStride, rows, cols, offset );
         break;
 
         case 4:
@@ -220,11 +221,19 @@ void Quad::FixImgFromCamera( const std::vector<uint16_t> & data,
             offset = c - cols;
             if( m_DoPixelReorder )
             {
-                ImgFix::QuadOuputFix( data, out, rows, cols, offset );
+                ImgFix::QuadOuputFix( data, out, outStride, rows, cols, offset );
             }
             else
             {
-                ImgFix::QuadOuputCopy( data, out, rows, cols, offset );
+                // the un-reordered data is not organized in rows, so
+                // it can only be copied as a whole
+                std::vector<uint16_t> temp( rows*cols );
+                ImgFix::QuadOuputCopy( data, temp, rows, cols, offset );
+                for( int32_t r=0; r < rows; ++r )
+                {
+                    std::copy( temp.begin() + r*cols, temp.begin() + (r+1)*cols,
+                        out + r*outStride );
+                }
             }
         }
         break;
@@ -14,34 +14,77 @@
 
 #include "apgHelper.h" 
 
-//////////////////////////// 
-// Write any errors in here  
-static char errorBuffer[CURL_ERROR_SIZE];  
-
 //////////////////////////// 
 // VECT WRITER
-static std::vector<uint8_t> bufferVect;  
-static int32_t vectWriter(uint8_t *data, size_t size, size_t nmemb,  
-                  std::vector<uint8_t> &bufferVect) 
+static size_t vectWriter(uint8_t *data, size_t size, size_t nmemb,  
+                  std::vector<uint8_t> *bufferVect) 
 {
-	const int32_t numBytes = apgHelper::SizeT2Int32(size) * apgHelper::SizeT2Int32(nmemb);
-	bufferVect.insert( bufferVect.end(), &data[0], &data[numBytes] );
+	const size_t numBytes = size * nmemb;
+	bufferVect->insert( bufferVect->end(), &data[0], &data[numBytes] );
 	return numBytes;
 }
  
 //////////////////////////// 
 // STR WRITER
 // This is the writer call back function used by curl  
-static std::string bufferStr; 
-static int32_t strWriter(char *data, size_t size, size_t nmemb,  
-                  std::string &bufferStr) 
+static size_t strWriter(char *data, size_t size, size_t nmemb,  
+                  std::string *bufferStr) 
 {
  
     const size_t numBytes = size * nmemb;
 
-    bufferStr.append( data, numBytes );
+    bufferStr->append( data, numBytes );
 
-    return apgHelper::SizeT2Int32( numBytes );
+    return numBytes;
+}
+
+//////////////////////////// 
+// SWAP WRITER
+// Big endian samples can be split across chunks, so the high byte
+// of a split sample is carried over to the next call
+namespace
+{
+    struct SwapSink
+    {
+        uint16_t * data;
+        size_t numSamples;
+        size_t received;
+        uint8_t carry;
+    };
+}
+
+static size_t swapWriter(uint8_t *data, size_t size, size_t nmemb,  
+                  SwapSink *sink) 
+{
+    const size_t numBytes = size * nmemb;
+    size_t i = 0;
+
+    if( (sink->received & 1) && numBytes )
+    {
+        const size_t sample = sink->received / 2;
+        if( sample < sink->numSamples )
+        {
+            sink->data[sample] = static_cast<uint16_t>( (sink->carry << 8) | data[0] );
+        }
+        i = 1;
+    }
+
+    size_t sample = (sink->received + i) / 2;
+    for( ; i + 1 < numBytes; i += 2, ++sample )
+    {
+        if( sample < sink->numSamples )
+        {
+            sink->data[sample] = static_cast<uint16_t>( (data[i] << 8) | data[i+1] );
+        }
+    }
+
+    if( i < numBytes )
+    {
+        sink->carry = data[i];
+    }
+
+    sink->received += numBytes;
+    return numBytes;
 }
 
 //////////////////////////// 
@@ -58,12 +101,18 @@ CLibCurlWrap::CLibCurlWrap() : m_curlHandle( 0 ),
 { 
     m_curlHandle = curl_easy_init();
 	m_timeout = OPERATION_TIMEOUT;
+    m_errorBuffer[0] = 0;
     if( !m_curlHandle )
     {
         std::string errStr("curl_easy_init failed");
          apgHelper::throwRuntimeException( m_fileName, 
              errStr, __LINE__, Apg::ErrorType_Connection );
     }
+
+    // these do not change between requests
+    curl_easy_setopt(m_curlHandle, CURLOPT_ERRORBUFFER, m_errorBuffer);
+    curl_easy_setopt(m_curlHandle, CURLOPT_NOSIGNAL, 1L);
+    curl_easy_setopt(m_curlHandle, CURLOPT_TCP_KEEPALIVE, 1L);
 } 
 
 //////////////////////////// 
@@ -80,8 +129,9 @@ CLibCurlWrap::~CLibCurlWrap()
 void CLibCurlWrap::HttpGet(const std::string & url,
                             std::string & result)
 {
-    CurlSetupStrWrite ( url );
-    result = ExecuteStr();
+    std::lock_guard<std::mutex> lock( m_mutex );
+    CurlSetupStrWrite ( url, result );
+    Execute();
 }
 
 //////////////////////////// 
@@ -89,8 +139,25 @@ void CLibCurlWrap::HttpGet(const std::string & url,
 void CLibCurlWrap::HttpGet(const std::string & url,
             std::vector<uint8_t> & result)
 {
+    std::lock_guard<std::mutex> lock( m_mutex );
     CurlSetupVectWrite ( url, result );
-    ExecuteVect( result );
+    Execute();
+}
+
+//////////////////////////// 
+// HTTP GET 
+size_t CLibCurlWrap::HttpGet(const std::string & url,
+            uint16_t * data, const size_t numSamples)
+{
+    std::lock_guard<std::mutex> lock( m_mutex );
+
+    SwapSink sink = { data, numSamples, 0, 0 };
+    CurlSetup( url );
+    curl_easy_setopt(m_curlHandle, CURLOPT_WRITEFUNCTION, swapWriter);  
+    curl_easy_setopt(m_curlHandle, CURLOPT_WRITEDATA, &sink); 
+    Execute();
+
+    return sink.received;
 }
 
 //////////////////////////// 
@@ -99,10 +166,11 @@ void CLibCurlWrap::HttpPost(const std::string & url,
                             const std::string & postFields,
                             std::string & result)
 {
-    CurlSetupStrWrite ( url );
+    std::lock_guard<std::mutex> lock( m_mutex );
+    CurlSetupStrWrite ( url, result );
     curl_easy_setopt(m_curlHandle, CURLOPT_POSTFIELDS, postFields.c_str());
 
-    result = ExecuteStr();
+    Execute();
 }
 
 //////////////////////////// 
@@ -111,77 +179,61 @@ void CLibCurlWrap::HttpPost(const std::string & url,
             const std::string & postFields, 
             std::vector<uint8_t> & result)
 {
+    std::lock_guard<std::mutex> lock( m_mutex );
     CurlSetupVectWrite ( url, result );
     curl_easy_setopt(m_curlHandle, CURLOPT_POSTFIELDS, postFields.c_str());
 
-    ExecuteVect( result );
+    Execute();
 }
 
 
 //////////////////////////// 
-// CURL     SETUP  STR  WRITE
-void CLibCurlWrap::CurlSetupStrWrite(const std::string & url)
+// CURL     SETUP
+void CLibCurlWrap::CurlSetup(const std::string & url)
 {
-     // Now set up all of the curl options  
-    curl_easy_setopt(m_curlHandle, CURLOPT_ERRORBUFFER, errorBuffer);  
+     // Now set up all of the curl options, the handle is reused so
+     // a previous post has to be undone
+    curl_easy_setopt(m_curlHandle, CURLOPT_HTTPGET, 1L);
     curl_easy_setopt(m_curlHandle, CURLOPT_URL, url.c_str());  
-    curl_easy_setopt(m_curlHandle, CURLOPT_WRITEFUNCTION, strWriter);  
-    curl_easy_setopt(m_curlHandle, CURLOPT_WRITEDATA, &bufferStr); 
-    curl_easy_setopt(m_curlHandle, CURLOPT_TIMEOUT, m_timeout);
-    
+    curl_easy_setopt(m_curlHandle, CURLOPT_TIMEOUT, static_cast<long>(m_timeout));
 }
 
 //////////////////////////// 
-// CURL     SETUP       VECTOR          WRITE
-void CLibCurlWrap::CurlSetupVectWrite(const std::string & url, const std::vector<uint8_t> & result)
+// CURL     SETUP  STR  WRITE
+void CLibCurlWrap::CurlSetupStrWrite(const std::string & url, std::string & result)
 {
-     // Now set up all of the curl options  
-    curl_easy_setopt(m_curlHandle, CURLOPT_ERRORBUFFER, errorBuffer);  
-    curl_easy_setopt(m_curlHandle, CURLOPT_URL, url.c_str());  
-    curl_easy_setopt(m_curlHandle, CURLOPT_WRITEFUNCTION, vectWriter);  
+    result.clear();
+    CurlSetup( url );
+    curl_easy_setopt(m_curlHandle, CURLOPT_WRITEFUNCTION, strWriter);  
     curl_easy_setopt(m_curlHandle, CURLOPT_WRITEDATA, &result); 
-    curl_easy_setopt(m_curlHandle, CURLOPT_TIMEOUT, m_timeout);
 }
 
 //////////////////////////// 
-// EXECUTE  STR
-std::string CLibCurlWrap::ExecuteStr()
+// CURL     SETUP       VECTOR          WRITE
+void CLibCurlWrap::CurlSetupVectWrite(const std::string & url, std::vector<uint8_t> & result)
 {
-    //clear out the string
-    bufferStr.clear();
-
-    //perform the transfer
-    const CURLcode result = curl_easy_perform(m_curlHandle);
-
-    if( CURLE_OK != result )
-    {
-        std::string curlError( errorBuffer );
-
-        apgHelper::throwRuntimeException( m_fileName, curlError, 
-            __LINE__, Apg::ErrorType_Critical );
-    }
-
-    return bufferStr;
+    result.clear();
+    CurlSetup( url );
+    curl_easy_setopt(m_curlHandle, CURLOPT_WRITEFUNCTION, vectWriter);  
+    curl_easy_setopt(m_curlHandle, CURLOPT_WRITEDATA, &result); 
 }
 
 //////////////////////////// 
-// EXECUTE  VECT
-void CLibCurlWrap::ExecuteVect( std::vector<uint8_t> & result )
+// EXECUTE
+void CLibCurlWrap::Execute()
 {
-    //clear out the vector
-    result.resize(0);
+    m_errorBuffer[0] = 0;
 
 	//perform the transfer
     const CURLcode returnCode = curl_easy_perform(m_curlHandle);
 
     if( CURLE_OK != returnCode )
     {
-        std::string curlError( errorBuffer );
+        std::string curlError( m_errorBuffer[0] ? m_errorBuffer : curl_easy_strerror( returnCode ) );
 
         apgHelper::throwRuntimeException( m_fileName, curlError, 
             __LINE__, Apg::ErrorType_Critical );
     }
-
 }
 
 //////////////////////////// 
@@ -14,6 +14,7 @@
 #define CLIBCURLWRAP_INCLUDE_H__ 
 
 #include "curl/curl.h"
+#include <mutex>
 #include <string>
 #include <vector>
 #include <stdint.h>
@@ -38,6 +39,12 @@ class CLibCurlWrap
             const std::string & postFields, 
             std::vector<uint8_t> & result);
 
+        // fetches big endian 16 bit samples, byte swapping each chunk
+        // straight into data as it arrives. returns the number of bytes
+        // the server sent, which can be more than the data fits.
+        size_t HttpGet(const std::string & url,
+            uint16_t * data, size_t numSamples);
+
 		void setTimeout( int timeout );
 		unsigned int getTimeout();
 
@@ -45,11 +52,16 @@ class CLibCurlWrap
     private:
 		unsigned int m_timeout;
 
-        void CurlSetupStrWrite(const std::string & url);
-        std::string ExecuteStr();
+        // the handle, and with it the connection to the camera, is reused
+        // by every request, requests from different threads are serialized
+        std::mutex m_mutex;
+        char m_errorBuffer[CURL_ERROR_SIZE];
+
+        void CurlSetupStrWrite(const std::string & url, std::string & result);
+        void CurlSetup(const std::string & url);
+        void Execute();
 
-        void CurlSetupVectWrite(const std::string & url, const std::vector<uint8_t> & result);
-        void ExecuteVect(std::vector<uint8_t> & result);
+        void CurlSetupVectWrite(const std::string & url, std::vector<uint8_t> & result);
 
         CURL * m_curlHandle;
         const std::string m_fileName;
@@ -0,0 +1,218 @@
+/*!
+* This Source Code Form is subject to the terms of the Mozilla Public
+* License, v. 2.0. If a copy of the MPL was not distributed with this file,
+* You can obtain one at http://mozilla.org/MPL/2.0/.
+*
+* \brief CLibCurlWrap against a loopback HTTP server that sends the image
+* in odd sized chunks, so big endian samples are split between writes
+*
+*/
+
+#include "libCurlWrap.h"
+
+#include <gtest/gtest.h>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace
+{
+    // sizes of the chunks the server writes, mostly odd
+    const size_t CHUNK_SIZES[] = { 1, 3, 7, 2, 5, 11, 4, 13, 4095, 1 };
+
+    uint16_t SampleAt( const size_t i )
+    {
+        return static_cast<uint16_t>( (i * 2654435761u) >> 13 );
+    }
+
+    std::vector<uint8_t> BigEndianSamples( const size_t count )
+    {
+        std::vector<uint8_t> bytes( count * 2 );
+        for( size_t i = 0; i < count; ++i )
+        {
+            bytes[2*i]   = static_cast<uint8_t>( SampleAt(i) >> 8 );
+            bytes[2*i+1] = static_cast<uint8_t>( SampleAt(i) & 0xFF );
+        }
+        return bytes;
+    }
+
+    // HTTP/1.1 server on 127.0.0.1 answering every GET with the same body.
+    // Each chunk goes out in its own segment with a pause in between, so
+    // curl hands it to the write callback on its own.
+    class LoopbackServer
+    {
+        public:
+            explicit LoopbackServer( const std::vector<uint8_t> & body ) :
+                m_body( body ), m_connections( 0 ), m_requests( 0 ), m_stop( false )
+            {
+                m_listen = socket( AF_INET, SOCK_STREAM, 0 );
+                int on = 1;
+                setsockopt( m_listen, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on) );
+
+                sockaddr_in addr = {};
+                addr.sin_family = AF_INET;
+                addr.sin_addr.s_addr = htonl( INADDR_LOOPBACK );
+                addr.sin_port = 0;
+                bind( m_listen, reinterpret_cast<sockaddr *>(&addr), sizeof(addr) );
+                listen( m_listen, 4 );
+
+                socklen_t len = sizeof(addr);
+                getsockname( m_listen, reinterpret_cast<sockaddr *>(&addr), &len );
+                m_port = ntohs( addr.sin_port );
+
+                m_thread = std::thread( &LoopbackServer::Run, this );
+            }
+
+            ~LoopbackServer()
+            {
+                m_stop = true;
+                shutdown( m_listen, SHUT_RDWR );
+                close( m_listen );
+                m_thread.join();
+            }
+
+            std::string Url() const
+            {
+                return "http://127.0.0.1:" + std::to_string( m_port ) + "/UE/image.bin";
+            }
+
+            int Connections() const { return m_connections; }
+            int Requests() const { return m_requests; }
+
+        private:
+            void Run()
+            {
+                while( !m_stop )
+                {
+                    const int fd = accept( m_listen, nullptr, nullptr );
+                    if( fd < 0 )
+                    {
+                        break;
+                    }
+                    ++m_connections;
+                    int on = 1;
+                    setsockopt( fd, IPPROTO_TCP, TCP_NODELAY, &on, sizeof(on) );
+                    while( ReadRequest( fd ) )
+                    {
+                        ++m_requests;
+                        SendResponse( fd );
+                    }
+                    close( fd );
+                }
+            }
+
+            bool ReadRequest( const int fd )
+            {
+                std::string request;
+                char c;
+                while( request.find( "\r\n\r\n" ) == std::string::npos )
+                {
+                    if( recv( fd, &c, 1, 0 ) != 1 )
+                    {
+                        return false;
+                    }
+                    request += c;
+                }
+                return true;
+            }
+
+            void Send( const int fd, const std::string & text )
+            {
+                send( fd, text.data(), text.size(), MSG_NOSIGNAL );
+            }
+
+            void SendResponse( const int fd )
+            {
+                Send( fd, "HTTP/1.1 200 OK\r\nContent-Type: application/octet-stream\r\n"
+                          "Transfer-Encoding: chunked\r\n\r\n" );
+
+                size_t offset = 0, n = 0;
+                while( offset < m_body.size() )
+                {
+                    const size_t nominal = CHUNK_SIZES[ n++ % (sizeof(CHUNK_SIZES) / sizeof(CHUNK_SIZES[0])) ];
+                    const size_t size = std::min( nominal, m_body.size() - offset );
+                    char header[32];
+                    snprintf( header, sizeof(header), "%zx\r\n", size );
+                    Send( fd, header + std::string( reinterpret_cast<const char *>(&m_body[offset]), size ) + "\r\n" );
+                    offset += size;
+                    std::this_thread::sleep_for( std::chrono::microseconds( 300 ) );
+                }
+                Send( fd, "0\r\n\r\n" );
+            }
+
+            std::vector<uint8_t> m_body;
+            int m_listen;
+            uint16_t m_port;
+            std::atomic<int> m_connections;
+            std::atomic<int> m_requests;
+            std::atomic<bool> m_stop;
+            std::thread m_thread;
+    };
+}
+
+TEST( LibCurlWrap, HttpGetSwapsOddChunks )
+{
+    const size_t numSamples = 3000;
+    LoopbackServer server( BigEndianSamples( numSamples ) );
+    CLibCurlWrap curl;
+
+    std::vector<uint16_t> data( numSamples, 0 );
+    EXPECT_EQ( curl.HttpGet( server.Url(), data.data(), data.size() ), numSamples * 2 );
+
+    for( size_t i = 0; i < numSamples; ++i )
+    {
+        ASSERT_EQ( data[i], SampleAt(i) ) << "sample " << i;
+    }
+}
+
+TEST( LibCurlWrap, HttpGetReportsLongResponse )
+{
+    const size_t numSamples = 1000;
+    LoopbackServer server( BigEndianSamples( numSamples + 7 ) );
+    CLibCurlWrap curl;
+
+    // the samples past numSamples are counted but not written
+    std::vector<uint16_t> data( numSamples + 16, 0xDEAD );
+    EXPECT_EQ( curl.HttpGet( server.Url(), data.data(), numSamples ), (numSamples + 7) * 2 );
+
+    for( size_t i = 0; i < numSamples; ++i )
+    {
+        ASSERT_EQ( data[i], SampleAt(i) ) << "sample " << i;
+    }
+    for( size_t i = numSamples; i < data.size(); ++i )
+    {
+        ASSERT_EQ( data[i], 0xDEAD ) << "sample " << i;
+    }
+}
+
+TEST( LibCurlWrap, HttpGetReusesConnection )
+{
+    const size_t numSamples = 500;
+    LoopbackServer server( BigEndianSamples( numSamples ) );
+    CLibCurlWrap curl;
+
+    std::vector<uint8_t> bytes;
+    curl.HttpGet( server.Url(), bytes );
+    EXPECT_EQ( bytes, BigEndianSamples( numSamples ) );
+
+    for( int pass = 0; pass < 3; ++pass )
+    {
+        std::vector<uint16_t> data( numSamples, 0 );
+        EXPECT_EQ( curl.HttpGet( server.Url(), data.data(), data.size() ), numSamples * 2 );
+        EXPECT_EQ( data.back(), SampleAt( numSamples - 1 ) );
+    }
+
+    EXPECT_EQ( server.Requests(), 4 );
+    EXPECT_EQ( server.Connections(), 1 );
+}
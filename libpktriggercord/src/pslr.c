@@ -63,6 +63,8 @@
 #define POLL_INTERVAL 50000 /* Number of us to wait when polling */
 #define BLKSZ 65536 /* Block size for downloads; if too big, we get
                      * memory allocation error from sg driver */
+#define MAX_BLKSZ (1024 * 1024) /* Block size limit for cameras with the new
+                                 * SCSI commands, if the sg driver allows it */
 #define BLOCK_RETRY 3 /* Number of retries, since we can occasionally
                        * get SCSI errors when downloading data */
 
@@ -79,6 +81,7 @@ static int ipslr_select_buffer(ipslr_handle_t *p, int bufno, pslr_buffer_type bu
 static int ipslr_buffer_segment_info(ipslr_handle_t *p, pslr_buffer_segment_info *pInfo);
 static int ipslr_next_segment(ipslr_handle_t *p);
 static int ipslr_download(ipslr_handle_t *p, uint32_t addr, uint32_t length, uint8_t *buf);
+static uint32_t ipslr_download_block_size(ipslr_handle_t *p);
 static int ipslr_identify(ipslr_handle_t *p);
 static int _ipslr_write_args(uint8_t cmd_2, ipslr_handle_t *p, int n, ...);
 #define ipslr_write_args(p,n,...) _ipslr_write_args(0,(p),(n),__VA_ARGS__)
@@ -425,6 +428,7 @@ int pslr_connect(pslr_handle_t h) {
         DPRINT("\nUnknown Pentax camera.\n");
         return -1;
     }
+    p->block_size = 0;
     CHECK(ipslr_status_full(p, &p->status));
     DPRINT("\tinit bufmask=0x%x\n", p->status.bufmask);
     if ( !p->model->old_scsi_command ) {
@@ -1093,8 +1097,8 @@ uint32_t pslr_buffer_read(pslr_handle_t h, uint8_t *buf, uint32_t size) {
     if (blksz > p->segments[i].length - seg_offs) {
         blksz = p->segments[i].length - seg_offs;
     }
-    if (blksz > BLKSZ) {
-        blksz = BLKSZ;
+    if (blksz > ipslr_download_block_size(p)) {
+        blksz = ipslr_download_block_size(p);
     }
 
 //    DPRINT("File offset %d segment: %d offset %d address 0x%x read size %d\n", p->offset,
@@ -1108,6 +1112,46 @@ uint32_t pslr_buffer_read(pslr_handle_t h, uint8_t *buf, uint32_t size) {
     return blksz;
 }
 
+/* Opt-in: cameras with the new SCSI commands download in larger blocks and
+ * are polled once per download instead of after every block. */
+void pslr_set_fast_download(pslr_handle_t h, bool enable) {
+    ipslr_handle_t *p = (ipslr_handle_t *) h;
+    DPRINT("[C]\tpslr_set_fast_download(%d)\n", enable);
+    if (p->fast_download != enable) {
+        p->fast_download = enable;
+        p->block_size = 0;
+    }
+}
+
+uint32_t pslr_buffer_read_full(pslr_handle_t h, uint8_t *buf, uint32_t size) {
+    ipslr_handle_t *p = (ipslr_handle_t *) h;
+    uint32_t i;
+    uint32_t pos = 0;
+    uint32_t done = 0;
+
+    DPRINT("[C]\tpslr_buffer_read_full(%d)\n", size);
+
+    /* One download per segment from the current offset, instead of one per block */
+    for (i = 0; i < p->segment_count && done < size; i++) {
+        uint32_t seg_end = pos + p->segments[i].length;
+        if (p->offset < seg_end) {
+            uint32_t seg_offs = p->offset - pos;
+            uint32_t len = p->segments[i].length - seg_offs;
+            if (len > size - done) {
+                len = size - done;
+            }
+            if (ipslr_download(p, p->segments[i].addr + seg_offs, len, buf + done) != PSLR_OK) {
+                pslr_write_log(PSLR_ERROR, "pslr_buffer_read_full: segment %u failed, read %u of %u bytes\n", i, done, size);
+                break;
+            }
+            p->offset += len;
+            done += len;
+        }
+        pos = seg_end;
+    }
+    return done;
+}
+
 uint32_t pslr_fullmemory_read(pslr_handle_t h, uint8_t *buf, uint32_t offset, uint32_t size) {
     ipslr_handle_t *p = (ipslr_handle_t *) h;
     int ret;
@@ -1428,18 +1472,34 @@ static int ipslr_buffer_segment_info(ipslr_handle_t *p, pslr_buffer_segment_info
     return PSLR_OK;
 }
 
+static uint32_t ipslr_download_block_size(ipslr_handle_t *p) {
+    if (p->block_size == 0) {
+        uint32_t max_transfer = scsi_get_max_transfer(p->fd);
+        p->block_size = BLKSZ;
+        if (p->fast_download && p->model && !p->model->old_scsi_command && max_transfer > BLKSZ) {
+            p->block_size = max_transfer < MAX_BLKSZ ? max_transfer : MAX_BLKSZ;
+        }
+        DPRINT("\tdownload block size: %d (driver limit %d)\n", p->block_size, max_transfer);
+    }
+    return p->block_size;
+}
+
 static int ipslr_download(ipslr_handle_t *p, uint32_t addr, uint32_t length, uint8_t *buf) {
     DPRINT("[C]\t\tipslr_download(address = 0x%X, length = %d)\n", addr, length);
     uint8_t downloadCmd[8] = {0xf0, 0x24, 0x06, 0x02, 0x00, 0x00, 0x00, 0x00};
     uint32_t block;
+    uint32_t blksz = ipslr_download_block_size(p);
     int n;
     int retry;
     uint32_t length_start = length;
+    /* By default every block is followed by a status poll. With fast download
+     * the newer cameras are polled before each read and once at the end. */
+    bool poll_each_block = !p->fast_download || p->model == NULL || p->model->old_scsi_command;
 
     retry = 0;
     while (length > 0) {
-        if (length > BLKSZ) {
-            block = BLKSZ;
+        if (length > blksz) {
+            block = blksz;
         } else {
             block = length;
         }
@@ -1450,9 +1510,18 @@ static int ipslr_download(ipslr_handle_t *p, uint32_t addr, uint32_t length, uin
         get_status(p->fd);
 
         n = scsi_read(p->fd, downloadCmd, sizeof (downloadCmd), buf, block);
-        get_status(p->fd);
+        if (poll_each_block || n < 0) {
+            get_status(p->fd);
+        }
 
         if (n < 0) {
+            if (blksz > BLKSZ) {
+                /* The camera or the driver refused the large block, keep the
+                 * default size for the rest of the session */
+                DPRINT("\tdownload of %d bytes failed, falling back to %d\n", blksz, BLKSZ);
+                blksz = p->block_size = BLKSZ;
+                continue;
+            }
             if (retry < BLOCK_RETRY) {
                 retry++;
                 continue;
@@ -1467,6 +1536,9 @@ static int ipslr_download(ipslr_handle_t *p, uint32_t addr, uint32_t length, uin
             progress_callback(length_start - length, length_start);
         }
     }
+    if (!poll_each_block) {
+        get_status(p->fd);
+    }
     return PSLR_OK;
 }
 
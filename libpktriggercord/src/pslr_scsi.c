@@ -23,7 +23,10 @@
     and GNU Lesser General Public License
     along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
-#if defined(WIN32) || defined(RAD10)
+#if defined(PSLR_SCSI_FAKE)
+/* In-memory camera for the unit tests */
+#include "pslr_scsi_fake.c"
+#elif defined(WIN32) || defined(RAD10)
 #include "pslr_scsi_win.c"
 #else
 /* Ugly hack. More generic ifs required */
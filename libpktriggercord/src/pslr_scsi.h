@@ -78,4 +78,7 @@ pslr_result get_drive_info(char* drive_name, FDTYPE* device,
                            char* product_id, int product_id_size_max);
 
 void close_drive(FDTYPE *device);
+
+/* Largest transfer in bytes the driver accepts for one command, 0 if unknown */
+uint32_t scsi_get_max_transfer(FDTYPE sg_fd);
 #endif
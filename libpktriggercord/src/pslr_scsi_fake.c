@@ -0,0 +1,145 @@
+/*
+    pkTriggerCord
+    Remote control of Pentax DSLR cameras.
+
+    In-memory SCSI backend for the unit tests, selected in pslr_scsi.c with
+    PSLR_SCSI_FAKE. It answers the commands of a download: argument writes,
+    status reads and block reads from a memory image of the camera buffer.
+    Every command succeeds at once, so there is never anything to wait for.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    and GNU Lesser General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "pslr_log.h"
+#include "pslr_model.h"
+#include "pslr_scsi.h"
+#include "pslr_scsi_fake.h"
+
+#define FAKE_MAX_ARGS 8
+
+static fake_scsi_config_t fake_config;
+static fake_scsi_stats_t fake_stats;
+static uint32_t fake_args[FAKE_MAX_ARGS];
+
+void fake_scsi_reset(const fake_scsi_config_t *config) {
+    fake_config = *config;
+    memset(&fake_stats, 0, sizeof (fake_stats));
+    memset(fake_args, 0, sizeof (fake_args));
+}
+
+fake_scsi_stats_t fake_scsi_stats(void) {
+    return fake_stats;
+}
+
+char **get_drives(int *drive_num) {
+    *drive_num = 0;
+    return NULL;
+}
+
+pslr_result get_drive_info(char* drive_name, FDTYPE* device,
+                           char* vendor_id, int vendor_id_size_max,
+                           char* product_id, int product_id_size_max) {
+    (void) drive_name;
+    (void) device;
+    (void) vendor_id_size_max;
+    (void) product_id_size_max;
+    vendor_id[0] = '\0';
+    product_id[0] = '\0';
+    return PSLR_DEVICE_ERROR;
+}
+
+void close_drive(FDTYPE *device) {
+    (void) device;
+}
+
+uint32_t scsi_get_max_transfer(FDTYPE sg_fd) {
+    (void) sg_fd;
+    return fake_config.max_transfer;
+}
+
+static int fake_download(uint8_t *buf, uint32_t bufLen) {
+    uint32_t addr = fake_args[0];
+    uint32_t length = fake_args[1];
+
+    if (length != bufLen || addr < fake_config.base_addr ||
+            addr - fake_config.base_addr + (uint64_t) length > fake_config.size) {
+        DPRINT("\tfake download out of range: 0x%X, %d\n", addr, length);
+        return -PSLR_SCSI_ERROR;
+    }
+    if (fake_config.refuse_above && length > fake_config.refuse_above) {
+        fake_stats.refused_blocks++;
+        return -PSLR_SCSI_ERROR;
+    }
+    if (fake_config.fail_addr && fake_config.fail_addr >= addr && fake_config.fail_addr < addr + length) {
+        fake_stats.failed_blocks++;
+        return -PSLR_SCSI_ERROR;
+    }
+    memcpy(buf, fake_config.memory + (addr - fake_config.base_addr), length);
+    fake_stats.blocks++;
+    if (length > fake_stats.largest_block) {
+        fake_stats.largest_block = length;
+    }
+    return length;
+}
+
+int scsi_read(FDTYPE sg_fd, uint8_t *cmd, uint32_t cmdLen,
+              uint8_t *buf, uint32_t bufLen) {
+    (void) sg_fd;
+    if (cmdLen < 8 || cmd[0] != 0xf0) {
+        return -PSLR_DEVICE_ERROR;
+    }
+    if (cmd[1] == 0x26) {
+        /* status: the last command is done, no error */
+        memset(buf, 0, bufLen);
+        if (bufLen >= 8) {
+            buf[6] = 0x01;
+        }
+        fake_stats.status_reads++;
+        return bufLen < 8 ? bufLen : 8;
+    }
+    if (cmd[1] == 0x24 && cmd[2] == 0x06) {
+        return fake_download(buf, bufLen);
+    }
+    DPRINT("\tfake read of unsupported command %02X %02X\n", cmd[1], cmd[2]);
+    return -PSLR_DEVICE_ERROR;
+}
+
+int scsi_write(FDTYPE sg_fd, uint8_t *cmd, uint32_t cmdLen,
+               uint8_t *buf, uint32_t bufLen) {
+    uint32_t i;
+    (void) sg_fd;
+    if (cmdLen < 8 || cmd[0] != 0xf0) {
+        return PSLR_DEVICE_ERROR;
+    }
+    if (cmd[1] == 0x4f) {
+        /* arguments, either all at once or one by one at offset cmd[2] */
+        for (i = 0; i + 4 <= bufLen; i += 4) {
+            uint32_t index = (cmd[2] + i) / 4;
+            if (index < FAKE_MAX_ARGS) {
+                fake_args[index] = fake_config.little_endian ? get_uint32_le(buf + i) : get_uint32_be(buf + i);
+            }
+        }
+        return PSLR_OK;
+    }
+    if (cmd[1] == 0x24) {
+        /* commands complete at once, the download itself is done by the read */
+        return PSLR_OK;
+    }
+    DPRINT("\tfake write of unsupported command %02X\n", cmd[1]);
+    return PSLR_DEVICE_ERROR;
+}
@@ -0,0 +1,59 @@
+/*
+    pkTriggerCord
+    Remote control of Pentax DSLR cameras.
+
+    In-memory SCSI backend used by the unit tests, see pslr_scsi_fake.c
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    and GNU Lesser General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef PSLR_SCSI_FAKE_H
+#define PSLR_SCSI_FAKE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct {
+    const uint8_t *memory;      /* camera memory visible to downloads */
+    uint32_t base_addr;         /* camera address of memory[0] */
+    uint32_t size;
+    bool little_endian;         /* byte order of the command arguments */
+    uint32_t max_transfer;      /* reported by scsi_get_max_transfer, 0 if unknown */
+    uint32_t refuse_above;      /* downloads larger than this fail, 0 for no limit */
+    uint32_t fail_addr;         /* downloads covering this address fail, 0 for none */
+} fake_scsi_config_t;
+
+typedef struct {
+    uint32_t blocks;            /* successful downloads */
+    uint32_t largest_block;
+    uint32_t refused_blocks;    /* downloads failed by refuse_above */
+    uint32_t failed_blocks;     /* downloads failed by fail_addr */
+    uint32_t status_reads;
+} fake_scsi_stats_t;
+
+/* Replaces the simulated camera and clears the statistics */
+void fake_scsi_reset(const fake_scsi_config_t *config);
+
+fake_scsi_stats_t fake_scsi_stats(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
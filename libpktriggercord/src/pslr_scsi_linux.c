@@ -36,6 +36,7 @@
 #endif
 #include <unistd.h>
 #include <dirent.h>
+#include <linux/fs.h>
 
 #include "pslr_log.h"
 #include "pslr_model.h"
@@ -174,6 +175,17 @@ void close_drive(int *device) {
     close( *device );
 }
 
+uint32_t scsi_get_max_transfer(int sg_fd) {
+#ifdef BLKSECTGET
+    int bytes = 0;
+    /* The sg driver reports the request queue limit in bytes */
+    if (ioctl(sg_fd, BLKSECTGET, &bytes) == 0 && bytes > 0) {
+        return bytes;
+    }
+#endif
+    return 0;
+}
+
 int scsi_read(int sg_fd, uint8_t *cmd, uint32_t cmdLen,
               uint8_t *buf, uint32_t bufLen) {
     sg_io_hdr_t io;
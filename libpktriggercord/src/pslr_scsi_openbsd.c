@@ -160,6 +160,10 @@ void close_drive(int *device) {
     close( *device );
 }
 
+uint32_t scsi_get_max_transfer(int sg_fd) {
+    return 0;
+}
+
 int scsi_read(int sg_fd, uint8_t *cmd, uint32_t cmdLen,
               uint8_t *buf, uint32_t bufLen) {
 
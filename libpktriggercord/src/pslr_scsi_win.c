@@ -168,6 +168,10 @@ void close_drive(int *device) {
     CloseHandle((HANDLE)*device);
 }
 
+uint32_t scsi_get_max_transfer(int sg_fd) {
+    return 0;
+}
+
 int scsi_read(int sg_fd, uint8_t *cmd, uint32_t cmdLen,
               uint8_t *buf, uint32_t bufLen) {
     SCSI_PASS_THROUGH_WITH_BUFFER sptdwb;
@@ -0,0 +1,214 @@
+/*
+    pkTriggerCord
+    Remote control of Pentax DSLR cameras.
+
+    Buffer downloads against the in-memory SCSI backend: block sizes,
+    status polls, the fallback from large blocks and partial reads.
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    and GNU Lesser General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <gtest/gtest.h>
+
+#include <cstring>
+#include <string>
+#include <vector>
+
+extern "C" {
+#include "pslr.h"
+#include "pslr_log.h"
+}
+#include "pslr_scsi_fake.h"
+
+namespace
+{
+
+const uint32_t BLKSZ = 65536;
+const uint32_t MAX_BLKSZ = 1024 * 1024;
+const uint32_t BUFFER_ADDR = 0x40000000;
+
+const uint32_t K5_ID = 0x12e76;     // new SCSI commands, big endian
+const uint32_t K3_ID = 0x12fc0;     // new SCSI commands, little endian
+const uint32_t ISTDS_ID = 0x12aa2;  // old SCSI commands
+
+class PslrDownload : public ::testing::Test
+{
+    protected:
+        void SetUp() override
+        {
+            pslr_set_verbosity(PSLR_ERROR);
+        }
+
+        // Camera buffer of two segments with a gap between them
+        void setUpCamera(uint32_t id, uint32_t length0, uint32_t length1)
+        {
+            memory.resize(length0 + 0x1000 + length1);
+            for (size_t i = 0; i < memory.size(); i++)
+            {
+                memory[i] = static_cast<uint8_t>((i * 2654435761u) >> 11);
+            }
+
+            memset(&handle, 0, sizeof(handle));
+            handle.id = id;
+            handle.model = pslr_find_model_by_id(id);
+            ASSERT_NE(handle.model, nullptr);
+            handle.segments[0].addr = BUFFER_ADDR;
+            handle.segments[0].length = length0;
+            handle.segments[1].addr = BUFFER_ADDR + length0 + 0x1000;
+            handle.segments[1].length = length1;
+            handle.segment_count = 2;
+
+            memset(&config, 0, sizeof(config));
+            config.memory = memory.data();
+            config.base_addr = BUFFER_ADDR;
+            config.size = memory.size();
+            config.little_endian = handle.model->is_little_endian;
+            config.max_transfer = 4 * 1024 * 1024;
+            fake_scsi_reset(&config);
+        }
+
+        // What the buffer should read as: both segments back to back
+        std::vector<uint8_t> expected() const
+        {
+            std::vector<uint8_t> bytes(memory.begin(), memory.begin() + handle.segments[0].length);
+            const auto second = memory.begin() + (handle.segments[1].addr - BUFFER_ADDR);
+            bytes.insert(bytes.end(), second, second + handle.segments[1].length);
+            return bytes;
+        }
+
+        uint32_t bufferSize() const
+        {
+            return handle.segments[0].length + handle.segments[1].length;
+        }
+
+        std::vector<uint8_t> memory;
+        ipslr_handle_t handle;
+        fake_scsi_config_t config;
+};
+
+}
+
+TEST_F(PslrDownload, DefaultUsesSmallBlocksAndPollsEachBlock)
+{
+    setUpCamera(K5_ID, 5 * BLKSZ + 100, 2 * BLKSZ);
+
+    std::vector<uint8_t> buf(bufferSize());
+    EXPECT_EQ(pslr_buffer_read_full(&handle, buf.data(), buf.size()), bufferSize());
+    EXPECT_EQ(buf, expected());
+
+    fake_scsi_stats_t stats = fake_scsi_stats();
+    EXPECT_EQ(handle.block_size, BLKSZ);
+    EXPECT_EQ(stats.largest_block, BLKSZ);
+    EXPECT_EQ(stats.blocks, 6u + 2u);
+    // before and after every block
+    EXPECT_EQ(stats.status_reads, 2 * stats.blocks);
+}
+
+TEST_F(PslrDownload, FastDownloadUsesLargeBlocks)
+{
+    setUpCamera(K3_ID, 3 * MAX_BLKSZ + 17, BLKSZ);
+    pslr_set_fast_download(&handle, true);
+
+    std::vector<uint8_t> buf(bufferSize());
+    EXPECT_EQ(pslr_buffer_read_full(&handle, buf.data(), buf.size()), bufferSize());
+    EXPECT_EQ(buf, expected());
+
+    fake_scsi_stats_t stats = fake_scsi_stats();
+    EXPECT_EQ(handle.block_size, MAX_BLKSZ);
+    EXPECT_EQ(stats.largest_block, MAX_BLKSZ);
+    EXPECT_EQ(stats.blocks, 4u + 1u);
+    // before every block and once at the end of each segment
+    EXPECT_EQ(stats.status_reads, stats.blocks + 2);
+}
+
+TEST_F(PslrDownload, FastDownloadKeepsToDriverLimit)
+{
+    setUpCamera(K5_ID, 4 * BLKSZ, BLKSZ);
+    config.max_transfer = 2 * BLKSZ;
+    fake_scsi_reset(&config);
+    pslr_set_fast_download(&handle, true);
+
+    std::vector<uint8_t> buf(bufferSize());
+    EXPECT_EQ(pslr_buffer_read_full(&handle, buf.data(), buf.size()), bufferSize());
+    EXPECT_EQ(buf, expected());
+    EXPECT_EQ(handle.block_size, 2 * BLKSZ);
+    EXPECT_EQ(fake_scsi_stats().largest_block, 2 * BLKSZ);
+}
+
+TEST_F(PslrDownload, RefusedLargeBlockFallsBack)
+{
+    setUpCamera(K5_ID, 2 * MAX_BLKSZ + 5, 3 * BLKSZ);
+    config.refuse_above = BLKSZ;
+    fake_scsi_reset(&config);
+    pslr_set_fast_download(&handle, true);
+
+    std::vector<uint8_t> buf(bufferSize());
+    EXPECT_EQ(pslr_buffer_read_full(&handle, buf.data(), buf.size()), bufferSize());
+    EXPECT_EQ(buf, expected());
+
+    fake_scsi_stats_t stats = fake_scsi_stats();
+    // one refused block, then the default size for the rest of the session
+    EXPECT_EQ(stats.refused_blocks, 1u);
+    EXPECT_EQ(handle.block_size, BLKSZ);
+    EXPECT_EQ(stats.largest_block, BLKSZ);
+    EXPECT_EQ(stats.blocks, 33u + 3u);
+}
+
+TEST_F(PslrDownload, OldCommandsKeepSmallBlocks)
+{
+    setUpCamera(ISTDS_ID, 3 * BLKSZ, BLKSZ + 1);
+    pslr_set_fast_download(&handle, true);
+
+    std::vector<uint8_t> buf(bufferSize());
+    EXPECT_EQ(pslr_buffer_read_full(&handle, buf.data(), buf.size()), bufferSize());
+    EXPECT_EQ(buf, expected());
+
+    fake_scsi_stats_t stats = fake_scsi_stats();
+    EXPECT_EQ(handle.block_size, BLKSZ);
+    EXPECT_EQ(stats.largest_block, BLKSZ);
+    EXPECT_EQ(stats.status_reads, 2 * stats.blocks);
+}
+
+TEST_F(PslrDownload, ReadsFromCurrentOffset)
+{
+    setUpCamera(K5_ID, 2 * BLKSZ, 2 * BLKSZ);
+
+    std::vector<uint8_t> buf(bufferSize());
+    const uint32_t first = BLKSZ + 10;
+    EXPECT_EQ(pslr_buffer_read_full(&handle, buf.data(), first), first);
+    EXPECT_EQ(pslr_buffer_read_full(&handle, buf.data() + first, buf.size() - first), bufferSize() - first);
+    EXPECT_EQ(buf, expected());
+}
+
+TEST_F(PslrDownload, FailureMidSegmentReturnsCompletedSegments)
+{
+    setUpCamera(K5_ID, 3 * BLKSZ, 4 * BLKSZ);
+    // second block of the second segment
+    config.fail_addr = handle.segments[1].addr + BLKSZ + 3;
+    fake_scsi_reset(&config);
+
+    std::vector<uint8_t> buf(bufferSize());
+    testing::internal::CaptureStderr();
+    const uint32_t read = pslr_buffer_read_full(&handle, buf.data(), buf.size());
+    const std::string log = testing::internal::GetCapturedStderr();
+
+    EXPECT_EQ(read, handle.segments[0].length);
+    EXPECT_EQ(handle.offset, handle.segments[0].length);
+    EXPECT_TRUE(std::equal(buf.begin(), buf.begin() + read, expected().begin()));
+    // the block is retried before giving up
+    EXPECT_EQ(fake_scsi_stats().failed_blocks, 4u);
+    EXPECT_NE(log.find("segment 1 failed, read " + std::to_string(read) + " of " + std::to_string(bufferSize())),
+              std::string::npos) << log;
+}
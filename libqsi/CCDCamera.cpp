@@ -2708,6 +2708,9 @@ int CCCDCamera::put_Connected(bool bCon)
 		m_pusBuffer = new USHORT [ m_DeviceDetails.ArrayColumns * m_DeviceDetails.ArrayRows ];
 		if( !m_pusBuffer ) 
 			return Error ( "Out of memory", IID_ICamera, MAKE_HRESULT(1,FACILITY_ITF, QSI_NOMEMORY) );
+
+		QSI_Registry rReg;
+		m_strImageCaptureFile = rReg.GetImageCaptureFile( std::string("") );
 		
 		m_bIsConnected = true;
 
@@ -2831,6 +2834,9 @@ int CCCDCamera::FillImageBuffer(bool bMakeRequest)
 	// Image is now in m_pusBuffer
 	//
 	csQSI.Unlock();
+
+	if (!m_strImageCaptureFile.empty())
+		CaptureImageBuffer(iStride);
 	
 	m_iError = GetAutoZeroData( bMakeRequest ); // true == issue autozero request to camera
 	if( m_iError != ALL_OK ) 
@@ -2842,6 +2848,25 @@ int CCCDCamera::FillImageBuffer(bool bMakeRequest)
 	return S_OK;
 }
 
+void CCCDCamera::CaptureImageBuffer(int iStride)
+{
+	// Appends the image as read from the camera, before hot pixel remap and auto zero,
+	// so qsireplay can run the readout again without a camera.
+	// The data is in host order, which is the camera's byte order on little endian hosts.
+	FILE * pFile = fopen(m_strImageCaptureFile.c_str(), "ab");
+	if (pFile == NULL)
+	{
+		m_QSIInterface.LogWrite(2, _T("Cannot open image capture file %s"), m_strImageCaptureFile.c_str());
+		return;
+	}
+	size_t bytes = (size_t)iStride * m_ExposureSettings.RowsToRead;
+	if (fwrite(m_pusBuffer, 1, bytes, pFile) != bytes)
+		m_QSIInterface.LogWrite(2, _T("Image capture write failed"));
+	fclose(pFile);
+	m_QSIInterface.LogWrite(2, _T("Captured %dx%d image to %s"), m_ExposureSettings.ColumnsToRead,
+							m_ExposureSettings.RowsToRead, m_strImageCaptureFile.c_str());
+}
+
 int CCCDCamera::GetAutoZeroData(bool bMakeRequest)
 {
 	int iPixelSize = sizeof(USHORT);
@@ -297,6 +297,7 @@ private:
 	void 	CloseCamera ( void );
 	int 	FillImageBuffer( bool bMakeRequest );
 	int		GetAutoZeroData(bool bMakeRequest );
+	void	CaptureImageBuffer( int iStride );
 
 	//////////////////////////////////////////////////////////////////////////////////////
 	// Private members
@@ -313,6 +314,7 @@ private:
 	int 						m_iError;				// Stores any errors and used to detect previous errors
 
 	std::string 				m_USBSerialNumber;
+	std::string 				m_strImageCaptureFile;	// Raw readouts are appended here when set
 	char						m_HWVersion[9];
 	char						m_FWVersion[9];
 	bool 						m_bIsMainCamera;
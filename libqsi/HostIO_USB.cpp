@@ -50,6 +50,7 @@ HostIO_USB::HostIO_USB(void)
 	m_IOTimeouts.StandardWrite = reg.GetUSBWriteTimeout( WRITE_TIMEOUT );
 	m_IOTimeouts.ExtendedRead = reg.GetUSBExReadTimeout( LONG_READ_TIMEOUT );
 	m_IOTimeouts.ExtendedWrite = reg.GetUSBExWriteTimeout( LONG_WRITE_TIMEOUT );
+	m_bLargeReadBlocks = reg.GetUSBLargeReadBlocks( 0 ) != 0;
 
 	this->m_log = new QSILog("QSIINTERFACELOG.TXT", "LOGUSBTOFILE", "USB");
 
@@ -498,8 +499,8 @@ int HostIO_USB::SetUSBParameters(DWORD dwInSize, DWORD dwOutSize)
 #if defined(USELIBFTDIZERO) || defined(USELIBFTDIONE)
 	m_iUSBStatus = 0;
 	if (dwInSize  != 0) 
-		// m_iUSBStatus = ftdi_read_data_set_chunksize(&m_ftdi, dwInSize);
-		ftdi_read_data_set_chunksize(&m_ftdi, 1<<14);
+		// One bulk transfer per image block only when the large read blocks are enabled
+		m_iUSBStatus = ftdi_read_data_set_chunksize(&m_ftdi, m_bLargeReadBlocks ? dwInSize : 1<<14);
 	if (dwOutSize != 0) 
 		m_iUSBStatus += ftdi_write_data_set_chunksize(&m_ftdi, dwOutSize);
 	m_iUSBStatus = -m_iUSBStatus;
@@ -543,10 +544,11 @@ int HostIO_USB::SetIOTimeout (IOTimeout ioTimeout)
 
 int HostIO_USB::MaxBytesPerReadBlock()
 {
-	// Maximum number of pixels (not bytes) to read per block
+	// Maximum number of bytes to read per block (ReadImageByRow divides it by the row size in bytes)
 	// Limited by ftdi constraints. 62 bytes of real data per packet, 510 for ft2232H
-	// Max is 65536 BYTES total
-	return 510 * 128 / 2;
+	// Max is 65536 BYTES total, so 128 full ft2232H packets. Half of that unless
+	// USBLargeReadBlocks is set, the size the cameras have always been read with.
+	return m_bLargeReadBlocks ? 510 * 128 : 510 * 128 / 2;
 }
 
 
@@ -72,6 +72,7 @@ private:
 	void* 			m_DLLHandle;        // Holds pointer to FTDI DLL in memory
 	bool 			m_bLoaded;          // True if the FTDI USB DLL is loaded
 	int 			m_iLoadStatus;      //
+	bool			m_bLargeReadBlocks;	// 64K image blocks and read chunks, USBLargeReadBlocks setting
 	std::vector<VidPid> 	m_vidpids;	// Table of Vendor and Product IDs to try
 	
 #if defined(USELIBFTDIZERO) || defined(USELIBFTDIONE)
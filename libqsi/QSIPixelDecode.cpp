@@ -0,0 +1,54 @@
+/*****************************************************************************************
+NAME
+ QSIPixelDecode
+
+DESCRIPTION
+ Pixel kernels for the image readout path
+
+COPYRIGHT (C)
+ QSI (Quantum Scientific Imaging) 2005-2006
+
+REVISION HISTORY
+ Split out of QSI_Interface
+******************************************************************************************/
+#include "QSIPixelDecode.h"
+#include <cstring>
+
+//////////////////////////////////////////////////////////////////////////////////////////
+//
+void QSI_UnpackPixels(const BYTE * pSrc, USHORT * pDst, size_t count)
+{
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+	for (size_t i = 0; i < count; i++)
+		pDst[i] = (USHORT)(pSrc[2 * i] | (pSrc[2 * i + 1] << 8));
+#else
+	if ((const void *)pSrc != (const void *)pDst)
+		memcpy(pDst, pSrc, count * sizeof(USHORT));
+#endif
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+//
+void QSI_AdjustZeroPixels(const USHORT * pSrc, USHORT * pDst, size_t count, int iAdjust, int iMaxADU,
+						  QSI_AdjustZeroStats & stats)
+{
+	int iNegPixelCount = 0;
+	int iSatPixelCount = 0;
+	int iLowPixel = 65535;
+
+	// Counts are accumulated with compares instead of ifs, which keeps the loop vectorizable
+	for (size_t i = 0; i < count; i++)
+	{
+		int pixel = (int)pSrc[i] + iAdjust;
+		iNegPixelCount += pixel < 0;
+		pixel = pixel < 0 ? 0 : pixel;
+		iLowPixel = pixel < iLowPixel ? pixel : iLowPixel;
+		iSatPixelCount += pixel > iMaxADU;
+		pixel = pixel > iMaxADU ? iMaxADU : pixel;
+		pDst[i] = (USHORT)pixel;
+	}
+
+	stats.NegPixels = iNegPixelCount;
+	stats.SatPixels = iSatPixelCount;
+	stats.LowPixel = iLowPixel;
+}
@@ -0,0 +1,39 @@
+/*****************************************************************************************
+NAME
+ QSIPixelDecode
+
+DESCRIPTION
+ Pixel kernels for the image readout path: conversion of the USB byte stream to host
+ order pixels and the auto zero (drift) adjustment. They do not depend on a camera
+ connection, so demo_src/qsireplay.cpp can run captured readouts through them.
+
+COPYRIGHT (C)
+ QSI (Quantum Scientific Imaging) 2005-2006
+
+REVISION HISTORY
+ Split out of QSI_Interface
+******************************************************************************************/
+#ifndef QSIPIXELDECODE_H
+#define QSIPIXELDECODE_H
+
+#include "WinTypes.h"
+#include <cstddef>
+
+struct QSI_AdjustZeroStats
+{
+	int NegPixels;		// Pixels clipped to zero by a negative adjustment
+	int SatPixels;		// Pixels clipped to the maximum ADU
+	int LowPixel;		// Lowest pixel after clipping to zero
+};
+
+// Pixels arrive from the camera as little endian 16 bit words. Converts count pixels
+// to host order. pSrc and pDst may be the same buffer, which is a no-op on little
+// endian hosts.
+void QSI_UnpackPixels(const BYTE * pSrc, USHORT * pDst, size_t count);
+
+// Adds iAdjust to count pixels and clips the result to 0..iMaxADU. pSrc and pDst
+// may be the same buffer. The loop has no branches so the compiler can vectorize it.
+void QSI_AdjustZeroPixels(const USHORT * pSrc, USHORT * pDst, size_t count, int iAdjust, int iMaxADU,
+						  QSI_AdjustZeroStats & stats);
+
+#endif
@@ -15,6 +15,7 @@ REVISION HISTORY
 #include "QSI_Interface.h"
 #include "IHostIO.h"
 #include "QSIError.h"
+#include "QSIPixelDecode.h"
 
 //////////////////////////////////////////////////////////////////////////////////////////
 // Constructor
@@ -384,6 +385,10 @@ int  QSI_Interface::ReadImageByRow(PVOID pvRxBuffer, int iRowsRequested, int iCo
 		return iError;
 	}
 
+	// Convert the block to host order in place, nothing to do on little endian hosts
+	if (iPixelSize == sizeof(USHORT))
+		QSI_UnpackPixels((BYTE *)pvRxBuffer, (USHORT *)pvRxBuffer, (size_t)iRowsRead * iColumnsRequested);
+
 	m_log->Write(2, _T("ReadImageByRow completed."));
 	return iError;
 }
@@ -2518,11 +2523,8 @@ void QSI_Interface::GetAutoZeroAdjustment(QSI_AutoZeroData autoZeroData, USHORT
 // AutoZero (drift adjust) the image using the median value of the zero data
 int QSI_Interface::AdjustZero(USHORT* pSrc, USHORT* pDst, int iPixelsPerRow, int iRowsLeft, int usAdjust, bool bAdjust)
 {
-	int pixel;
 	int result;
-	int iNegPixelCount;
-	int iLowPixel;
-	int iSatPixelCount;
+	QSI_AdjustZeroStats stats;
 
 	m_log->Write(2, _T("AutoZero adjust pixels (unsigned short) started."));
 
@@ -2534,62 +2536,38 @@ int QSI_Interface::AdjustZero(USHORT* pSrc, USHORT* pDst, int iPixelsPerRow, int
 		bAdjust = false;
 	}
 
-	m_log->Write(6, _T("First row of un-adjusted image data (up to the first 512 bytes):"));
-
-	int iSampleSize = iPixelsPerRow  > 512 ? 512 : iPixelsPerRow;
-	int iLines = (iSampleSize / 16);
-	if (iSampleSize % 16 > 0)
-		iLines++;
-
-	for (int i = 0; i < iLines; i++)
+	if (m_log->LoggingEnabled(6))
 	{
-		for (int j = 0; j < 16 && iSampleSize > 0; j++)
-		{
-			snprintf(m_log->m_Message+(j*6), MSGSIZE, _T("%5u "), ((unsigned short*)pSrc)[(i*16)+j]);
-			iSampleSize--;
-		}
-		m_log->Write(6);
-	}
+		m_log->Write(6, _T("First row of un-adjusted image data (up to the first 512 bytes):"));
 
-	//
-	// Now drift adjust the image
-	//
-	iSatPixelCount = 0;
-	iNegPixelCount = 0;
-	iLowPixel = 65535;
-	//
-	// Break up adjustment into rows with pad
-	//
+		int iSampleSize = iPixelsPerRow  > 512 ? 512 : iPixelsPerRow;
+		int iLines = (iSampleSize / 16);
+		if (iSampleSize % 16 > 0)
+			iLines++;
 
-	USHORT* psrc = pSrc;
-	USHORT* pdst = pDst;
-	while (iRowsLeft-- > 0)
-	{
-		for (int i = 0; i < iPixelsPerRow; i++)
+		for (int i = 0; i < iLines; i++)
 		{
-			pixel = *psrc++;
-			if (bAdjust) pixel = pixel + (int)usAdjust;
-			if (pixel < 0) 
-			{
-				pixel = 0; 				//result = ERR_IFC_NegAutoZero;
-				iNegPixelCount++;
-			}
-			if (pixel < iLowPixel) 
-				iLowPixel = pixel;
-			if (pixel > (int)m_dwAutoZeroMaxADU)
+			for (int j = 0; j < 16 && iSampleSize > 0; j++)
 			{
-				pixel = (int)m_dwAutoZeroMaxADU;
-				iSatPixelCount++;
+				snprintf(m_log->m_Message+(j*6), MSGSIZE, _T("%5u "), ((unsigned short*)pSrc)[(i*16)+j]);
+				iSampleSize--;
 			}
-			*pdst++ = (USHORT)pixel;
+			m_log->Write(6);
 		}
 	}
 
-	if (m_log->LoggingEnabled(6) || (m_log->LoggingEnabled(1) && iNegPixelCount > 0) )
+	//
+	// Now drift adjust the image.
+	// Rows are contiguous (no pad), so the whole image goes through the kernel at once.
+	//
+	size_t count = (size_t)iPixelsPerRow * (iRowsLeft > 0 ? iRowsLeft : 0);
+	QSI_AdjustZeroPixels(pSrc, pDst, count, bAdjust ? usAdjust : 0, (int)m_dwAutoZeroMaxADU, stats);
+
+	if (m_log->LoggingEnabled(6) || (m_log->LoggingEnabled(1) && stats.NegPixels > 0) )
 	{
 		m_log->Write(6, _T("AutoZero Data:"));
 		snprintf(m_log->m_Message, MSGSIZE, _T("NegPixels: %d, Lowest Net Pixel: %d, Pixels Exceeding Sat Threshold : %d"),
-											 iNegPixelCount, iLowPixel, iSatPixelCount );
+											 stats.NegPixels, stats.LowPixel, stats.SatPixels );
 		m_log->Write(6);
 	}
 
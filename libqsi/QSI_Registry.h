@@ -262,12 +262,26 @@ public:
 		return GetNumber(KEY_Base, "MaxPixelsPerBlock", iDefaultValue);
 	}
 
+	////////////////////////////////////////////////////////////////////////////////////////
+	// Raw image data of every readout is appended to this file, for use with qsireplay
+	std::string GetImageCaptureFile( std::string strDefault )
+	{
+		return GetString(KEY_Base, "ImageCaptureFile", strDefault);
+	}
+
 	////////////////////////////////////////////////////////////////////////////////////////
 	int GetUSBInSize( int iDefaultValue )
 	{
 		return GetNumber(KEY_Base, "USBInSize", iDefaultValue);
 	}
 
+	////////////////////////////////////////////////////////////////////////////////////////
+	// Nonzero reads each image block in one 64K USB transfer instead of 16K chunks
+	int GetUSBLargeReadBlocks( int iDefaultValue )
+	{
+		return GetNumber(KEY_Base, "USBLargeReadBlocks", iDefaultValue);
+	}
+
 	////////////////////////////////////////////////////////////////////////////////////////
 	int GetUSBOutSize( int iDefaultValue )
 	{
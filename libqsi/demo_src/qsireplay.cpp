@@ -0,0 +1,174 @@
+//
+// qsireplay.cpp
+//
+// Runs image readouts captured with the ImageCaptureFile setting through the
+// pixel path of the library (block unpack and auto zero adjust), without a camera.
+// Used to benchmark the decoder and to check it against a known good output.
+//
+#include "QSIPixelDecode.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <unistd.h>
+
+static void usage(const char * progname)
+{
+	printf("usage: %s [options] width height capturefile\n", progname);
+	printf("options:\n");
+	printf("  -b bytes   USB read block size in bytes (default 32640, 65280 with USBLargeReadBlocks)\n");
+	printf("  -a adjust  auto zero adjustment added to every pixel (default 0)\n");
+	printf("  -m maxadu  saturation level (default 65535)\n");
+	printf("  -n count   number of passes over the capture (default 10)\n");
+	printf("  -o file    write the decoded frames to file\n");
+	printf("  -c file    compare the decoded frames with file, exit 1 on mismatch\n");
+}
+
+static bool readFile(const char * path, std::vector<BYTE> & data)
+{
+	FILE * f = fopen(path, "rb");
+	if (f == NULL)
+		return false;
+	fseek(f, 0, SEEK_END);
+	long size = ftell(f);
+	fseek(f, 0, SEEK_SET);
+	data.resize(size > 0 ? size : 0);
+	bool ok = size >= 0 && fread(data.data(), 1, data.size(), f) == data.size();
+	fclose(f);
+	return ok;
+}
+
+int main(int argc, char * argv[])
+{
+	int blockBytes = 510 * 128 / 2;
+	int adjust = 0;
+	int maxADU = 65535;
+	int passes = 10;
+	const char * outFile = NULL;
+	const char * compareFile = NULL;
+
+	int c;
+	while ((c = getopt(argc, argv, "b:a:m:n:o:c:h")) != EOF)
+	{
+		switch (c)
+		{
+			case 'b': blockBytes = atoi(optarg); break;
+			case 'a': adjust = atoi(optarg); break;
+			case 'm': maxADU = atoi(optarg); break;
+			case 'n': passes = atoi(optarg); break;
+			case 'o': outFile = optarg; break;
+			case 'c': compareFile = optarg; break;
+			default:
+				usage(argv[0]);
+				return EXIT_FAILURE;
+		}
+	}
+
+	if (argc - optind != 3 || passes < 1)
+	{
+		usage(argv[0]);
+		return EXIT_FAILURE;
+	}
+
+	int width = atoi(argv[optind]);
+	int height = atoi(argv[optind + 1]);
+	if (width <= 0 || height <= 0)
+	{
+		fprintf(stderr, "invalid frame size %sx%s\n", argv[optind], argv[optind + 1]);
+		return EXIT_FAILURE;
+	}
+
+	std::vector<BYTE> capture;
+	if (!readFile(argv[optind + 2], capture))
+	{
+		fprintf(stderr, "cannot read %s\n", argv[optind + 2]);
+		return EXIT_FAILURE;
+	}
+
+	size_t rowBytes = (size_t)width * sizeof(USHORT);
+	size_t frameBytes = rowBytes * height;
+	size_t frames = capture.size() / frameBytes;
+	if (frames == 0)
+	{
+		fprintf(stderr, "capture holds %zu bytes, less than one %dx%d frame\n", capture.size(), width, height);
+		return EXIT_FAILURE;
+	}
+	if (capture.size() % frameBytes != 0)
+		fprintf(stderr, "ignoring %zu trailing bytes\n", capture.size() % frameBytes);
+
+	// Same block size calculation as QSI_Interface::ReadImageByRow
+	int rowsPerBlock = blockBytes / (int)rowBytes;
+	if (rowsPerBlock == 0)
+		rowsPerBlock = 1;
+
+	std::vector<USHORT> readout((size_t)width * height);
+	std::vector<USHORT> output(readout.size() * frames);
+	double unpackSeconds = 0;
+	double adjustSeconds = 0;
+	QSI_AdjustZeroStats stats;
+	memset(&stats, 0, sizeof(stats));
+
+	for (int pass = 0; pass < passes; pass++)
+	{
+		for (size_t frame = 0; frame < frames; frame++)
+		{
+			const BYTE * pFrame = capture.data() + frame * frameBytes;
+
+			// Blocks land in the readout buffer as the USB reads would deliver them
+			auto start = std::chrono::steady_clock::now();
+			for (int row = 0; row < height; row += rowsPerBlock)
+			{
+				int rows = height - row < rowsPerBlock ? height - row : rowsPerBlock;
+				size_t offset = row * rowBytes;
+				QSI_UnpackPixels(pFrame + offset, (USHORT *)((BYTE *)readout.data() + offset), (size_t)rows * width);
+			}
+			auto unpacked = std::chrono::steady_clock::now();
+			QSI_AdjustZeroPixels(readout.data(), output.data() + frame * readout.size(), readout.size(), adjust, maxADU, stats);
+			auto adjusted = std::chrono::steady_clock::now();
+
+			unpackSeconds += std::chrono::duration<double>(unpacked - start).count();
+			adjustSeconds += std::chrono::duration<double>(adjusted - unpacked).count();
+		}
+	}
+
+	double megabytes = (double)frameBytes * frames * passes / (1024.0 * 1024.0);
+	printf("%zu frame(s) of %dx%d, %d rows per block, %d pass(es)\n", frames, width, height, rowsPerBlock, passes);
+	printf("unpack: %8.3f ms/frame %10.1f MB/s\n", unpackSeconds * 1000.0 / (frames * passes), megabytes / unpackSeconds);
+	printf("adjust: %8.3f ms/frame %10.1f MB/s\n", adjustSeconds * 1000.0 / (frames * passes), megabytes / adjustSeconds);
+	printf("last frame: %d negative, %d saturated, lowest %d\n", stats.NegPixels, stats.SatPixels, stats.LowPixel);
+
+	size_t outputBytes = output.size() * sizeof(USHORT);
+	if (outFile != NULL)
+	{
+		FILE * f = fopen(outFile, "wb");
+		if (f == NULL || fwrite(output.data(), 1, outputBytes, f) != outputBytes)
+		{
+			fprintf(stderr, "cannot write %s\n", outFile);
+			if (f != NULL)
+				fclose(f);
+			return EXIT_FAILURE;
+		}
+		fclose(f);
+	}
+
+	if (compareFile != NULL)
+	{
+		std::vector<BYTE> expected;
+		if (!readFile(compareFile, expected))
+		{
+			fprintf(stderr, "cannot read %s\n", compareFile);
+			return EXIT_FAILURE;
+		}
+		if (expected.size() != outputBytes || memcmp(expected.data(), output.data(), outputBytes) != 0)
+		{
+			printf("output differs from %s\n", compareFile);
+			return EXIT_FAILURE;
+		}
+		printf("output matches %s\n", compareFile);
+	}
+
+	return EXIT_SUCCESS;
+}